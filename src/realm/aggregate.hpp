@@ -21,6 +21,7 @@
 
 #include <realm/column_type_traits.hpp>
 #include <realm/array.hpp>
+#include <realm/array_basic.hpp>
 #include <realm/query_conditions.hpp>
 
 namespace realm {
@@ -45,23 +46,82 @@ inline bool is_null<double>(const double& v)
     return null::is_null_float(v);
 }
 
+template <Action action, class Condition, class LeafType, class T, class R>
+bool find_generic(const LeafType& leaf, T target, QueryState<R>& state)
+{
+    Condition cond;
+    bool cont = true;
+    bool null_target = is_null(target);
+    size_t sz = leaf.size();
+    for (size_t local_index = 0; cont && local_index < sz; local_index++) {
+        auto v = leaf.get(local_index);
+        if (cond(v, target, is_null(v), null_target)) {
+            cont = state.template match<action, false>(local_index, 0, v);
+        }
+    }
+    return cont;
+}
+
 template <class LeafType>
 struct FindInLeaf {
 
     template <Action action, class Condition, class T, class R>
     static bool find(const LeafType& leaf, T target, QueryState<R>& state)
     {
-        Condition cond;
-        bool cont = true;
-        bool null_target = is_null(target);
-        size_t sz = leaf.size();
-        for (size_t local_index = 0; cont && local_index < sz; local_index++) {
-            auto v = leaf.get(local_index);
-            if (cond(v, target, is_null(v), null_target)) {
-                cont = state.template match<action, false>(local_index, 0, v);
+        return find_generic<action, Condition>(leaf, target, state);
+    }
+};
+
+// Float and double leaves. Sum, max and min over all non-null entries are
+// computed by the vectorized leaf kernels and folded into the state, which
+// gives the same result as matching the entries one by one.
+template <class V>
+struct FindInBasicArray {
+
+    template <Action action, class Condition, class LeafType, class T, class R>
+    static bool find(const LeafType& leaf, T target, QueryState<R>& state)
+    {
+        constexpr bool all_non_null = std::is_same<Condition, None>::value || std::is_same<Condition, NotNull>::value;
+        if constexpr (all_non_null && (action == act_Sum || action == act_Max || action == act_Min)) {
+            if (state.m_limit == size_t(-1)) {
+                size_t count;
+                if constexpr (action == act_Sum) {
+                    state.m_state += leaf.sum_not_null(count);
+                }
+                else {
+                    V m = state.m_state;
+                    size_t ndx = action == act_Max ? leaf.maximum_not_null(m, count) : leaf.minimum_not_null(m, count);
+                    if (ndx != npos) {
+                        state.m_state = m;
+                        state.m_minmax_index =
+                            state.m_key_values ? state.m_key_values->get(ndx) + state.m_key_offset : int64_t(ndx);
+                    }
+                }
+                state.m_match_count += count;
+                return true;
             }
         }
-        return cont;
+        return find_generic<action, Condition>(leaf, target, state);
+    }
+};
+
+template <class V>
+struct FindInLeaf<BasicArray<V>> {
+
+    template <Action action, class Condition, class T, class R>
+    static bool find(const BasicArray<V>& leaf, T target, QueryState<R>& state)
+    {
+        return FindInBasicArray<V>::template find<action, Condition>(leaf, target, state);
+    }
+};
+
+template <class V>
+struct FindInLeaf<BasicArrayNull<V>> {
+
+    template <Action action, class Condition, class T, class R>
+    static bool find(const BasicArrayNull<V>& leaf, T target, QueryState<R>& state)
+    {
+        return FindInBasicArray<V>::template find<action, Condition>(leaf, target, state);
     }
 };
 
@@ -253,6 +253,23 @@ SlabAlloc::FreeBlock* SlabAlloc::get_next_block_if_mergeable(SlabAlloc::FreeBloc
 SlabAlloc::FreeList SlabAlloc::find(int size)
 {
     FreeList retval;
+    if (size <= small_block_limit) {
+        // Find the first list of small blocks of at least this size that
+        // is not empty
+        size_t list_ndx = size_t(size) / 8;
+        size_t word_ndx = list_ndx / bits_per_word;
+        // Mask out the lists before `list_ndx` in its word
+        size_t word = m_small_block_bitmap[word_ndx] & (~size_t(0) << (list_ndx % bits_per_word));
+        for (;;) {
+            if (word) {
+                retval.size = int((word_ndx * bits_per_word + size_t(ctz(word))) * 8);
+                return retval;
+            }
+            if (++word_ndx == sizeof m_small_block_bitmap / sizeof m_small_block_bitmap[0])
+                break;
+            word = m_small_block_bitmap[word_ndx];
+        }
+    }
     retval.it = m_block_map.lower_bound(size);
     if (retval.it != m_block_map.end()) {
         retval.size = retval.it->first;
@@ -266,21 +283,44 @@ SlabAlloc::FreeList SlabAlloc::find(int size)
 SlabAlloc::FreeList SlabAlloc::find_larger(FreeList hint, int size)
 {
     int needed_size = size + sizeof(BetweenBlocks) + sizeof(FreeBlock);
-    while (hint.it != m_block_map.end() && hint.it->first < needed_size)
-        ++hint.it;
-    if (hint.it == m_block_map.end())
-        hint.size = 0; // indicate "not found"
-    return hint;
+    if (hint.found_something() && hint.size >= needed_size)
+        return hint;
+    return find(needed_size);
+}
+
+SlabAlloc::FreeBlock*& SlabAlloc::freelist_head(int size)
+{
+    if (size <= small_block_limit)
+        return m_small_blocks[size / 8];
+    return m_block_map[size]; // Throws
+}
+
+void SlabAlloc::erase_freelist(int size)
+{
+    if (size <= small_block_limit) {
+        size_t list_ndx = size_t(size) / 8;
+        m_small_blocks[list_ndx] = nullptr;
+        m_small_block_bitmap[list_ndx / bits_per_word] &= ~(size_t(1) << (list_ndx % bits_per_word));
+    }
+    else {
+        m_block_map.erase(size);
+    }
 }
 
 SlabAlloc::FreeBlock* SlabAlloc::pop_freelist_entry(FreeList list)
 {
-    FreeBlock* retval = list.it->second;
+    FreeBlock*& head = list.size <= small_block_limit ? m_small_blocks[list.size / 8] : list.it->second;
+    FreeBlock* retval = head;
     FreeBlock* header = retval->next;
-    if (header == retval)
-        m_block_map.erase(list.it);
-    else
-        list.it->second = header;
+    if (header == retval) {
+        if (list.size <= small_block_limit)
+            erase_freelist(list.size);
+        else
+            m_block_map.erase(list.it);
+    }
+    else {
+        head = header;
+    }
     retval->unlink();
     return retval;
 }
@@ -297,15 +337,16 @@ void SlabAlloc::FreeBlock::unlink()
 void SlabAlloc::remove_freelist_entry(FreeBlock* entry)
 {
     int size = bb_before(entry)->block_after_size;
-    auto it = m_block_map.find(size);
-    REALM_ASSERT_EX(it != m_block_map.end(), get_file_path_for_assertions());
-    auto header = it->second;
-    if (header == entry) {
-        header = entry->next;
-        if (header == entry)
-            m_block_map.erase(it);
-        else
-            it->second = header;
+    FreeBlock*& head = freelist_head(size);
+    REALM_ASSERT_EX(head, get_file_path_for_assertions());
+    if (head == entry) {
+        FreeBlock* header = entry->next;
+        if (header == entry) {
+            entry->unlink();
+            erase_freelist(size);
+            return;
+        }
+        head = header;
     }
     entry->unlink();
 }
@@ -313,21 +354,21 @@ void SlabAlloc::remove_freelist_entry(FreeBlock* entry)
 void SlabAlloc::push_freelist_entry(FreeBlock* entry)
 {
     int size = bb_before(entry)->block_after_size;
-    FreeBlock* header;
-    auto it = m_block_map.find(size);
-    if (it != m_block_map.end()) {
-        header = it->second;
-        it->second = entry;
+    FreeBlock*& header = freelist_head(size); // Throws
+    if (header) {
         entry->next = header;
         entry->prev = header->prev;
         entry->prev->next = entry;
         entry->next->prev = entry;
     }
     else {
-        header = nullptr;
-        m_block_map[size] = entry;
         entry->next = entry->prev = entry;
+        if (size <= small_block_limit) {
+            size_t list_ndx = size_t(size) / 8;
+            m_small_block_bitmap[list_ndx / bits_per_word] |= size_t(1) << (list_ndx % bits_per_word);
+        }
     }
+    header = entry;
 }
 
 void SlabAlloc::mark_freed(FreeBlock* entry, int size)
@@ -395,6 +436,8 @@ SlabAlloc::FreeBlock* SlabAlloc::slab_to_entry(const Slab& slab, ref_type ref_st
 void SlabAlloc::clear_freelists()
 {
     m_block_map.clear();
+    std::fill(std::begin(m_small_blocks), std::end(m_small_blocks), nullptr);
+    std::fill(std::begin(m_small_block_bitmap), std::end(m_small_block_bitmap), 0);
 }
 
 void SlabAlloc::rebuild_freelists_from_slab()
@@ -814,6 +857,10 @@ ref_type SlabAlloc::attach_file(const std::string& file_path, Config& cfg)
             }
         }
     }
+    catch (const UnsupportedEncryptionFormat&) {
+        note_reader_end(this);
+        throw InvalidDatabase("Realm file is encrypted in an unsupported format", path);
+    }
     catch (const DecryptionFailed&) {
         note_reader_end(this);
         throw InvalidDatabase("Realm file decryption failed", path);
@@ -1036,9 +1083,17 @@ void SlabAlloc::reset_free_space_tracking()
     // been commited to persistent space)
     m_free_read_only.clear();
 
-    // release slabs.. keep the initial allocation if it's a minimal allocation,
-    // otherwise release it as well. This saves map/unmap for small transactions.
-    while (m_slabs.size() > 1 || (m_slabs.size() == 1 && m_slabs[0].size > minimal_alloc)) {
+    // release slabs.. keep the first ones as long as they fit within the
+    // retention budget, by default only the initial allocation if it's a
+    // minimal allocation. This saves map/unmap and touching fresh pages for
+    // the following transactions.
+    size_t num_retained = 0;
+    size_t retained_size = 0;
+    while (num_retained < m_slabs.size() && retained_size + m_slabs[num_retained].size <= m_cfg.slab_retention) {
+        retained_size += m_slabs[num_retained].size;
+        ++num_retained;
+    }
+    while (m_slabs.size() > num_retained) {
         auto& last_slab = m_slabs.back();
         auto& last_translation = m_ref_translation_ptr[m_translation_table_size - 1];
         REALM_ASSERT(last_translation.mapping_addr == last_slab.addr);
@@ -1118,6 +1173,8 @@ void SlabAlloc::update_reader_view(size_t file_size)
     REALM_ASSERT_EX(m_attach_mode == attach_SharedFile || m_attach_mode == attach_UnsharedFile, m_attach_mode, get_file_path_for_assertions());
     REALM_ASSERT_DEBUG(is_free_space_clean());
     bool requires_new_translation = false;
+    // Only prefetch the file when it is first mapped
+    const int map_flags = old_baseline == 0 ? m_cfg.map_flags : m_cfg.map_flags & ~File::map_WillNeed;
 
     // Extend mapping by adding sections, potentially replacing older sections
     const auto old_slab_base = align_size_to_section_boundary(old_baseline);
@@ -1140,7 +1197,7 @@ void SlabAlloc::update_reader_view(size_t file_size)
             // extension cannot possibly happen if we alread have a xover mapping established
             REALM_ASSERT(!cur_entry.xover_mapping.is_attached());
             cur_entry.primary_mapping =
-                util::File::Map<char>(m_file, section_start_offset, File::access_ReadOnly, section_size);
+                util::File::Map<char>(m_file, section_start_offset, File::access_ReadOnly, section_size, map_flags);
             m_mapping_version++;
         }
         else { // extension stretches over multiple sections:
@@ -1162,7 +1219,8 @@ void SlabAlloc::update_reader_view(size_t file_size)
                 // A xover mapping cannot be present in this case:
                 REALM_ASSERT(!cur_entry.xover_mapping.is_attached());
                 cur_entry.primary_mapping =
-                    util::File::Map<char>(m_file, section_start_offset, File::access_ReadOnly, section_size);
+                    util::File::Map<char>(m_file, section_start_offset, File::access_ReadOnly, section_size,
+                                          map_flags);
                 m_mapping_version++;
             }
 
@@ -1179,7 +1237,8 @@ void SlabAlloc::update_reader_view(size_t file_size)
                 const size_t section_start_offset = get_section_base(k);
                 const size_t section_size = 1 << section_shift;
                 m_mappings[k].primary_mapping =
-                    util::File::Map<char>(m_file, section_start_offset, File::access_ReadOnly, section_size);
+                    util::File::Map<char>(m_file, section_start_offset, File::access_ReadOnly, section_size,
+                                          map_flags);
             }
 
             // 3. add a final partial mapping if needed
@@ -1188,7 +1247,8 @@ void SlabAlloc::update_reader_view(size_t file_size)
                 const size_t section_start_offset = get_section_base(num_full_mappings);
                 const size_t section_size = file_size - section_start_offset;
                 m_mappings[num_full_mappings].primary_mapping =
-                    util::File::Map<char>(m_file, section_start_offset, File::access_ReadOnly, section_size);
+                    util::File::Map<char>(m_file, section_start_offset, File::access_ReadOnly, section_size,
+                                          map_flags);
             }
         }
     }
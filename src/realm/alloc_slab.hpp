@@ -105,6 +105,18 @@ public:
     /// Always initialize the file as if it was a newly
     /// created file and ignore any pre-existing contents. Requires that
     /// Config::session_initiator be true as well.
+    ///
+    /// \var Config::map_flags
+    /// Access hints for the mappings of the file, a combination of
+    /// util::File::map_Sequential, map_Random, map_WillNeed and
+    /// map_HugePages. map_WillNeed only applies to the mappings made when the
+    /// file is attached.
+    ///
+    /// \var Config::slab_retention
+    /// The slabs holding the arrays written by a transaction are kept for
+    /// the next one, as long as their total size does not exceed this many
+    /// bytes. Slabs are added in order of increasing size, so the first ones
+    /// are kept.
     struct Config {
         bool is_shared = false;
         bool read_only = false;
@@ -114,6 +126,8 @@ public:
         bool clear_file = false;
         bool disable_sync = false;
         const char* encryption_key = nullptr;
+        int map_flags = 0;
+        size_t slab_retention = 128 * 1024;
     };
 
     struct Retry {
@@ -433,11 +447,22 @@ private:
     using FreeListMap = std::map<int, FreeBlock*>; // log(N) addressing for larger blocks
     FreeListMap m_block_map;
 
+    // Free blocks of up to small_block_limit bytes are kept in a list per
+    // size, indexed by size / 8, as most arrays copied on write are small.
+    // A bit is set in m_small_block_bitmap for every list that is not empty,
+    // so the smallest list holding blocks of at least a given size is found
+    // by scanning a few words.
+    constexpr static int small_block_limit = 2048;
+    constexpr static size_t num_small_block_lists = small_block_limit / 8 + 1;
+    constexpr static size_t bits_per_word = sizeof(size_t) * 8;
+    FreeBlock* m_small_blocks[num_small_block_lists] = {};
+    size_t m_small_block_bitmap[(num_small_block_lists + bits_per_word - 1) / bits_per_word] = {};
+
     // abstract notion of a freelist - used to hide whether a freelist
     // is residing in the small blocks or the large blocks structures.
     struct FreeList {
         int size = 0; // size of every element in the list, 0 if not found
-        FreeListMap::iterator it;
+        FreeListMap::iterator it; // only used for sizes above small_block_limit
         bool found_something()
         {
             return size != 0;
@@ -494,6 +519,9 @@ private:
     FreeList find(int size);
     FreeList find_larger(FreeList hint, int size);
     FreeBlock* pop_freelist_entry(FreeList list);
+    // the first entry of the list of blocks of the given size, or nullptr
+    FreeBlock*& freelist_head(int size);
+    void erase_freelist(int size);
     void push_freelist_entry(FreeBlock* entry);
     void remove_freelist_entry(FreeBlock* element);
     void rebuild_freelists_from_slab();
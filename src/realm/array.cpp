@@ -20,6 +20,7 @@
 #include <cstring> // std::memcpy
 #include <iomanip>
 #include <limits>
+#include <memory>
 #include <tuple>
 
 #ifdef REALM_DEBUG
@@ -42,6 +43,7 @@
 #include <realm/index_string.hpp>
 #include <realm/array_integer.hpp>
 #include <realm/array_key.hpp>
+#include <realm/array_string_compact.hpp>
 #include <realm/impl/array_writer.hpp>
 
 
@@ -59,6 +61,10 @@
 // |--------|--------|--------|--------|--------|--------|--------|--------|
 // |             checksum              |12344555|           size           |
 //
+// The reserved byte marks arrays that may be packed when written to the file,
+// and a packed array keeps its number of bits per element in it, in memory
+// as well as in place of the last byte of the checksum.
+//
 //
 //  1: 'is_inner_bptree_node' (inner node of B+-tree).
 //
@@ -73,6 +79,7 @@
 //        0    |  number of bits      |  ceil(width * size / 8)
 //        1    |  number of bytes     |  width * size
 //        2    |  ignored             |  size
+//        3    |  width before packing|  16 + 8 * ceil(bits * size / 64)
 //
 //  5: 'width_ndx' (3 bits)
 //
@@ -90,6 +97,22 @@
 // including the header.
 //
 //
+// Packed arrays:
+// --------------
+//
+// An array of integers without refs may be written to the file in a frame of
+// reference encoding (width scheme 3), when that makes it smaller:
+//
+//   --> | min | max | o_1 o_2 ... o_N |
+//
+// Here `min` and `max` are the smallest and the largest element as 64-bit
+// integers, and `o_i` is the i'th element minus `min`, stored as an unsigned
+// integer of as many bits as the difference between `max` and `min` needs,
+// packed back to back into 64-bit words from the least significant bit. A
+// packed array is only read. It is unpacked to its previous width when it is
+// modified.
+//
+//
 // Inner node of B+-tree:
 // ----------------------
 //
@@ -281,11 +304,71 @@ void Array::destroy_children(size_t offset) noexcept
 }
 
 
+namespace {
+
+// The checksum of a packed array ends with its number of bits per element
+uint32_t packed_checksum(int bits) noexcept
+{
+    char bytes[4] = {'A', 'A', 'A', char(bits)};
+    uint32_t checksum;
+    std::memcpy(&checksum, bytes, 4);
+    return checksum;
+}
+
+} // anonymous namespace
+
 ref_type Array::do_write_shallow(_impl::ArrayWriterBase& out) const
 {
     // Write flat array
     const char* header = get_header_from_data(m_data);
     size_t byte_size = get_byte_size();
+    if (m_packed)
+        return out.write_array(header, byte_size, packed_checksum(m_width)); // Throws
+
+    // The only arrays of multiplied width that may be packed are leaves of
+    // short strings
+    if (out.compact_strings() && get_packable_from_header(header) &&
+        get_wtype_from_header(header) == wtype_Multiply) {
+        ref_type new_ref = ArrayStringCompact::write(header, out); // Throws
+        if (new_ref != 0)
+            return new_ref;
+    }
+
+    if (out.pack_integers() && get_packable_from_header(header) && !m_has_refs && m_size > 0 &&
+        get_wtype_from_header(header) == wtype_Bits) {
+        int64_t min = get(0);
+        int64_t max = min;
+        for (size_t i = 1; i < m_size; ++i) {
+            int64_t v = get(i);
+            if (v < min)
+                min = v;
+            if (v > max)
+                max = v;
+        }
+        uint64_t range = uint64_t(max) - uint64_t(min);
+        int bits = 0;
+        while (bits < 64 && (range >> bits) != 0)
+            ++bits;
+        size_t packed_byte_size = calc_byte_size(wtype_Packed, m_size, bits);
+        if (bits < 64 && packed_byte_size < byte_size) {
+            std::unique_ptr<uint64_t[]> buffer(new uint64_t[packed_byte_size / 8]()); // Throws
+            char* packed_header = reinterpret_cast<char*>(buffer.get());
+            // The width is kept for when the array is unpacked
+            init_header(packed_header, m_is_inner_bptree_node, m_has_refs, m_context_flag, wtype_Packed, m_width,
+                        m_size, packed_byte_size);
+            set_packed_bits_in_header(bits, packed_header);
+            char* packed_data = get_data_from_header(packed_header);
+            *reinterpret_cast<int64_t*>(packed_data) = min;
+            *reinterpret_cast<int64_t*>(packed_data + 8) = max;
+            for (size_t i = 0; i < m_size; ++i)
+                set_packed_offset(packed_data, bits, i, uint64_t(get(i)) - uint64_t(min));
+            ref_type new_ref = out.write_array(packed_header, packed_byte_size, packed_checksum(bits)); // Throws
+            REALM_ASSERT_3(new_ref % 8, ==, 0);
+            out.require_extended_file_format();
+            return new_ref;
+        }
+    }
+
     uint32_t dummy_checksum = 0x41414141UL;                                // "AAAA" in ASCII
     ref_type new_ref = out.write_array(header, byte_size, dummy_checksum); // Throws
     REALM_ASSERT_3(new_ref % 8, ==, 0);                                    // 8-byte alignment
@@ -356,6 +439,7 @@ void Array::move(Array& dst, size_t ndx)
     size_t dest_begin = dst.m_size;
     size_t nb_to_move = m_size - ndx;
     dst.copy_on_write();
+    dst.ensure_minimum_width(this->m_lbound);
     dst.ensure_minimum_width(this->m_ubound);
     dst.alloc(dst.m_size + nb_to_move, dst.m_width); // Make room for the new elements
 
@@ -443,6 +527,9 @@ void Array::insert(size_t ndx, int_fast64_t value)
 {
     REALM_ASSERT_DEBUG(ndx <= m_size);
 
+    if (m_packed)
+        unpack(); // Throws
+
     const auto old_width = m_width;
     const auto old_size = m_size;
     const Getter old_getter = m_getter; // Save old getter before potential width expansion
@@ -561,6 +648,11 @@ void Array::truncate_and_destroy_children(size_t new_size)
 
 void Array::do_ensure_minimum_width(int_fast64_t value)
 {
+    if (m_packed) {
+        unpack(); // Throws
+        if (value >= m_lbound && value <= m_ubound)
+            return;
+    }
 
     // Make room for the new value
     const size_t width = bit_width(value);
@@ -581,7 +673,7 @@ void Array::do_ensure_minimum_width(int_fast64_t value)
 
 void Array::set_all_to_zero()
 {
-    if (m_size == 0 || m_width == 0)
+    if (m_size == 0 || (m_width == 0 && !m_packed))
         return;
 
     copy_on_write(); // Throws
@@ -723,8 +815,6 @@ size_t find_zero(uint64_t v)
 template <bool find_max, size_t w>
 bool Array::minmax(int64_t& result, size_t start, size_t end, size_t* return_ndx) const
 {
-    size_t best_index = 0;
-
     if (end == size_t(-1))
         end = m_size;
     REALM_ASSERT_11(start, <, m_size, &&, end, <=, m_size, &&, start, <, end);
@@ -732,6 +822,8 @@ bool Array::minmax(int64_t& result, size_t start, size_t end, size_t* return_ndx
     if (m_size == 0)
         return false;
 
+    size_t best_index = start;
+
     if (w == 0) {
         if (return_ndx)
             *return_ndx = best_index;
@@ -742,51 +834,24 @@ bool Array::minmax(int64_t& result, size_t start, size_t end, size_t* return_ndx
     int64_t m = get<w>(start);
     ++start;
 
-#if 0 // We must now return both value AND index of result. SSE does not support finding index, so we've disabled it
-#ifdef REALM_COMPILER_SSE
-    if (sseavx<42>()) {
-        // Test manually until 128 bit aligned
-        for (; (start < end) && (((size_t(m_data) & 0xf) * 8 + start * w) % (128) != 0); start++) {
-            if (find_max ? get<w>(start) > m : get<w>(start) < m) {
-                m = get<w>(start);
-                best_index = start;
-            }
-        }
-
-        if ((w == 8 || w == 16 || w == 32) && end - start > 2 * sizeof (__m128i) * 8 / no0(w)) {
-            __m128i* data = reinterpret_cast<__m128i*>(m_data + start * w / 8);
-            __m128i state = data[0];
-            char state2[sizeof (state)];
-
-            size_t chunks = (end - start) * w / 8 / sizeof (__m128i);
-            for (size_t t = 0; t < chunks; t++) {
-                if (w == 8)
-                    state = find_max ? _mm_max_epi8(data[t], state) : _mm_min_epi8(data[t], state);
-                else if (w == 16)
-                    state = find_max ? _mm_max_epi16(data[t], state) : _mm_min_epi16(data[t], state);
-                else if (w == 32)
-                    state = find_max ? _mm_max_epi32(data[t], state) : _mm_min_epi32(data[t], state);
-
-                start += sizeof (__m128i) * 8 / no0(w);
-            }
-
-            // Todo: prevent taking address of 'state' to make the compiler keep it in SSE register in above loop (vc2010/gcc4.6)
-
-            // We originally had declared '__m128i state2' and did an 'state2 = state' assignment. When we read from state2 through int16_t, int32_t or int64_t in GetUniversal(),
-            // the compiler thinks it cannot alias state2 and hence reorders the read and assignment.
-
-            // In this fixed version using memcpy, we have char-read-access from __m128i (OK aliasing) and char-write-access to char-array, and finally int8/16/32/64
-            // read access from char-array (OK aliasing).
-            memcpy(&state2, &state, sizeof state);
-            for (size_t t = 0; t < sizeof (__m128i) * 8 / no0(w); ++t) {
-                int64_t v = get_universal<w>(reinterpret_cast<char*>(&state2), t);
-                if (find_max ? v > m : v < m) {
+#ifdef REALM_COMPILER_AVX
+    if constexpr (w >= 8) {
+        // The vectors only give us the value, so find its first occurrence afterwards. Unlike the scalar loop
+        // below, both passes run at vector speed.
+        if (sseavx<2>() && end - start >= 2 * 256 / w) {
+            size_t begin = start - 1;
+            m = minmax_avx2<find_max, w>(m, start, end);
+            for (; start < end; ++start) {
+                const int64_t v = get<w>(start);
+                if (find_max ? v > m : v < m)
                     m = v;
-                }
             }
+            result = m;
+            if (return_ndx)
+                *return_ndx = find_first(m, begin, end);
+            return true;
         }
     }
-#endif
 #endif
 
     for (; start < end; ++start) {
@@ -803,18 +868,85 @@ bool Array::minmax(int64_t& result, size_t start, size_t end, size_t* return_ndx
     return true;
 }
 
+#ifdef REALM_COMPILER_AVX
+template <bool find_max, size_t w>
+REALM_TARGET_AVX2 int64_t Array::minmax_avx2(int64_t m, size_t& start, size_t end) const
+{
+    constexpr size_t elements_per_vector = 256 / w;
+    __m256i state;
+    if constexpr (w == 8)
+        state = _mm256_set1_epi8(static_cast<char>(m));
+    else if constexpr (w == 16)
+        state = _mm256_set1_epi16(static_cast<short int>(m));
+    else if constexpr (w == 32)
+        state = _mm256_set1_epi32(static_cast<int>(m));
+    else
+        state = _mm256_set1_epi64x(m);
+
+    for (; end - start >= elements_per_vector; start += elements_per_vector) {
+        __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(m_data + start * w / 8));
+        if constexpr (w == 8)
+            state = find_max ? _mm256_max_epi8(data, state) : _mm256_min_epi8(data, state);
+        else if constexpr (w == 16)
+            state = find_max ? _mm256_max_epi16(data, state) : _mm256_min_epi16(data, state);
+        else if constexpr (w == 32)
+            state = find_max ? _mm256_max_epi32(data, state) : _mm256_min_epi32(data, state);
+        else {
+            // There is no 64 bit min/max before AVX-512
+            __m256i data_greater = _mm256_cmpgt_epi64(data, state);
+            state = find_max ? _mm256_blendv_epi8(state, data, data_greater)
+                             : _mm256_blendv_epi8(data, state, data_greater);
+        }
+    }
+
+    char lanes[sizeof(__m256i)];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), state);
+    for (size_t t = 0; t < elements_per_vector; ++t) {
+        int64_t v = get_universal<w>(lanes, t);
+        if (find_max ? v > m : v < m)
+            m = v;
+    }
+    return m;
+}
+#endif
+
 bool Array::maximum(int64_t& result, size_t start, size_t end, size_t* return_ndx) const
 {
+    if (m_packed) {
+        QueryState<int64_t> state(act_Max);
+        find_packed<None, act_Max>(0, start, end, 0, &state, CallbackDummy());
+        if (state.m_match_count == 0)
+            return false;
+        result = state.m_state;
+        if (return_ndx)
+            *return_ndx = state.m_minmax_index;
+        return true;
+    }
     REALM_TEMPEX2(return minmax, true, m_width, (result, start, end, return_ndx));
 }
 
 bool Array::minimum(int64_t& result, size_t start, size_t end, size_t* return_ndx) const
 {
+    if (m_packed) {
+        QueryState<int64_t> state(act_Min);
+        find_packed<None, act_Min>(0, start, end, 0, &state, CallbackDummy());
+        if (state.m_match_count == 0)
+            return false;
+        result = state.m_state;
+        if (return_ndx)
+            *return_ndx = state.m_minmax_index;
+        return true;
+    }
     REALM_TEMPEX2(return minmax, false, m_width, (result, start, end, return_ndx));
 }
 
 int64_t Array::sum(size_t start, size_t end) const
 {
+    if (m_packed) {
+        QueryState<int64_t> state(act_Sum);
+        find_packed<None, act_Sum>(0, start, end, 0, &state, CallbackDummy());
+        return state.m_state;
+    }
     REALM_TEMPEX(return sum, m_width, (start, end));
 }
 
@@ -986,6 +1118,12 @@ int64_t Array::sum(size_t start, size_t end) const
 
 size_t Array::count(int64_t value) const noexcept
 {
+    if (m_packed) {
+        QueryState<int64_t> state(act_Count);
+        find_packed<Equal, act_Count>(value, 0, m_size, 0, &state, CallbackDummy());
+        return size_t(state.m_state);
+    }
+
     const uint64_t* next = reinterpret_cast<uint64_t*>(m_data);
     size_t value_count = 0;
     const size_t end = m_size;
@@ -1377,9 +1515,38 @@ struct Array::VTableForWidth {
 template <size_t width>
 const typename Array::VTableForWidth<width>::PopulatedVTable Array::VTableForWidth<width>::vtable;
 
+struct Array::VTableForPacked {
+    struct PopulatedVTable : Array::VTable {
+        PopulatedVTable()
+        {
+            getter = &Array::get_packed;
+            setter = nullptr; // A packed array is unpacked before it is modified
+            chunk_getter = &Array::get_chunk_packed;
+            finder[cond_Equal] = &Array::find_packed<Equal, act_ReturnFirst>;
+            finder[cond_NotEqual] = &Array::find_packed<NotEqual, act_ReturnFirst>;
+            finder[cond_Greater] = &Array::find_packed<Greater, act_ReturnFirst>;
+            finder[cond_Less] = &Array::find_packed<Less, act_ReturnFirst>;
+        }
+    };
+    static const PopulatedVTable vtable;
+};
+
+const Array::VTableForPacked::PopulatedVTable Array::VTableForPacked::vtable;
+
 void Array::update_width_cache_from_header() noexcept
 {
-    auto width = get_width_from_header(get_header());
+    const char* header = get_header();
+    m_packed = get_wtype_from_header(header) == wtype_Packed;
+    if (REALM_UNLIKELY(m_packed)) {
+        m_width = get_packed_bits_from_header(header);
+        m_lbound = get_packed_min(m_data);
+        m_ubound = get_packed_max(m_data);
+        m_vtable = &VTableForPacked::vtable;
+        m_getter = m_vtable->getter;
+        return;
+    }
+
+    auto width = get_width_from_header(header);
     m_lbound = lbound_for_width(width);
     m_ubound = ubound_for_width(width);
 
@@ -1389,6 +1556,52 @@ void Array::update_width_cache_from_header() noexcept
     m_getter = m_vtable->getter;
 }
 
+int64_t Array::get_packed(size_t ndx) const noexcept
+{
+    return get_packed_direct(m_data, m_width, ndx);
+}
+
+void Array::get_chunk_packed(size_t ndx, int64_t res[8]) const noexcept
+{
+    REALM_ASSERT_3(ndx, <, m_size);
+    size_t i = 0;
+    for (; i + ndx < m_size && i < 8; i++)
+        res[i] = get_packed(ndx + i);
+
+    for (; i < 8; i++)
+        res[i] = 0;
+}
+
+void Array::unpack()
+{
+    REALM_ASSERT_DEBUG(m_packed);
+    char* old_header = get_header_from_data(m_data);
+    ref_type old_ref = m_ref;
+    size_t width = get_width_from_header(old_header);
+
+    // The array is likely about to grow, so leave some room as
+    // Node::do_copy_on_write() does
+    size_t byte_size = calc_byte_size(wtype_Bits, m_size, width) + 64;
+    MemRef mem = m_alloc.alloc(byte_size); // Throws
+    char* header = mem.get_addr();
+    init_header(header, m_is_inner_bptree_node, m_has_refs, m_context_flag, wtype_Bits, int(width), m_size,
+                byte_size);
+    char* data = get_data_from_header(header);
+    for (size_t i = 0; i < m_size; ++i) {
+        int64_t value = get_packed(i);
+        REALM_TEMPEX(set_direct, width, (data, i, value));
+    }
+
+    m_ref = mem.get_ref();
+    m_data = data;
+    update_width_cache_from_header();
+    update_parent(); // Throws
+
+    // Mark original as deleted, so that the space can be reclaimed in
+    // future commits, when no versions are using it anymore
+    m_alloc.free_(old_ref, old_header);
+}
+
 // This method reads 8 concecutive values into res[8], starting from index 'ndx'. It's allowed for the 8 values to
 // exceed array length; in this case, remainder of res[8] will be left untouched.
 template <size_t w>
@@ -1559,8 +1772,13 @@ void Array::verify() const
 #ifdef REALM_DEBUG
     REALM_ASSERT(is_attached());
 
-    REALM_ASSERT(m_width == 0 || m_width == 1 || m_width == 2 || m_width == 4 || m_width == 8 || m_width == 16 ||
-                 m_width == 32 || m_width == 64);
+    REALM_ASSERT(m_packed || m_width == 0 || m_width == 1 || m_width == 2 || m_width == 4 || m_width == 8 ||
+                 m_width == 16 || m_width == 32 || m_width == 64);
+    if (m_packed) {
+        REALM_ASSERT(!m_has_refs);
+        REALM_ASSERT_3(m_width, <, 64);
+        REALM_ASSERT_3(m_lbound, <=, m_ubound);
+    }
 
     if (!get_parent())
         return;
@@ -1573,11 +1791,35 @@ void Array::verify() const
 
 size_t Array::lower_bound_int(int64_t value) const noexcept
 {
+    if (m_packed) {
+        size_t lo = 0;
+        size_t hi = m_size;
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (get_packed(mid) < value)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return lo;
+    }
     REALM_TEMPEX(return lower_bound, m_width, (m_data, m_size, value));
 }
 
 size_t Array::upper_bound_int(int64_t value) const noexcept
 {
+    if (m_packed) {
+        size_t lo = 0;
+        size_t hi = m_size;
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (get_packed(mid) <= value)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return lo;
+    }
     REALM_TEMPEX(return upper_bound, m_width, (m_data, m_size, value));
 }
 
@@ -1591,6 +1833,10 @@ void Array::find_all(IntegerColumn* result, int64_t value, size_t col_offset, si
         end = m_size;
 
     QueryState<int64_t> state(act_FindAll, result);
+    if (m_packed) {
+        find_packed<Equal, act_FindAll>(value, begin, end, col_offset, &state, CallbackDummy());
+        return;
+    }
     REALM_TEMPEX3(find, Equal, act_FindAll, m_width, (value, begin, end, col_offset, &state, CallbackDummy()));
 
     return;
@@ -1631,6 +1877,8 @@ size_t Array::find_first(int64_t value, size_t start, size_t end) const
 int_fast64_t Array::get(const char* header, size_t ndx) noexcept
 {
     const char* data = get_data_from_header(header);
+    if (REALM_UNLIKELY(get_wtype_from_header(header) == wtype_Packed))
+        return get_packed_direct(data, get_packed_bits_from_header(header), ndx);
     uint_least8_t width = get_width_from_header(header);
     return get_direct(data, width, ndx);
 }
@@ -1639,6 +1887,10 @@ int_fast64_t Array::get(const char* header, size_t ndx) noexcept
 std::pair<int64_t, int64_t> Array::get_two(const char* header, size_t ndx) noexcept
 {
     const char* data = get_data_from_header(header);
+    if (REALM_UNLIKELY(get_wtype_from_header(header) == wtype_Packed)) {
+        size_t bits = get_packed_bits_from_header(header);
+        return std::make_pair(get_packed_direct(data, bits, ndx), get_packed_direct(data, bits, ndx + 1));
+    }
     uint_least8_t width = get_width_from_header(header);
     std::pair<int64_t, int64_t> p = ::get_two(data, width, ndx);
     return std::make_pair(p.first, p.second);
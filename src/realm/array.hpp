@@ -58,6 +58,7 @@ Searching: The main finding function is:
 #include <realm/column_fwd.hpp>
 #include <realm/array_direct.hpp>
 #include <realm/array_unsigned.hpp>
+#include <realm/impl/array_writer.hpp>
 
 /*
     MMX: mmintrin.h
@@ -73,6 +74,9 @@ Searching: The main finding function is:
 #include <emmintrin.h>             // SSE2
 #include <realm/realm_nmmintrin.h> // SSE42
 #endif
+#ifdef REALM_COMPILER_AVX
+#include <immintrin.h> // AVX2, AVX-512 (only used in functions compiled with REALM_TARGET_AVX2/AVX512)
+#endif
 
 namespace realm {
 
@@ -258,9 +262,13 @@ public:
 
     void alloc(size_t init_size, size_t new_width)
     {
+        if (m_packed)
+            unpack(); // Throws
         REALM_ASSERT_3(m_width, ==, get_width_from_header(get_header()));
         REALM_ASSERT_3(m_size, ==, get_size_from_header(get_header()));
         Node::alloc(init_size, new_width);
+        if (m_packable)
+            set_packable_in_header(true, get_header());
         update_width_cache_from_header();
     }
 
@@ -458,6 +466,31 @@ public:
     bool find(Action action, int64_t value, size_t start, size_t end, size_t baseindex, QueryState<int64_t>* state,
               bool nullable_array = false, bool find_null = false) const
     {
+        if (m_packed) {
+            if (action == act_ReturnFirst)
+                return find_packed<cond, act_ReturnFirst>(value, start, end, baseindex, state, CallbackDummy(),
+                                                          nullable_array, find_null);
+            if (action == act_Sum)
+                return find_packed<cond, act_Sum>(value, start, end, baseindex, state, CallbackDummy(),
+                                                  nullable_array, find_null);
+            if (action == act_Min)
+                return find_packed<cond, act_Min>(value, start, end, baseindex, state, CallbackDummy(),
+                                                  nullable_array, find_null);
+            if (action == act_Max)
+                return find_packed<cond, act_Max>(value, start, end, baseindex, state, CallbackDummy(),
+                                                  nullable_array, find_null);
+            if (action == act_Count)
+                return find_packed<cond, act_Count>(value, start, end, baseindex, state, CallbackDummy(),
+                                                    nullable_array, find_null);
+            if (action == act_FindAll)
+                return find_packed<cond, act_FindAll>(value, start, end, baseindex, state, CallbackDummy(),
+                                                      nullable_array, find_null);
+            if (action == act_CallbackIdx)
+                return find_packed<cond, act_CallbackIdx>(value, start, end, baseindex, state, CallbackDummy(),
+                                                          nullable_array, find_null);
+            REALM_ASSERT_DEBUG(false);
+            return false;
+        }
         if (action == act_ReturnFirst) {
             REALM_TEMPEX3(return find, cond, act_ReturnFirst, m_width,
                                  (value, start, end, baseindex, state, CallbackDummy(), nullable_array, find_null))
@@ -514,6 +547,16 @@ public:
               QueryState<int64_t>* state, Callback callback) const;
     */
 
+    // Search of a packed array. The elements are compared as offsets from the
+    // smallest one where the condition allows it.
+    template <class cond, Action action, class Callback>
+    bool find_packed(int64_t value, size_t start, size_t end, size_t baseindex, QueryState<int64_t>* state,
+                     Callback callback, bool nullable_array = false, bool find_null = false) const;
+
+    // This is the one installed into the finder slots of packed arrays.
+    template <class cond, Action action>
+    bool find_packed(int64_t value, size_t start, size_t end, size_t baseindex, QueryState<int64_t>* state) const;
+
     // Optimized implementation for release mode
     template <class cond, Action action, size_t bitwidth, class Callback>
     bool find_optimized(int64_t value, size_t start, size_t end, size_t baseindex, QueryState<int64_t>* state,
@@ -580,6 +623,24 @@ public:
 
 #endif
 
+// AVX2 / AVX-512 find for the four functions Equal/NotEqual/Less/Greater. They search whole vectors from 'start'
+// and leave 'start' at the first element not searched, which the caller must handle with compare().
+#ifdef REALM_COMPILER_AVX
+    template <class cond, Action action, size_t width, class Callback>
+    REALM_TARGET_AVX2 bool find_avx2(int64_t value, size_t& start, size_t end, size_t baseindex,
+                                     QueryState<int64_t>* state, Callback callback) const;
+
+    // Only for Equal/NotEqual on 1, 2 and 4 bit elements. Skips vectors without any match and hands the others
+    // to compare(). 'start' must be at a byte boundary.
+    template <class cond, Action action, size_t width, class Callback>
+    REALM_TARGET_AVX2 bool find_avx2_packed(int64_t value, size_t& start, size_t end, size_t baseindex,
+                                            QueryState<int64_t>* state, Callback callback) const;
+
+    template <class cond, Action action, size_t width, class Callback>
+    REALM_TARGET_AVX512 bool find_avx512(int64_t value, size_t& start, size_t end, size_t baseindex,
+                                         QueryState<int64_t>* state, Callback callback) const;
+#endif
+
     template <size_t width>
     inline bool test_zero(uint64_t value) const; // Tests value for 0-elements
 
@@ -671,9 +732,33 @@ protected:
     // for the given bit width. Valid widths are 0, 1, 2, 4, 8, 16, 32, and 64.
     static int_fast64_t ubound_for_width(size_t width) noexcept;
 
+protected:
+    using Node::copy_on_write;
+
+    /// Same as Node::copy_on_write(), but also unpacks a packed array, and
+    /// marks the array as one that may be packed if this is an integer leaf.
+    void copy_on_write()
+    {
+        if (m_packed) {
+            unpack(); // Throws
+        }
+        else {
+            Node::copy_on_write(); // Throws
+        }
+        if (m_packable)
+            set_packable_in_header(true, get_header());
+    }
+
 private:
     void update_width_cache_from_header() noexcept;
 
+    /// Replace a packed array by a copy in the width it had before it was
+    /// packed.
+    void unpack();
+
+    int64_t get_packed(size_t ndx) const noexcept;
+    void get_chunk_packed(size_t ndx, int64_t res[8]) const noexcept;
+
     void do_ensure_minimum_width(int_fast64_t);
 
     int64_t sum(size_t start, size_t end) const;
@@ -689,6 +774,12 @@ private:
     template <bool max, size_t w>
     bool minmax(int64_t& result, size_t start, size_t end, size_t* return_ndx) const;
 
+#ifdef REALM_COMPILER_AVX
+    // Folds whole 256 bit vectors from 'start' into 'm' and leaves 'start' at the first element not visited
+    template <bool max, size_t w>
+    REALM_TARGET_AVX2 int64_t minmax_avx2(int64_t m, size_t& start, size_t end) const;
+#endif
+
 protected:
     /// It is an error to specify a non-zero value unless the width
     /// type is wtype_Bits. It is also an error to specify a non-zero
@@ -718,6 +809,7 @@ protected:
     };
     template <size_t w>
     struct VTableForWidth;
+    struct VTableForPacked;
 
 protected:
     /// Takes a 64-bit value and returns the minimum number of bits needed
@@ -739,6 +831,10 @@ protected:
     bool m_is_inner_bptree_node; // This array is an inner node of B+-tree.
     bool m_has_refs;             // Elements whose first bit is zero are refs to subarrays.
     bool m_context_flag;         // Meaning depends on context.
+    // If set, m_width is the number of bits per element, and m_lbound and
+    // m_ubound are the smallest and the largest element.
+    bool m_packed = false;
+    bool m_packable = false; // Set by integer leaves, which may be packed when written.
 
 private:
     ref_type do_write_shallow(_impl::ArrayWriterBase&) const;
@@ -1083,7 +1179,7 @@ inline ref_type Array::write(_impl::ArrayWriterBase& out, bool deep, bool only_i
     REALM_ASSERT(is_attached());
 
     if (only_if_modified && m_alloc.is_read_only(m_ref))
-        return m_ref;
+        return out.write_unmodified(m_ref, m_alloc); // Throws
 
     if (!deep || !m_has_refs)
         return do_write_shallow(out); // Throws
@@ -1094,7 +1190,7 @@ inline ref_type Array::write(_impl::ArrayWriterBase& out, bool deep, bool only_i
 inline ref_type Array::write(ref_type ref, Allocator& alloc, _impl::ArrayWriterBase& out, bool only_if_modified)
 {
     if (only_if_modified && alloc.is_read_only(ref))
-        return ref;
+        return out.write_unmodified(ref, alloc); // Throws
 
     Array array(alloc);
     array.init_from_ref(ref);
@@ -1582,6 +1678,39 @@ bool Array::find_optimized(int64_t value, size_t start, size_t end, size_t basei
     // finder cannot handle this bitwidth
     REALM_ASSERT_3(m_width, !=, 0);
 
+#if defined(REALM_COMPILER_AVX)
+    if constexpr (std::is_same<cond, Equal>::value || std::is_same<cond, NotEqual>::value ||
+                  std::is_same<cond, Greater>::value || std::is_same<cond, Less>::value) {
+        if constexpr (bitwidth >= 8) {
+            if (sseavx<512>() && end - start2 >= 512 / bitwidth) {
+                if (!find_avx512<cond, action, bitwidth, Callback>(value, start2, end, baseindex, state, callback))
+                    return false;
+                return compare<cond, action, bitwidth, Callback>(value, start2, end, baseindex, state, callback);
+            }
+            if (sseavx<2>() && end - start2 >= 256 / bitwidth) {
+                if (!find_avx2<cond, action, bitwidth, Callback>(value, start2, end, baseindex, state, callback))
+                    return false;
+                return compare<cond, action, bitwidth, Callback>(value, start2, end, baseindex, state, callback);
+            }
+        }
+        else if constexpr (bitwidth > 0 &&
+                           (std::is_same<cond, Equal>::value || std::is_same<cond, NotEqual>::value)) {
+            // Relational conditions on packed elements are left to compare_relation(), which already handles
+            // 64 bits at a time
+            if (sseavx<2>() && end - start2 >= 2 * 256 / bitwidth) {
+                size_t aligned = round_up(start2, 8 / bitwidth);
+                if (!compare<cond, action, bitwidth, Callback>(value, start2, aligned, baseindex, state, callback))
+                    return false;
+                start2 = aligned;
+                if (!find_avx2_packed<cond, action, bitwidth, Callback>(value, start2, end, baseindex, state,
+                                                                        callback))
+                    return false;
+                return compare<cond, action, bitwidth, Callback>(value, start2, end, baseindex, state, callback);
+            }
+        }
+    }
+#endif
+
 #if defined(REALM_COMPILER_SSE)
     // Only use SSE if payload is at least one SSE chunk (128 bits) in size. Also note taht SSE doesn't support
     // Less-than comparison for 64-bit values.
@@ -2001,6 +2130,9 @@ template <class cond, Action action, class Callback>
 bool Array::find(int64_t value, size_t start, size_t end, size_t baseindex, QueryState<int64_t>* state,
                  Callback callback, bool nullable_array, bool find_null) const
 {
+    if (m_packed)
+        return find_packed<cond, action, Callback>(value, start, end, baseindex, state, callback, nullable_array,
+                                                   find_null);
     REALM_TEMPEX4(return find, cond, action, m_width, Callback,
                          (value, start, end, baseindex, state, callback, nullable_array, find_null));
 }
@@ -2013,6 +2145,71 @@ bool Array::find(int64_t value, size_t start, size_t end, size_t baseindex, Quer
                                                             nullable_array, find_null);
 }
 
+template <class cond, Action action>
+bool Array::find_packed(int64_t value, size_t start, size_t end, size_t baseindex, QueryState<int64_t>* state) const
+{
+    return find_packed<cond, action>(value, start, end, baseindex, state, CallbackDummy());
+}
+
+template <class cond, Action action, class Callback>
+bool Array::find_packed(int64_t value, size_t start, size_t end, size_t baseindex, QueryState<int64_t>* state,
+                        Callback callback, bool nullable_array, bool find_null) const
+{
+    REALM_ASSERT(!(find_null && !nullable_array));
+    REALM_ASSERT_DEBUG(m_packed);
+    cond c;
+
+    if (end == npos)
+        end = nullable_array ? size() - 1 : size();
+
+    if (nullable_array) {
+        // As in find_optimized(), the null value is the first element
+        int64_t null_value = get_packed(0);
+        for (; start < end; ++start) {
+            int64_t v = get_packed(start + 1);
+            bool value_is_null = (v == null_value);
+            if (c(v, value, value_is_null, find_null)) {
+                util::Optional<int64_t> v2(value_is_null ? util::none : util::make_optional(v));
+                if (!find_action<action, Callback>(start + baseindex, v2, state, callback))
+                    return false; // tell caller to stop aggregating/search
+            }
+        }
+        return true; // tell caller to continue aggregating/search (on next array leafs)
+    }
+
+    // m_lbound and m_ubound are the actual smallest and largest element
+    if (!c.can_match(value, m_lbound, m_ubound))
+        return true;
+
+    if constexpr (std::is_same<cond, Equal>::value || std::is_same<cond, NotEqual>::value ||
+                  std::is_same<cond, Greater>::value || std::is_same<cond, Less>::value) {
+        if (!c.will_match(value, m_lbound, m_ubound)) {
+            // The value is within [m_lbound, m_ubound] now, so comparing the
+            // offsets from m_lbound gives the same result as comparing the
+            // elements. The offsets have at most 63 bits.
+            int64_t target = int64_t(uint64_t(value) - uint64_t(m_lbound));
+            for (; start < end; ++start) {
+                int64_t offset = int64_t(get_packed_offset(m_data, m_width, start));
+                if (c(offset, target)) {
+                    int64_t v = int64_t(uint64_t(m_lbound) + uint64_t(offset));
+                    if (!find_action<action, Callback>(start + baseindex, v, state, callback))
+                        return false;
+                }
+            }
+            return true;
+        }
+    }
+
+    for (; start < end; ++start) {
+        int64_t v = get_packed(start);
+        if (c(v, value)) {
+            if (!find_action<action, Callback>(start + baseindex, v, state, callback))
+                return false;
+        }
+    }
+    return true;
+}
+
 #ifdef REALM_COMPILER_SSE
 // 'items' is the number of 16-byte SSE chunks. Returns index of packed element relative to first integer of first
 // chunk
@@ -2116,6 +2313,172 @@ REALM_FORCEINLINE bool Array::find_sse_intern(__m128i* action_data, __m128i* dat
 }
 #endif // REALM_COMPILER_SSE
 
+#ifdef REALM_COMPILER_AVX
+template <class cond, Action action, size_t width, class Callback>
+REALM_TARGET_AVX2 bool Array::find_avx2(int64_t value, size_t& start, size_t end, size_t baseindex,
+                                        QueryState<int64_t>* state, Callback callback) const
+{
+    static_assert(width >= 8, "Packed elements are handled by find_avx2_packed()");
+    constexpr size_t bytes_per_element = width / 8;
+    constexpr size_t elements_per_vector = 256 / width;
+    // movemask gives one bit per byte, keep only the bit of the first byte of each element
+    constexpr uint32_t element_bits = bytes_per_element == 1 ? 0xffffffff
+                                      : bytes_per_element == 2 ? 0x55555555
+                                      : bytes_per_element == 4 ? 0x11111111
+                                                               : 0x01010101;
+
+    __m256i search;
+    if constexpr (width == 8)
+        search = _mm256_set1_epi8(static_cast<char>(value));
+    else if constexpr (width == 16)
+        search = _mm256_set1_epi16(static_cast<short int>(value));
+    else if constexpr (width == 32)
+        search = _mm256_set1_epi32(static_cast<int>(value));
+    else
+        search = _mm256_set1_epi64x(value);
+
+    for (; end - start >= elements_per_vector; start += elements_per_vector) {
+        __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(m_data + start * bytes_per_element));
+        __m256i compare_result;
+        if constexpr (std::is_same<cond, Equal>::value || std::is_same<cond, NotEqual>::value) {
+            if constexpr (width == 8)
+                compare_result = _mm256_cmpeq_epi8(data, search);
+            else if constexpr (width == 16)
+                compare_result = _mm256_cmpeq_epi16(data, search);
+            else if constexpr (width == 32)
+                compare_result = _mm256_cmpeq_epi32(data, search);
+            else
+                compare_result = _mm256_cmpeq_epi64(data, search);
+        }
+        else {
+            // Only signed greater-than exists, so less-than is done by swapping the operands
+            __m256i a = std::is_same<cond, Greater>::value ? data : search;
+            __m256i b = std::is_same<cond, Greater>::value ? search : data;
+            if constexpr (width == 8)
+                compare_result = _mm256_cmpgt_epi8(a, b);
+            else if constexpr (width == 16)
+                compare_result = _mm256_cmpgt_epi16(a, b);
+            else if constexpr (width == 32)
+                compare_result = _mm256_cmpgt_epi32(a, b);
+            else
+                compare_result = _mm256_cmpgt_epi64(a, b);
+        }
+
+        uint32_t resmask = uint32_t(_mm256_movemask_epi8(compare_result));
+        if (std::is_same<cond, NotEqual>::value)
+            resmask = ~resmask;
+        resmask &= element_bits;
+        if (resmask == 0)
+            continue;
+
+        if (find_action_pattern<action, Callback>(start + baseindex, resmask, state, callback))
+            continue;
+
+        while (resmask != 0) {
+            size_t ndx = start + ctz(resmask) / bytes_per_element;
+            if (!find_action<action, Callback>(ndx + baseindex, get<width>(ndx), state, callback)) {
+                start = end;
+                return false;
+            }
+            resmask &= resmask - 1;
+        }
+    }
+    return true;
+}
+
+template <class cond, Action action, size_t width, class Callback>
+REALM_TARGET_AVX2 bool Array::find_avx2_packed(int64_t value, size_t& start, size_t end, size_t baseindex,
+                                               QueryState<int64_t>* state, Callback callback) const
+{
+    static_assert(width == 1 || width == 2 || width == 4, "Only for packed elements");
+    REALM_ASSERT_DEBUG(start * width % 8 == 0);
+    constexpr size_t elements_per_vector = 256 / width;
+    constexpr uint64_t element_mask = (1ULL << width) - 1;
+
+    // XOR with the search value repeated in every element turns matching elements into zero elements. Testing a
+    // vector for zero elements is then the same bit hack as test_zero(), just done for four words at a time.
+    const uint64_t lower = lower_bits<width>();
+    const uint64_t upper = lower_bits<width>() * 1ULL << (width - 1ULL);
+    const __m256i search = _mm256_set1_epi64x(int64_t((uint64_t(value) & element_mask) * lower_bits<width>()));
+    const __m256i lower_v = _mm256_set1_epi64x(int64_t(lower));
+    const __m256i upper_v = _mm256_set1_epi64x(int64_t(upper));
+
+    for (; end - start >= elements_per_vector; start += elements_per_vector) {
+        __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(m_data + start * width / 8));
+        __m256i diff = _mm256_xor_si256(data, search);
+        bool candidate;
+        if constexpr (std::is_same<cond, Equal>::value) {
+            // (v - lower) & ~v & upper
+            __m256i zero_elements = _mm256_and_si256(_mm256_andnot_si256(diff, _mm256_sub_epi64(diff, lower_v)),
+                                                     upper_v);
+            candidate = !_mm256_testz_si256(zero_elements, zero_elements);
+        }
+        else {
+            candidate = !_mm256_testz_si256(diff, diff);
+        }
+        if (candidate) {
+            if (!compare<cond, action, width, Callback>(value, start, start + elements_per_vector, baseindex, state,
+                                                        callback)) {
+                start = end;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+template <class cond, Action action, size_t width, class Callback>
+REALM_TARGET_AVX512 bool Array::find_avx512(int64_t value, size_t& start, size_t end, size_t baseindex,
+                                            QueryState<int64_t>* state, Callback callback) const
+{
+    static_assert(width >= 8, "Packed elements are handled by find_avx2_packed()");
+    constexpr size_t elements_per_vector = 512 / width;
+    constexpr int predicate = std::is_same<cond, Equal>::value      ? _MM_CMPINT_EQ
+                              : std::is_same<cond, NotEqual>::value ? _MM_CMPINT_NE
+                              : std::is_same<cond, Greater>::value  ? _MM_CMPINT_NLE
+                                                                    : _MM_CMPINT_LT;
+
+    __m512i search;
+    if constexpr (width == 8)
+        search = _mm512_set1_epi8(static_cast<char>(value));
+    else if constexpr (width == 16)
+        search = _mm512_set1_epi16(static_cast<short int>(value));
+    else if constexpr (width == 32)
+        search = _mm512_set1_epi32(static_cast<int>(value));
+    else
+        search = _mm512_set1_epi64(value);
+
+    for (; end - start >= elements_per_vector; start += elements_per_vector) {
+        __m512i data = _mm512_loadu_si512(m_data + start * width / 8);
+        // AVX-512 compares into a mask register with exactly one bit per element
+        uint64_t resmask;
+        if constexpr (width == 8)
+            resmask = _mm512_cmp_epi8_mask(data, search, predicate);
+        else if constexpr (width == 16)
+            resmask = _mm512_cmp_epi16_mask(data, search, predicate);
+        else if constexpr (width == 32)
+            resmask = _mm512_cmp_epi32_mask(data, search, predicate);
+        else
+            resmask = _mm512_cmp_epi64_mask(data, search, predicate);
+        if (resmask == 0)
+            continue;
+
+        if (find_action_pattern<action, Callback>(start + baseindex, resmask, state, callback))
+            continue;
+
+        while (resmask != 0) {
+            size_t ndx = start + ctz(resmask);
+            if (!find_action<action, Callback>(ndx + baseindex, get<width>(ndx), state, callback)) {
+                start = end;
+                return false;
+            }
+            resmask &= resmask - 1;
+        }
+    }
+    return true;
+}
+#endif // REALM_COMPILER_AVX
+
 template <class cond, Action action, class Callback>
 bool Array::compare_leafs(const Array* foreign, size_t start, size_t end, size_t baseindex,
                           QueryState<int64_t>* state, Callback callback) const
@@ -2159,6 +2522,16 @@ bool Array::compare_leafs(const Array* foreign, size_t start, size_t end, size_t
         return true;
     }
 
+    if (m_packed || foreign->m_packed) {
+        for (; start < end; ++start) {
+            v = get(start);
+            if (c(v, foreign->get(start)))
+                if (!find_action<action, Callback>(start + baseindex, v, state, callback))
+                    return false;
+        }
+        return true;
+    }
+
     bool r;
     REALM_TEMPEX4(r = compare_leafs, cond, action, m_width, Callback,
                   (foreign, start, end, baseindex, state, callback))
@@ -83,6 +83,17 @@ public:
     bool maximum(T& result, size_t begin = 0, size_t end = npos) const;
     bool minimum(T& result, size_t begin = 0, size_t end = npos) const;
 
+    /// Aggregates that skip null entries in one pass over the leaf and
+    /// store the number of non-null entries in `count`. The sum is
+    /// accumulated in four interleaved lanes, so the result does not
+    /// depend on whether the vectorized path is taken. The min/max
+    /// variants also ignore NaN and return the index of the first
+    /// occurrence of a value that is strictly better than `result`, or
+    /// `npos` if there is none.
+    double sum_not_null(size_t& count, size_t begin = 0, size_t end = npos) const;
+    size_t maximum_not_null(T& result, size_t& count, size_t begin = 0, size_t end = npos) const;
+    size_t minimum_not_null(T& result, size_t& count, size_t begin = 0, size_t end = npos) const;
+
     /// Compare two arrays for equality.
     bool compare(const BasicArray<T>&) const;
 
@@ -123,6 +134,15 @@ private:
     template <bool find_max>
     bool minmax(T& result, size_t begin, size_t end) const;
 
+    template <bool find_max>
+    size_t minmax_not_null(T& result, size_t& count, size_t begin, size_t end) const;
+
+#ifdef REALM_COMPILER_AVX
+    REALM_TARGET_AVX2 static void sum_avx2(const T* data, size_t& begin, size_t end, double* lanes, size_t& count);
+    template <bool find_max>
+    REALM_TARGET_AVX2 static T minmax_avx2(const T* data, size_t& begin, size_t end, T m, size_t& count);
+#endif
+
     /// Calculate the total number of bytes needed for a basic array
     /// with the specified number of elements. This includes the size
     /// of the header. The result will be upwards aligned to the
@@ -342,6 +342,152 @@ bool BasicArray<T>::minimum(T& result, size_t begin, size_t end) const
     return minmax<false>(result, begin, end);
 }
 
+template <class T>
+double BasicArray<T>::sum_not_null(size_t& count, size_t begin, size_t end) const
+{
+    if (end == npos)
+        end = m_size;
+    REALM_ASSERT(begin <= m_size && end <= m_size && begin <= end);
+    const T* data = reinterpret_cast<const T*>(m_data);
+    double lanes[4] = {0, 0, 0, 0};
+    size_t first = begin;
+    count = 0;
+
+#ifdef REALM_COMPILER_AVX
+    if (sseavx<2>())
+        sum_avx2(data, begin, end, lanes, count);
+#endif
+
+    for (; begin < end; ++begin) {
+        T v = data[begin];
+        if (!null::is_null_float(v)) {
+            lanes[(begin - first) % 4] += v;
+            ++count;
+        }
+    }
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+
+template <class T>
+template <bool find_max>
+size_t BasicArray<T>::minmax_not_null(T& result, size_t& count, size_t begin, size_t end) const
+{
+    if (end == npos)
+        end = m_size;
+    REALM_ASSERT(begin <= m_size && end <= m_size && begin <= end);
+    const T* data = reinterpret_cast<const T*>(m_data);
+    size_t first = begin;
+    T m = result;
+    count = 0;
+
+#ifdef REALM_COMPILER_AVX
+    if (sseavx<2>())
+        m = minmax_avx2<find_max>(data, begin, end, m, count);
+#endif
+
+    for (; begin < end; ++begin) {
+        T v = data[begin];
+        if (!null::is_null_float(v)) {
+            ++count;
+            // NaN compares false and is thereby skipped
+            if (find_max ? v > m : v < m)
+                m = v;
+        }
+    }
+
+    if (!(find_max ? m > result : m < result))
+        return npos;
+
+    // Equal values may differ in the sign of zero, so report the element actually found
+    size_t ndx = std::find(data + first, data + end, m) - data;
+    result = data[ndx];
+    return ndx;
+}
+
+template <class T>
+size_t BasicArray<T>::maximum_not_null(T& result, size_t& count, size_t begin, size_t end) const
+{
+    return minmax_not_null<true>(result, count, begin, end);
+}
+
+template <class T>
+size_t BasicArray<T>::minimum_not_null(T& result, size_t& count, size_t begin, size_t end) const
+{
+    return minmax_not_null<false>(result, count, begin, end);
+}
+
+#ifdef REALM_COMPILER_AVX
+template <class T>
+REALM_TARGET_AVX2 void BasicArray<T>::sum_avx2(const T* data, size_t& begin, size_t end, double* lanes,
+                                               size_t& count)
+{
+    // Four elements per iteration, element i always going to lane i % 4, just like the scalar loop
+    __m256d acc = _mm256_loadu_pd(lanes);
+    size_t nulls = 0;
+    size_t first = begin;
+    for (; end - begin >= 4; begin += 4) {
+        if constexpr (std::is_same<T, float>::value) {
+            __m128i null_pattern = _mm_set1_epi32(static_cast<int>(0x7fc000aa));
+            __m128 v = _mm_loadu_ps(data + begin);
+            __m128 is_null = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_castps_si128(v), null_pattern));
+            nulls += fast_popcount32(_mm_movemask_ps(is_null));
+            acc = _mm256_add_pd(acc, _mm256_cvtps_pd(_mm_andnot_ps(is_null, v)));
+        }
+        else {
+            __m256i null_pattern = _mm256_set1_epi64x(0x7ff80000000000aa);
+            __m256d v = _mm256_loadu_pd(data + begin);
+            __m256d is_null = _mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_castpd_si256(v), null_pattern));
+            nulls += fast_popcount32(_mm256_movemask_pd(is_null));
+            acc = _mm256_add_pd(acc, _mm256_andnot_pd(is_null, v));
+        }
+    }
+    _mm256_storeu_pd(lanes, acc);
+    count += begin - first - nulls;
+}
+
+template <class T>
+template <bool find_max>
+REALM_TARGET_AVX2 T BasicArray<T>::minmax_avx2(const T* data, size_t& begin, size_t end, T m, size_t& count)
+{
+    // max/min return the second operand if either is NaN, so keeping the accumulator second skips NaN and null
+    size_t nulls = 0;
+    size_t first = begin;
+    if constexpr (std::is_same<T, float>::value) {
+        __m256i null_pattern = _mm256_set1_epi32(static_cast<int>(0x7fc000aa));
+        __m256 acc = _mm256_set1_ps(m);
+        for (; end - begin >= 8; begin += 8) {
+            __m256 v = _mm256_loadu_ps(data + begin);
+            __m256 is_null = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_castps_si256(v), null_pattern));
+            nulls += fast_popcount32(_mm256_movemask_ps(is_null));
+            acc = find_max ? _mm256_max_ps(v, acc) : _mm256_min_ps(v, acc);
+        }
+        alignas(32) float lanes[8];
+        _mm256_store_ps(lanes, acc);
+        for (float v : lanes) {
+            if (find_max ? v > m : v < m)
+                m = v;
+        }
+    }
+    else {
+        __m256i null_pattern = _mm256_set1_epi64x(0x7ff80000000000aa);
+        __m256d acc = _mm256_set1_pd(m);
+        for (; end - begin >= 4; begin += 4) {
+            __m256d v = _mm256_loadu_pd(data + begin);
+            __m256d is_null = _mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_castpd_si256(v), null_pattern));
+            nulls += fast_popcount32(_mm256_movemask_pd(is_null));
+            acc = find_max ? _mm256_max_pd(v, acc) : _mm256_min_pd(v, acc);
+        }
+        alignas(32) double lanes[4];
+        _mm256_store_pd(lanes, acc);
+        for (double v : lanes) {
+            if (find_max ? v > m : v < m)
+                m = v;
+        }
+    }
+    count += begin - first - nulls;
+    return m;
+}
+#endif
 
 template <class T>
 inline size_t BasicArray<T>::lower_bound(T value) const noexcept
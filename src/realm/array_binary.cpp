@@ -38,8 +38,20 @@ void ArrayBinary::init_from_mem(MemRef mem) noexcept
     ArrayParent* parent = m_arr->get_parent();
     size_t ndx_in_parent = m_arr->get_ndx_in_parent();
 
-    m_is_big = Array::get_context_flag_from_header(header);
-    if (!m_is_big) {
+    if (m_is_compressed) {
+        // The other kinds of leaves are constructed in m_storage
+        m_arr = new (&m_storage.m_small_blobs) ArraySmallBlobs(m_alloc);
+    }
+
+    m_is_compressed = ArrayCompressedBlobs::is_compressed(header);
+    m_is_big = !m_is_compressed && Array::get_context_flag_from_header(header);
+    if (m_is_compressed) {
+        if (!m_compressed)
+            m_compressed = std::make_unique<ArrayCompressedBlobs>(m_alloc);
+        m_compressed->init_from_mem(mem);
+        m_arr = m_compressed.get();
+    }
+    else if (!m_is_big) {
         auto arr = new (&m_storage.m_small_blobs) ArraySmallBlobs(m_alloc);
         arr->init_from_mem(mem);
     }
@@ -60,7 +72,10 @@ void ArrayBinary::init_from_parent()
 
 size_t ArrayBinary::size() const
 {
-    if (!m_is_big) {
+    if (m_is_compressed) {
+        return m_compressed->size();
+    }
+    else if (!m_is_big) {
         return static_cast<ArraySmallBlobs*>(m_arr)->size();
     }
     else {
@@ -103,7 +118,10 @@ void ArrayBinary::insert(size_t ndx, BinaryData value)
 
 BinaryData ArrayBinary::get(size_t ndx) const
 {
-    if (!m_is_big) {
+    if (m_is_compressed) {
+        return m_compressed->get(ndx);
+    }
+    else if (!m_is_big) {
         return static_cast<ArraySmallBlobs*>(m_arr)->get(ndx);
     }
     else {
@@ -113,7 +131,11 @@ BinaryData ArrayBinary::get(size_t ndx) const
 
 BinaryData ArrayBinary::get_at(size_t ndx, size_t& pos) const
 {
-    if (!m_is_big) {
+    if (m_is_compressed) {
+        pos = 0;
+        return m_compressed->get(ndx);
+    }
+    else if (!m_is_big) {
         pos = 0;
         return static_cast<ArraySmallBlobs*>(m_arr)->get(ndx);
     }
@@ -129,7 +151,10 @@ Mixed ArrayBinary::get_any(size_t ndx) const
 
 bool ArrayBinary::is_null(size_t ndx) const
 {
-    if (!m_is_big) {
+    if (m_is_compressed) {
+        return m_compressed->is_null(ndx);
+    }
+    else if (!m_is_big) {
         return static_cast<ArraySmallBlobs*>(m_arr)->is_null(ndx);
     }
     else {
@@ -139,6 +164,7 @@ bool ArrayBinary::is_null(size_t ndx) const
 
 void ArrayBinary::erase(size_t ndx)
 {
+    decompress(); // Throws
     if (!m_is_big) {
         return static_cast<ArraySmallBlobs*>(m_arr)->erase(ndx);
     }
@@ -149,6 +175,7 @@ void ArrayBinary::erase(size_t ndx)
 
 void ArrayBinary::move(ArrayBinary& dst, size_t ndx)
 {
+    decompress(); // Throws
     size_t sz = size();
     for (size_t i = ndx; i < sz; i++) {
         dst.add(get(i));
@@ -164,6 +191,7 @@ void ArrayBinary::move(ArrayBinary& dst, size_t ndx)
 
 void ArrayBinary::clear()
 {
+    decompress(); // Throws
     if (!m_is_big) {
         return static_cast<ArraySmallBlobs*>(m_arr)->clear();
     }
@@ -174,7 +202,10 @@ void ArrayBinary::clear()
 
 size_t ArrayBinary::find_first(BinaryData value, size_t begin, size_t end) const noexcept
 {
-    if (!m_is_big) {
+    if (m_is_compressed) {
+        return m_compressed->find_first(value, begin, end);
+    }
+    else if (!m_is_big) {
         return static_cast<ArraySmallBlobs*>(m_arr)->find_first(value, false, begin, end);
     }
     else {
@@ -183,8 +214,85 @@ size_t ArrayBinary::find_first(BinaryData value, size_t begin, size_t end) const
 }
 
 
+void ArrayBinary::compress()
+{
+    if (m_is_compressed)
+        return;
+
+    size_t n = size();
+    std::vector<BinaryData> values;
+    values.reserve(n); // Throws
+    for (size_t i = 0; i < n; i++) {
+        BinaryData value = get(i);
+        // Values too big for a single blob are not compressed
+        if (value.is_null() && !is_null(i))
+            return;
+        values.push_back(value);
+    }
+    MemRef mem = ArrayCompressedBlobs::create(values, m_alloc); // Throws
+    if (!mem.get_addr())
+        return;
+
+    auto parent = m_arr->get_parent();
+    auto ndx_in_parent = m_arr->get_ndx_in_parent();
+    Array::destroy_deep(m_arr->get_ref(), m_alloc);
+
+    if (!m_compressed)
+        m_compressed = std::make_unique<ArrayCompressedBlobs>(m_alloc); // Throws
+    m_compressed->init_from_mem(mem);
+    m_arr = m_compressed.get();
+    m_arr->set_parent(parent, ndx_in_parent);
+    m_arr->update_parent();
+
+    m_is_compressed = true;
+    m_is_big = false;
+}
+
+void ArrayBinary::decompress()
+{
+    if (!m_is_compressed)
+        return;
+
+    // The values stay valid until the accessor is attached to another leaf
+    auto compressed = m_compressed.get();
+    auto parent = compressed->get_parent();
+    auto ndx_in_parent = compressed->get_ndx_in_parent();
+    size_t n = compressed->size();
+    if (compressed->max_value_size() <= small_blob_max_size) {
+        ArraySmallBlobs small_blobs(m_alloc);
+        small_blobs.create(); // Throws
+        for (size_t i = 0; i < n; i++) {
+            small_blobs.add(compressed->get(i)); // Throws
+        }
+        compressed->destroy();
+
+        auto arr = new (&m_storage.m_small_blobs) ArraySmallBlobs(m_alloc);
+        arr->init_from_mem(small_blobs.get_mem());
+        m_arr = arr;
+        m_is_big = false;
+    }
+    else {
+        ArrayBigBlobs big_blobs(m_alloc, true);
+        big_blobs.create(); // Throws
+        for (size_t i = 0; i < n; i++) {
+            big_blobs.add(compressed->get(i)); // Throws
+        }
+        compressed->destroy();
+
+        auto arr = new (&m_storage.m_big_blobs) ArrayBigBlobs(m_alloc, true);
+        arr->init_from_mem(big_blobs.get_mem());
+        m_arr = arr;
+        m_is_big = true;
+    }
+    m_arr->set_parent(parent, ndx_in_parent);
+    m_arr->update_parent(); // Throws
+    m_is_compressed = false;
+}
+
 bool ArrayBinary::upgrade_leaf(size_t value_size)
 {
+    decompress(); // Throws
+
     if (m_is_big)
         return true;
 
@@ -216,7 +324,10 @@ bool ArrayBinary::upgrade_leaf(size_t value_size)
 void ArrayBinary::verify() const
 {
 #ifdef REALM_DEBUG
-    if (!m_is_big) {
+    if (m_is_compressed) {
+        m_compressed->verify();
+    }
+    else if (!m_is_big) {
         static_cast<ArraySmallBlobs*>(m_arr)->verify();
     }
     else {
@@ -21,6 +21,7 @@
 
 #include <realm/array_blobs_small.hpp>
 #include <realm/array_blobs_big.hpp>
+#include <realm/array_blobs_compressed.hpp>
 
 namespace realm {
 
@@ -78,10 +79,21 @@ public:
 
     size_t find_first(BinaryData value, size_t begin, size_t end) const noexcept;
 
+    /// True for a compressed leaf. See ArrayCompressedBlobs.
+    bool is_compressed() const
+    {
+        return m_is_compressed;
+    }
+    /// Replace a leaf by a compressed one, if that saves space
+    void compress();
+    /// Replace a compressed leaf by one of small or big blobs. This is done
+    /// before a compressed leaf is modified.
+    void decompress();
+
     /// Get the specified element without the cost of constructing an
     /// array instance. If an array instance is already available, or
     /// you need to get multiple values, then this method will be
-    /// slower.
+    /// slower. Compressed leaves are not supported.
     static BinaryData get(const char* header, size_t ndx, Allocator& alloc) noexcept;
 
     void verify() const;
@@ -95,10 +107,14 @@ private:
     };
 
     bool m_is_big = false;
+    bool m_is_compressed = false;
 
     Allocator& m_alloc;
     Storage m_storage;
     Array* m_arr;
+    // Unlike the other kinds of leaves, a compressed one owns memory, so
+    // it is not kept in m_storage
+    std::unique_ptr<ArrayCompressedBlobs> m_compressed;
 
     bool upgrade_leaf(size_t value_size);
 };
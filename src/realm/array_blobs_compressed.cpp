@@ -0,0 +1,262 @@
+/*************************************************************************
+ *
+ * Copyright 2021 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <realm/array_blobs_compressed.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+using namespace realm;
+
+namespace {
+
+constexpr size_t min_match_length = 4;
+constexpr size_t max_match_distance = 0xFFFF;
+constexpr int hash_bits = 14;
+
+// The compressed block follows the number of values and the size of the
+// decompressed block
+constexpr size_t block_header_size = 8;
+
+// A leaf is only compressed if that saves at least an eighth of its size
+constexpr size_t min_saving_ratio = 8;
+
+inline uint32_t read_u32(const char* p) noexcept
+{
+    uint32_t value;
+    std::memcpy(&value, p, 4);
+    return value;
+}
+
+inline void write_u32(char* p, uint32_t value) noexcept
+{
+    std::memcpy(p, &value, 4);
+}
+
+inline size_t hash_sequence(uint32_t sequence) noexcept
+{
+    return size_t((sequence * 2654435761U) >> (32 - hash_bits));
+}
+
+// Add the part of a length that does not fit in the nibble of the token
+void put_length(std::vector<char>& out, size_t length)
+{
+    while (length >= 255) {
+        out.push_back(char(255));
+        length -= 255;
+    }
+    out.push_back(char(length));
+}
+
+void put_sequence(std::vector<char>& out, const char* literals, size_t num_literals, size_t distance,
+                  size_t match_length)
+{
+    size_t extra_length = match_length ? match_length - min_match_length : 0;
+    unsigned token = unsigned(std::min<size_t>(num_literals, 15) << 4 | std::min<size_t>(extra_length, 15));
+    out.push_back(char(token));
+    if (num_literals >= 15)
+        put_length(out, num_literals - 15);
+    out.insert(out.end(), literals, literals + num_literals);
+    if (match_length == 0)
+        return; // The end of the block
+    out.push_back(char(distance & 0xFF));
+    out.push_back(char(distance >> 8));
+    if (extra_length >= 15)
+        put_length(out, extra_length - 15);
+}
+
+void compress_block(const char* src, size_t size, std::vector<char>& out)
+{
+    // Positions of earlier sequences of 4 bytes with the same hash, plus one
+    std::vector<uint32_t> table(size_t(1) << hash_bits);
+    size_t anchor = 0;
+    size_t pos = 0;
+    while (size >= min_match_length && pos <= size - min_match_length) {
+        uint32_t sequence = read_u32(src + pos);
+        uint32_t& entry = table[hash_sequence(sequence)];
+        size_t candidate = entry;
+        entry = uint32_t(pos + 1);
+        if (candidate == 0 || pos - (candidate - 1) > max_match_distance ||
+            read_u32(src + candidate - 1) != sequence) {
+            // Step faster through data that does not compress
+            pos += 1 + ((pos - anchor) >> 6);
+            continue;
+        }
+        size_t match = candidate - 1;
+        size_t length = min_match_length;
+        while (pos + length < size && src[match + length] == src[pos + length])
+            ++length;
+        put_sequence(out, src + anchor, pos - anchor, pos - match, length); // Throws
+        pos += length;
+        anchor = pos;
+    }
+    put_sequence(out, src + anchor, size - anchor, 0, 0); // Throws
+}
+
+inline bool get_length(const unsigned char*& in, const unsigned char* end, size_t& length) noexcept
+{
+    unsigned byte;
+    do {
+        if (in == end)
+            return false;
+        byte = *in++;
+        length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+bool decompress_block(const char* src, size_t size, char* dst, size_t dst_size) noexcept
+{
+    const unsigned char* in = reinterpret_cast<const unsigned char*>(src);
+    const unsigned char* end = in + size;
+    size_t out = 0;
+    while (in != end) {
+        unsigned token = *in++;
+        size_t num_literals = token >> 4;
+        if (num_literals == 15 && !get_length(in, end, num_literals))
+            return false;
+        if (num_literals > size_t(end - in) || num_literals > dst_size - out)
+            return false;
+        std::memcpy(dst + out, in, num_literals);
+        in += num_literals;
+        out += num_literals;
+        if (in == end)
+            break;
+
+        if (end - in < 2)
+            return false;
+        size_t distance = size_t(in[0]) | size_t(in[1]) << 8;
+        in += 2;
+        size_t length = token & 15;
+        if (length == 15 && !get_length(in, end, length))
+            return false;
+        length += min_match_length;
+        if (distance == 0 || distance > out || length > dst_size - out)
+            return false;
+        // The match may overlap the bytes it produces
+        const char* match = dst + out - distance;
+        if (distance >= length) {
+            std::memcpy(dst + out, match, length);
+        }
+        else {
+            for (size_t i = 0; i < length; ++i)
+                dst[out + i] = match[i];
+        }
+        out += length;
+    }
+    return out == dst_size;
+}
+
+} // anonymous namespace
+
+
+void ArrayCompressedBlobs::init_from_mem(MemRef mem) noexcept
+{
+    Array::init_from_mem(mem);
+    m_num_values = read_u32(m_data);
+    m_block.reset();
+    m_offsets = nullptr;
+    m_values = nullptr;
+}
+
+void ArrayCompressedBlobs::decompress() const noexcept
+{
+    size_t block_size = read_u32(m_data + 4);
+    m_block.reset(new char[block_size]);
+    bool valid = decompress_block(m_data + block_header_size, m_size - block_header_size, m_block.get(), block_size);
+    REALM_ASSERT_RELEASE(valid && block_size >= (m_num_values + 1) * 4);
+    m_offsets = reinterpret_cast<const uint32_t*>(m_block.get());
+    m_values = m_block.get() + (m_num_values + 1) * 4;
+}
+
+size_t ArrayCompressedBlobs::find_first(BinaryData value, size_t begin, size_t end) const noexcept
+{
+    if (end == npos)
+        end = m_num_values;
+    REALM_ASSERT_11(begin, <=, m_num_values, &&, end, <=, m_num_values, &&, begin, <=, end);
+
+    for (size_t i = begin; i < end; ++i) {
+        if (get(i) == value)
+            return i;
+    }
+    return not_found;
+}
+
+size_t ArrayCompressedBlobs::max_value_size() const noexcept
+{
+    const uint32_t* offsets = get_offsets();
+    size_t max_size = 0;
+    for (size_t i = 0; i < m_num_values; ++i) {
+        size_t value_size = (offsets[i + 1] & ~null_bit) - (offsets[i] & ~null_bit) - 1;
+        max_size = std::max(max_size, value_size);
+    }
+    return max_size;
+}
+
+MemRef ArrayCompressedBlobs::create(const std::vector<BinaryData>& values, Allocator& alloc)
+{
+    size_t num_values = values.size();
+    size_t offsets_size = (num_values + 1) * 4;
+    size_t block_size = offsets_size;
+    for (const BinaryData& value : values)
+        block_size += value.size() + 1;
+    if (num_values == 0 || block_size >= null_bit)
+        return {};
+
+    std::unique_ptr<char[]> block(new char[block_size]); // Throws
+    size_t offset = 0;
+    for (size_t i = 0; i < num_values; ++i) {
+        const BinaryData& value = values[i];
+        write_u32(block.get() + i * 4, uint32_t(offset) | (value.is_null() ? null_bit : 0));
+        char* dst = block.get() + offsets_size + offset;
+        if (value.size() != 0)
+            std::memcpy(dst, value.data(), value.size());
+        dst[value.size()] = 0;
+        offset += value.size() + 1;
+    }
+    write_u32(block.get() + num_values * 4, uint32_t(offset));
+
+    std::vector<char> compressed;
+    compressed.reserve(block_size / 2);              // Throws
+    compress_block(block.get(), block_size, compressed); // Throws
+    size_t byte_size = block_header_size + compressed.size();
+    if (byte_size > ArrayBlob::max_binary_size || byte_size > block_size - block_size / min_saving_ratio)
+        return {};
+
+    bool context_flag = true;
+    MemRef mem = create_node(byte_size, alloc, context_flag, type_Normal, wtype_Ignore, 0); // Throws
+    char* data = get_data_from_header(mem.get_addr());
+    write_u32(data, uint32_t(num_values));
+    write_u32(data + 4, uint32_t(block_size));
+    std::memcpy(data + block_header_size, compressed.data(), compressed.size());
+    return mem;
+}
+
+void ArrayCompressedBlobs::verify() const
+{
+#ifdef REALM_DEBUG
+    REALM_ASSERT(is_compressed(get_header()));
+    const uint32_t* offsets = get_offsets();
+    for (size_t i = 0; i < m_num_values; ++i) {
+        size_t begin = offsets[i] & ~null_bit;
+        size_t end = offsets[i + 1] & ~null_bit;
+        REALM_ASSERT(begin < end);
+        REALM_ASSERT(m_values[end - 1] == 0);
+    }
+#endif
+}
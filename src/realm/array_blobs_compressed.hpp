@@ -0,0 +1,152 @@
+/*************************************************************************
+ *
+ * Copyright 2021 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_ARRAY_BLOBS_COMPRESSED_HPP
+#define REALM_ARRAY_BLOBS_COMPRESSED_HPP
+
+#include <realm/array_blob.hpp>
+#include <realm/binary_data.hpp>
+#include <realm/string_data.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace realm {
+
+/*
+STORAGE FORMAT
+---------------------------------------------------------------------------------------
+A compressed leaf of a String or Binary column is a single node without refs
+(width type 'ignore', context flag set) holding all the values of the leaf:
+
+  --> | number of values | size of the block | compressed block |
+
+The first two fields are 32-bit integers. The block, once decompressed, starts
+with the offsets of the values, one more than there are values, as 32-bit
+integers. The values follow, each of them with a terminating zero. The highest
+bit of an offset is set for a null value.
+
+The block is compressed in a byte oriented LZ77 format in the style of LZ4. It
+is a sequence of a token byte, a run of literal bytes and, unless the block
+ends there, the 16-bit distance back to a match and its length. The high
+nibble of the token is the number of literals and the low nibble the length
+of the match minus 4. A nibble of 15 is followed by bytes that are added to
+it, up to and including the first one less than 255.
+
+A compressed leaf is only read. Leaves of medium and big values are replaced
+by compressed ones when they are written to a column that is compressed (see
+Table::compress_column()), and a compressed leaf is replaced by one of medium
+or big values when it is modified.
+*/
+class ArrayCompressedBlobs : public Array {
+public:
+    explicit ArrayCompressedBlobs(Allocator&) noexcept;
+
+    // Disable copying, this is not allowed.
+    ArrayCompressedBlobs& operator=(const ArrayCompressedBlobs&) = delete;
+    ArrayCompressedBlobs(const ArrayCompressedBlobs&) = delete;
+
+    /// The values are decompressed when one of them is first needed, and
+    /// kept by the accessor until it is attached to another leaf.
+    void init_from_mem(MemRef) noexcept;
+    void init_from_ref(ref_type ref) noexcept
+    {
+        init_from_mem(MemRef(get_alloc().translate(ref), ref, get_alloc()));
+    }
+
+    size_t size() const noexcept
+    {
+        return m_num_values;
+    }
+    BinaryData get(size_t ndx) const noexcept;
+    StringData get_string(size_t ndx) const noexcept;
+    bool is_null(size_t ndx) const noexcept;
+    size_t find_first(BinaryData value, size_t begin = 0, size_t end = npos) const noexcept;
+
+    /// The size of the largest value, not counting the terminating zero of
+    /// strings. Used to pick the kind of leaf the values go back into.
+    size_t max_value_size() const noexcept;
+
+    static bool is_compressed(const char* header) noexcept
+    {
+        return !get_hasrefs_from_header(header) && get_context_flag_from_header(header) &&
+               get_wtype_from_header(header) == wtype_Ignore;
+    }
+
+    /// Create a compressed leaf holding the specified values, or return a
+    /// null MemRef if compressing them would not save enough space.
+    ///
+    /// Note that the caller assumes ownership of the allocated
+    /// underlying node. It is not owned by the accessor.
+    static MemRef create(const std::vector<BinaryData>& values, Allocator&);
+
+    void verify() const;
+
+private:
+    size_t m_num_values = 0;
+    mutable std::unique_ptr<char[]> m_block;
+    mutable const uint32_t* m_offsets = nullptr;
+    mutable const char* m_values = nullptr;
+
+    static constexpr uint32_t null_bit = 0x80000000;
+
+    void decompress() const noexcept;
+    const uint32_t* get_offsets() const noexcept
+    {
+        if (REALM_UNLIKELY(!m_offsets))
+            decompress();
+        return m_offsets;
+    }
+};
+
+
+// Implementation:
+
+inline ArrayCompressedBlobs::ArrayCompressedBlobs(Allocator& allocator) noexcept
+    : Array(allocator)
+{
+}
+
+inline BinaryData ArrayCompressedBlobs::get(size_t ndx) const noexcept
+{
+    REALM_ASSERT_3(ndx, <, m_num_values);
+    const uint32_t* offsets = get_offsets();
+    uint32_t begin = offsets[ndx];
+    if (begin & null_bit)
+        return {};
+    uint32_t end = offsets[ndx + 1] & ~null_bit;
+    return BinaryData(m_values + begin, end - begin - 1); // Do not include terminating zero
+}
+
+inline StringData ArrayCompressedBlobs::get_string(size_t ndx) const noexcept
+{
+    BinaryData bin = get(ndx);
+    if (bin.is_null())
+        return realm::null();
+    return StringData(bin.data(), bin.size());
+}
+
+inline bool ArrayCompressedBlobs::is_null(size_t ndx) const noexcept
+{
+    REALM_ASSERT_3(ndx, <, m_num_values);
+    return (get_offsets()[ndx] & null_bit) != 0;
+}
+
+} // namespace realm
+
+#endif // REALM_ARRAY_BLOBS_COMPRESSED_HPP
@@ -226,6 +226,60 @@ inline void get_three(const char* data, size_t width, size_t ndx, ref_type& v0,
 }
 
 
+// Packed arrays
+// -------------
+//
+// The payload of a packed array starts with the smallest and the largest
+// element, followed by the offsets of the elements from the smallest one,
+// `bits` bits each, stored from the least significant bit of 64 bit words.
+
+inline int64_t get_packed_min(const char* data) noexcept
+{
+    return *reinterpret_cast<const int64_t*>(data);
+}
+
+inline int64_t get_packed_max(const char* data) noexcept
+{
+    return *reinterpret_cast<const int64_t*>(data + 8);
+}
+
+inline uint64_t get_packed_offset(const char* data, size_t bits, size_t ndx) noexcept
+{
+    if (bits == 0)
+        return 0;
+    const uint64_t* words = reinterpret_cast<const uint64_t*>(data + 16);
+    size_t bit_ndx = ndx * bits;
+    size_t word_ndx = bit_ndx >> 6;
+    size_t shift = bit_ndx & 63;
+    uint64_t value = words[word_ndx] >> shift;
+    // The offset may continue in the next word
+    if (shift + bits > 64)
+        value |= words[word_ndx + 1] << (64 - shift);
+    return value & ((uint64_t(1) << bits) - 1);
+}
+
+inline void set_packed_offset(char* data, size_t bits, size_t ndx, uint64_t value) noexcept
+{
+    if (bits == 0)
+        return;
+    uint64_t* words = reinterpret_cast<uint64_t*>(data + 16);
+    uint64_t mask = (uint64_t(1) << bits) - 1;
+    size_t bit_ndx = ndx * bits;
+    size_t word_ndx = bit_ndx >> 6;
+    size_t shift = bit_ndx & 63;
+    words[word_ndx] = (words[word_ndx] & ~(mask << shift)) | (value << shift);
+    if (shift + bits > 64) {
+        size_t rest = 64 - shift;
+        words[word_ndx + 1] = (words[word_ndx + 1] & ~(mask >> rest)) | (value >> rest);
+    }
+}
+
+inline int64_t get_packed_direct(const char* data, size_t bits, size_t ndx) noexcept
+{
+    return int64_t(uint64_t(get_packed_min(data)) + get_packed_offset(data, bits, ndx));
+}
+
+
 // Lower/upper bound in sorted sequence
 // ------------------------------------
 //
@@ -115,6 +115,10 @@ void ArrayIntNull::replace_nulls_with(int64_t new_null)
 
 void ArrayIntNull::avoid_null_collision(int64_t value)
 {
+    // The bounds of a packed array are those of its elements
+    if (m_packed)
+        copy_on_write(); // Throws
+
     if (m_width == 64) {
         if (value == null_value()) {
             int_fast64_t new_null = choose_random_null(value);
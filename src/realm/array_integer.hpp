@@ -175,11 +175,13 @@ inline ArrayInteger::ArrayInteger(Allocator& allocator) noexcept
     : Array(allocator)
 {
     m_is_inner_bptree_node = false;
+    m_packable = true;
 }
 
 inline ArrayIntNull::ArrayIntNull(Allocator& allocator) noexcept
     : Array(allocator)
 {
+    m_packable = true;
 }
 
 inline ArrayIntNull::~ArrayIntNull() noexcept {}
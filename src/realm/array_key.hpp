@@ -46,6 +46,7 @@ public:
     ArrayKeyBase(Allocator& allocator)
         : Array(allocator)
     {
+        m_packable = true;
     }
 
     static ObjKey default_value(bool)
@@ -29,7 +29,9 @@ ArrayString::ArrayString(Allocator& a)
 
 void ArrayString::create()
 {
-    static_cast<ArrayStringShort*>(m_arr)->create();
+    auto arr = static_cast<ArrayStringShort*>(m_arr);
+    arr->create();
+    arr->set_compactable();
 }
 
 void ArrayString::init_from_mem(MemRef mem) noexcept
@@ -39,13 +41,31 @@ void ArrayString::init_from_mem(MemRef mem) noexcept
     ArrayParent* parent = m_arr->get_parent();
     size_t ndx_in_parent = m_arr->get_ndx_in_parent();
 
+    if (m_type == Type::compressed_strings) {
+        // The other kinds of leaves are constructed in m_storage
+        m_arr = new (&m_storage.m_string_short) ArrayStringShort(m_alloc, m_nullable);
+    }
+
     bool long_strings = Array::get_hasrefs_from_header(header);
-    if (!long_strings) {
+    if (ArrayCompressedBlobs::is_compressed(header)) {
+        if (!m_compressed)
+            m_compressed = std::make_unique<ArrayCompressedBlobs>(m_alloc);
+        m_compressed->init_from_mem(mem);
+        m_arr = m_compressed.get();
+        m_type = Type::compressed_strings;
+    }
+    else if (ArrayStringCompact::is_compact(header)) {
+        auto arr = new (&m_storage.m_string_compact) ArrayStringCompact(m_alloc, m_nullable);
+        arr->init_from_mem(mem);
+        m_type = Type::compact_strings;
+    }
+    else if (!long_strings) {
         // Small strings
         bool is_small = Array::get_wtype_from_header(header) == Array::wtype_Multiply;
         if (is_small) {
             auto arr = new (&m_storage.m_string_short) ArrayStringShort(m_alloc, m_nullable);
             arr->init_from_mem(mem);
+            arr->set_compactable();
             m_type = Type::small_strings;
         }
         else {
@@ -106,6 +126,10 @@ size_t ArrayString::size() const
             return static_cast<ArrayBigBlobs*>(m_arr)->size();
         case Type::enum_strings:
             return static_cast<Array*>(m_arr)->size();
+        case Type::compressed_strings:
+            return m_compressed->size();
+        case Type::compact_strings:
+            return static_cast<ArrayStringCompact*>(m_arr)->size();
     }
     return {};
 }
@@ -129,6 +153,11 @@ void ArrayString::add(StringData value)
             set(ndx, value);
             break;
         }
+        case Type::compressed_strings:
+        case Type::compact_strings:
+            // The leaf is decompressed or expanded by upgrade_leaf()
+            REALM_UNREACHABLE();
+            break;
     }
 }
 
@@ -154,6 +183,10 @@ void ArrayString::set(size_t ndx, StringData value)
             static_cast<Array*>(m_arr)->set(ndx, res);
             break;
         }
+        case Type::compressed_strings:
+        case Type::compact_strings:
+            REALM_UNREACHABLE();
+            break;
     }
 }
 
@@ -172,7 +205,12 @@ void ArrayString::insert(size_t ndx, StringData value)
         case Type::enum_strings: {
             static_cast<Array*>(m_arr)->insert(ndx, 0);
             set(ndx, value);
+            break;
         }
+        case Type::compressed_strings:
+        case Type::compact_strings:
+            REALM_UNREACHABLE();
+            break;
     }
 }
 
@@ -189,6 +227,10 @@ StringData ArrayString::get(size_t ndx) const
             size_t index = size_t(static_cast<Array*>(m_arr)->get(ndx));
             return m_string_enum_values->get(index);
         }
+        case Type::compressed_strings:
+            return m_compressed->get_string(ndx);
+        case Type::compact_strings:
+            return static_cast<ArrayStringCompact*>(m_arr)->get(ndx);
     }
     return {};
 }
@@ -206,6 +248,10 @@ StringData ArrayString::get_legacy(size_t ndx) const
             size_t index = size_t(static_cast<Array*>(m_arr)->get(ndx));
             return m_string_enum_values->get(index);
         }
+        case Type::compressed_strings:
+            return m_compressed->get_string(ndx);
+        case Type::compact_strings:
+            return static_cast<ArrayStringCompact*>(m_arr)->get(ndx);
     }
     return {};
 }
@@ -228,12 +274,18 @@ bool ArrayString::is_null(size_t ndx) const
             size_t index = size_t(static_cast<Array*>(m_arr)->get(ndx));
             return m_string_enum_values->is_null(index);
         }
+        case Type::compressed_strings:
+            return m_compressed->is_null(ndx);
+        case Type::compact_strings:
+            return static_cast<ArrayStringCompact*>(m_arr)->is_null(ndx);
     }
     return {};
 }
 
 void ArrayString::erase(size_t ndx)
 {
+    decompress(); // Throws
+    expand();     // Throws
     switch (m_type) {
         case Type::small_strings:
             static_cast<ArrayStringShort*>(m_arr)->erase(ndx);
@@ -247,11 +299,17 @@ void ArrayString::erase(size_t ndx)
         case Type::enum_strings:
             static_cast<Array*>(m_arr)->erase(ndx);
             break;
+        case Type::compressed_strings:
+        case Type::compact_strings:
+            REALM_UNREACHABLE();
+            break;
     }
 }
 
 void ArrayString::move(ArrayString& dst, size_t ndx)
 {
+    decompress(); // Throws
+    expand();     // Throws
     size_t sz = size();
     for (size_t i = ndx; i < sz; i++) {
         dst.add(get(i));
@@ -268,6 +326,8 @@ void ArrayString::move(ArrayString& dst, size_t ndx)
             static_cast<ArrayBigBlobs*>(m_arr)->truncate(ndx);
             break;
         case Type::enum_strings:
+        case Type::compressed_strings:
+        case Type::compact_strings:
             // this operation will never be called for enumerated columns
             REALM_UNREACHABLE();
             break;
@@ -276,6 +336,8 @@ void ArrayString::move(ArrayString& dst, size_t ndx)
 
 void ArrayString::clear()
 {
+    decompress(); // Throws
+    expand();     // Throws
     switch (m_type) {
         case Type::small_strings:
             static_cast<ArrayStringShort*>(m_arr)->clear();
@@ -289,6 +351,10 @@ void ArrayString::clear()
         case Type::enum_strings:
             static_cast<Array*>(m_arr)->clear();
             break;
+        case Type::compressed_strings:
+        case Type::compact_strings:
+            REALM_UNREACHABLE();
+            break;
     }
 }
 
@@ -315,6 +381,34 @@ size_t ArrayString::find_first(StringData value, size_t begin, size_t end) const
             }
             break;
         }
+        case Type::compressed_strings: {
+            BinaryData as_binary(value.data(), value.size());
+            return m_compressed->find_first(as_binary, begin, end);
+        }
+        case Type::compact_strings:
+            return static_cast<ArrayStringCompact*>(m_arr)->find_first(value, begin, end);
+    }
+    return not_found;
+}
+
+size_t ArrayString::find_first_prefix(StringData prefix, size_t begin, size_t end) const
+{
+    switch (m_type) {
+        case Type::small_strings:
+            return static_cast<ArrayStringShort*>(m_arr)->find_first_prefix(prefix, begin, end);
+        case Type::compact_strings:
+            return static_cast<ArrayStringCompact*>(m_arr)->find_first_prefix(prefix, begin, end);
+        case Type::medium_strings:
+        case Type::big_strings:
+        case Type::enum_strings:
+        case Type::compressed_strings:
+            break;
+    }
+    if (end == npos)
+        end = size();
+    for (size_t i = begin; i < end; ++i) {
+        if (get(i).begins_with(prefix))
+            return i;
     }
     return not_found;
 }
@@ -333,6 +427,12 @@ inline StringData get_string(const ArrayStringShort* arr, size_t ndx)
     return arr->get(ndx);
 }
 
+template <>
+inline StringData get_string(const ArrayStringCompact* arr, size_t ndx)
+{
+    return arr->get(ndx);
+}
+
 template <class T, class U>
 size_t lower_bound_string(const T* arr, U value)
 {
@@ -363,14 +463,118 @@ size_t ArrayString::lower_bound(StringData value)
             return lower_bound_string(static_cast<ArraySmallBlobs*>(m_arr), value);
         case Type::big_strings:
             return lower_bound_string(static_cast<ArrayBigBlobs*>(m_arr), value);
+        case Type::compressed_strings:
+            return lower_bound_string(m_compressed.get(), value);
+        case Type::compact_strings:
+            return lower_bound_string(static_cast<ArrayStringCompact*>(m_arr), value);
         case Type::enum_strings:
             break;
     }
     return realm::npos;
 }
 
+void ArrayString::compress()
+{
+    if (m_type != Type::medium_strings && m_type != Type::big_strings)
+        return;
+
+    size_t n = size();
+    std::vector<BinaryData> values;
+    values.reserve(n); // Throws
+    for (size_t i = 0; i < n; i++) {
+        StringData value = get(i);
+        values.emplace_back(value.data(), value.size());
+    }
+    MemRef mem = ArrayCompressedBlobs::create(values, m_alloc); // Throws
+    if (!mem.get_addr())
+        return;
+
+    auto parent = m_arr->get_parent();
+    auto ndx_in_parent = m_arr->get_ndx_in_parent();
+    Array::destroy_deep(m_arr->get_ref(), m_alloc);
+
+    if (!m_compressed)
+        m_compressed = std::make_unique<ArrayCompressedBlobs>(m_alloc); // Throws
+    m_compressed->init_from_mem(mem);
+    m_arr = m_compressed.get();
+    m_arr->set_parent(parent, ndx_in_parent);
+    m_arr->update_parent();
+
+    m_type = Type::compressed_strings;
+}
+
+void ArrayString::decompress()
+{
+    if (m_type != Type::compressed_strings)
+        return;
+
+    // The values stay valid until the accessor is attached to another leaf
+    auto compressed = m_compressed.get();
+    auto parent = compressed->get_parent();
+    auto ndx_in_parent = compressed->get_ndx_in_parent();
+    size_t n = compressed->size();
+    if (compressed->max_value_size() <= medium_string_max_size) {
+        ArraySmallBlobs string_long(m_alloc);
+        string_long.create(); // Throws
+        for (size_t i = 0; i < n; i++) {
+            string_long.add_string(compressed->get_string(i)); // Throws
+        }
+        compressed->destroy();
+
+        auto arr = new (&m_storage.m_string_long) ArraySmallBlobs(m_alloc);
+        arr->init_from_mem(string_long.get_mem());
+        m_arr = arr;
+        m_type = Type::medium_strings;
+    }
+    else {
+        ArrayBigBlobs big_blobs(m_alloc, true);
+        big_blobs.create(); // Throws
+        for (size_t i = 0; i < n; i++) {
+            big_blobs.add_string(compressed->get_string(i)); // Throws
+        }
+        compressed->destroy();
+
+        auto arr = new (&m_storage.m_big_blobs) ArrayBigBlobs(m_alloc, true);
+        arr->init_from_mem(big_blobs.get_mem());
+        m_arr = arr;
+        m_type = Type::big_strings;
+    }
+    m_arr->set_parent(parent, ndx_in_parent);
+    m_arr->update_parent(); // Throws
+}
+
+void ArrayString::expand()
+{
+    if (m_type != Type::compact_strings)
+        return;
+
+    auto compact = static_cast<ArrayStringCompact*>(m_arr);
+    ArrayStringShort string_short(m_alloc, m_nullable);
+    string_short.create(); // Throws
+    string_short.set_compactable();
+
+    size_t n = compact->size();
+    for (size_t i = 0; i < n; i++) {
+        string_short.add(compact->get(i)); // Throws
+    }
+    auto parent = compact->get_parent();
+    auto ndx_in_parent = compact->get_ndx_in_parent();
+    compact->destroy();
+
+    auto arr = new (&m_storage.m_string_short) ArrayStringShort(m_alloc, m_nullable);
+    arr->init_from_mem(string_short.get_mem());
+    arr->set_compactable();
+    arr->set_parent(parent, ndx_in_parent);
+    arr->update_parent(); // Throws
+
+    m_type = Type::small_strings;
+}
+
 ArrayString::Type ArrayString::upgrade_leaf(size_t value_size)
 {
+    decompress(); // Throws
+    expand();     // Throws
+
     if (m_type == Type::big_strings)
         return Type::big_strings;
 
@@ -469,6 +673,12 @@ void ArrayString::verify() const
         case Type::enum_strings:
             static_cast<Array*>(m_arr)->verify();
             break;
+        case Type::compressed_strings:
+            m_compressed->verify();
+            break;
+        case Type::compact_strings:
+            static_cast<ArrayStringCompact*>(m_arr)->verify();
+            break;
     }
 #endif
 }
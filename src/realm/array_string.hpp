@@ -20,8 +20,10 @@
 #define REALM_ARRAY_STRING_HPP
 
 #include <realm/array_string_short.hpp>
+#include <realm/array_string_compact.hpp>
 #include <realm/array_blobs_small.hpp>
 #include <realm/array_blobs_big.hpp>
+#include <realm/array_blobs_compressed.hpp>
 
 namespace realm {
 
@@ -112,13 +114,58 @@ public:
     void clear();
 
     size_t find_first(StringData value, size_t begin, size_t end) const noexcept;
+    /// Find the first string that begins with the specified value, which
+    /// must not be null.
+    size_t find_first_prefix(StringData prefix, size_t begin, size_t end) const;
 
     size_t lower_bound(StringData value);
 
+    /// True for a leaf of an enumerated column. Such a leaf holds, for each
+    /// element, the index of its value among the unique values of the column.
+    bool is_enumerated() const
+    {
+        return m_type == Type::enum_strings;
+    }
+    /// The unique values of the column of an enumerated leaf
+    const ArrayString& get_enum_values() const
+    {
+        REALM_ASSERT_DEBUG(m_type == Type::enum_strings);
+        return *m_string_enum_values;
+    }
+    size_t get_enum_index(size_t ndx) const
+    {
+        REALM_ASSERT_DEBUG(m_type == Type::enum_strings);
+        return size_t(static_cast<Array*>(m_arr)->get(ndx));
+    }
+    size_t find_first_enum_index(size_t index, size_t begin, size_t end) const
+    {
+        REALM_ASSERT_DEBUG(m_type == Type::enum_strings);
+        return static_cast<Array*>(m_arr)->find_first(int64_t(index), begin, end);
+    }
+
+    /// True for a compressed leaf. See ArrayCompressedBlobs.
+    bool is_compressed() const
+    {
+        return m_type == Type::compressed_strings;
+    }
+    /// Replace a leaf of medium or big strings by a compressed one, if that
+    /// saves space. Other leaves are left as they are.
+    void compress();
+    /// Replace a compressed leaf by one of medium or big strings. This is
+    /// done before a compressed leaf is modified.
+    void decompress();
+
+    /// True for a leaf of short strings in the compact format. See
+    /// ArrayStringCompact.
+    bool is_compact() const
+    {
+        return m_type == Type::compact_strings;
+    }
+
     /// Get the specified element without the cost of constructing an
     /// array instance. If an array instance is already available, or
     /// you need to get multiple values, then this method will be
-    /// slower.
+    /// slower. Compressed leaves are not supported.
     static StringData get(const char* header, size_t ndx, Allocator& alloc) noexcept;
 
     void verify() const;
@@ -131,8 +178,9 @@ private:
         std::aligned_storage<sizeof(ArraySmallBlobs), alignof(ArraySmallBlobs)>::type m_string_long;
         std::aligned_storage<sizeof(ArrayBigBlobs), alignof(ArrayBigBlobs)>::type m_big_blobs;
         std::aligned_storage<sizeof(Array), alignof(Array)>::type m_enum;
+        std::aligned_storage<sizeof(ArrayStringCompact), alignof(ArrayStringCompact)>::type m_string_compact;
     };
-    enum class Type { small_strings, medium_strings, big_strings, enum_strings };
+    enum class Type { small_strings, medium_strings, big_strings, enum_strings, compressed_strings, compact_strings };
 
     Type m_type = Type::small_strings;
 
@@ -144,14 +192,22 @@ private:
     bool m_nullable = true;
 
     std::unique_ptr<ArrayString> m_string_enum_values;
+    // Unlike the other kinds of leaves, a compressed one owns memory, so
+    // it is not kept in m_storage
+    std::unique_ptr<ArrayCompressedBlobs> m_compressed;
 
     Type upgrade_leaf(size_t value_size);
+    // Replace a compact leaf by an ArrayStringShort before it is modified
+    void expand();
 };
 
 inline StringData ArrayString::get(const char* header, size_t ndx, Allocator& alloc) noexcept
 {
     bool long_strings = Array::get_hasrefs_from_header(header);
-    if (!long_strings) {
+    if (ArrayStringCompact::is_compact(header)) {
+        return ArrayStringCompact::get(header, ndx, true);
+    }
+    else if (!long_strings) {
         return ArrayStringShort::get(header, ndx, true);
     }
     else {
@@ -0,0 +1,250 @@
+/*************************************************************************
+ *
+ * Copyright 2021 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <realm/array_string_compact.hpp>
+#include <realm/array_string_short.hpp>
+
+#include <cstring>
+#include <memory>
+#include <unordered_map>
+
+using namespace realm;
+
+namespace {
+
+// The checksum of a compact leaf ends with its number of bits per element,
+// as that of a packed array
+uint32_t compact_checksum(int bits) noexcept
+{
+    char bytes[4] = {'A', 'A', 'A', char(bits)};
+    uint32_t checksum;
+    std::memcpy(&checksum, bytes, 4);
+    return checksum;
+}
+
+inline bool has_prefix(const char* value, StringData prefix) noexcept
+{
+    size_t size = static_cast<unsigned char>(value[-1]);
+    return size >= prefix.size() && std::memcmp(value, prefix.data(), prefix.size()) == 0;
+}
+
+// The kernels below look for a 16-bit offset among those in [begin, end) and
+// return its index. When there is none, 'begin' is left at the first offset
+// they have not looked at.
+
+#ifdef REALM_COMPILER_AVX
+REALM_TARGET_AVX2 size_t find_offset_avx2(const uint16_t* offsets, uint16_t offset, size_t& begin,
+                                          size_t end) noexcept
+{
+    __m256i needle = _mm256_set1_epi16(short(offset));
+    for (; begin + 16 <= end; begin += 16) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(offsets + begin));
+        unsigned mask = unsigned(_mm256_movemask_epi8(_mm256_cmpeq_epi16(v, needle)));
+        if (mask != 0)
+            return begin + size_t(ctz(mask)) / 2;
+    }
+    return not_found;
+}
+#endif
+
+#ifdef REALM_COMPILER_SSE
+// SSE2 is part of x86-64, so this needs no check of the CPU
+size_t find_offset_sse(const uint16_t* offsets, uint16_t offset, size_t& begin, size_t end) noexcept
+{
+    __m128i needle = _mm_set1_epi16(short(offset));
+    for (; begin + 8 <= end; begin += 8) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(offsets + begin));
+        unsigned mask = unsigned(_mm_movemask_epi8(_mm_cmpeq_epi16(v, needle)));
+        if (mask != 0)
+            return begin + size_t(ctz(mask)) / 2;
+    }
+    return not_found;
+}
+#endif
+
+} // anonymous namespace
+
+
+void ArrayStringCompact::init_from_mem(MemRef mem) noexcept
+{
+    Array::init_from_mem(mem);
+    m_offsets = reinterpret_cast<const uint16_t*>(m_data + head_size);
+    m_values = reinterpret_cast<const char*>(m_offsets + m_size);
+}
+
+size_t ArrayStringCompact::find_offset(uint16_t offset, size_t begin, size_t end) const noexcept
+{
+#ifdef REALM_COMPILER_AVX
+    if (sseavx<2>()) {
+        size_t res = find_offset_avx2(m_offsets, offset, begin, end);
+        if (res != not_found)
+            return res;
+    }
+#endif
+#ifdef REALM_COMPILER_SSE
+    size_t res = find_offset_sse(m_offsets, offset, begin, end);
+    if (res != not_found)
+        return res;
+#endif
+    for (size_t i = begin; i < end; ++i) {
+        if (m_offsets[i] == offset)
+            return i;
+    }
+    return not_found;
+}
+
+size_t ArrayStringCompact::find_first(StringData value, size_t begin, size_t end) const noexcept
+{
+    if (end == npos)
+        end = m_size;
+    REALM_ASSERT(begin <= m_size && end <= m_size && begin <= end);
+
+    if (m_nullable ? value.is_null() : value.size() == 0) {
+        if (m_nullable)
+            return find_offset(null_offset, begin, end);
+        // Empty strings may be stored as nulls in leaves that are not nullable
+        for (size_t i = begin; i < end; ++i) {
+            if (get(i).size() == 0)
+                return i;
+        }
+        return not_found;
+    }
+
+    // Each value is stored once, so there is at most one offset to look for
+    size_t values_size = get_values_size();
+    for (size_t pos = 0; pos < values_size;) {
+        size_t size = static_cast<unsigned char>(m_values[pos]);
+        const char* data = m_values + pos + 1;
+        if (size == value.size() && std::memcmp(data, value.data(), size) == 0)
+            return find_offset(uint16_t(pos + 1), begin, end);
+        pos += size + 2;
+    }
+    return not_found;
+}
+
+size_t ArrayStringCompact::find_first_prefix(StringData prefix, size_t begin, size_t end) const noexcept
+{
+    if (end == npos)
+        end = m_size;
+    REALM_ASSERT(begin <= m_size && end <= m_size && begin <= end);
+    REALM_ASSERT(!prefix.is_null());
+
+    if (prefix.size() == 0) {
+        // Every string begins with the empty string, but nulls do not
+        for (size_t i = begin; i < end; ++i) {
+            if (!is_null(i))
+                return i;
+        }
+        return not_found;
+    }
+
+    // Compare the offsets if only one of the values has the prefix
+    size_t values_size = get_values_size();
+    size_t num_matches = 0;
+    size_t match = 0;
+    for (size_t pos = 0; pos < values_size && num_matches < 2;) {
+        const char* data = m_values + pos + 1;
+        if (has_prefix(data, prefix)) {
+            match = pos + 1;
+            ++num_matches;
+        }
+        pos += static_cast<unsigned char>(m_values[pos]) + 2;
+    }
+    if (num_matches == 0)
+        return not_found;
+    if (num_matches == 1)
+        return find_offset(uint16_t(match), begin, end);
+
+    for (size_t i = begin; i < end; ++i) {
+        uint16_t offset = m_offsets[i];
+        if (offset != null_offset && has_prefix(m_values + offset, prefix))
+            return i;
+    }
+    return not_found;
+}
+
+ref_type ArrayStringCompact::write(const char* header, _impl::ArrayWriterBase& out)
+{
+    size_t size = get_size_from_header(header);
+    size_t width = get_width_from_header(header);
+    if (size == 0 || width == 0)
+        return 0;
+
+    std::unique_ptr<uint16_t[]> offsets(new uint16_t[size]); // Throws
+    std::vector<char> values;
+    std::unordered_map<StringData, uint16_t> positions;
+    for (size_t i = 0; i < size; ++i) {
+        StringData value = ArrayStringShort::get(header, i, true);
+        if (value.is_null()) {
+            offsets[i] = null_offset;
+            continue;
+        }
+        auto it = positions.find(value);
+        if (it != positions.end()) {
+            offsets[i] = it->second;
+            continue;
+        }
+        if (values.size() + value.size() + 2 >= null_offset)
+            return 0;
+        values.push_back(char(value.size()));
+        uint16_t offset = uint16_t(values.size());
+        values.insert(values.end(), value.data(), value.data() + value.size());
+        values.push_back(0);
+        // The key refers to the leaf, which outlives the map
+        positions.emplace(value, offset);
+        offsets[i] = offset;
+    }
+
+    size_t num_bits = (2 * size + values.size()) * 8;
+    size_t bits = std::max<size_t>(64, (num_bits + size - 1) / size);
+    if (bits > 255)
+        return 0;
+    size_t byte_size = calc_byte_size(wtype_Packed, size, uint_least8_t(bits));
+    if (byte_size >= calc_byte_size(wtype_Multiply, size, uint_least8_t(width)))
+        return 0;
+
+    std::unique_ptr<uint64_t[]> buffer(new uint64_t[byte_size / 8]()); // Throws
+    char* compact_header = reinterpret_cast<char*>(buffer.get());
+    init_header(compact_header, false, false, false, wtype_Packed, int(width), size, byte_size);
+    char* data = get_data_from_header(compact_header);
+    *reinterpret_cast<uint32_t*>(data) = uint32_t(values.size());
+    *reinterpret_cast<uint32_t*>(data + 4) = uint32_t(positions.size());
+    std::memcpy(data + head_size, offsets.get(), size * 2);
+    std::memcpy(data + head_size + size * 2, values.data(), values.size());
+    ref_type new_ref = out.write_array(compact_header, byte_size, compact_checksum(int(bits))); // Throws
+    REALM_ASSERT_3(new_ref % 8, ==, 0);
+    return new_ref;
+}
+
+void ArrayStringCompact::verify() const
+{
+#ifdef REALM_DEBUG
+    REALM_ASSERT(is_compact(get_header()));
+    size_t values_size = get_values_size();
+    REALM_ASSERT(head_size + m_size * 2 + values_size <= get_byte_size() - header_size);
+    for (size_t i = 0; i < m_size; ++i) {
+        uint16_t offset = m_offsets[i];
+        if (offset == null_offset)
+            continue;
+        REALM_ASSERT(offset > 0 && offset < values_size);
+        size_t size = static_cast<unsigned char>(m_values[offset - 1]);
+        REALM_ASSERT(offset + size < values_size);
+        REALM_ASSERT(m_values[offset + size] == 0);
+    }
+#endif
+}
@@ -0,0 +1,142 @@
+/*************************************************************************
+ *
+ * Copyright 2021 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_ARRAY_STRING_COMPACT_HPP
+#define REALM_ARRAY_STRING_COMPACT_HPP
+
+#include <realm/array.hpp>
+
+namespace realm {
+
+/*
+STORAGE FORMAT
+---------------------------------------------------------------------------------------
+A compact leaf holds the same strings as an ArrayStringShort, but stores each
+distinct value once, in as many bytes as it needs:
+
+  --> | size of the values | number of distinct values | 0 | offsets | values |
+
+The first two fields are 32-bit integers, followed by 8 bytes of zeros. There
+is a 16-bit offset for each string, pointing to its value, or 0xFFFF for a
+null. Each distinct value is stored as a byte holding its size, the bytes of
+the value and a terminating zero. The offset points to the bytes of the value.
+
+The leaf uses the width scheme of packed integer arrays, with as many bits per
+element as make room for the offsets and the values, and at least 64, which
+integer arrays never use. The size of the leaf therefore follows from its
+header like that of any other array, and a leaf takes at least 8 bytes per
+string. The width of the header is the one the leaf had before it was made
+compact.
+
+Compact leaves are only written by commits, see
+_impl::ArrayWriterBase::compact_strings(), and are only read. A compact leaf
+is replaced by an ArrayStringShort when it is modified.
+*/
+class ArrayStringCompact : public Array {
+public:
+    explicit ArrayStringCompact(Allocator&, bool nullable) noexcept;
+
+    void init_from_mem(MemRef) noexcept;
+    void init_from_ref(ref_type ref) noexcept
+    {
+        init_from_mem(MemRef(get_alloc().translate(ref), ref, get_alloc()));
+    }
+
+    StringData get(size_t ndx) const noexcept;
+    bool is_null(size_t ndx) const noexcept;
+
+    /// The value is looked for among the distinct values once, and its offset
+    /// is then compared with those of the strings, many at a time.
+    size_t find_first(StringData value, size_t begin = 0, size_t end = npos) const noexcept;
+    /// Find the first string that begins with the specified value, which
+    /// must not be null.
+    size_t find_first_prefix(StringData prefix, size_t begin = 0, size_t end = npos) const noexcept;
+
+    static bool is_compact(const char* header) noexcept
+    {
+        return !get_hasrefs_from_header(header) && get_wtype_from_header(header) == wtype_Packed &&
+               get_packed_bits_from_header(header) >= 64;
+    }
+
+    /// Get the specified element without the cost of constructing an
+    /// array instance.
+    static StringData get(const char* header, size_t ndx, bool nullable) noexcept;
+
+    /// Write the ArrayStringShort with the specified header in the compact
+    /// format. Returns a null ref, and writes nothing, if that would not
+    /// make it smaller.
+    static ref_type write(const char* header, _impl::ArrayWriterBase&);
+
+    void verify() const;
+
+private:
+    bool m_nullable;
+    const uint16_t* m_offsets = nullptr;
+    const char* m_values = nullptr;
+
+    static constexpr uint16_t null_offset = 0xFFFF;
+    static constexpr size_t head_size = 16;
+
+    size_t get_values_size() const noexcept
+    {
+        return *reinterpret_cast<const uint32_t*>(m_data);
+    }
+    size_t find_offset(uint16_t offset, size_t begin, size_t end) const noexcept;
+};
+
+
+// Implementation:
+
+inline ArrayStringCompact::ArrayStringCompact(Allocator& allocator, bool nullable) noexcept
+    : Array(allocator)
+    , m_nullable(nullable)
+{
+}
+
+inline StringData ArrayStringCompact::get(size_t ndx) const noexcept
+{
+    REALM_ASSERT_3(ndx, <, m_size);
+    uint16_t offset = m_offsets[ndx];
+    if (offset == null_offset)
+        return m_nullable ? realm::null() : StringData("");
+    const char* value = m_values + offset;
+    return StringData(value, static_cast<unsigned char>(value[-1]));
+}
+
+inline bool ArrayStringCompact::is_null(size_t ndx) const noexcept
+{
+    REALM_ASSERT_3(ndx, <, m_size);
+    return m_nullable && m_offsets[ndx] == null_offset;
+}
+
+inline StringData ArrayStringCompact::get(const char* header, size_t ndx, bool nullable) noexcept
+{
+    size_t size = get_size_from_header(header);
+    REALM_ASSERT(ndx < size);
+    const char* data = get_data_from_header(header);
+    const uint16_t* offsets = reinterpret_cast<const uint16_t*>(data + head_size);
+    uint16_t offset = offsets[ndx];
+    if (offset == null_offset)
+        return nullable ? realm::null() : StringData("");
+    const char* value = reinterpret_cast<const char*>(offsets + size) + offset;
+    return StringData(value, static_cast<unsigned char>(value[-1]));
+}
+
+} // namespace realm
+
+#endif // REALM_ARRAY_STRING_COMPACT_HPP
@@ -53,6 +53,100 @@ size_t round_up(size_t size)
     return size;
 }
 
+// The search kernels below compare the bytes of a value, and the last byte of
+// a slot, which tells the length of its string, with a whole slot at once. The
+// zeros between the string and the last byte are not compared. If 'is_prefix'
+// is true, a slot matches if its string begins with the value, otherwise if it
+// is equal to it. The value must be shorter than the slots, and not empty.
+
+template <class T, bool is_prefix>
+size_t find_in_slots(const char* data, StringData value, size_t begin, size_t end) noexcept
+{
+    constexpr size_t width = sizeof(T);
+    size_t size = value.size();
+    REALM_ASSERT_DEBUG(size > 0 && size < width);
+    unsigned pad = unsigned(width - 1 - size);
+
+    char needle_bytes[width] = {};
+    char mask_bytes[width] = {};
+    std::copy_n(value.data(), size, needle_bytes);
+    std::fill_n(mask_bytes, size, char(0xFF));
+    if (!is_prefix) {
+        needle_bytes[width - 1] = char(pad);
+        mask_bytes[width - 1] = char(0xFF);
+    }
+    T needle, mask;
+    std::memcpy(&needle, needle_bytes, width);
+    std::memcpy(&mask, mask_bytes, width);
+
+    for (size_t i = begin; i < end; ++i) {
+        const char* slot = data + i * width;
+        T v;
+        std::memcpy(&v, slot, width);
+        // A prefix only needs the string to be at least as long
+        if (((v ^ needle) & mask) == 0 && (!is_prefix || static_cast<unsigned char>(slot[width - 1]) <= pad))
+            return i;
+    }
+    return not_found;
+}
+
+#ifdef REALM_COMPILER_SSE
+// SSE2 is part of x86-64, so this needs no check of the CPU
+template <bool is_prefix>
+size_t find_in_slots_sse(const char* data, StringData value, size_t begin, size_t end) noexcept
+{
+    constexpr size_t width = 16;
+    size_t size = value.size();
+    REALM_ASSERT_DEBUG(size > 0 && size < width);
+    unsigned pad = unsigned(width - 1 - size);
+
+    alignas(16) char needle_bytes[width] = {};
+    std::copy_n(value.data(), size, needle_bytes);
+    unsigned mask = (1U << size) - 1;
+    if (!is_prefix) {
+        needle_bytes[width - 1] = char(pad);
+        mask |= 1U << (width - 1);
+    }
+    __m128i needle = _mm_load_si128(reinterpret_cast<const __m128i*>(needle_bytes));
+
+    for (size_t i = begin; i < end; ++i) {
+        const char* slot = data + i * width;
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(slot));
+        unsigned equal = unsigned(_mm_movemask_epi8(_mm_cmpeq_epi8(v, needle)));
+        if ((equal & mask) == mask && (!is_prefix || static_cast<unsigned char>(slot[width - 1]) <= pad))
+            return i;
+    }
+    return not_found;
+}
+#endif
+
+template <bool is_prefix>
+size_t find_in_slots(const char* data, size_t width, StringData value, size_t begin, size_t end) noexcept
+{
+    switch (width) {
+        case 2:
+            return find_in_slots<uint16_t, is_prefix>(data, value, begin, end);
+        case 4:
+            return find_in_slots<uint32_t, is_prefix>(data, value, begin, end);
+        case 8:
+            return find_in_slots<uint64_t, is_prefix>(data, value, begin, end);
+#ifdef REALM_COMPILER_SSE
+        case 16:
+            return find_in_slots_sse<is_prefix>(data, value, begin, end);
+#endif
+    }
+
+    size_t size = value.size();
+    unsigned pad = unsigned(width - 1 - size);
+    for (size_t i = begin; i < end; ++i) {
+        const char* slot = data + i * width;
+        unsigned slot_pad = static_cast<unsigned char>(slot[width - 1]);
+        if ((is_prefix ? slot_pad <= pad : slot_pad == pad) && std::memcmp(slot, value.data(), size) == 0)
+            return i;
+    }
+    return not_found;
+}
+
 } // anonymous namespace
 
 bool ArrayStringShort::is_null(size_t ndx) const
@@ -256,18 +350,33 @@ size_t ArrayStringShort::find_first(StringData value, size_t begin, size_t end)
         }
     }
     else {
+        return find_in_slots<false>(m_data, m_width, value, begin, end);
+    }
+
+    return not_found;
+}
+
+size_t ArrayStringShort::find_first_prefix(StringData prefix, size_t begin, size_t end) const noexcept
+{
+    if (end == npos)
+        end = m_size;
+    REALM_ASSERT(begin <= m_size && end <= m_size && begin <= end);
+    REALM_ASSERT(!prefix.is_null());
+
+    if (prefix.size() == 0) {
+        // Every string begins with the empty string, but nulls do not
         for (size_t i = begin; i != end; ++i) {
-            const char* data = m_data + (i * m_width);
-            if (memcmp(data, value.data(), value_size) == 0) {
-                size_t data_size = (m_width - 1) - data[m_width - 1];
-                if (data_size == value_size) {
-                    return i;
-                }
-            }
+            if (!get(i).is_null())
+                return i;
         }
+        return not_found;
     }
 
-    return not_found;
+    // A string can never be wider than the column width
+    if (m_width <= prefix.size())
+        return not_found;
+
+    return find_in_slots<true>(m_data, m_width, prefix, begin, end);
 }
 
 void ArrayStringShort::find_all(IntegerColumn& result, StringData value, size_t add_offset, size_t begin, size_t end)
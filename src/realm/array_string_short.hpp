@@ -61,7 +61,11 @@ public:
     void erase(size_t ndx);
 
     size_t count(StringData value, size_t begin = 0, size_t end = npos) const noexcept;
+    /// The value and its length are compared with a whole slot at once.
     size_t find_first(StringData value, size_t begin = 0, size_t end = npos) const noexcept;
+    /// Find the first string that begins with the specified value, which
+    /// must not be null.
+    size_t find_first_prefix(StringData prefix, size_t begin = 0, size_t end = npos) const noexcept;
     void find_all(IntegerColumn& result, StringData value, size_t add_offset = 0, size_t begin = 0,
                   size_t end = npos);
 
@@ -87,6 +91,13 @@ public:
     /// underlying node. It is not owned by the accessor.
     void create();
 
+    /// Mark the leaf as one that may be written in the compact format of
+    /// ArrayStringCompact. Only the leaves of string columns are.
+    void set_compactable() noexcept
+    {
+        m_packable = true;
+    }
+
 #ifdef REALM_DEBUG
     void string_stats() const;
 #endif
@@ -65,7 +65,7 @@ public:
     }
 
     bool traverse(ClusterTree::TraverseFunction func, int64_t) const;
-    void update(ClusterTree::UpdateFunction func, int64_t);
+    void update(ClusterTree::UpdateFunction func, int64_t, bool only_modified = false);
 
     size_t node_size() const override
     {
@@ -667,12 +667,15 @@ bool ClusterNodeInner::traverse(ClusterTree::TraverseFunction func, int64_t key_
     return false;
 }
 
-void ClusterNodeInner::update(ClusterTree::UpdateFunction func, int64_t key_offset)
+void ClusterNodeInner::update(ClusterTree::UpdateFunction func, int64_t key_offset, bool only_modified)
 {
     auto sz = node_size();
 
     for (unsigned i = 0; i < sz; i++) {
         ref_type ref = _get_child_ref(i);
+        // Nothing below an unmodified node is modified
+        if (only_modified && m_alloc.is_read_only(ref))
+            continue;
         char* header = m_alloc.translate(ref);
         bool child_is_leaf = !Array::get_is_inner_bptree_node_from_header(header);
         MemRef mem(header, ref, m_alloc);
@@ -687,7 +690,7 @@ void ClusterNodeInner::update(ClusterTree::UpdateFunction func, int64_t key_offs
             ClusterNodeInner node(m_alloc, m_tree_top);
             node.init(mem);
             node.set_parent(this, i + s_first_node_index);
-            node.update(func, offs);
+            node.update(func, offs, only_modified);
         }
     }
 }
@@ -942,6 +945,19 @@ void ClusterTree::update(UpdateFunction func)
     }
 }
 
+void ClusterTree::update_modified(UpdateFunction func)
+{
+    if (m_root->is_read_only())
+        return;
+
+    if (m_root->is_leaf()) {
+        func(static_cast<Cluster*>(m_root.get()));
+    }
+    else {
+        static_cast<ClusterNodeInner*>(m_root.get())->update(func, 0, true);
+    }
+}
+
 void ClusterTree::verify() const
 {
 #ifdef REALM_DEBUG
@@ -136,6 +136,8 @@ public:
     bool traverse(TraverseFunction func) const;
     // Visit all leaves and call the supplied function. The function can modify the leaf.
     void update(UpdateFunction func);
+    // Same as update(), but only visits the leaves modified in the current transaction
+    void update_modified(UpdateFunction func);
 
     virtual void for_each_and_every_column(ColIterateFunction) const = 0;
     virtual void update_indexes(ObjKey k, const FieldValues& init_values) = 0;
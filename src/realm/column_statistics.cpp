@@ -0,0 +1,135 @@
+/*************************************************************************
+ *
+ * Copyright 2021 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <realm/column_statistics.hpp>
+#include <realm/array_integer.hpp>
+#include <realm/table.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace realm;
+
+namespace {
+
+bool less(const Mixed& a, const Mixed& b)
+{
+    return a.compare(b) < 0;
+}
+
+bool is_nan(const Mixed& m)
+{
+    DataType type = m.get_type();
+    if (type == type_Float)
+        return std::isnan(m.get_float());
+    if (type == type_Double)
+        return std::isnan(m.get_double());
+    return false;
+}
+
+} // anonymous namespace
+
+ColumnStatistics::ColumnStatistics(const Table& table, ColKey col_key)
+    : m_row_count(table.size())
+{
+    REALM_ASSERT(is_supported(col_key));
+    m_sample_size = std::min(m_row_count, max_sample_size);
+    if (m_sample_size == 0) {
+        m_sample_size = 1;
+        return;
+    }
+
+    m_sorted_sample.reserve(m_sample_size);
+    for (size_t i = 0; i < m_sample_size; ++i) {
+        size_t ndx = i * m_row_count / m_sample_size;
+        Mixed value = table.get_object(ndx).get_any(col_key);
+        if (value.is_null()) {
+            ++m_null_count;
+            continue;
+        }
+        // NaN does not order and can never match a comparison, so it is left out
+        if (is_nan(value))
+            continue;
+        if (value.get_type() == type_String) {
+            StringData str = value.get_string();
+            m_strings.emplace_back(str.data(), str.size());
+            value = Mixed(StringData(m_strings.back()));
+        }
+        m_sorted_sample.push_back(value);
+    }
+
+    std::sort(m_sorted_sample.begin(), m_sorted_sample.end(), less);
+    if (!m_sorted_sample.empty()) {
+        m_distinct_count = 1;
+        for (size_t i = 1; i < m_sorted_sample.size(); ++i) {
+            if (less(m_sorted_sample[i - 1], m_sorted_sample[i]))
+                ++m_distinct_count;
+        }
+    }
+}
+
+bool ColumnStatistics::is_supported(ColKey col_key) noexcept
+{
+    if (col_key.is_collection())
+        return false;
+    switch (col_key.get_type()) {
+        case col_type_Int:
+        case col_type_Bool:
+        case col_type_String:
+        case col_type_Timestamp:
+        case col_type_Float:
+        case col_type_Double:
+        case col_type_Decimal:
+        case col_type_ObjectId:
+        case col_type_UUID:
+            return true;
+        default:
+            return false;
+    }
+}
+
+size_t ColumnStatistics::count_less(Mixed value) const
+{
+    return std::lower_bound(m_sorted_sample.begin(), m_sorted_sample.end(), value, less) - m_sorted_sample.begin();
+}
+
+size_t ColumnStatistics::count_less_equal(Mixed value) const
+{
+    return std::upper_bound(m_sorted_sample.begin(), m_sorted_sample.end(), value, less) - m_sorted_sample.begin();
+}
+
+namespace realm {
+
+template <>
+LeafSummary LeafSummary::compute(const ArrayInteger& leaf)
+{
+    // Not nullable, so the vectorized min/max of the leaf can be used
+    LeafSummary summary;
+    summary.size = leaf.size();
+    if (summary.size) {
+        QueryState<int64_t> min_state(act_Min);
+        QueryState<int64_t> max_state(act_Max);
+        leaf.find(cond_None, act_Min, 0, 0, summary.size, 0, &min_state);
+        leaf.find(cond_None, act_Max, 0, 0, summary.size, 0, &max_state);
+        summary.min = min_state.m_state;
+        summary.max = max_state.m_state;
+    }
+    return summary;
+}
+
+} // namespace realm
@@ -0,0 +1,300 @@
+/*************************************************************************
+ *
+ * Copyright 2021 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_COLUMN_STATISTICS_HPP
+#define REALM_COLUMN_STATISTICS_HPP
+
+#include <realm/alloc.hpp>
+#include <realm/keys.hpp>
+#include <realm/mixed.hpp>
+#include <realm/query_conditions.hpp>
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace realm {
+
+class ArrayInteger;
+class Table;
+
+/// Statistics for a single column, estimated from values sampled at evenly
+/// spaced rows. The query engine uses them to estimate how selective a
+/// condition is before it has seen any matches, so that it can start with a
+/// good node instead of learning the match frequencies from scratch.
+///
+/// The sorted sample works as an equi-depth histogram with one bucket per
+/// sampled value. Statistics are only kept for tables of at least
+/// `min_table_size` rows, and only for columns holding a single value of a
+/// type that can be compared (no collections, links or binaries).
+class ColumnStatistics {
+public:
+    static constexpr size_t min_table_size = 4096;
+    static constexpr size_t max_sample_size = 1024;
+
+    ColumnStatistics(const Table& table, ColKey col_key);
+
+    static bool is_supported(ColKey col_key) noexcept;
+
+    /// Number of rows in the table when the statistics were taken
+    size_t get_row_count() const noexcept
+    {
+        return m_row_count;
+    }
+
+    /// Estimated number of null entries in the column
+    size_t get_null_count() const noexcept
+    {
+        return m_null_count * m_row_count / m_sample_size;
+    }
+
+    /// Number of distinct non-null values in the sample. This is a lower
+    /// bound on the cardinality of the column.
+    size_t get_distinct_count() const noexcept
+    {
+        return m_distinct_count;
+    }
+
+    /// Smallest and largest sampled value, or null if all sampled values are null
+    Mixed get_min() const noexcept
+    {
+        return m_sorted_sample.empty() ? Mixed() : m_sorted_sample.front();
+    }
+    Mixed get_max() const noexcept
+    {
+        return m_sorted_sample.empty() ? Mixed() : m_sorted_sample.back();
+    }
+
+    /// Estimated fraction of the rows for which 'column Condition value'
+    /// holds, or a negative number if the condition is not supported.
+    template <class Condition>
+    double estimate_selectivity(Mixed value) const;
+
+private:
+    size_t m_row_count;
+    size_t m_sample_size = 0;
+    size_t m_null_count = 0;
+    size_t m_distinct_count = 0;
+    std::vector<Mixed> m_sorted_sample; // Sampled non-null values
+    std::deque<std::string> m_strings;  // Owns the string payloads in m_sorted_sample
+
+    size_t count_less(Mixed value) const;
+    size_t count_less_equal(Mixed value) const;
+};
+
+template <class Condition>
+double ColumnStatistics::estimate_selectivity(Mixed value) const
+{
+    // Values that are not in the sample still match a few rows, but no more than
+    // what falls between two neighbouring samples
+    const double not_sampled = 0.5 / m_sample_size;
+    size_t non_null = m_sorted_sample.size();
+    size_t count;
+
+    if (value.is_null()) {
+        if (std::is_same<Condition, Equal>::value)
+            count = m_null_count;
+        else if (std::is_same<Condition, NotEqual>::value)
+            count = m_sample_size - m_null_count;
+        else
+            return -1;
+    }
+    else if (std::is_same<Condition, Equal>::value)
+        count = count_less_equal(value) - count_less(value);
+    else if (std::is_same<Condition, NotEqual>::value)
+        count = m_sample_size - (count_less_equal(value) - count_less(value));
+    else if (std::is_same<Condition, Less>::value)
+        count = count_less(value);
+    else if (std::is_same<Condition, LessEqual>::value)
+        count = count_less_equal(value);
+    else if (std::is_same<Condition, Greater>::value)
+        count = non_null - count_less_equal(value);
+    else if (std::is_same<Condition, GreaterEqual>::value)
+        count = non_null - count_less(value);
+    else
+        return -1;
+
+    return count ? double(count) / m_sample_size : not_sampled;
+}
+
+/// Statistics of committed table content, shared by the transactions of a
+/// DB so that they are not sampled again by each of them. An entry is only
+/// used for the version of the table it was taken from, which is identified
+/// by the ref of the top array of the table together with the version of
+/// the table stored in it. Both change when a commit modifies the table.
+class ColumnStatisticsCache {
+public:
+    template <class F>
+    std::shared_ptr<const ColumnStatistics> get(TableKey table_key, ColKey col_key, ref_type top_ref,
+                                                uint64_t table_version, F&& compute);
+
+private:
+    struct Entry {
+        ref_type top_ref = 0;
+        uint64_t table_version = 0;
+        std::shared_ptr<const ColumnStatistics> statistics;
+    };
+    std::mutex m_mutex;
+    std::map<std::pair<TableKey, ColKey>, Entry> m_entries;
+};
+
+template <class F>
+std::shared_ptr<const ColumnStatistics> ColumnStatisticsCache::get(TableKey table_key, ColKey col_key,
+                                                                   ref_type top_ref, uint64_t table_version,
+                                                                   F&& compute)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_entries.find({table_key, col_key});
+        if (it != m_entries.end() && it->second.top_ref == top_ref && it->second.table_version == table_version)
+            return it->second.statistics;
+    }
+    // Sample without holding the lock, so that other columns can be looked up
+    // meanwhile. Should two transactions sample the same column, the last
+    // one to finish wins.
+    std::shared_ptr<const ColumnStatistics> statistics = compute(); // Throws
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries[{table_key, col_key}] = Entry{top_ref, table_version, statistics};
+    return statistics;
+}
+
+/// Min, max and null count of one column within one cluster (a zone map).
+/// The query engine uses it to skip clusters that cannot contain a match.
+struct LeafSummary {
+    Mixed min; // Null if the leaf has no non-null values
+    Mixed max;
+    size_t null_count = 0;
+    size_t size = 0;
+
+    template <class LeafType>
+    static LeafSummary compute(const LeafType& leaf);
+
+    /// False if no entry in the leaf can satisfy 'entry Condition value'
+    template <class Condition>
+    bool may_match(Mixed value) const;
+};
+
+/// Leaf summaries for a table, keyed by the ref of the leaf. The cache is
+/// only valid for one content version of the table and is emptied when the
+/// version changes. A summary is computed the second time a leaf is asked
+/// for, so that queries that only run once do not pay for it.
+class LeafSummaryCache {
+public:
+    template <class LeafType>
+    const LeafSummary* get(const LeafType& leaf, uint_fast64_t content_version);
+
+private:
+    struct Entry {
+        bool computed = false;
+        LeafSummary summary;
+    };
+    std::mutex m_mutex;
+    uint_fast64_t m_content_version = uint_fast64_t(-1);
+    std::unordered_map<ref_type, Entry> m_entries;
+};
+
+template <class LeafType>
+LeafSummary LeafSummary::compute(const LeafType& leaf)
+{
+    LeafSummary summary;
+    summary.size = leaf.size();
+    for (size_t i = 0; i < summary.size; ++i) {
+        Mixed value(leaf.get(i));
+        if (value.is_null()) {
+            ++summary.null_count;
+        }
+        else {
+            if (summary.min.is_null() || value.compare(summary.min) < 0)
+                summary.min = value;
+            if (summary.max.is_null() || value.compare(summary.max) > 0)
+                summary.max = value;
+        }
+    }
+    return summary;
+}
+
+template <>
+LeafSummary LeafSummary::compute(const ArrayInteger& leaf);
+
+template <class Condition>
+bool LeafSummary::may_match(Mixed value) const
+{
+    bool has_values = null_count < size;
+    if (value.is_null()) {
+        if (std::is_same<Condition, Equal>::value)
+            return null_count > 0;
+        if (std::is_same<Condition, NotEqual>::value)
+            return has_values;
+        return true;
+    }
+    if (std::is_same<Condition, Equal>::value)
+        return has_values && min.compare(value) <= 0 && max.compare(value) >= 0;
+    if (std::is_same<Condition, NotEqual>::value)
+        return null_count > 0 || min.compare(value) != 0 || max.compare(value) != 0;
+    if (std::is_same<Condition, Greater>::value)
+        return has_values && max.compare(value) > 0;
+    if (std::is_same<Condition, GreaterEqual>::value)
+        return has_values && max.compare(value) >= 0;
+    if (std::is_same<Condition, Less>::value)
+        return has_values && min.compare(value) < 0;
+    if (std::is_same<Condition, LessEqual>::value)
+        return has_values && min.compare(value) <= 0;
+    return true;
+}
+
+template <class LeafType>
+const LeafSummary* LeafSummaryCache::get(const LeafType& leaf, uint_fast64_t content_version)
+{
+    ref_type ref = leaf.get_ref();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (content_version != m_content_version) {
+            m_entries.clear();
+            m_content_version = content_version;
+        }
+        auto it = m_entries.find(ref);
+        if (it == m_entries.end()) {
+            m_entries.emplace(ref, Entry{});
+            return nullptr;
+        }
+        if (it->second.computed)
+            return &it->second.summary;
+    }
+
+    // Compute without holding the lock. Entries are never erased while the
+    // version is unchanged, and a concurrent computation yields the same result.
+    LeafSummary summary = LeafSummary::compute(leaf);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (content_version != m_content_version)
+        return nullptr;
+    Entry& entry = m_entries[ref];
+    if (!entry.computed) {
+        entry.summary = summary;
+        entry.computed = true;
+    }
+    return &entry.summary;
+}
+
+} // namespace realm
+
+#endif // REALM_COLUMN_STATISTICS_HPP
@@ -146,8 +146,10 @@ enum ColumnAttr {
     /// `col_attr_Indexed`.
     col_attr_Unique = 2,
 
-    /// Reserved for future use.
-    col_attr_Reserved = 4,
+    /// Specifies that the leaves of this column are stored compressed.
+    /// Applies only to string and binary columns. See
+    /// `Table::compress_column()`.
+    col_attr_Compressed = 4,
 
     /// Specifies that the links of this column are strong, not weak. Applies
     /// only to link columns (`type_Link` and `type_LinkList`).
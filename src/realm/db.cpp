@@ -24,6 +24,7 @@
 #include <iostream>
 #include <mutex>
 #include <sstream>
+#include <thread>
 #include <type_traits>
 #include <random>
 
@@ -40,6 +41,7 @@
 #include <realm/table_view.hpp>
 #include <realm/impl/simulated_failure.hpp>
 #include <realm/disable_sync_to_disk.hpp>
+#include <realm/warm_start.hpp>
 #include <realm/set.hpp>
 
 #ifndef _WIN32
@@ -80,7 +82,9 @@ const uint16_t relaxed_sync_threshold = 50;
 //  9      Fair write transactions requires an additional condition variable,
 //         `write_fairness`
 // 10      Introducing SharedInfo::history_schema_version.
-const uint_fast16_t g_shared_info_version = 10;
+// 11      Introducing SharedInfo::unsynced_commits in place of `filler_1`.
+// 12      Introducing SharedInfo::write_ahead_log in place of `filler_2`.
+const uint_fast16_t g_shared_info_version = 12;
 
 // The following functions are carefully designed for minimal overhead
 // in case of contention among read transactions. In case of contention,
@@ -495,14 +499,21 @@ struct alignas(8) DB::SharedInfo {
     /// Cleared by the daemon when it decides to exit.
     uint8_t daemon_ready = 0; // Offset 42
 
-    uint8_t filler_1; // Offset 43
+    /// Set (1) by a commit that was not synced to disk (group commit or
+    /// async durability). The next commit that is synced must then sync the
+    /// whole file rather than just what it wrote itself. Guarded by the write
+    /// mutex.
+    uint8_t unsynced_commits = 0; // Offset 43
 
     /// Stores a history schema version (as returned by
     /// Replication::get_history_schema_version()). Must match across all
     /// session participants.
     uint16_t history_schema_version; // Offset 44
 
-    uint16_t filler_2; // Offset 46
+    /// Set (1) if commits are made durable through a write-ahead log (see
+    /// DBOptions::write_ahead_log). Must match across all session
+    /// participants.
+    uint16_t write_ahead_log = 0; // Offset 46
 
     InterprocessMutex::SharedPart shared_writemutex; // Offset 48
 #ifdef REALM_ASYNC_DAEMON
@@ -607,10 +618,10 @@ DB::SharedInfo::SharedInfo(Durability dura, Replication::HistoryType ht, int hsv
             std::is_same<decltype(sync_agent_present), uint8_t>::value &&
             offsetof(SharedInfo, daemon_started) == 41 && std::is_same<decltype(daemon_started), uint8_t>::value &&
             offsetof(SharedInfo, daemon_ready) == 42 && std::is_same<decltype(daemon_ready), uint8_t>::value &&
-            offsetof(SharedInfo, filler_1) == 43 && std::is_same<decltype(filler_1), uint8_t>::value &&
+            offsetof(SharedInfo, unsynced_commits) == 43 && std::is_same<decltype(unsynced_commits), uint8_t>::value &&
             offsetof(SharedInfo, history_schema_version) == 44 &&
-            std::is_same<decltype(history_schema_version), uint16_t>::value && offsetof(SharedInfo, filler_2) == 46 &&
-            std::is_same<decltype(filler_2), uint16_t>::value && offsetof(SharedInfo, shared_writemutex) == 48 &&
+            std::is_same<decltype(history_schema_version), uint16_t>::value && offsetof(SharedInfo, write_ahead_log) == 46 &&
+            std::is_same<decltype(write_ahead_log), uint16_t>::value && offsetof(SharedInfo, shared_writemutex) == 48 &&
             std::is_same<decltype(shared_writemutex), InterprocessMutex::SharedPart>::value,
         "Caught layout change requiring SharedInfo file format bumping");
 #ifndef _WIN32
@@ -749,9 +760,13 @@ void DB::do_open(const std::string& path, bool no_create_file, bool is_backend,
     REALM_ASSERT(!is_attached());
 
 #ifndef REALM_ASYNC_DAEMON
-    if (options.durability == Durability::Async)
-        throw std::runtime_error("Async mode not yet supported on Windows, iOS and watchOS");
+    // Commits are flushed by a thread of this DB, which cannot update the
+    // header of an encrypted file on its own
+    if (options.durability == Durability::Async && options.encryption_key)
+        throw std::runtime_error("Async mode is not supported for encrypted files");
 #endif
+    bool write_ahead_log =
+        options.write_ahead_log && options.durability == Durability::Full && !options.encryption_key;
 
     m_db_path = path;
     m_coordination_dir = path + ".management";
@@ -823,6 +838,7 @@ void DB::do_open(const std::string& path, bool no_create_file, bool is_backend,
             SharedInfo* info_2 = m_file_map.get_addr();
 
             new (info_2) SharedInfo{options.durability, openers_hist_type, openers_hist_schema_version}; // Throws
+            info_2->write_ahead_log = write_ahead_log;
 
             // Because init_complete is an std::atomic, it's guaranteed not to be observable by others
             // as being 1 before the entire SharedInfo header has been written.
@@ -1013,8 +1029,25 @@ void DB::do_open(const std::string& path, bool no_create_file, bool is_backend,
             cfg.clear_file = (options.durability == Durability::MemOnly && begin_new_session);
 
             cfg.encryption_key = m_key;
+            if (options.access_pattern == DBOptions::AccessPattern::Sequential)
+                cfg.map_flags |= File::map_Sequential;
+            else if (options.access_pattern == DBOptions::AccessPattern::Random)
+                cfg.map_flags |= File::map_Random;
+            if (options.prefetch_on_open)
+                cfg.map_flags |= File::map_WillNeed;
+            if (options.huge_pages)
+                cfg.map_flags |= File::map_HugePages;
+            cfg.slab_retention = options.slab_retention;
             ref_type top_ref;
             try {
+                // Commits left in the write-ahead log by a session that did
+                // not end cleanly must be applied before the file is used
+                if (begin_new_session && !m_key && options.durability != Durability::MemOnly)
+                    WriteAheadLog::recover(path); // Throws
+                // Blocks can only be re-encrypted while no session maps them
+                if (begin_new_session && m_key && m_upgrade_encryption && options.durability != Durability::MemOnly &&
+                    File::exists(path))
+                    util::upgrade_encryption(path, m_key); // Throws
                 top_ref = alloc.attach_file(path, cfg); // Throws
                 if (top_ref) {
                     alloc.note_reader_start(this);
@@ -1066,6 +1099,7 @@ void DB::do_open(const std::string& path, bool no_create_file, bool is_backend,
                 case 10:
                 case 11:
                 case 20:
+                case 21:
                     file_format_ok = true;
                     break;
             }
@@ -1176,6 +1210,8 @@ void DB::do_open(const std::string& path, bool no_create_file, bool is_backend,
                 // use the same durability setting for the same Realm file.
                 if (Durability(info->durability) != options.durability)
                     throw LogicError(LogicError::mixed_durability);
+                if ((info->write_ahead_log != 0) != write_ahead_log)
+                    throw LogicError(LogicError::mixed_durability);
 
                 // History type must be consistent across a session. An
                 // inconsistency is a logic error, as the user is required to
@@ -1217,7 +1253,13 @@ void DB::do_open(const std::string& path, bool no_create_file, bool is_backend,
                 // we shall instead simply check that there is agreement, and
                 // throw the same kind of exception, as would have been thrown
                 // with a bumped SharedInfo file format version, if there isn't.
-                if (info->file_format_version != target_file_format_version) {
+                //
+                // A commit of the session may have moved the file to the
+                // extended format after this participant read the file
+                // header. The file is never moved back, so that is fine.
+                bool moved_to_extended = info->file_format_version == Group::extended_file_format_version &&
+                                         target_file_format_version == 20;
+                if (info->file_format_version != target_file_format_version && !moved_to_extended) {
                     std::stringstream ss;
                     ss << "File format version deosn't match: " << info->file_format_version << " "
                        << target_file_format_version << ".";
@@ -1296,10 +1338,28 @@ void DB::do_open(const std::string& path, bool no_create_file, bool is_backend,
     }
 #else
     static_cast<void>(is_backend);
+    if (options.durability == Durability::Async) {
+        if (options.group_commit_window.count() > 0)
+            m_async_flush_interval = options.group_commit_window;
+        m_async_flusher = std::thread([this] {
+            run_async_flusher();
+        });
+    }
 #endif
 
+    if (m_warm_start) {
+        std::vector<WarmStart::Range> ranges = WarmStart::load(path);
+        if (!ranges.empty()) {
+            m_prefetcher = std::thread([this, ranges = std::move(ranges)] {
+                WarmStart::prefetch(m_db_path, ranges, m_stop_prefetcher);
+            });
+        }
+    }
+
     // Upgrade file format and/or history schema
     try {
+        if (write_ahead_log)
+            m_wal = std::make_unique<WriteAheadLog>(path); // Throws
         if (stored_hist_schema_version == -1) {
             // current_hist_schema_version has not been read. Read it now
             stored_hist_schema_version = start_read()->get_history_schema_version();
@@ -1408,11 +1468,16 @@ bool DB::compact(bool bump_version_number, util::Optional<const char*> output_en
 
         // Holding the controlmutex prevents any other DB from attaching to the file.
 
+        // Commits waiting to be made durable hold a read lock, see m_durable_lock.
+        // They are made durable below, so that lock is not an active transaction.
+        // The mutex is taken before m_mutex, as in do_begin_write().
+        std::lock_guard<std::mutex> group_commit_lock(m_group_commit_mutex);
+
         // local lock blocking any transaction from starting (and stopping)
         std::lock_guard<std::recursive_mutex> local_lock(m_mutex);
 
         // We should be the only transaction active - otherwise back out
-        if (m_transaction_count != 0)
+        if (m_transaction_count != (m_holds_durable_lock ? 1 : 0))
             return false;
 
         // group::write() will throw if the file already exists.
@@ -1425,17 +1490,36 @@ bool DB::compact(bool bump_version_number, util::Optional<const char*> output_en
         // This is also needed to attach the group (get the proper top pointer, etc)
         TransactionRef tr = start_read();
 
+        if (m_holds_durable_lock || (m_wal && m_wal->size() > 0)) {
+            // The records in the log refer to the layout of the current file,
+            // so they must be checkpointed and discarded before it is replaced
+            SharedInfo* r_info = m_reader_map.get_addr();
+            ref_type top_ref = r_info->readers.get_last().current_top;
+            GroupWriter::commit_written(m_alloc.get_file(), top_ref, info->file_format_version); // Throws
+            if (m_wal)
+                m_wal->clear(); // Throws
+            info->unsynced_commits = 0;
+            do_set_durable_version(info->latest_version_number);
+        }
+
         // Compact by writing a new file holding only live data, then renaming the new file
         // so it becomes the database file, replacing the old one in the process.
         try {
             File file;
             file.open(tmp_path, File::access_ReadWrite, File::create_Must, 0);
             int incr = bump_version_number ? 1 : 0;
+            // A participant that has left may have moved the file to the
+            // extended format
+            tr->set_file_format_version(std::max(tr->get_file_format_version(), int(info->file_format_version)));
             tr->write(file, write_key, info->latest_version_number + incr, true); // Throws
             // Data needs to be flushed to the disk before renaming.
             bool disable_sync = get_disable_sync_to_disk();
             if (!disable_sync && dura != Durability::Unsafe)
                 file.sync(); // Throws
+            // The new file is written with AES-CBC, so keep it in the format
+            // the sessions of this DB use
+            if (write_key && m_upgrade_encryption)
+                util::upgrade_encryption(tmp_path, write_key); // Throws
         }
         catch (...) {
             // If writing the compact version failed in any way, delete the partially written file to clean up disk
@@ -1533,6 +1617,40 @@ void DB::close_internal(std::unique_lock<InterprocessMutex> lock, bool allow_ope
     if (!is_attached())
         return;
 
+    {
+        std::lock_guard<std::recursive_mutex> local_lock(m_mutex);
+        if (m_write_transaction_open)
+            throw LogicError(LogicError::wrong_transact_state);
+    }
+    // Checkpoint the write-ahead log, so that the file is complete without it
+    if (m_wal) {
+        try {
+            if (m_wal->size() > 0) {
+                do_begin_write(); // Throws
+                auto end_write = util::make_scope_exit([&]() noexcept {
+                    do_end_write();
+                });
+                flush_group_commit(); // Throws
+            }
+        }
+        catch (...) {
+            // The log is applied when the next session starts
+        }
+        m_wal.reset();
+    }
+    // Flush the commits that the async flusher has not got to yet
+    stop_async_flusher();
+    stop_prefetcher();
+    if (m_warm_start)
+        record_warm_start();
+    {
+        // Only left behind by a flush that failed
+        std::lock_guard<std::mutex> lock(m_group_commit_mutex);
+        if (m_holds_durable_lock) {
+            release_read_lock(m_durable_lock);
+            m_holds_durable_lock = false;
+        }
+    }
     {
         std::lock_guard<std::recursive_mutex> local_lock(m_mutex);
         if (m_write_transaction_open)
@@ -1636,27 +1754,27 @@ void Transaction::set_transact_stage(DB::TransactStage stage) noexcept
         size_t free_space = db->m_free_space;
         size_t num_objects = m_total_rows;
         size_t num_available_versions = static_cast<size_t>(db->get_number_of_versions());
-        size_t num_decrypted_pages = realm::util::get_num_decrypted_pages();
+        auto decrypted_memory = realm::util::get_decrypted_memory_stats();
 
         if (stage == DB::transact_Reading) {
             if (m_transact_stage == DB::transact_Writing) {
                 m_metrics->end_write_transaction(total_size, free_space, num_objects, num_available_versions,
-                                                 num_decrypted_pages);
+                                                 decrypted_memory);
             }
             m_metrics->start_read_transaction();
         }
         else if (stage == DB::transact_Writing) {
             if (m_transact_stage == DB::transact_Reading) {
                 m_metrics->end_read_transaction(total_size, free_space, num_objects, num_available_versions,
-                                                num_decrypted_pages);
+                                                decrypted_memory);
             }
             m_metrics->start_write_transaction();
         }
         else if (stage == DB::transact_Ready) {
             m_metrics->end_read_transaction(total_size, free_space, num_objects, num_available_versions,
-                                            num_decrypted_pages);
+                                            decrypted_memory);
             m_metrics->end_write_transaction(total_size, free_space, num_objects, num_available_versions,
-                                             num_decrypted_pages);
+                                             decrypted_memory);
         }
     }
 #endif
@@ -2060,8 +2178,9 @@ void DB::do_end_write() noexcept
 }
 
 
-Replication::version_type DB::do_commit(Transaction& transaction)
+Replication::version_type DB::do_commit(Transaction& transaction, bool allow_group_commit)
 {
+    bool defer_sync = (allow_group_commit && group_commit_enabled()) || m_async_flusher.joinable() || m_wal;
     version_type current_version;
     {
         std::lock_guard<std::recursive_mutex> lock(m_mutex);
@@ -2077,7 +2196,7 @@ Replication::version_type DB::do_commit(Transaction& transaction)
         // must call Replication::abort_transact().
         new_version = repl->prepare_commit(current_version); // Throws
         try {
-            low_level_commit(new_version, transaction); // Throws
+            low_level_commit(new_version, transaction, defer_sync); // Throws
         }
         catch (...) {
             repl->abort_transact();
@@ -2086,12 +2205,197 @@ Replication::version_type DB::do_commit(Transaction& transaction)
         repl->finalize_commit();
     }
     else {
-        low_level_commit(new_version, transaction); // Throws
+        low_level_commit(new_version, transaction, defer_sync); // Throws
     }
     return new_version;
 }
 
 
+void DB::wait_for_group_commit(version_type version)
+{
+    std::unique_lock<std::mutex> lock(m_group_commit_mutex);
+    while (m_durable_version < version) {
+        if (m_group_commit_leader) {
+            m_group_commit_changed.wait(lock);
+            continue;
+        }
+
+        // Let the commits arriving within the window join this flush
+        m_group_commit_leader = true;
+        lock.unlock();
+        auto done = util::make_scope_exit([&]() noexcept {
+            lock.lock();
+            m_group_commit_leader = false;
+            m_group_commit_changed.notify_all();
+        });
+        std::this_thread::sleep_for(m_group_commit_window);
+        do_begin_write(); // Throws
+        try {
+            flush_group_commit(); // Throws
+        }
+        catch (...) {
+            do_end_write();
+            throw;
+        }
+        do_end_write();
+    }
+}
+
+
+void DB::flush_group_commit()
+{
+    // Everything committed so far has been written, so the latest version
+    // covers the commits of all waiters
+    ReadLockInfo latest;
+    grab_read_lock(latest, VersionID()); // Throws
+    ReadLockGuard g(*this, latest);
+    {
+        // protect against race with any other DB trying to attach to the file
+        std::lock_guard<InterprocessMutex> lock(m_controlmutex); // Throws
+        SharedInfo* info = m_file_map.get_addr();
+        GroupWriter::commit_written(m_alloc.get_file(), latest.m_top_ref, info->file_format_version); // Throws
+        if (m_wal)
+            m_wal->clear(); // Throws
+    }
+    m_file_map.get_addr()->unsynced_commits = 0;
+    set_durable_version(latest.m_version);
+}
+
+
+void DB::set_durable_version(version_type version)
+{
+    std::lock_guard<std::mutex> lock(m_group_commit_mutex);
+    do_set_durable_version(version);
+}
+
+
+void DB::do_set_durable_version(version_type version)
+{
+    if (version > m_durable_version)
+        m_durable_version = version;
+    m_flush_error = nullptr;
+    // The file header now refers to a version at least as new as the one
+    // that was locked, so that one need not be kept around any more
+    if (m_holds_durable_lock) {
+        release_read_lock(m_durable_lock);
+        m_holds_durable_lock = false;
+    }
+    m_group_commit_changed.notify_all();
+}
+
+
+void DB::wait_for_durable(version_type version)
+{
+    if (version > get_version_of_latest_snapshot())
+        throw LogicError(LogicError::bad_version);
+    if (group_commit_enabled()) {
+        wait_for_group_commit(version); // Throws
+        return;
+    }
+    if (!m_async_flusher.joinable())
+        return;
+
+    std::unique_lock<std::mutex> lock(m_group_commit_mutex);
+    while (m_durable_version < version) {
+        if (m_flush_error)
+            std::rethrow_exception(m_flush_error);
+        m_flush_requested = true;
+        m_group_commit_changed.notify_all();
+        m_group_commit_changed.wait(lock);
+    }
+}
+
+
+void DB::run_async_flusher()
+{
+    std::unique_lock<std::mutex> lock(m_group_commit_mutex);
+    for (;;) {
+        // The durable lock is held exactly while there are deferred commits
+        m_group_commit_changed.wait(lock, [&] {
+            return m_holds_durable_lock || m_flush_requested || m_stop_async_flusher;
+        });
+        if (!m_flush_requested && !m_stop_async_flusher) {
+            // Let more commits arrive, unless asked to hurry up
+            m_group_commit_changed.wait_for(lock, m_async_flush_interval, [&] {
+                return m_flush_requested || m_stop_async_flusher;
+            });
+        }
+        bool stop = m_stop_async_flusher;
+        if (m_holds_durable_lock || m_flush_requested) {
+            m_flush_requested = false;
+            lock.unlock();
+            try {
+                do_begin_write(); // Throws
+                try {
+                    flush_group_commit(); // Throws
+                }
+                catch (...) {
+                    do_end_write();
+                    throw;
+                }
+                do_end_write();
+            }
+            catch (...) {
+                lock.lock();
+                m_flush_error = std::current_exception();
+                m_group_commit_changed.notify_all();
+                if (stop)
+                    return;
+                // Retry after a while, rather than spinning on the error
+                m_group_commit_changed.wait_for(lock, m_async_flush_interval, [&] {
+                    return m_stop_async_flusher;
+                });
+                continue;
+            }
+            lock.lock();
+        }
+        if (stop)
+            return;
+    }
+}
+
+
+void DB::stop_async_flusher() noexcept
+{
+    if (!m_async_flusher.joinable())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(m_group_commit_mutex);
+        m_stop_async_flusher = true;
+        m_group_commit_changed.notify_all();
+    }
+    m_async_flusher.join();
+}
+
+
+void DB::record_warm_start() noexcept
+{
+    try {
+        ReadLockInfo read_lock;
+        grab_read_lock(read_lock, VersionID()); // Throws
+        ReadLockGuard g(*this, read_lock);
+        m_alloc.note_reader_start(this);
+        auto reader_end = util::make_scope_exit([&]() noexcept {
+            m_alloc.note_reader_end(this);
+        });
+        m_alloc.update_reader_view(read_lock.m_file_size);                                 // Throws
+        WarmStart::record(m_db_path, m_alloc, read_lock.m_top_ref, read_lock.m_file_size); // Throws
+    }
+    catch (...) {
+        // The profile recorded previously, if any, is used by the next session
+    }
+}
+
+
+void DB::stop_prefetcher() noexcept
+{
+    if (!m_prefetcher.joinable())
+        return;
+    m_stop_prefetcher = true;
+    m_prefetcher.join();
+}
+
+
 DB::version_type Transaction::commit_and_continue_as_read()
 {
     if (!is_attached())
@@ -2101,7 +2405,7 @@ DB::version_type Transaction::commit_and_continue_as_read()
 
     flush_accessors_for_commit();
 
-    DB::version_type version = db->do_commit(*this); // Throws
+    DB::version_type version = db->do_commit(*this, true); // Throws
 
     // advance read lock but dont update accessors:
     // As this is done under lock, along with the addition above of the newest commit,
@@ -2124,6 +2428,9 @@ DB::version_type Transaction::commit_and_continue_as_read()
     m_history = nullptr;
     set_transact_stage(DB::transact_Reading);
 
+    if (db->group_commit_enabled())
+        db->wait_for_group_commit(version); // Throws
+
     return version;
 }
 
@@ -2182,10 +2489,29 @@ DB::version_type DB::get_version_of_latest_snapshot()
 }
 
 
-void DB::low_level_commit(uint_fast64_t new_version, Transaction& transaction)
+void DB::low_level_commit(uint_fast64_t new_version, Transaction& transaction, bool defer_sync)
 {
     SharedInfo* info = m_file_map.get_addr();
 
+    if (defer_sync) {
+        // The file header keeps referring to the latest durable version until
+        // the next group flush, so its space must not be reused before then.
+        // Nothing is deferred unless this lock is held, so the latest version
+        // is either durable or protected by a lock held elsewhere.
+        std::lock_guard<std::mutex> lock(m_group_commit_mutex);
+        if (m_holds_durable_lock && m_wal && m_wal->size() == 0) {
+            // Another session participant has checkpointed the log, so the
+            // file header refers to the latest version
+            release_read_lock(m_durable_lock);
+            m_holds_durable_lock = false;
+        }
+        if (!m_holds_durable_lock) {
+            grab_read_lock(m_durable_lock, VersionID()); // Throws
+            m_holds_durable_lock = true;
+            m_group_commit_changed.notify_all(); // Wake the async flusher
+        }
+    }
+
     // Version of oldest snapshot currently (or recently) bound in a transaction
     // of the current session.
     uint_fast64_t oldest_version;
@@ -2218,15 +2544,48 @@ void DB::low_level_commit(uint_fast64_t new_version, Transaction& transaction)
     transaction.update_num_objects();
 #endif // REALM_METRICS
 
+    if (defer_sync)
+        info->unsynced_commits = 1;
+
     // info->readers.dump();
     GroupWriter out(transaction, Durability(info->durability)); // Throws
     out.set_versions(new_version, oldest_version);
+    std::vector<char> logged_writes;
+    if (m_wal)
+        out.set_write_log(&logged_writes, WriteAheadLog::checkpoint_size);
+    if (m_incremental_compaction)
+        out.set_relocation_position(m_relocation_table, m_relocation_path);
+    out.set_pack_integers(m_pack_integers);
+    out.set_compact_strings(m_compact_strings);
     ref_type new_top_ref;
     // Recursively write all changed arrays to end of file
     {
         // protect against race with any other DB trying to attach to the file
         std::lock_guard<InterprocessMutex> lock(m_controlmutex); // Throws
         new_top_ref = out.write_group();                         // Throws
+
+        // The file format is never moved back, also not when another session
+        // participant has moved it to the extended format
+        int file_format_version = std::max(transaction.get_file_format_version(), int(info->file_format_version));
+        transaction.set_file_format_version(file_format_version);
+        info->file_format_version = uint8_t(file_format_version);
+        m_file_format_version = file_format_version;
+    }
+    if (m_incremental_compaction) {
+        m_relocation_table = out.get_next_relocation_table();
+        m_relocation_path = out.get_next_relocation_path();
+    }
+    // With a write-ahead log, small commits are made durable by appending
+    // them to the log, and large ones by flushing the file
+    bool flushed = !defer_sync;
+    if (m_wal) {
+        if (logged_writes.empty()) {
+            flushed = true;
+        }
+        else {
+            m_wal->append(new_version, new_top_ref, out.get_file_size(), info->file_format_version,
+                          logged_writes); // Throws
+        }
     }
     {
         // protect access to shared variables and m_reader_mapping from here
@@ -2239,7 +2598,11 @@ void DB::low_level_commit(uint_fast64_t new_version, Transaction& transaction)
         switch (Durability(info->durability)) {
             case Durability::Full:
             case Durability::Unsafe:
-                out.commit(new_top_ref); // Throws
+                // With group commit, the flush is done by wait_for_group_commit()
+                if (flushed) {
+                    out.commit(new_top_ref, info->unsynced_commits != 0); // Throws
+                    info->unsynced_commits = 0;
+                }
                 break;
             case Durability::MemOnly:
             case Durability::Async:
@@ -2294,6 +2657,15 @@ void DB::low_level_commit(uint_fast64_t new_version, Transaction& transaction)
 
         m_new_commit_available.notify_all();
     }
+    // A commit that is flushed at once also makes all deferred ones durable
+    if ((group_commit_enabled() || m_wal) && flushed) {
+        if (m_wal)
+            m_wal->clear(); // Throws
+        set_durable_version(new_version);
+    }
+    else if (m_wal && m_wal->size() >= WriteAheadLog::checkpoint_size) {
+        flush_group_commit(); // Throws
+    }
 }
 
 #ifdef REALM_DEBUG
@@ -2329,6 +2701,15 @@ std::vector<std::pair<std::string, bool>> DB::get_core_files(const std::string&
 {
     std::vector<std::pair<std::string, bool>> files;
     files.emplace_back(std::make_pair(realm_path, false));
+    // Only present if the file has been opened with a write-ahead log. It must
+    // be removed along with the file, or it would be applied to a new one.
+    std::string wal_path = WriteAheadLog::get_path(realm_path);
+    if (File::exists(wal_path))
+        files.emplace_back(std::make_pair(wal_path, false));
+    // Only present if the file has been opened with DBOptions::warm_start
+    std::string warm_start_path = WarmStart::get_path(realm_path);
+    if (File::exists(warm_start_path))
+        files.emplace_back(std::make_pair(warm_start_path, false));
     files.emplace_back(std::make_pair(realm_path + ".management", true));
     return files;
 }
@@ -2374,6 +2755,7 @@ Transaction::Transaction(DBRef _db, SlabAlloc* alloc, DB::ReadLockInfo& rli, DB:
     bool writable = stage == DB::transact_Writing;
     m_transact_stage = DB::transact_Ready;
     set_metrics(db->m_metrics);
+    m_column_statistics = db->m_column_statistics;
     set_transact_stage(stage);
     m_alloc.note_reader_start(this);
     attach_shared(m_read_lock.m_top_ref, m_read_lock.m_file_size, writable);
@@ -2493,7 +2875,7 @@ DB::version_type Transaction::commit()
     // before committing, allow any accessors at group level or below to sync
     flush_accessors_for_commit();
 
-    DB::version_type new_version = db->do_commit(*this); // Throws
+    DB::version_type new_version = db->do_commit(*this, true); // Throws
 
     // We need to set m_read_lock in order for wait_for_change to work.
     // To set it, we grab a readlock on the latest available snapshot
@@ -2505,9 +2887,14 @@ DB::version_type Transaction::commit()
 
     db->do_end_write();
 
+    // do_end_read() releases our reference to the DB
+    DBRef db_ref = db;
     do_end_read();
     m_read_lock = lock_after_commit;
 
+    if (db_ref->group_commit_enabled())
+        db_ref->wait_for_group_commit(new_version); // Throws
+
     return new_version;
 }
 
@@ -2697,6 +3084,15 @@ std::unique_ptr<ConstTableView> Transaction::import_copy_of(ConstTableView& tv,
 inline DB::DB(const DBOptions& options)
     : m_key(options.encryption_key)
     , m_upgrade_callback(std::move(options.upgrade_callback))
+    , m_group_commit_window(options.durability == Durability::Full && !options.encryption_key &&
+                                    !options.write_ahead_log
+                                ? options.group_commit_window
+                                : std::chrono::microseconds(0))
+    , m_incremental_compaction(options.incremental_compaction && !options.encryption_key)
+    , m_upgrade_encryption(options.upgrade_encryption)
+    , m_warm_start(options.warm_start && !options.encryption_key && options.durability != Durability::MemOnly)
+    , m_pack_integers(options.pack_integers)
+    , m_compact_strings(options.compact_strings)
 {
 }
 
@@ -19,9 +19,14 @@
 #ifndef REALM_GROUP_SHARED_HPP
 #define REALM_GROUP_SHARED_HPP
 
+#include <atomic>
+#include <condition_variable>
 #include <functional>
 #include <cstdint>
+#include <exception>
 #include <limits>
+#include <mutex>
+#include <thread>
 #include <realm/util/features.h>
 #include <realm/util/thread.hpp>
 #include <realm/util/interprocess_condvar.hpp>
@@ -33,6 +38,7 @@
 #include <realm/replication.hpp>
 #include <realm/version_id.hpp>
 #include <realm/db_options.hpp>
+#include <realm/write_ahead_log.hpp>
 
 namespace realm {
 
@@ -214,6 +220,13 @@ public:
     /// Returns the version of the latest snapshot.
     version_type get_version_of_latest_snapshot();
 
+    /// Wait until the specified version, or a later one, has been made
+    /// durable. With Durability::Async, commit() returns before the commit is
+    /// durable, and a background thread flushes commits shortly after. This
+    /// makes it flush at once. With the other durability levels, commits are
+    /// durable, as far as they ever get, when commit() returns.
+    void wait_for_durable(version_type version);
+
     /// Thrown by start_read() if the specified version does not correspond to a
     /// bound (AKA tethered) snapshot.
     struct BadVersion;
@@ -399,7 +412,7 @@ private:
     std::string m_db_path;
     std::string m_coordination_dir;
     const char* m_key;
-    int m_file_format_version = 0;
+    std::atomic<int> m_file_format_version{0}; // Moved forward by commits, see low_level_commit()
     util::InterprocessMutex m_writemutex;
 #ifdef REALM_ASYNC_DAEMON
     util::InterprocessMutex m_balancemutex;
@@ -415,6 +428,55 @@ private:
     std::function<void(int, int)> m_upgrade_callback;
 
     std::shared_ptr<metrics::Metrics> m_metrics;
+    std::shared_ptr<ColumnStatisticsCache> m_column_statistics = std::make_shared<ColumnStatisticsCache>();
+
+    // Group commit state, see DBOptions::group_commit_window. Commits up to
+    // m_durable_version have been flushed. While commits are waiting for a
+    // flush, m_durable_lock is a read lock on a version no later than the
+    // one in the file header, which keeps its space from being reused.
+    std::chrono::microseconds m_group_commit_window;
+    std::mutex m_group_commit_mutex;
+    std::condition_variable m_group_commit_changed;
+    bool m_group_commit_leader = false;
+    bool m_holds_durable_lock = false;
+    ReadLockInfo m_durable_lock;
+    version_type m_durable_version = 0;
+
+    // In-process flusher for Durability::Async. It flushes the deferred
+    // commits m_async_flush_interval after the first of them, or at once
+    // when a flush is requested.
+    std::thread m_async_flusher;
+    std::chrono::microseconds m_async_flush_interval = std::chrono::milliseconds(100);
+    bool m_stop_async_flusher = false;
+    bool m_flush_requested = false;
+    std::exception_ptr m_flush_error;
+
+    // See DBOptions::write_ahead_log. Commits are deferred as with group
+    // commit, but made durable by the log, and m_durable_lock is held until
+    // the next checkpoint.
+    std::unique_ptr<WriteAheadLog> m_wal;
+
+    // See DBOptions::incremental_compaction. The index of the table to search
+    // for data to move in the next commit, and where in it to start.
+    bool m_incremental_compaction;
+    size_t m_relocation_table = 0;
+    std::vector<size_t> m_relocation_path;
+
+    // See DBOptions::upgrade_encryption
+    bool m_upgrade_encryption;
+
+    // See DBOptions::warm_start. The profile of the file is recorded on close
+    // if m_warm_start is set. m_prefetcher reads the profile recorded last
+    // time into the page cache.
+    bool m_warm_start;
+    std::thread m_prefetcher;
+    std::atomic<bool> m_stop_prefetcher{false};
+
+    // See DBOptions::pack_integers
+    bool m_pack_integers;
+    // See DBOptions::compact_strings
+    bool m_compact_strings;
+
     /// Attach this DB instance to the specified database file.
     ///
     /// While at least one instance of DB exists for a specific
@@ -493,7 +555,7 @@ private:
     /// return true if write transaction can commence, false otherwise.
     bool do_try_begin_write();
     void do_begin_write();
-    version_type do_commit(Transaction&);
+    version_type do_commit(Transaction&, bool allow_group_commit = false);
     void do_end_write() noexcept;
 
     // make sure the given index is within the currently mapped area.
@@ -501,7 +563,24 @@ private:
     bool grow_reader_mapping(uint_fast32_t index);
 
     // Must be called only by someone that has a lock on the write mutex.
-    void low_level_commit(uint_fast64_t new_version, Transaction& transaction);
+    void low_level_commit(uint_fast64_t new_version, Transaction& transaction, bool defer_sync = false);
+
+    bool group_commit_enabled() const noexcept
+    {
+        return m_group_commit_window.count() > 0;
+    }
+    // Wait until `version`, committed with do_commit(tr, true), is durable.
+    // One of the waiting threads flushes the commits of all of them.
+    void wait_for_group_commit(version_type version);
+    // Must be called only by someone that has a lock on the write mutex.
+    void flush_group_commit();
+    void set_durable_version(version_type version);
+    // Must be called only by someone that has a lock on m_group_commit_mutex.
+    void do_set_durable_version(version_type version);
+    void run_async_flusher();
+    void stop_async_flusher() noexcept;
+    void record_warm_start() noexcept;
+    void stop_prefetcher() noexcept;
 
     void do_async_commits();
 
@@ -932,6 +1011,8 @@ inline void Transaction::rollback_and_continue_as_read(O* observer)
     m_alloc.update_reader_view(file_size); // Throws
     update_allocator_wrappers(false);
     advance_transact(top_ref, reversed_in, false); // Throws
+    // Forget any move to the extended file format made by the transaction
+    set_file_format_version(db->get_file_format_version());
 
     db->do_end_write();
 
@@ -19,6 +19,7 @@
 #ifndef REALM_GROUP_SHARED_OPTIONS_HPP
 #define REALM_GROUP_SHARED_OPTIONS_HPP
 
+#include <chrono>
 #include <functional>
 #include <string>
 
@@ -31,10 +32,18 @@ struct DBOptions {
     enum class Durability : uint16_t {
         Full,
         MemOnly,
-        Async, ///< Not yet supported on windows.
+        Async, ///< Commits are flushed shortly after commit() returns. See DB::wait_for_durable().
         Unsafe // If you use this, you loose ACID property
     };
 
+    /// How the mapped Realm file is expected to be accessed. Passed on to the
+    /// kernel as a hint, where supported.
+    enum class AccessPattern : uint16_t {
+        Normal,
+        Sequential, ///< Mostly scans. Pages are read ahead aggressively.
+        Random      ///< Mostly point lookups. Pages are not read ahead.
+    };
+
     explicit DBOptions(Durability level = Durability::Full, const char* key = nullptr, bool allow_upgrade = true,
                        std::function<void(int, int)> file_upgrade_callback = std::function<void(int, int)>(),
                        std::string temp_directory = sys_tmp_dir, bool track_metrics = false,
@@ -46,7 +55,17 @@ struct DBOptions {
         , temp_dir(temp_directory)
         , enable_metrics(track_metrics)
         , metrics_buffer_size(metrics_history_size)
-
+        , group_commit_window(0)
+        , write_ahead_log(false)
+        , incremental_compaction(false)
+        , upgrade_encryption(false)
+        , access_pattern(AccessPattern::Normal)
+        , prefetch_on_open(false)
+        , huge_pages(false)
+        , warm_start(false)
+        , slab_retention(128 * 1024)
+        , pack_integers(false)
+        , compact_strings(false)
     {
     }
 
@@ -58,6 +77,17 @@ struct DBOptions {
         , temp_dir(sys_tmp_dir)
         , enable_metrics(false)
         , metrics_buffer_size(10000)
+        , group_commit_window(0)
+        , write_ahead_log(false)
+        , incremental_compaction(false)
+        , upgrade_encryption(false)
+        , access_pattern(AccessPattern::Normal)
+        , prefetch_on_open(false)
+        , huge_pages(false)
+        , warm_start(false)
+        , slab_retention(128 * 1024)
+        , pack_integers(false)
+        , compact_strings(false)
     {
     }
 
@@ -101,6 +131,100 @@ struct DBOptions {
     /// is exceeded without being consumed, only the most recent entries will be stored.
     size_t metrics_buffer_size;
 
+    /// If not zero, and \a durability is Durability::Full, commits made
+    /// through this DB are flushed to disk in groups. A commit publishes its
+    /// version to readers at once, but `Transaction::commit()` only returns
+    /// once the version has been made durable. The first committer waits this
+    /// long for others to commit, and then makes all of them durable with a
+    /// single flush. Ignored for encrypted files.
+    ///
+    /// With Durability::Async, this is how long the background flusher lets
+    /// commits accumulate before flushing them, 100 ms if zero.
+    std::chrono::microseconds group_commit_window;
+
+    /// If true, and \a durability is Durability::Full, small commits are made
+    /// durable by appending the arrays they write to a sequential log next to
+    /// the Realm file (<path>.wal), with a single sync. The Realm file itself
+    /// is flushed only when the log has grown large, when the DB is closed,
+    /// and on large commits. Commits in the log are applied to the Realm file
+    /// when the next session starts after a crash. Must be the same for all
+    /// participants in a session. Ignored for encrypted files. Overrides
+    /// \a group_commit_window.
+    bool write_ahead_log;
+
+    /// If true, commits made through this DB gradually vacate the end of the
+    /// Realm file once much of the file is free: a bounded amount of data is
+    /// moved from the end of the file into free space further in, and free
+    /// space at the end is given back by truncating the file. This reclaims
+    /// space while the file stays in use, unlike DB::compact(). One table is
+    /// searched for data to move per commit, so each commit may take longer.
+    /// Ignored for encrypted files.
+    bool incremental_compaction;
+
+    /// If true, and the file is encrypted, blocks encrypted with AES-CBC and
+    /// authenticated with a separate HMAC are re-encrypted with AES-GCM when
+    /// a session starts, and all blocks are written with AES-GCM after that.
+    /// AES-GCM decrypts and authenticates a block in a single pass. A file
+    /// created by the session is upgraded when the next session starts. Only
+    /// supported where Core uses OpenSSL for encryption, so not on Apple
+    /// platforms nor on Windows, where it is ignored. Upgraded files cannot be
+    /// opened by those, nor by earlier versions of Core.
+    bool upgrade_encryption;
+
+    /// Hint given to the kernel for the memory mappings of the Realm file. See
+    /// AccessPattern. Ignored for encrypted files, and where madvise() is not
+    /// available.
+    AccessPattern access_pattern;
+
+    /// If true, the kernel is asked to read the Realm file into the page cache
+    /// in the background when it is mapped by this DB, so that the first
+    /// transactions do not fault in the pages one at a time. Ignored for
+    /// encrypted files, and where madvise() is not available.
+    bool prefetch_on_open;
+
+    /// If true, transparent huge pages are requested for the read-only
+    /// mappings of the Realm file, which are up to 64 MiB each. This reduces
+    /// TLB misses when large files are scanned. The kernel only backs file
+    /// mappings with huge pages if it supports it for the file system in use.
+    /// Ignored for encrypted files, and where madvise() is not available.
+    bool huge_pages;
+
+    /// If true, the pages holding the structure of the latest version (group
+    /// and table tops, cluster trees and search indexes) are recorded when the
+    /// DB is closed, and read into the page cache by a background thread when
+    /// the file is next opened with this option. Up to 64 MiB of pages are
+    /// recorded, in <path>.warm. This avoids faulting in these pages one at a
+    /// time during the first queries after the process starts. Ignored for
+    /// encrypted files and with Durability::MemOnly.
+    bool warm_start;
+
+    /// The memory holding the arrays written by a write transaction is kept
+    /// for the next one, up to this many bytes. Keeping more saves the cost of
+    /// allocating memory and faulting in fresh pages at every commit when
+    /// write transactions are frequent and large, at the cost of holding on
+    /// to the memory between them.
+    size_t slab_retention;
+
+    /// If true, the integer, timestamp and link leaves written by commits are
+    /// stored as offsets from their smallest value, in as few bits as the
+    /// difference between their smallest and largest value needs, when that
+    /// makes them smaller. Columns of large values that lie close together,
+    /// such as timestamps or ids, take much less space in the file. Packed
+    /// leaves are searched without unpacking them, and unpacked when they
+    /// are modified. The first commit writing a packed leaf moves the file
+    /// to file format 21, which versions of Realm that do not know the
+    /// packed format refuse to open.
+    bool pack_integers;
+
+    /// If true, the leaves of short strings written by commits store each
+    /// distinct value once, in as many bytes as it needs, instead of in slots
+    /// as wide as the longest value, when that makes them smaller. Equality
+    /// searches on such leaves look for the value once and then compare
+    /// 16-bit offsets. Compact leaves are expanded when they are modified.
+    /// Files written with this option cannot be opened by versions of Realm
+    /// that do not know the compact format.
+    bool compact_strings;
+
     /// sys_tmp_dir will be used if the temp_dir is empty when creating DBOptions.
     /// It must be writable and allowed to create pipe/fifo file on it.
     /// set_sys_tmp_dir is not a thread-safe call and it is only supposed to be called once
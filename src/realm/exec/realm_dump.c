@@ -80,7 +80,8 @@ size_t dump_header(FILE* fp, int64_t offset)
     unsigned char header[8];
     do_seek(fp, offset, SEEK_SET);
     size_t actual = fread(header, 1, 8, fp);
-    if (strncmp(header, "AAAA", 4) != 0) {
+    /* A packed array has its number of bits in place of the last 'A' */
+    if (strncmp(header, "AAA", 3) != 0) {
         printf("Ref '0x%zx' does not point to an array\n", offset);
         dump(fp, offset, 64);
         return 0;
@@ -114,6 +115,13 @@ size_t dump_header(FILE* fp, int64_t offset)
         case 2:
             num_bytes = size;
             break;
+        case 3: {
+            assert(size < 0x1000000);
+            size_t num_bits = size * header[3];
+            num_bytes = 16 + ((num_bits + 63) >> 6) * 8;
+            type = "packed";
+            break;
+        }
     }
 
     if (is_inner && has_refs) {
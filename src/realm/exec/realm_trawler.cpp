@@ -135,10 +135,18 @@ public:
     {
         return unsigned(m_size);
     }
+    bool packed() const
+    {
+        return ((unsigned(m_header[4]) & 0x18) >> 3) == 3;
+    }
+    unsigned packed_bits() const
+    {
+        return unsigned(static_cast<unsigned char>(m_header[3]));
+    }
     unsigned length() const
     {
         unsigned width_type = (unsigned(m_header[4]) & 0x18) >> 3;
-        return calc_byte_size(width_type, m_size, width());
+        return calc_byte_size(width_type, m_size, packed() ? packed_bits() : width());
     }
     uint64_t ref() const
     {
@@ -171,6 +179,9 @@ protected:
             case 2:
                 num_bytes = size;
                 break;
+            case 3:
+                num_bytes = 16 + ((size * width + 63) >> 6) * 8;
+                break;
         }
 
         // Ensure 8-byte alignment
@@ -194,6 +205,8 @@ public:
     }
     int64_t get_val(size_t ndx) const
     {
+        if (packed())
+            return realm::get_packed_direct(m_data, packed_bits(), ndx);
         int64_t val = realm::get_direct(m_data, width(), ndx);
 
         if (m_has_refs) {
@@ -513,7 +526,9 @@ void Node::init(realm::Allocator& alloc, uint64_t ref)
     m_ref = ref;
     m_header = alloc.translate(ref);
 
-    if (memcmp(m_header, &signature, 4)) {
+    // A packed array has its number of bits in place of the last 'A'
+    bool packed = ((unsigned(m_header[4]) & 0x18) >> 3) == 3;
+    if (memcmp(m_header, &signature, packed ? 3 : 4)) {
     }
     else {
         unsigned char* u = reinterpret_cast<unsigned char*>(m_header);
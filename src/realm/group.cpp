@@ -301,6 +301,13 @@ int Group::get_committed_file_format_version() const noexcept
 }
 
 
+void Group::require_extended_file_format() noexcept
+{
+    if (m_file_format_version < extended_file_format_version)
+        m_file_format_version = extended_file_format_version;
+}
+
+
 int Group::get_target_file_format_version_for_session(int current_file_format_version,
                                                       int requested_history_type) noexcept
 {
@@ -321,6 +328,11 @@ int Group::get_target_file_format_version_for_session(int current_file_format_ve
         return 11;
     }
 
+    // Files are only moved to the extended format by the commits that need
+    // it, see require_extended_file_format(), and never moved back
+    if (current_file_format_version == extended_file_format_version)
+        return extended_file_format_version;
+
     return 20;
 }
 
@@ -547,6 +559,7 @@ void Group::open(ref_type top_ref, const std::string& file_path)
             break;
         case 11:
         case 20:
+        case 21:
             file_format_ok = true;
             break;
     }
@@ -633,6 +633,8 @@ private:
     std::function<void(const CascadeNotification&)> m_notify_handler;
     std::function<void()> m_schema_change_handler;
     std::shared_ptr<metrics::Metrics> m_metrics;
+    // Shared by the transactions of a DB, null for a group of its own
+    std::shared_ptr<ColumnStatisticsCache> m_column_statistics;
     size_t m_total_rows;
 
     class TableRecycler : public std::vector<Table*> {
@@ -748,6 +750,10 @@ private:
 
     std::shared_ptr<metrics::Metrics> get_metrics() const noexcept;
     void set_metrics(std::shared_ptr<metrics::Metrics> other) noexcept;
+    ColumnStatisticsCache* get_column_statistics_cache() const noexcept
+    {
+        return m_column_statistics.get();
+    }
     void update_num_objects();
     class TransactAdvancer;
     /// Memory mappings must have been updated to reflect any growth in filesize before
@@ -825,6 +831,14 @@ private:
     ///
     ///  20 New data types: Decimal128 and ObjectId. Embedded tables.
     ///
+    ///  21 Same as 20, but the file may hold structures that older versions
+    ///     would misread, or leave stale when writing to the file: ordered
+    ///     indexes, full-text indexes and packed integer leaves (see
+    ///     DBOptions::pack_integers). A file is moved to this version by the
+    ///     first commit that adds one of them (see
+    ///     require_extended_file_format()) and is never moved back. Files of
+    ///     version 20 are not upgraded when they are opened.
+    ///
     /// IMPORTANT: When introducing a new file format version, be sure to review
     /// the file validity checks in Group::open() and DB::do_open, the file
     /// format selection logic in
@@ -835,6 +849,13 @@ private:
     void set_file_format_version(int) noexcept;
     int get_committed_file_format_version() const noexcept;
 
+    static constexpr int extended_file_format_version = 21;
+
+    /// Have the next commit move the file to file format 21, as something
+    /// was added that older versions cannot handle. See
+    /// get_file_format_version().
+    void require_extended_file_format() noexcept;
+
     /// The specified history type must be a value of Replication::HistoryType.
     static int get_target_file_format_version_for_session(int current_file_format_version, int history_type) noexcept;
 
@@ -28,6 +28,7 @@
 #include <realm/db.hpp>
 #include <realm/alloc_slab.hpp>
 #include <realm/disable_sync_to_disk.hpp>
+#include <realm/write_ahead_log.hpp>
 #include <realm/metrics/metric_timer.hpp>
 #include <realm/impl/destroy_guard.hpp>
 
@@ -333,8 +334,10 @@ ref_type GroupWriter::write_group()
     // commit), as that would lead to clobbering of the previous database
     // version.
     bool deep = true, only_if_modified = true;
+    if (m_relocation_limit != realm::npos && m_group.m_table_names.get_ref() >= m_relocation_limit)
+        m_group.m_table_names.copy_on_write(); // Throws
     ref_type names_ref = m_group.m_table_names.write(*this, deep, only_if_modified); // Throws
-    ref_type tables_ref = m_group.m_tables.write(*this, deep, only_if_modified);     // Throws
+    ref_type tables_ref = write_tables();                                            // Throws
 
     int_fast64_t value_1 = from_ref(names_ref);
     int_fast64_t value_2 = from_ref(tables_ref);
@@ -416,8 +419,8 @@ ref_type GroupWriter::write_group()
     // using the maximum size possible, we still do not end up with a zero size
     // free-space chunk as we deduct the actually used size from it.
     auto reserve = reserve_free_space(max_free_space_needed + 8); // Throws
-    size_t reserve_pos = reserve->second;
-    size_t reserve_size = reserve->first;
+    size_t reserve_pos = m_size_map.get(reserve).ref;
+    size_t reserve_size = m_size_map.get(reserve).size;
 
     // At this point we have allocated all the space we need, so we can add to
     // the free-lists any free space created during the current transaction (or
@@ -566,24 +569,185 @@ void GroupWriter::read_in_freelist()
     }
 
     free_in_file.merge_adjacent_entries_in_freelist();
-    // Previous step produces - potentially - some entries with size of zero. These
+
+    if (m_relocation_table != realm::npos) {
+        // Once enough of the file is free, arrays beyond a limit are moved
+        // into the free space before it. The limit is chosen such that they
+        // fit, and the free space beyond it is not allocated from.
+        size_t logical_file_size = to_size_t(m_group.m_top.get(2) / 2);
+        size_t free_space_size = 0;
+        for (const auto& elem : free_in_file)
+            free_space_size += elem.size;
+        if (free_space_size >= min_free_space_to_relocate && free_space_size >= logical_file_size / 4) {
+            m_relocation_limit = (logical_file_size - free_space_size / 2) & ~size_t(7);
+            for (auto& elem : free_in_file) {
+                if (elem.size == 0 || elem.ref + elem.size <= m_relocation_limit)
+                    continue;
+                size_t start = std::max(elem.ref, m_relocation_limit);
+                m_free_beyond_limit.emplace_back(start, elem.ref + elem.size - start, 0);
+                elem.size = start - elem.ref;
+            }
+        }
+    }
+
+    // Previous steps produce - potentially - some entries with size of zero. These
     // entries will be skipped in the next step.
     free_in_file.move_free_in_file_to_size_map(m_size_map);
 }
 
+// Write the table array like Array::write() does, but with the table picked
+// for relocation searched for arrays to move.
+ref_type GroupWriter::write_tables()
+{
+    Array& tables = m_group.m_tables;
+    bool deep = true, only_if_modified = true;
+    if (m_relocation_limit == realm::npos)
+        return tables.write(*this, deep, only_if_modified); // Throws
+
+    // The table array is small, so it is always written anew
+    tables.copy_on_write(); // Throws
+    Array new_tables(Allocator::get_default());
+    new_tables.create(Array::type_HasRefs, tables.get_context_flag()); // Throws
+    _impl::ShallowArrayDestroyGuard dg(&new_tables);
+    size_t n = tables.size();
+    if (m_relocation_table >= n) {
+        m_relocation_table = 0; // Start over
+        m_resume_path.clear();
+    }
+    for (size_t i = 0; i < n; ++i) {
+        int_fast64_t value = tables.get(i);
+        if (value != 0 && (value & 1) == 0) {
+            m_relocating = (i == m_relocation_table);
+            ref_type new_ref = Array::write(to_ref(value), m_alloc, *this, only_if_modified); // Throws
+            m_relocating = false;
+            value = from_ref(new_ref);
+        }
+        new_tables.add(value); // Throws
+    }
+    return new_tables.do_write_shallow(*this); // Throws
+}
+
+// The file format is written by commit()
+void GroupWriter::require_extended_file_format()
+{
+    m_group.require_extended_file_format();
+}
+
+// Called by Array::write() for the root of each unmodified subtree. Subtrees
+// before the one where the search of an earlier commit was cut short are
+// skipped. The order of the subtrees only changes when the table is modified,
+// and then an array that is skipped in error is found by a later search.
+ref_type GroupWriter::write_unmodified(ref_type ref, Allocator& alloc)
+{
+    if (!m_relocating)
+        return ref;
+    size_t ndx = m_unmodified_subtrees++;
+    bool on_resume_path = !m_resume_path.empty();
+    if (on_resume_path && ndx < m_resume_path[0])
+        return ref;
+    m_path.assign(1, ndx);
+    return relocate_unmodified(ref, alloc, on_resume_path && ndx == m_resume_path[0]); // Throws
+}
+
+// Search an unmodified array, and the arrays below it, for arrays beyond the
+// relocation limit. An array is written anew if it is beyond the limit, or if
+// any array below it was.
+ref_type GroupWriter::relocate_unmodified(ref_type ref, Allocator& alloc, bool on_resume_path)
+{
+    if (m_relocation_cut_short)
+        return ref;
+    if (m_relocated_size >= max_relocated_per_commit || m_searched >= max_searched_per_commit) {
+        m_relocation_cut_short = true;
+        m_stop_path = m_path;
+        return ref;
+    }
+    ++m_searched;
+
+    // Children before the one on the resume path were searched before
+    size_t depth = m_path.size();
+    size_t resume_ndx = (on_resume_path && depth < m_resume_path.size()) ? m_resume_path[depth] : 0;
+    on_resume_path = on_resume_path && depth < m_resume_path.size();
+
+    Array array(alloc);
+    array.init_from_ref(ref);
+    bool move = ref >= m_relocation_limit;
+    ref_type new_ref = ref;
+    if (array.has_refs()) {
+        // Temp array for updated refs, only created if needed
+        Array new_array(Allocator::get_default());
+        _impl::ShallowArrayDestroyGuard dg(&new_array);
+        auto ensure_new_array = [&](size_t copied) {
+            if (new_array.is_attached())
+                return;
+            Array::Type type = array.is_inner_bptree_node() ? Array::type_InnerBptreeNode : Array::type_HasRefs;
+            new_array.create(type, array.get_context_flag()); // Throws
+            for (size_t i = 0; i < copied; ++i)
+                new_array.add(array.get(i)); // Throws
+        };
+        if (move)
+            ensure_new_array(0); // Throws
+        size_t n = array.size();
+        for (size_t i = 0; i < n; ++i) {
+            int_fast64_t value = array.get(i);
+            bool is_ref = (value != 0 && (value & 1) == 0);
+            if (is_ref && i >= resume_ndx) {
+                ref_type subref = to_ref(value);
+                m_path.push_back(i);
+                ref_type new_subref = relocate_unmodified(subref, alloc, on_resume_path && i == resume_ndx); // Throws
+                m_path.pop_back();
+                if (new_subref != subref) {
+                    ensure_new_array(i); // Throws
+                    value = from_ref(new_subref);
+                }
+            }
+            if (new_array.is_attached())
+                new_array.add(value); // Throws
+        }
+        if (new_array.is_attached())
+            new_ref = new_array.do_write_shallow(*this); // Throws
+    }
+    else if (move) {
+        new_ref = array.do_write_shallow(*this); // Throws
+    }
+
+    if (new_ref != ref) {
+        m_relocated_size += array.get_byte_size();
+        alloc.free_(ref, array.get_header());
+    }
+    return new_ref;
+}
+
+size_t GroupWriter::get_next_relocation_table() const noexcept
+{
+    if (m_relocation_limit == realm::npos || m_relocation_cut_short)
+        return m_relocation_table;
+    return m_relocation_table + 1;
+}
+
+std::vector<size_t> GroupWriter::get_next_relocation_path() const
+{
+    if (m_relocation_limit == realm::npos)
+        return m_resume_path;
+    if (m_relocation_cut_short)
+        return m_stop_path;
+    return {};
+}
+
 size_t GroupWriter::recreate_freelist(size_t reserve_pos)
 {
     std::vector<FreeSpaceEntry> free_in_file;
     auto& new_free_space = m_group.m_alloc.get_free_read_only(); // Throws
-    auto nb_elements = m_size_map.size() + m_not_free_in_file.size() + new_free_space.size();
+    auto nb_elements =
+        m_size_map.size() + m_free_beyond_limit.size() + m_not_free_in_file.size() + new_free_space.size();
     free_in_file.reserve(nb_elements);
 
     size_t reserve_ndx = realm::npos;
     bool is_shared = m_group.m_is_shared;
 
-    for (const auto& entry : m_size_map) {
-        free_in_file.emplace_back(entry.second, entry.first, 0);
-    }
+    m_size_map.for_each([&](const FreeSpaceBins::Chunk& chunk) {
+        free_in_file.emplace_back(chunk.ref, chunk.size, 0);
+    });
+    free_in_file.insert(free_in_file.end(), m_free_beyond_limit.begin(), m_free_beyond_limit.end());
 
     {
         size_t locked_space_size = 0;
@@ -599,21 +763,56 @@ size_t GroupWriter::recreate_freelist(size_t reserve_pos)
         }
         m_locked_space_size = locked_space_size;
     }
-
     REALM_ASSERT(free_in_file.size() == nb_elements);
+
     std::sort(begin(free_in_file), end(free_in_file), [](auto& a, auto& b) {
         return a.ref < b.ref;
     });
 
+    if (m_relocation_table != realm::npos) {
+        // Free space at the end of the file that no snapshot refers to any
+        // more is cut off the logical file size, in whole pages
+        Array& top = m_group.m_top;
+        size_t logical_file_size = to_size_t(top.get(2) / 2);
+        size_t end = logical_file_size;
+        auto first_cut = free_in_file.end();
+        while (first_cut != free_in_file.begin()) {
+            const auto& prev = *(first_cut - 1);
+            if (prev.ref + prev.size != end || prev.released_at_version >= m_readlock_version ||
+                prev.ref == reserve_pos)
+                break;
+            end = prev.ref;
+            --first_cut;
+        }
+        size_t new_file_size = round_up_to_page_size(end);
+        if (new_file_size < logical_file_size) {
+            free_in_file.erase(first_cut, free_in_file.end());
+            if (end < new_file_size)
+                free_in_file.emplace_back(end, new_file_size - end, 0);
+            top.set(2, 1 + 2 * uint64_t(new_file_size)); // Throws
+        }
+    }
+
     {
         // Copy into arrays while checking consistency
         size_t prev_ref = 0;
         size_t prev_size = 0;
+        uint64_t prev_version = 0;
         size_t free_space_size = 0;
         auto limit = free_in_file.size();
         for (size_t i = 0; i < limit; ++i) {
             const auto& free_space = free_in_file[i];
             auto ref = free_space.ref;
+            // Adjacent chunks released at the same version become free
+            // together, so they need just one entry. The reserved chunk is
+            // kept apart, as it is adjusted once its use is known.
+            if (i > 0 && prev_ref + prev_size == ref && prev_version == free_space.released_at_version &&
+                ref != reserve_pos && prev_ref != reserve_pos) {
+                prev_size += free_space.size;
+                m_free_lengths.set(m_free_lengths.size() - 1, prev_size); // Throws
+                free_space_size += free_space.size;
+                continue;
+            }
             if (REALM_UNLIKELY(prev_ref + prev_size > ref)) {
                 // Check if we are freeing arrays already in 'm_not_free_in_file'
                 for (const auto& elem : new_free_space) {
@@ -632,20 +831,20 @@ size_t GroupWriter::recreate_freelist(size_t reserve_pos)
                 REALM_ASSERT_RELEASE_EX(prev_ref + prev_size <= ref, prev_ref, prev_size, ref, i, limit,
                                         m_alloc.get_file_path_for_assertions());
             }
-            if (reserve_pos == ref) {
-                reserve_ndx = i;
-            }
-            else {
+            if (reserve_pos != ref) {
                 // The reserved chunk should not be counted in now. We don't know how much of it
                 // will eventually be used.
                 free_space_size += free_space.size;
             }
+            if (reserve_pos == ref)
+                reserve_ndx = m_free_positions.size();
             m_free_positions.add(free_space.ref);
             m_free_lengths.add(free_space.size);
             if (is_shared)
                 m_free_versions.add(free_space.released_at_version);
             prev_ref = free_space.ref;
             prev_size = free_space.size;
+            prev_version = free_space.released_at_version;
         }
         REALM_ASSERT_RELEASE(reserve_ndx != realm::npos);
 
@@ -673,18 +872,95 @@ void GroupWriter::FreeList::merge_adjacent_entries_in_freelist()
     }
 }
 
-void GroupWriter::FreeList::move_free_in_file_to_size_map(std::multimap<size_t, size_t>& size_map)
+void GroupWriter::FreeList::move_free_in_file_to_size_map(FreeSpaceBins& size_map)
 {
     for (auto& elem : *this) {
         // Skip elements merged in 'merge_adjacent_entries_in_freelist'
         if (elem.size) {
             REALM_ASSERT_RELEASE_EX(!(elem.size & 7), elem.size);
             REALM_ASSERT_RELEASE_EX(!(elem.ref & 7), elem.ref);
-            size_map.emplace(elem.size, elem.ref);
+            size_map.add(elem.size, elem.ref);
         }
     }
 }
 
+GroupWriter::FreeSpaceBins::FreeSpaceBins()
+    : m_bins(num_bins)
+{
+    std::fill(std::begin(m_non_empty), std::end(m_non_empty), 0);
+}
+
+size_t GroupWriter::FreeSpaceBins::bin_of(size_t size) noexcept
+{
+    REALM_ASSERT_DEBUG(size >= 8);
+    if (size <= num_exact_bins * 8)
+        return size / 8 - 1;
+    // Four bins for each power of two, selected by the two bits below the
+    // highest one
+    size_t msb = size_t(log2(size));
+    size_t sub = (size >> (msb - 2)) & 3;
+    return num_exact_bins + (msb - 10) * 4 + sub;
+}
+
+size_t GroupWriter::FreeSpaceBins::min_size_of_bin(size_t bin) noexcept
+{
+    if (bin < num_exact_bins)
+        return (bin + 1) * 8;
+    size_t msb = 10 + (bin - num_exact_bins) / 4;
+    size_t sub = (bin - num_exact_bins) % 4;
+    return (size_t(1) << msb) + sub * (size_t(1) << (msb - 2));
+}
+
+size_t GroupWriter::FreeSpaceBins::first_bin_of_at_least(size_t size) noexcept
+{
+    size_t bin = bin_of(size);
+    if (min_size_of_bin(bin) < size)
+        ++bin;
+    return bin;
+}
+
+auto GroupWriter::FreeSpaceBins::add(size_t size, size_t ref) -> Position
+{
+    size_t bin = bin_of(size);
+    m_bins[bin].push_back({size, ref}); // Throws
+    m_non_empty[bin / bits_per_word] |= size_t(1) << (bin % bits_per_word);
+    ++m_size;
+    return {bin, m_bins[bin].size() - 1};
+}
+
+void GroupWriter::FreeSpaceBins::erase(Position pos) noexcept
+{
+    auto& chunks = m_bins[pos.bin];
+    chunks[pos.ndx] = chunks.back();
+    chunks.pop_back();
+    if (chunks.empty())
+        m_non_empty[pos.bin / bits_per_word] &= ~(size_t(1) << (pos.bin % bits_per_word));
+    --m_size;
+}
+
+auto GroupWriter::FreeSpaceBins::first_from(size_t bin) const noexcept -> Position
+{
+    size_t word_ndx = bin / bits_per_word;
+    if (word_ndx >= sizeof m_non_empty / sizeof m_non_empty[0])
+        return end();
+    // Mask out the bins before `bin` in its word
+    size_t word = m_non_empty[word_ndx] & (~size_t(0) << (bin % bits_per_word));
+    for (;;) {
+        if (word)
+            return {word_ndx * bits_per_word + size_t(ctz(word)), 0};
+        if (++word_ndx == sizeof m_non_empty / sizeof m_non_empty[0])
+            return end();
+        word = m_non_empty[word_ndx];
+    }
+}
+
+auto GroupWriter::FreeSpaceBins::next(Position pos) const noexcept -> Position
+{
+    if (pos.ndx + 1 < m_bins[pos.bin].size())
+        return {pos.bin, pos.ndx + 1};
+    return first_from(pos.bin + 1);
+}
+
 size_t GroupWriter::get_free_space(size_t size)
 {
     REALM_ASSERT_3(size % 8, ==, 0); // 8-byte alignment
@@ -692,8 +968,8 @@ size_t GroupWriter::get_free_space(size_t size)
     auto p = reserve_free_space(size);
 
     // Claim space from identified chunk
-    size_t chunk_pos = p->second;
-    size_t chunk_size = p->first;
+    size_t chunk_pos = m_size_map.get(p).ref;
+    size_t chunk_size = m_size_map.get(p).size;
     REALM_ASSERT_3(chunk_size, >=, size);
     REALM_ASSERT_RELEASE_EX(!(chunk_pos & 7), chunk_pos);
     REALM_ASSERT_RELEASE_EX(!(chunk_size & 7), chunk_size);
@@ -705,7 +981,7 @@ size_t GroupWriter::get_free_space(size_t size)
         // of the chunk. The call to reserve_free_space may split chunks
         // in order to make sure that it returns a chunk from which allocation
         // can be done from the beginning
-        m_size_map.emplace(rest, chunk_pos + size);
+        m_size_map.add(rest, chunk_pos + size); // Throws
     }
     return chunk_pos;
 }
@@ -713,26 +989,26 @@ size_t GroupWriter::get_free_space(size_t size)
 
 inline GroupWriter::FreeListElement GroupWriter::split_freelist_chunk(FreeListElement it, size_t alloc_pos)
 {
-    size_t start_pos = it->second;
-    size_t chunk_size = it->first;
+    size_t start_pos = m_size_map.get(it).ref;
+    size_t chunk_size = m_size_map.get(it).size;
     m_size_map.erase(it);
     REALM_ASSERT_RELEASE_EX(alloc_pos > start_pos, alloc_pos, start_pos);
 
     REALM_ASSERT_RELEASE_EX(!(alloc_pos & 7), alloc_pos);
     size_t size_first = alloc_pos - start_pos;
     size_t size_second = chunk_size - size_first;
-    m_size_map.emplace(size_first, start_pos);
-    return m_size_map.emplace(size_second, alloc_pos);
+    m_size_map.add(size_first, start_pos); // Throws
+    return m_size_map.add(size_second, alloc_pos); // Throws
 }
 
 GroupWriter::FreeListElement GroupWriter::search_free_space_in_free_list_element(FreeListElement it, size_t size)
 {
     SlabAlloc& alloc = m_group.m_alloc;
-    size_t chunk_size = it->first;
+    size_t chunk_size = m_size_map.get(it).size;
 
     // search through the chunk, finding a place within it,
     // where an allocation will not cross a mmap boundary
-    size_t start_pos = it->second;
+    size_t start_pos = m_size_map.get(it).ref;
     size_t alloc_pos = alloc.find_section_in_range(start_pos, chunk_size, size);
     if (alloc_pos == 0) {
         return m_size_map.end();
@@ -749,21 +1025,30 @@ GroupWriter::FreeListElement GroupWriter::search_free_space_in_free_list_element
 
 GroupWriter::FreeListElement GroupWriter::search_free_space_in_part_of_freelist(size_t size)
 {
-    auto it = m_size_map.lower_bound(size);
-    while (it != m_size_map.end()) {
-        // Accept either a perfect match or a block that is twice the size. Tests have shown
-        // that this is a good strategy.
-        if (it->first == size || it->first >= 2 * size) {
+    // Accept either a perfect match or a block that is twice the size. Tests have shown
+    // that this is a good strategy.
+    // Perfect matches are only looked for in the bins of a single size, so
+    // that no bin is searched through.
+    size_t bin = FreeSpaceBins::bin_of(size);
+    if (FreeSpaceBins::is_exact_bin(bin)) {
+        for (size_t ndx = 0; ndx < m_size_map.bin_size(bin); ++ndx) {
+            FreeListElement it{bin, ndx};
+            if (m_size_map.get(it).size != size)
+                break;
             auto ret = search_free_space_in_free_list_element(it, size);
             if (ret != m_size_map.end()) {
                 return ret;
             }
-            ++it;
         }
-        else {
-            // If block was too small, search for the first that is at least twice as big.
-            it = m_size_map.lower_bound(2 * size);
+    }
+    // Chunks in the bins from here on are all at least twice as big
+    auto it = m_size_map.first_from(FreeSpaceBins::first_bin_of_at_least(2 * size));
+    while (it != m_size_map.end()) {
+        auto ret = search_free_space_in_free_list_element(it, size);
+        if (ret != m_size_map.end()) {
+            return ret;
         }
+        it = m_size_map.next(it);
     }
     // No match
     return m_size_map.end();
@@ -849,7 +1134,7 @@ GroupWriter::FreeListElement GroupWriter::extend_free_space(size_t requested_siz
     size_t chunk_size = new_file_size - logical_file_size;
     REALM_ASSERT_RELEASE_EX(!(chunk_size & 7), chunk_size);
     REALM_ASSERT_RELEASE(chunk_size != 0);
-    auto it = m_size_map.emplace(chunk_size, logical_file_size);
+    auto it = m_size_map.add(chunk_size, logical_file_size); // Throws
 
     // Update the logical file size
     m_group.m_top.set(2, 1 + 2 * uint64_t(new_file_size)); // Throws
@@ -878,6 +1163,8 @@ ref_type GroupWriter::write_array(const char* data, size_t size, uint32_t checks
     window->encryption_write_barrier(dest_addr, size);
     // return ref of the written array
     ref_type ref = to_ref(pos);
+    if (m_write_log)
+        log_write(ref, dest_addr, size); // Throws
     return ref;
 }
 
@@ -894,10 +1181,24 @@ void GroupWriter::write_array_at(MapWindow* window, ref_type ref, const char* da
     uint32_t dummy_checksum = 0x41414141UL; // "AAAA" in ASCII
     memcpy(dest_addr, &dummy_checksum, 4);
     memcpy(dest_addr + 4, data + 4, size - 4);
+    if (m_write_log)
+        log_write(ref, dest_addr, size); // Throws
+}
+
+
+void GroupWriter::log_write(ref_type ref, const char* data, size_t size)
+{
+    if (m_write_log->size() + size > m_write_log_max_size) {
+        // Too large to be worth logging, the commit must be flushed instead
+        m_write_log->clear();
+        m_write_log = nullptr;
+        return;
+    }
+    WriteAheadLog::add_write(*m_write_log, ref, data, size); // Throws
 }
 
 
-void GroupWriter::commit(ref_type new_top_ref)
+void GroupWriter::commit(ref_type new_top_ref, bool sync_whole_file)
 {
     MapWindow* window = get_window(0, sizeof(SlabAlloc::Header));
     SlabAlloc::Header& file_header = *reinterpret_cast<SlabAlloc::Header*>(window->translate(0));
@@ -934,8 +1235,11 @@ void GroupWriter::commit(ref_type new_top_ref)
     // stable storage before flipping the slot selector
     window->encryption_write_barrier(&file_header.m_top_ref[slot_selector],
                                      sizeof(file_header.m_top_ref[slot_selector]));
-    if (!disable_sync)
+    if (!disable_sync) {
         sync_all_mappings();
+        if (sync_whole_file)
+            m_alloc.get_file().sync();
+    }
 
     // Flip the slot selector bit.
     using type_2 = std::remove_reference<decltype(file_header.m_flags)>::type;
@@ -946,9 +1250,47 @@ void GroupWriter::commit(ref_type new_top_ref)
     window->encryption_write_barrier(&file_header.m_flags, sizeof(file_header.m_flags));
     if (!disable_sync)
         window->sync();
+
+#ifndef _WIN32
+    // The file header now refers to a snapshot that ends at the logical file
+    // size, and no other snapshot in use refers to anything beyond it. A file
+    // cannot be truncated while it is mapped on Windows.
+    if (m_relocation_table != realm::npos) {
+        size_t logical_file_size = to_size_t(m_group.m_top.get(2) / 2);
+        if (logical_file_size < get_file_size())
+            m_alloc.get_file().resize(logical_file_size); // Throws
+    }
+#endif
 }
 
 
+void GroupWriter::commit_written(util::File& file, ref_type new_top_ref, int file_format_version)
+{
+    File::Map<SlabAlloc::Header> map(file, File::access_ReadWrite, sizeof(SlabAlloc::Header));
+    SlabAlloc::Header& file_header = *map.get_addr();
+    REALM_ASSERT(!map.get_encrypted_mapping());
+
+    // Same slot logic as in commit()
+    unsigned old_flags = file_header.m_flags;
+    unsigned new_flags = old_flags ^ SlabAlloc::flags_SelectBit;
+    int slot_selector = ((new_flags & SlabAlloc::flags_SelectBit) != 0 ? 1 : 0);
+    using type_1 = std::remove_reference<decltype(file_header.m_file_format[0])>::type;
+    REALM_ASSERT(!util::int_cast_has_overflow<type_1>(file_format_version));
+    file_header.m_file_format[slot_selector] = type_1(file_format_version);
+    file_header.m_top_ref[slot_selector] = new_top_ref;
+
+    bool disable_sync = get_disable_sync_to_disk();
+    if (!disable_sync) {
+        map.sync();
+        file.sync();
+    }
+
+    using type_2 = std::remove_reference<decltype(file_header.m_flags)>::type;
+    file_header.m_flags = type_2(new_flags);
+    if (!disable_sync)
+        map.sync();
+}
+
 #ifdef REALM_DEBUG
 
 void GroupWriter::dump()
@@ -22,6 +22,7 @@
 #include <cstdint> // unint8_t etc
 #include <utility>
 #include <map>
+#include <vector>
 
 #include <realm/util/file.hpp>
 #include <realm/alloc.hpp>
@@ -66,12 +67,79 @@ public:
 
     /// Flush changes to physical medium, then write the new top ref
     /// to the file header, then flush again. Pass the top ref
-    /// returned by write_group().
-    void commit(ref_type new_top_ref);
+    /// returned by write_group(). If `sync_whole_file` is true, the whole
+    /// file is flushed, not just what this writer wrote, because earlier
+    /// commits were not flushed.
+    void commit(ref_type new_top_ref, bool sync_whole_file = false);
+
+    /// Flush the whole file to physical medium, then make the file header
+    /// refer to the snapshot at `new_top_ref`, then flush again. The arrays of
+    /// that snapshot must already have been written by write_group(), whose
+    /// commit() was skipped. Used to make several commits durable at once.
+    /// Not supported for encrypted files.
+    static void commit_written(util::File&, ref_type new_top_ref, int file_format_version);
 
     size_t get_file_size() const noexcept;
 
+    /// Record the arrays written by write_group() in `log`, in the format of
+    /// WriteAheadLog::add_write(). If they would take up more than `max_size`
+    /// bytes, recording stops and `log` is left empty.
+    void set_write_log(std::vector<char>* log, size_t max_size) noexcept
+    {
+        m_write_log = log;
+        m_write_log_max_size = max_size;
+    }
+
+    /// Vacate the end of the file while much of the file is free, so that
+    /// the file can be truncated (see DBOptions::incremental_compaction).
+    ///
+    /// Unmodified arrays near the end of the file are written anew into free
+    /// space further in. Only the table at index `table_ndx` in the group
+    /// (the first one if there is no such table) is searched for such arrays,
+    /// starting at `resume_path`, where the search of an earlier commit was
+    /// cut short. At most max_relocated_per_commit bytes are moved, and at
+    /// most max_searched_per_commit arrays are looked at. Free space at the
+    /// end of the file that no snapshot refers to any more is cut off the
+    /// logical file size, and off the file itself by commit().
+    void set_relocation_position(size_t table_ndx, std::vector<size_t> resume_path) noexcept
+    {
+        m_relocation_table = table_ndx;
+        m_resume_path = std::move(resume_path);
+    }
+
+    /// The table to search in the next commit: the same one if the search
+    /// was cut short, otherwise the next one. Call after write_group().
+    size_t get_next_relocation_table() const noexcept;
+
+    /// Where to start searching that table, empty for the start of the table.
+    /// Call after write_group().
+    std::vector<size_t> get_next_relocation_path() const;
+
+    /// Write integer leaves that were modified in the packed format when
+    /// that makes them smaller. See DBOptions::pack_integers.
+    void set_pack_integers(bool value) noexcept
+    {
+        m_pack_integers = value;
+    }
+
+    /// Write leaves of short strings that were modified in the compact
+    /// format when that makes them smaller. See DBOptions::compact_strings.
+    void set_compact_strings(bool value) noexcept
+    {
+        m_compact_strings = value;
+    }
+
     ref_type write_array(const char*, size_t, uint32_t) override;
+    ref_type write_unmodified(ref_type, Allocator&) override;
+    bool pack_integers() const override
+    {
+        return m_pack_integers;
+    }
+    bool compact_strings() const override
+    {
+        return m_compact_strings;
+    }
+    void require_extended_file_format() override;
 
 #ifdef REALM_DEBUG
     void dump();
@@ -100,6 +168,34 @@ private:
     size_t m_free_space_size = 0;
     size_t m_locked_space_size = 0;
     Durability m_durability;
+    std::vector<char>* m_write_log = nullptr;
+    size_t m_write_log_max_size = 0;
+
+    // Relocation starts when at least this much, and at least a quarter of
+    // the file, is free
+    static constexpr size_t min_free_space_to_relocate = 1024 * 1024;
+    static constexpr size_t max_relocated_per_commit = 1024 * 1024;
+    static constexpr size_t max_searched_per_commit = 1024;
+
+    size_t m_relocation_table = realm::npos;
+    // Arrays at or beyond this position are moved, if relocating
+    size_t m_relocation_limit = realm::npos;
+    // True while writing the table searched for arrays to move
+    bool m_relocating = false;
+    bool m_relocation_cut_short = false;
+    // A position in the table searched for arrays to move: the number of
+    // unmodified subtrees of the table before the one holding the position,
+    // followed by the index of the child taken at each level of the subtree.
+    // The search resumes at m_resume_path, and m_stop_path is where it was
+    // cut short. m_path is the position of the array being searched.
+    std::vector<size_t> m_resume_path;
+    std::vector<size_t> m_stop_path;
+    std::vector<size_t> m_path;
+    size_t m_unmodified_subtrees = 0;
+    size_t m_searched = 0;
+    bool m_pack_integers = false;
+    bool m_compact_strings = false;
+    size_t m_relocated_size = 0;
 
     struct FreeSpaceEntry {
         FreeSpaceEntry(size_t r, size_t s, uint64_t v)
@@ -112,20 +208,103 @@ private:
         size_t size;
         uint64_t released_at_version;
     };
+    // Free space available for allocation, binned by size class. Every chunk
+    // size up to 1KB has a bin of its own, and larger chunks share a bin with
+    // chunks less than 25% larger. A bitmap of the non-empty bins gives the
+    // first bin holding chunks of at least a given size in constant time.
+    class FreeSpaceBins {
+    public:
+        struct Chunk {
+            size_t size;
+            size_t ref;
+        };
+        // A chunk is found by its bin and index in the bin. A position is
+        // invalidated by any change to the bins.
+        struct Position {
+            size_t bin;
+            size_t ndx;
+            bool operator==(const Position& other) const noexcept
+            {
+                return bin == other.bin && ndx == other.ndx;
+            }
+            bool operator!=(const Position& other) const noexcept
+            {
+                return !(*this == other);
+            }
+        };
+
+        FreeSpaceBins();
+        size_t size() const noexcept
+        {
+            return m_size;
+        }
+        Position end() const noexcept
+        {
+            return {num_bins, 0};
+        }
+        const Chunk& get(Position pos) const noexcept
+        {
+            return m_bins[pos.bin][pos.ndx];
+        }
+        size_t bin_size(size_t bin) const noexcept
+        {
+            return m_bins[bin].size();
+        }
+        Position add(size_t size, size_t ref);
+        void erase(Position) noexcept;
+        // First chunk in the first non-empty bin from `bin` on
+        Position first_from(size_t bin) const noexcept;
+        // The chunk after `pos`, in bin order
+        Position next(Position pos) const noexcept;
+        template <class F>
+        void for_each(F f) const
+        {
+            for (auto& bin : m_bins) {
+                for (auto& chunk : bin)
+                    f(chunk);
+            }
+        }
+
+        // The bin of chunks of `size` bytes
+        static size_t bin_of(size_t size) noexcept;
+        // The first bin holding only chunks of at least `size` bytes
+        static size_t first_bin_of_at_least(size_t size) noexcept;
+        // True if all chunks in `bin` have the same size
+        static bool is_exact_bin(size_t bin) noexcept
+        {
+            return bin < num_exact_bins;
+        }
+
+    private:
+        static constexpr size_t num_exact_bins = 128;
+        static constexpr size_t bits_per_word = sizeof(size_t) * 8;
+        static constexpr size_t num_bins = num_exact_bins + (bits_per_word - 10) * 4;
+
+        std::vector<std::vector<Chunk>> m_bins;
+        size_t m_non_empty[(num_bins + bits_per_word - 1) / bits_per_word];
+        size_t m_size = 0;
+
+        static size_t min_size_of_bin(size_t bin) noexcept;
+    };
     class FreeList : public std::vector<FreeSpaceEntry> {
     public:
         FreeList() = default;
         // Merge adjacent chunks
         void merge_adjacent_entries_in_freelist();
-        // Copy free space entries to structure where entries are sorted by size
-        void move_free_in_file_to_size_map(std::multimap<size_t, size_t>& size_map);
+        // Copy free space entries to structure where entries are binned by size
+        void move_free_in_file_to_size_map(FreeSpaceBins& size_map);
     };
     //  m_free_in_file;
     std::vector<FreeSpaceEntry> m_not_free_in_file;
-    std::multimap<size_t, size_t> m_size_map;
-    using FreeListElement = std::multimap<size_t, size_t>::iterator;
+    // Free space beyond m_relocation_limit, which is not allocated from
+    std::vector<FreeSpaceEntry> m_free_beyond_limit;
+    FreeSpaceBins m_size_map;
+    using FreeListElement = FreeSpaceBins::Position;
 
     void read_in_freelist();
+    ref_type write_tables();
+    ref_type relocate_unmodified(ref_type, Allocator&, bool on_resume_path);
+    void log_write(ref_type ref, const char* data, size_t size);
     size_t recreate_freelist(size_t reserve_pos);
     // Currently cached memory mappings. We keep as many as 16 1MB windows
     // open for writing. The allocator will favor sequential allocation
@@ -36,6 +36,35 @@ public:
     /// Returns the ref (position in the target stream) of the written copy of
     /// the specified array data.
     virtual ref_type write_array(const char* data, size_t size, uint32_t checksum) = 0;
+
+    /// Called instead of writing an array that has not been modified, and
+    /// therefore already is in the target stream at `ref`.
+    ///
+    /// Returns the ref of the array in the target stream, which is `ref`
+    /// unless the writer has moved the array, or some array below it, to
+    /// another position.
+    virtual ref_type write_unmodified(ref_type ref, Allocator&)
+    {
+        return ref;
+    }
+
+    /// If true, integer leaves are written in the packed format when that
+    /// makes them smaller. See Array::do_write_shallow().
+    virtual bool pack_integers() const
+    {
+        return false;
+    }
+
+    /// If true, leaves of short strings are written in the compact format
+    /// when that makes them smaller. See ArrayStringCompact.
+    virtual bool compact_strings() const
+    {
+        return false;
+    }
+
+    /// Called when an array is written in a format that older versions of
+    /// Core cannot read. See Group::require_extended_file_format().
+    virtual void require_extended_file_format() {}
 };
 
 } // namespace impl_
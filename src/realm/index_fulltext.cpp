@@ -0,0 +1,183 @@
+/*************************************************************************
+ *
+ * Copyright 2021 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <realm/index_fulltext.hpp>
+#include <realm/unicode.hpp>
+
+#include <algorithm>
+#include <iterator>
+
+using namespace realm;
+
+namespace {
+
+bool is_word_char(char c) noexcept
+{
+    unsigned char u = static_cast<unsigned char>(c);
+    return (u >= '0' && u <= '9') || (u >= 'a' && u <= 'z') || (u >= 'A' && u <= 'Z') || u >= 0x80;
+}
+
+bool starts_with(const std::string& word, const std::string& prefix) noexcept
+{
+    return word.size() >= prefix.size() && std::equal(prefix.begin(), prefix.end(), word.begin());
+}
+
+Mixed as_value(const std::string& word) noexcept
+{
+    return Mixed(BinaryData(word.data(), word.size()));
+}
+
+} // anonymous namespace
+
+FullTextIndex::FullTextIndex(Allocator& alloc, ArrayParent* refs_parent, size_t refs_ndx_in_parent, size_t col_ndx)
+    : m_entries(alloc, refs_parent, refs_ndx_in_parent, col_ndx)
+{
+}
+
+bool FullTextIndex::type_supported(ColKey col_key) noexcept
+{
+    return col_key.get_type() == col_type_String && !col_key.is_collection();
+}
+
+std::vector<std::string> FullTextIndex::tokenize(StringData text)
+{
+    std::vector<std::string> words;
+    const char* p = text.data();
+    const char* end = p + text.size();
+    while (p != end) {
+        while (p != end && !is_word_char(*p))
+            ++p;
+        const char* begin = p;
+        while (p != end && is_word_char(*p))
+            ++p;
+        if (p != begin)
+            words.push_back(case_fold_ascii(StringData(begin, p - begin)));
+    }
+    std::sort(words.begin(), words.end());
+    words.erase(std::unique(words.begin(), words.end()), words.end());
+    return words;
+}
+
+std::vector<FullTextIndex::Term> FullTextIndex::parse_search(StringData search)
+{
+    std::vector<Term> terms;
+    const char* p = search.data();
+    const char* end = p + search.size();
+    while (p != end) {
+        while (p != end && !is_word_char(*p))
+            ++p;
+        const char* begin = p;
+        while (p != end && is_word_char(*p))
+            ++p;
+        if (p != begin) {
+            bool prefix = (p != end && *p == '*');
+            terms.push_back({case_fold_ascii(StringData(begin, p - begin)), prefix});
+        }
+    }
+    return terms;
+}
+
+bool FullTextIndex::matches(StringData text, const std::vector<Term>& terms)
+{
+    if (terms.empty() || text.is_null())
+        return false;
+    auto words = tokenize(text);
+    for (auto& term : terms) {
+        auto it = std::lower_bound(words.begin(), words.end(), term.word);
+        if (it == words.end())
+            return false;
+        if (term.prefix ? !starts_with(*it, term.word) : *it != term.word)
+            return false;
+    }
+    return true;
+}
+
+void FullTextIndex::insert(ObjKey key, StringData value)
+{
+    for (auto& word : tokenize(value))
+        m_entries.insert(key, as_value(word)); // Throws
+}
+
+void FullTextIndex::erase(ObjKey key, StringData value)
+{
+    for (auto& word : tokenize(value))
+        m_entries.erase(key, as_value(word));
+}
+
+void FullTextIndex::set(ObjKey key, StringData old_value, StringData new_value)
+{
+    // Only the words that differ between the two values are touched
+    auto old_words = tokenize(old_value);
+    auto new_words = tokenize(new_value);
+    std::vector<std::string> removed;
+    std::vector<std::string> added;
+    std::set_difference(old_words.begin(), old_words.end(), new_words.begin(), new_words.end(),
+                        std::back_inserter(removed));
+    std::set_difference(new_words.begin(), new_words.end(), old_words.begin(), old_words.end(),
+                        std::back_inserter(added));
+    for (auto& word : removed)
+        m_entries.erase(key, as_value(word));
+    for (auto& word : added)
+        m_entries.insert(key, as_value(word)); // Throws
+}
+
+void FullTextIndex::clear()
+{
+    m_entries.clear();
+}
+
+void FullTextIndex::find_term(const Term& term, std::vector<ObjKey>& result) const
+{
+    size_t sz = m_entries.size();
+    size_t begin = m_entries.lower_bound(as_value(term.word));
+    size_t end = begin;
+    if (term.prefix) {
+        // All words starting with the prefix follow each other
+        while (end < sz) {
+            BinaryData word = m_entries.get_value(end).get_binary();
+            if (word.size() < term.word.size() || !std::equal(term.word.begin(), term.word.end(), word.data()))
+                break;
+            ++end;
+        }
+    }
+    else {
+        end = m_entries.upper_bound(as_value(term.word));
+    }
+    // A prefix can match several words of the same object
+    m_entries.find_keys(begin, end, result);
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+}
+
+void FullTextIndex::find_all(const std::vector<Term>& terms, std::vector<ObjKey>& result) const
+{
+    result.clear();
+    if (terms.empty())
+        return;
+
+    find_term(terms[0], result);
+    std::vector<ObjKey> term_keys;
+    std::vector<ObjKey> intersection;
+    for (size_t i = 1; i < terms.size() && !result.empty(); ++i) {
+        term_keys.clear();
+        find_term(terms[i], term_keys);
+        intersection.clear();
+        std::set_intersection(result.begin(), result.end(), term_keys.begin(), term_keys.end(),
+                              std::back_inserter(intersection));
+        result.swap(intersection);
+    }
+}
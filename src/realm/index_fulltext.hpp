@@ -0,0 +1,93 @@
+/*************************************************************************
+ *
+ * Copyright 2021 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_INDEX_FULLTEXT_HPP
+#define REALM_INDEX_FULLTEXT_HPP
+
+#include <realm/index_ordered.hpp>
+#include <realm/string_data.hpp>
+
+#include <string>
+#include <vector>
+
+namespace realm {
+
+/// An inverted index over the words of a string column, used to answer
+/// `Query::text()` conditions without scanning the column.
+///
+/// Strings are split into words at every character that is not an ASCII
+/// letter or digit. Bytes outside ASCII are kept as part of the word, so
+/// words in other scripts stay whole. Words are case folded to lower case.
+///
+/// The index holds one (word, object key) entry for every distinct word of
+/// every object, ordered by word and key. It uses the layout of OrderedIndex,
+/// with words stored as binary values so that they are ordered bytewise
+/// whatever the string compare method is. All words with a common prefix
+/// therefore form one range.
+class FullTextIndex {
+public:
+    /// Attach to the index of the column with leaf index `col_ndx`. The array
+    /// of index refs must be found at `refs_ndx_in_parent` in `refs_parent`.
+    FullTextIndex(Allocator& alloc, ArrayParent* refs_parent, size_t refs_ndx_in_parent, size_t col_ndx);
+
+    /// Create an empty index and return its ref
+    static ref_type create(Allocator& alloc)
+    {
+        return OrderedIndex::create(alloc);
+    }
+
+    /// String columns holding a single value can be indexed
+    static bool type_supported(ColKey col_key) noexcept;
+
+    /// The distinct, case folded words of `text`, in bytewise order
+    static std::vector<std::string> tokenize(StringData text);
+
+    /// Parse a search text into search terms. A term ending in '*' matches
+    /// every word starting with it, other terms match a whole word.
+    struct Term {
+        std::string word;
+        bool prefix;
+    };
+    static std::vector<Term> parse_search(StringData search);
+
+    /// True if `text` contains all of `terms`
+    static bool matches(StringData text, const std::vector<Term>& terms);
+
+    /// Number of entries (words of all objects) in the index
+    size_t size() const noexcept
+    {
+        return m_entries.size();
+    }
+
+    void insert(ObjKey key, StringData value);
+    void erase(ObjKey key, StringData value);
+    void set(ObjKey key, StringData old_value, StringData new_value);
+    void clear();
+
+    /// Find the objects containing all of `terms`, ordered by key
+    void find_all(const std::vector<Term>& terms, std::vector<ObjKey>& result) const;
+
+private:
+    OrderedIndex m_entries;
+
+    void find_term(const Term& term, std::vector<ObjKey>& result) const;
+};
+
+} // namespace realm
+
+#endif // REALM_INDEX_FULLTEXT_HPP
@@ -0,0 +1,166 @@
+/*************************************************************************
+ *
+ * Copyright 2021 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <realm/index_ordered.hpp>
+#include <realm/impl/destroy_guard.hpp>
+
+#include <algorithm>
+
+using namespace realm;
+
+OrderedIndex::OrderedIndex(Allocator& alloc, ArrayParent* refs_parent, size_t refs_ndx_in_parent, size_t col_ndx)
+    : m_refs(alloc)
+    , m_top(alloc)
+    , m_values(alloc)
+    , m_keys(alloc)
+{
+    m_refs.set_parent(refs_parent, refs_ndx_in_parent);
+    m_refs.init_from_parent();
+    m_top.set_parent(&m_refs, col_ndx);
+    m_top.init_from_parent();
+    m_values.set_parent(&m_top, 0);
+    m_values.init_from_parent();
+    m_keys.set_parent(&m_top, 1);
+    m_keys.init_from_parent();
+}
+
+ref_type OrderedIndex::create(Allocator& alloc)
+{
+    Array top(alloc);
+    _impl::DeepArrayDestroyGuard dg(&top);
+    top.create(Array::type_HasRefs); // Throws
+    top.add(0);                      // Throws
+    top.add(0);                      // Throws
+
+    BPlusTree<Mixed> values(alloc);
+    values.set_parent(&top, 0);
+    values.create(); // Throws
+    BPlusTree<ObjKey> keys(alloc);
+    keys.set_parent(&top, 1);
+    keys.create(); // Throws
+
+    dg.release();
+    return top.get_ref();
+}
+
+bool OrderedIndex::type_supported(ColKey col_key) noexcept
+{
+    if (col_key.is_collection())
+        return false;
+    switch (col_key.get_type()) {
+        case col_type_Int:
+        case col_type_Timestamp:
+        case col_type_Decimal:
+            return true;
+        default:
+            return false;
+    }
+}
+
+size_t OrderedIndex::lower_bound(Mixed value) const
+{
+    size_t lo = 0;
+    size_t hi = size();
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (m_values.get(mid).compare(value) < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+size_t OrderedIndex::upper_bound(Mixed value) const
+{
+    size_t lo = 0;
+    size_t hi = size();
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (m_values.get(mid).compare(value) <= 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+// Position of the first entry not less than (value, key)
+size_t OrderedIndex::find_entry(ObjKey key, Mixed value) const
+{
+    size_t lo = 0;
+    size_t hi = size();
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        int c = m_values.get(mid).compare(value);
+        if (c < 0 || (c == 0 && m_keys.get(mid) < key))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+void OrderedIndex::insert(ObjKey key, Mixed value)
+{
+    size_t ndx = find_entry(key, value);
+    m_values.insert(ndx, value); // Throws
+    m_keys.insert(ndx, key);     // Throws
+}
+
+void OrderedIndex::erase(ObjKey key, Mixed value)
+{
+    size_t ndx = find_entry(key, value);
+    REALM_ASSERT(ndx < size() && m_keys.get(ndx) == key);
+    m_values.erase(ndx);
+    m_keys.erase(ndx);
+}
+
+void OrderedIndex::set(ObjKey key, Mixed old_value, Mixed new_value)
+{
+    if (old_value.compare(new_value) == 0)
+        return;
+    erase(key, old_value);
+    insert(key, new_value); // Throws
+}
+
+void OrderedIndex::clear()
+{
+    m_values.clear();
+    m_keys.clear();
+}
+
+void OrderedIndex::find_keys(size_t begin, size_t end, std::vector<ObjKey>& keys) const
+{
+    size_t first = keys.size();
+    keys.reserve(first + (end - begin));
+    for (size_t i = begin; i < end; ++i)
+        keys.push_back(m_keys.get(i));
+    std::sort(keys.begin() + first, keys.end());
+}
+
+void OrderedIndex::verify() const
+{
+#ifdef REALM_DEBUG
+    REALM_ASSERT(m_values.size() == m_keys.size());
+    for (size_t i = 1; i < size(); ++i) {
+        int c = m_values.get(i - 1).compare(m_values.get(i));
+        REALM_ASSERT(c < 0 || (c == 0 && m_keys.get(i - 1) < m_keys.get(i)));
+    }
+#endif
+}
@@ -0,0 +1,145 @@
+/*************************************************************************
+ *
+ * Copyright 2021 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_INDEX_ORDERED_HPP
+#define REALM_INDEX_ORDERED_HPP
+
+#include <realm/array.hpp>
+#include <realm/array_key.hpp>
+#include <realm/array_mixed.hpp>
+#include <realm/bplustree.hpp>
+#include <realm/keys.hpp>
+#include <realm/mixed.hpp>
+#include <realm/query_conditions.hpp>
+
+#include <type_traits>
+#include <vector>
+
+namespace realm {
+
+/// A secondary index that keeps the values of one column in sorted order.
+///
+/// Where StringIndex can only answer equality lookups, the ordered index can
+/// also answer range lookups (greater, less, between) and deliver the objects
+/// of a table ordered by the column, which is used for sorting.
+///
+/// The index is made of two B+-trees of equal size: one holding the column
+/// values and one holding the matching object keys. Entries are ordered by
+/// value and, for equal values, by object key. Null sorts before any other
+/// value, as it does in Mixed::compare().
+///
+/// All ordered indexes of a table are stored in one array of refs (one entry
+/// per column) held by the table. An accessor attaches to the index of one
+/// column and is cheap enough to be created when needed.
+class OrderedIndex {
+public:
+    /// Attach to the index of the column with leaf index `col_ndx`. The array
+    /// of index refs must be found at `refs_ndx_in_parent` in `refs_parent`.
+    OrderedIndex(Allocator& alloc, ArrayParent* refs_parent, size_t refs_ndx_in_parent, size_t col_ndx);
+
+    /// Create an empty index and return its ref
+    static ref_type create(Allocator& alloc);
+
+    /// Integer, Timestamp and Decimal128 columns holding a single value can be indexed
+    static bool type_supported(ColKey col_key) noexcept;
+
+    size_t size() const noexcept
+    {
+        return m_keys.size();
+    }
+    Mixed get_value(size_t ndx) const
+    {
+        return m_values.get(ndx);
+    }
+    ObjKey get_key(size_t ndx) const
+    {
+        return m_keys.get(ndx);
+    }
+
+    void insert(ObjKey key, Mixed value);
+    void erase(ObjKey key, Mixed value);
+    void set(ObjKey key, Mixed old_value, Mixed new_value);
+    void clear();
+
+    /// Position of the first entry not less than `value`, and of the first
+    /// entry greater than `value`.
+    size_t lower_bound(Mixed value) const;
+    size_t upper_bound(Mixed value) const;
+
+    /// Find the range [begin, end) of entries for which 'entry Condition value'
+    /// holds. Returns false if the condition cannot be answered by the index.
+    template <class Condition>
+    bool find_range(Mixed value, size_t& begin, size_t& end) const;
+
+    /// Append the keys of the entries in [begin, end), ordered by key
+    void find_keys(size_t begin, size_t end, std::vector<ObjKey>& keys) const;
+
+    void verify() const;
+
+private:
+    Array m_refs;
+    Array m_top;
+    BPlusTree<Mixed> m_values;
+    BPlusTree<ObjKey> m_keys;
+
+    size_t find_entry(ObjKey key, Mixed value) const;
+};
+
+template <class Condition>
+bool OrderedIndex::find_range(Mixed value, size_t& begin, size_t& end) const
+{
+    // Only equality can match null, and null never matches an ordering
+    // condition, so the nulls in front of the index are skipped for those.
+    size_t first_non_null = upper_bound(Mixed());
+    if (value.is_null()) {
+        if (!std::is_same<Condition, Equal>::value)
+            return false;
+        begin = 0;
+        end = first_non_null;
+        return true;
+    }
+
+    begin = first_non_null;
+    end = size();
+    if (std::is_same<Condition, Equal>::value) {
+        begin = lower_bound(value);
+        end = upper_bound(value);
+    }
+    else if (std::is_same<Condition, Greater>::value) {
+        begin = upper_bound(value);
+    }
+    else if (std::is_same<Condition, GreaterEqual>::value) {
+        begin = lower_bound(value);
+    }
+    else if (std::is_same<Condition, Less>::value) {
+        end = lower_bound(value);
+    }
+    else if (std::is_same<Condition, LessEqual>::value) {
+        end = upper_bound(value);
+    }
+    else {
+        return false;
+    }
+    if (end < begin)
+        end = begin;
+    return true;
+}
+
+} // namespace realm
+
+#endif // REALM_INDEX_ORDERED_HPP
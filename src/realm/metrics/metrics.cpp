@@ -69,11 +69,11 @@ void Metrics::start_write_transaction()
 }
 
 void Metrics::end_read_transaction(size_t total_size, size_t free_space, size_t num_objects, size_t num_versions,
-                                   size_t num_decrypted_pages)
+                                   const util::decrypted_memory_stats_t& decrypted_memory)
 {
     REALM_ASSERT_DEBUG(m_transaction_info);
     if (m_pending_read) {
-        m_pending_read->update_stats(total_size, free_space, num_objects, num_versions, num_decrypted_pages);
+        m_pending_read->update_stats(total_size, free_space, num_objects, num_versions, decrypted_memory);
         m_pending_read->finish_timer();
         add_transaction(*m_pending_read);
         m_pending_read.reset(nullptr);
@@ -81,11 +81,11 @@ void Metrics::end_read_transaction(size_t total_size, size_t free_space, size_t
 }
 
 void Metrics::end_write_transaction(size_t total_size, size_t free_space, size_t num_objects, size_t num_versions,
-                                    size_t num_decrypted_pages)
+                                    const util::decrypted_memory_stats_t& decrypted_memory)
 {
     REALM_ASSERT_DEBUG(m_transaction_info);
     if (m_pending_write) {
-        m_pending_write->update_stats(total_size, free_space, num_objects, num_versions, num_decrypted_pages);
+        m_pending_write->update_stats(total_size, free_space, num_objects, num_versions, decrypted_memory);
         m_pending_write->finish_timer();
         add_transaction(*m_pending_write);
         m_pending_write.reset(nullptr);
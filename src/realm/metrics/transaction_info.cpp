@@ -27,7 +27,7 @@ TransactionInfo::TransactionInfo(TransactionInfo::TransactionType type)
     , m_total_objects(0)
     , m_type(type)
     , m_num_versions(0)
-    , m_num_decrypted_pages(0)
+    , m_decrypted_memory{0, 0, 0, 0, 0, 0, 0}
 {
 #if REALM_METRICS
     if (m_type == write_transaction) {
@@ -89,17 +89,23 @@ size_t TransactionInfo::get_num_available_versions() const
 
 size_t TransactionInfo::get_num_decrypted_pages() const
 {
-    return m_num_decrypted_pages;
+    return m_decrypted_memory.memory_size / util::page_size();
+}
+
+const util::decrypted_memory_stats_t& TransactionInfo::get_decrypted_memory_stats() const
+{
+    return m_decrypted_memory;
 }
 
 void TransactionInfo::update_stats(size_t disk_size, size_t free_space, size_t total_objects,
-                                   size_t available_versions, size_t num_decrypted_pages)
+                                   size_t available_versions,
+                                   const util::decrypted_memory_stats_t& decrypted_memory)
 {
     m_realm_disk_size = disk_size;
     m_realm_free_space = free_space;
     m_total_objects = total_objects;
     m_num_versions = available_versions;
-    m_num_decrypted_pages = num_decrypted_pages;
+    m_decrypted_memory = decrypted_memory;
 }
 
 void TransactionInfo::finish_timer()
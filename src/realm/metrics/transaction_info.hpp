@@ -24,6 +24,7 @@
 
 #include <realm/metrics/metric_timer.hpp>
 #include <realm/util/features.h>
+#include <realm/util/file_mapper.hpp>
 
 namespace realm {
 namespace metrics {
@@ -47,6 +48,9 @@ public:
     size_t get_total_objects() const;
     size_t get_num_available_versions() const;
     size_t get_num_decrypted_pages() const;
+    // Decrypted pages of all encrypted files of the process, including the
+    // hits, misses and evictions since the process started
+    const util::decrypted_memory_stats_t& get_decrypted_memory_stats() const;
 
 private:
     MetricTimerResult m_transaction_time;
@@ -59,11 +63,11 @@ private:
     size_t m_total_objects;
     TransactionType m_type;
     size_t m_num_versions;
-    size_t m_num_decrypted_pages;
+    util::decrypted_memory_stats_t m_decrypted_memory;
 
     friend class Metrics;
     void update_stats(size_t disk_size, size_t free_space, size_t total_objects, size_t available_versions,
-                      size_t num_decrypted_pages);
+                      const util::decrypted_memory_stats_t& decrypted_memory);
     void finish_timer();
 };
 
@@ -52,6 +52,7 @@ public:
         wtype_Bits = 0,     // width indicates how many bits every element occupies
         wtype_Multiply = 1, // width indicates how many bytes every element occupies
         wtype_Ignore = 2,   // each element is 1 byte
+        wtype_Packed = 3,   // elements are offsets from the smallest one, see get_packed_bits_from_header()
     };
 
     static const int header_size = 8; // Number of bytes used by header
@@ -109,6 +110,29 @@ public:
         return uint_least8_t((1 << (int(h[4]) & 0x07)) >> 1);
     }
 
+    // The byte following the capacity is not used by the other width types. A
+    // packed array keeps the number of bits per element there, which is
+    // written to the file in place of the last byte of the checksum. Its width
+    // is the one it had before it was packed, and gets back when unpacked.
+    // Integers are packed in less than 64 bits. A larger number marks a
+    // compact leaf of short strings, see ArrayStringCompact.
+    static uint_least8_t get_packed_bits_from_header(const char* header) noexcept
+    {
+        typedef unsigned char uchar;
+        const uchar* h = reinterpret_cast<const uchar*>(header);
+        return uint_least8_t(h[3]);
+    }
+
+    // Arrays that are not packed use the same byte in memory to record that
+    // they may be packed when they are written to the file. See
+    // _impl::ArrayWriterBase::pack_integers() and compact_strings().
+    static bool get_packable_from_header(const char* header) noexcept
+    {
+        typedef unsigned char uchar;
+        const uchar* h = reinterpret_cast<const uchar*>(header);
+        return (int(h[3]) & 0x80) != 0;
+    }
+
     static size_t get_size_from_header(const char* header) noexcept
     {
         typedef unsigned char uchar;
@@ -159,6 +183,7 @@ public:
         // 0: bits      (width/8) * size
         // 1: multiply  width * size
         // 2: ignore    1 * size
+        // 3: packed    16 + 8 * ceil(bits * size / 64)
         typedef unsigned char uchar;
         uchar* h = reinterpret_cast<uchar*>(header);
         h[4] = uchar((int(h[4]) & ~0x18) | int(value) << 3);
@@ -179,6 +204,21 @@ public:
         h[4] = uchar((int(h[4]) & ~0x7) | w);
     }
 
+    static void set_packed_bits_in_header(int value, char* header) noexcept
+    {
+        REALM_ASSERT_3(value, <, 64);
+        typedef unsigned char uchar;
+        uchar* h = reinterpret_cast<uchar*>(header);
+        h[3] = uchar(value);
+    }
+
+    static void set_packable_in_header(bool value, char* header) noexcept
+    {
+        typedef unsigned char uchar;
+        uchar* h = reinterpret_cast<uchar*>(header);
+        h[3] = uchar((int(h[3]) & ~0x80) | int(value) << 7);
+    }
+
     static void set_size_in_header(size_t value, char* header) noexcept
     {
         REALM_ASSERT_3(value, <=, max_array_size);
@@ -203,8 +243,9 @@ public:
     static size_t get_byte_size_from_header(const char* header) noexcept
     {
         size_t size = get_size_from_header(header);
-        uint_least8_t width = get_width_from_header(header);
         WidthType wtype = get_wtype_from_header(header);
+        uint_least8_t width =
+            wtype == wtype_Packed ? get_packed_bits_from_header(header) : get_width_from_header(header);
         size_t num_bytes = calc_byte_size(wtype, size, width);
 
         return num_bytes;
@@ -229,6 +270,14 @@ public:
             case wtype_Ignore:
                 num_bytes = size;
                 break;
+            case wtype_Packed: {
+                // The smallest and largest element, then the offsets in whole
+                // 64-bit words. Here 'width' is the number of bits per offset.
+                REALM_ASSERT_3(size, <, 0x1000000);
+                size_t num_bits = size * width;
+                num_bytes = 16 + ((num_bits + 63) >> 6) * 8;
+                break;
+            }
         }
 
         // Ensure 8-byte alignment
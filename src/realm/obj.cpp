@@ -31,6 +31,8 @@
 #include "realm/array_backlink.hpp"
 #include "realm/array_typed_link.hpp"
 #include "realm/column_type_traits.hpp"
+#include "realm/index_fulltext.hpp"
+#include "realm/index_ordered.hpp"
 #include "realm/index_string.hpp"
 #include "realm/cluster_tree.hpp"
 #include "realm/spec.hpp"
@@ -325,8 +327,10 @@ int64_t Obj::_get<int64_t>(ColKey::Idx col_ndx) const
 
     ref_type ref = to_ref(Array::get(m_mem.get_addr(), col_ndx.val + 1));
     char* header = alloc.translate(ref);
-    int width = Array::get_width_from_header(header);
     char* data = Array::get_data_from_header(header);
+    if (REALM_UNLIKELY(Array::get_wtype_from_header(header) == Array::wtype_Packed))
+        return get_packed_direct(data, Array::get_packed_bits_from_header(header), m_row_ndx);
+    int width = Array::get_width_from_header(header);
     REALM_TEMPEX(return get_direct, width, (data, m_row_ndx));
 }
 
@@ -379,18 +383,24 @@ StringData Obj::_get<StringData>(ColKey::Idx col_ndx) const
     }
 
     ref_type ref = to_ref(Array::get(m_mem.get_addr(), col_ndx.val + 1));
+    const char* header = alloc.translate(ref);
+    // The values of a compressed leaf must outlive this call
+    if (ArrayCompressedBlobs::is_compressed(header))
+        return m_table->get_compressed_leaf(ref).get_string(m_row_ndx);
     auto spec_ndx = m_table->leaf_ndx2spec_ndx(col_ndx);
     auto& spec = get_spec();
-    if (spec.is_string_enum_type(spec_ndx)) {
-        ArrayString values(get_alloc());
-        values.set_spec(const_cast<Spec*>(&spec), spec_ndx);
-        values.init_from_ref(ref);
-
-        return values.get(m_row_ndx);
-    }
-    else {
-        return ArrayString::get(alloc.translate(ref), m_row_ndx, alloc);
+    // Leaves of enumerated columns written by older versions may hold the
+    // values, which is told by the header as in ArrayString::init_from_mem()
+    if (spec.is_string_enum_type(spec_ndx) && !Array::get_hasrefs_from_header(header) &&
+        Array::get_wtype_from_header(header) != Array::wtype_Multiply && !ArrayStringCompact::is_compact(header)) {
+        // The leaf holds the index of the value among the unique values of
+        // the column, which are kept in a single leaf
+        size_t index = size_t(Array::get(header, m_row_ndx));
+        ArrayParent* keys_parent;
+        ref_type keys_ref = const_cast<Spec&>(spec).get_enumkeys_ref(spec_ndx, keys_parent);
+        return ArrayString::get(alloc.translate(keys_ref), index, alloc);
     }
+    return ArrayString::get(header, m_row_ndx, alloc);
 }
 
 template <>
@@ -404,7 +414,11 @@ BinaryData Obj::_get<BinaryData>(ColKey::Idx col_ndx) const
     }
 
     ref_type ref = to_ref(Array::get(m_mem.get_addr(), col_ndx.val + 1));
-    return ArrayBinary::get(alloc.translate(ref), m_row_ndx, alloc);
+    const char* header = alloc.translate(ref);
+    // The values of a compressed leaf must outlive this call
+    if (ArrayCompressedBlobs::is_compressed(header))
+        return m_table->get_compressed_leaf(ref).get(m_row_ndx);
+    return ArrayBinary::get(header, m_row_ndx, alloc);
 }
 
 Mixed Obj::get_any(ColKey col_key) const
@@ -1320,6 +1334,9 @@ Obj& Obj::set<int64_t>(ColKey col_key, int64_t value, bool is_default)
     if (StringIndex* index = m_table->get_search_index(col_key)) {
         index->set<int64_t>(m_key, value);
     }
+    if (auto index = m_table->get_ordered_index(col_key)) {
+        index->set(m_key, get_any(col_key), value);
+    }
 
     Allocator& alloc = get_alloc();
     alloc.bump_content_version();
@@ -1380,6 +1397,9 @@ Obj& Obj::add_int(ColKey col_key, int64_t value)
             if (StringIndex* index = m_table->get_search_index(col_key)) {
                 index->set<int64_t>(m_key, new_val);
             }
+            if (auto index = m_table->get_ordered_index(col_key)) {
+                index->set(m_key, *old, new_val);
+            }
             values.set(m_row_ndx, new_val);
         }
         else {
@@ -1395,6 +1415,9 @@ Obj& Obj::add_int(ColKey col_key, int64_t value)
         if (StringIndex* index = m_table->get_search_index(col_key)) {
             index->set<int64_t>(m_key, new_val);
         }
+        if (auto index = m_table->get_ordered_index(col_key)) {
+            index->set(m_key, old, new_val);
+        }
         values.set(m_row_ndx, new_val);
     }
 
@@ -1602,6 +1625,14 @@ Obj& Obj::set(ColKey col_key, T value, bool is_default)
     if (StringIndex* index = m_table->get_search_index(col_key)) {
         index->set<T>(m_key, value);
     }
+    if (auto index = m_table->get_ordered_index(col_key)) {
+        index->set(m_key, get_any(col_key), value);
+    }
+    if constexpr (std::is_same_v<T, StringData>) {
+        if (auto index = m_table->get_fulltext_index(col_key)) {
+            index->set(m_key, get<StringData>(col_key), value);
+        }
+    }
 
     Allocator& alloc = get_alloc();
     alloc.bump_content_version();
@@ -2093,6 +2124,12 @@ Obj& Obj::set_null(ColKey col_key, bool is_default)
         if (StringIndex* index = m_table->get_search_index(col_key)) {
             index->set(m_key, null{});
         }
+        if (auto index = m_table->get_ordered_index(col_key)) {
+            index->set(m_key, get_any(col_key), Mixed());
+        }
+        if (auto index = m_table->get_fulltext_index(col_key)) {
+            index->set(m_key, get<StringData>(col_key), StringData());
+        }
 
         switch (col_type) {
             case col_type_Int:
@@ -274,6 +274,7 @@ public:
 
 private:
     friend class ArrayBacklink;
+    friend class BaseDescriptor;
     friend class CascadeState;
     friend class Cluster;
     friend class ColumnListBase;
@@ -197,6 +197,7 @@ struct contains : string_token_t("contains") {};
 struct begins : string_token_t("beginswith") {};
 struct ends : string_token_t("endswith") {};
 struct like : string_token_t("like") {};
+struct text : string_token_t("text") {};
 struct between : string_token_t("between") {};
 
 struct sort_prefix : seq< string_token_t("sort"), star< blank >, one< '(' > > {};
@@ -218,7 +219,7 @@ struct include : seq<string_token_t("include"), star<blank>, one<'('>,
 struct predicate_suffix_modifier : sor<sort, distinct, limit, include> {
 };
 
-struct string_oper : seq< sor< contains, begins, ends, like>, star< blank >, opt< case_insensitive > > {};
+struct string_oper : seq< sor< contains, begins, ends, like, text>, star< blank >, opt< case_insensitive > > {};
 // "=" is equality and since other operators can start with "=" we must check equal last
 struct symbolic_oper : sor< noteq, lteq, lt, gteq, gt, eq, in, between > {};
 
@@ -731,6 +732,7 @@ OPERATOR_ACTION(begins, Predicate::Operator::BeginsWith)
 OPERATOR_ACTION(ends, Predicate::Operator::EndsWith)
 OPERATOR_ACTION(contains, Predicate::Operator::Contains)
 OPERATOR_ACTION(like, Predicate::Operator::Like)
+OPERATOR_ACTION(text, Predicate::Operator::Text)
 
 template<> struct action< between >
 {
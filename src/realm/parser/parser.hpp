@@ -101,6 +101,7 @@ struct Predicate
         EndsWith,
         Contains,
         Like,
+        Text,
         In
     };
 
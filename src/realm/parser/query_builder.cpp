@@ -170,6 +170,8 @@ const char* operator_description(const Predicate::Operator& op)
             return "CONTAINS";
         case realm::parser::Predicate::Operator::Like:
             return "LIKE";
+        case realm::parser::Predicate::Operator::Text:
+            return "TEXT";
         case realm::parser::Predicate::Operator::In:
             return "IN";
     }
@@ -214,6 +216,14 @@ make_string_constraint_query(const Predicate::Comparison& cmp, LHS&& lhs, RHS&&
             return lhs.not_equal(rhs, case_sensitive);
         case Predicate::Operator::Like:
             return lhs.like(rhs, case_sensitive);
+        case Predicate::Operator::Text:
+            // Only a plain string property can be searched for words
+            if constexpr (std::is_same_v<std::decay_t<LHS>, Columns<String>> &&
+                          std::is_same_v<std::decay_t<RHS>, StringData>) {
+                if (!lhs.links_exist())
+                    return Query(lhs.get_base_table()).text(lhs.column_key(), rhs);
+            }
+            throw_logic_error("TEXT is only supported on a string property of the queried object.");
         default:
             throw_logic_error(
                 util::format("Unsupported operator '%1' for string queries.", operator_description(cmp.op)));
@@ -28,11 +28,25 @@
 #include <realm/set.hpp>
 
 #include <algorithm>
+#include <atomic>
+#include <exception>
+#include <map>
+#include <thread>
 
 
 using namespace realm;
 using namespace realm::metrics;
 
+namespace {
+
+// Number of consecutive clusters handed to a thread at a time by the parallel executor
+constexpr size_t parallel_chunk_size = 16;
+
+// Tables smaller than this are not worth the cost of starting threads
+constexpr size_t parallel_min_table_size = 64 * 1024;
+
+} // anonymous namespace
+
 Query::Query()
 {
     create();
@@ -100,6 +114,7 @@ Query::Query(const Query& source)
     : error_code(source.error_code)
     , m_groups(source.m_groups)
     , m_table(source.m_table)
+    , m_threadcount(source.m_threadcount)
 {
     if (source.m_owned_source_table_view) {
         m_owned_source_table_view = source.m_owned_source_table_view->clone();
@@ -130,6 +145,7 @@ Query& Query::operator=(const Query& source)
     if (this != &source) {
         m_groups = source.m_groups;
         m_table = source.m_table;
+        m_threadcount = source.m_threadcount;
 
         if (source.m_owned_source_table_view) {
             m_owned_source_table_view = source.m_owned_source_table_view->clone();
@@ -187,6 +203,7 @@ Query::Query(const Query* source, Transaction* tr, PayloadPolicy policy)
         m_view = m_source_link_set.get();
     }
     m_groups = source->m_groups;
+    m_threadcount = source->m_threadcount;
     if (source->m_table)
         set_table(tr->import_copy_of(source->m_table));
     // otherwise: empty query.
@@ -867,6 +884,14 @@ Query& Query::like(ColKey column_key, StringData value, bool case_sensitive)
         add_condition<LikeIns>(column_key, value);
     return *this;
 }
+Query& Query::text(ColKey column_key, StringData text)
+{
+    m_table->report_invalid_key(column_key);
+    if (column_key.get_type() != col_type_String || column_key.is_collection())
+        throw_type_mismatch_error();
+    add_node(std::unique_ptr<ParentNode>(new TextNode(text, column_key)));
+    return *this;
+}
 
 
 // Aggregates =================================================================================
@@ -881,6 +906,108 @@ bool Query::eval_object(const Obj& obj) const
 }
 
 
+void Query::set_threads(unsigned int threadcount)
+{
+    m_threadcount = std::max(threadcount, 1u);
+}
+
+bool Query::use_parallel_execution() const
+{
+    // Frozen tables are the only ones that may be read from several threads at once
+    return m_threadcount > 1 && !m_view && m_table && m_table->is_frozen() &&
+           m_table->size() >= parallel_min_table_size;
+}
+
+std::vector<Query> Query::make_workers() const
+{
+    // Each thread gets its own copy of the node tree since the nodes carry per-leaf state
+    std::vector<Query> workers;
+    workers.reserve(m_threadcount);
+    for (unsigned i = 0; i < m_threadcount; ++i) {
+        workers.emplace_back(*this);
+        workers.back().m_threadcount = 1;
+        workers.back().init();
+    }
+    return workers;
+}
+
+/**************************************************************************************************************
+ *                                                                                                             *
+ * Runs func(worker_ndx, cluster, chunk_ndx) for every cluster of the table, spread over one thread per        *
+ * worker. Clusters are handed out in chunks of parallel_chunk_size through a shared counter, so a thread      *
+ * which is done with its chunk picks up the next unclaimed one. Every thread walks the inner nodes of the     *
+ * tree, but only the threads owning a chunk touch the column leaves of its clusters.                          *
+ *                                                                                                             *
+ **************************************************************************************************************/
+
+template <class F>
+void Query::parallel_traverse_clusters(std::vector<Query>& workers, F func) const
+{
+    std::atomic<size_t> next_chunk{0};
+    std::vector<std::exception_ptr> errors(workers.size());
+
+    auto run = [&](size_t worker_ndx) {
+        try {
+            size_t chunk = next_chunk.fetch_add(1, std::memory_order_relaxed);
+            size_t cluster_ndx = 0;
+            m_table->traverse_clusters([&](const Cluster* cluster) {
+                size_t current = cluster_ndx++ / parallel_chunk_size;
+                if (current > chunk) {
+                    // Claims are made at the first cluster after our previous chunk, so the new claim can
+                    // never be behind the current position.
+                    chunk = next_chunk.fetch_add(1, std::memory_order_relaxed);
+                }
+                if (current == chunk) {
+                    func(worker_ndx, cluster, chunk);
+                }
+                // Continue
+                return false;
+            });
+        }
+        catch (...) {
+            errors[worker_ndx] = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(workers.size() - 1);
+    for (size_t i = 1; i < workers.size(); ++i)
+        threads.emplace_back(run, i);
+    run(0);
+    for (auto& t : threads)
+        t.join();
+
+    for (auto& e : errors) {
+        if (e)
+            std::rethrow_exception(e);
+    }
+}
+
+namespace {
+
+// Fold the result of one part of a parallel aggregate into the overall result. Parts must be merged in table
+// order for min/max to pick the same object as a serial run.
+template <Action action, class R>
+void merge_query_state(QueryState<R>& into, const QueryState<R>& from)
+{
+    if (from.m_match_count == 0)
+        return;
+
+    if (action == act_Sum) {
+        into.m_state += from.m_state;
+    }
+    else {
+        bool better = (action == act_Max) ? from.m_state > into.m_state : from.m_state < into.m_state;
+        if (into.m_match_count == 0 || better) {
+            into.m_state = from.m_state;
+            into.m_minmax_index = from.m_minmax_index;
+        }
+    }
+    into.m_match_count += from.m_match_count;
+}
+
+} // anonymous namespace
+
 template <Action action, typename T, typename R>
 R Query::aggregate(ColKey column_key, size_t* resultcount, ObjKey* return_ndx) const
 {
@@ -917,6 +1044,51 @@ R Query::aggregate(ColKey column_key, size_t* resultcount, ObjKey* return_ndx) c
                 LeafType leaf(m_table.unchecked_ptr()->get_alloc());
                 bool nullable = m_table->is_nullable(column_key);
 
+                if constexpr (std::is_arithmetic_v<ResultType> &&
+                              (action == act_Sum || action == act_Max || action == act_Min)) {
+                    if (use_parallel_execution()) {
+                        auto workers = make_workers();
+                        std::vector<std::unique_ptr<LeafType>> leafs;
+                        std::vector<std::vector<std::pair<size_t, QueryState<ResultType>>>> results(workers.size());
+                        for (auto& w : workers) {
+                            for (auto& child : w.root_node()->m_children)
+                                child->aggregate_local_prepare(action, ColumnTypeTraits<T>::id, nullable);
+                            leafs.push_back(std::make_unique<LeafType>(m_table.unchecked_ptr()->get_alloc()));
+                        }
+
+                        parallel_traverse_clusters(workers, [&](size_t w, const Cluster* cluster, size_t chunk) {
+                            auto& chunk_results = results[w];
+                            if (chunk_results.empty() || chunk_results.back().first != chunk)
+                                chunk_results.emplace_back(chunk, QueryState<ResultType>(action));
+                            auto& chunk_st = chunk_results.back().second;
+                            ParentNode* worker_node = workers[w].root_node();
+                            worker_node->set_cluster(cluster);
+                            cluster->init_leaf(column_key, leafs[w].get());
+                            chunk_st.m_key_offset = cluster->get_offset();
+                            chunk_st.m_key_values = cluster->get_key_array();
+                            workers[w].aggregate_internal(worker_node, &chunk_st, 0, cluster->node_size(),
+                                                          leafs[w].get());
+                        });
+
+                        // Merge in table order so that min/max report the same object as a serial run would
+                        std::map<size_t, const QueryState<ResultType>*> ordered;
+                        for (auto& chunk_results : results) {
+                            for (auto& r : chunk_results)
+                                ordered.emplace(r.first, &r.second);
+                        }
+                        for (auto& r : ordered)
+                            merge_query_state<action>(st, *r.second);
+
+                        if (resultcount) {
+                            *resultcount = st.m_match_count;
+                        }
+                        if (return_ndx) {
+                            *return_ndx = st.m_minmax_index;
+                        }
+                        return st.m_state;
+                    }
+                }
+
                 for (size_t c = 0; c < node->m_children.size(); c++)
                     node->m_children[c]->aggregate_local_prepare(action, ColumnTypeTraits<T>::id, nullable);
 
@@ -975,6 +1147,9 @@ size_t Query::find_best_node(ParentNode* pn) const
 void Query::aggregate_internal(ParentNode* pn, QueryStateBase* st, size_t start, size_t end,
                                ArrayPayload* source_column) const
 {
+    if (!pn->cluster_may_match())
+        return;
+
     while (start < end) {
         // Executes start...end range of a query and will stay inside the condition loop of the node it was called
         // on. Can be called on any node; yields same result, but different performance. Returns prematurely if
@@ -1385,6 +1560,45 @@ void Query::find_all(ConstTableView& ret, size_t begin, size_t end, size_t limit
                 return;
             }
             // no index on best node (and likely no index at all), descend B+-tree
+            if (begin == 0 && end == m_table->size() && limit == size_t(-1) && use_parallel_execution()) {
+                auto workers = make_workers();
+                std::vector<std::vector<std::pair<size_t, std::unique_ptr<KeyColumn>>>> results(workers.size());
+                for (auto& w : workers) {
+                    for (auto& child : w.root_node()->m_children)
+                        child->aggregate_local_prepare(act_FindAll, type_Int, false);
+                }
+
+                parallel_traverse_clusters(workers, [&](size_t w, const Cluster* cluster, size_t chunk) {
+                    auto& chunk_results = results[w];
+                    if (chunk_results.empty() || chunk_results.back().first != chunk) {
+                        auto keys = std::make_unique<KeyColumn>(Allocator::get_default());
+                        keys->create();
+                        chunk_results.emplace_back(chunk, std::move(keys));
+                    }
+                    QueryState<int64_t> st(act_FindAll, chunk_results.back().second.get());
+                    ParentNode* worker_node = workers[w].root_node();
+                    worker_node->set_cluster(cluster);
+                    st.m_key_offset = cluster->get_offset();
+                    st.m_key_values = cluster->get_key_array();
+                    workers[w].aggregate_internal(worker_node, &st, 0, cluster->node_size(), nullptr);
+                });
+
+                // Chunks are numbered in table order
+                std::map<size_t, KeyColumn*> ordered;
+                for (auto& chunk_results : results) {
+                    for (auto& r : chunk_results)
+                        ordered.emplace(r.first, r.second.get());
+                }
+                KeyColumn& refs = ret.m_key_values;
+                for (auto& r : ordered) {
+                    KeyColumn& keys = *r.second;
+                    for (size_t i = 0, sz = keys.size(); i < sz; ++i)
+                        refs.add(keys.get(i));
+                    keys.destroy();
+                }
+                return;
+            }
+
             node = pn;
             QueryState<int64_t> st(act_FindAll, &ret.m_key_values, limit);
 
@@ -1472,6 +1686,28 @@ size_t Query::do_count(size_t limit) const
             return counter;
         }
         // no index, descend down the B+-tree instead
+        if (limit == size_t(-1) && use_parallel_execution()) {
+            auto workers = make_workers();
+            std::vector<QueryState<int64_t>> states;
+            for (auto& w : workers) {
+                for (auto& child : w.root_node()->m_children)
+                    child->aggregate_local_prepare(act_Count, type_Int, false);
+                states.emplace_back(act_Count);
+            }
+
+            parallel_traverse_clusters(workers, [&](size_t w, const Cluster* cluster, size_t) {
+                ParentNode* worker_node = workers[w].root_node();
+                worker_node->set_cluster(cluster);
+                states[w].m_key_offset = cluster->get_offset();
+                states[w].m_key_values = cluster->get_key_array();
+                workers[w].aggregate_internal(worker_node, &states[w], 0, cluster->node_size(), nullptr);
+            });
+
+            for (auto& st : states)
+                cnt += size_t(st.m_state);
+            return cnt;
+        }
+
         node = pn;
         QueryState<int64_t> st(act_Count, limit);
 
@@ -1539,6 +1775,65 @@ TableView Query::find_all(const DescriptorOrdering& descriptor)
     return ret;
 }
 
+// When the results are sorted on a column with an ordered index and then
+// limited, only the objects that can make it through the limit are needed.
+// They are found by walking the index in sort order and evaluating the query on
+// each object until the limit is reached. All objects sharing the value at the
+// limit are included, so that the remaining sort columns order them as usual.
+// Returns false, leaving `ret` untouched, if the walk would be too long; the
+// caller must then run the query normally. The keys are added in table order.
+bool Query::find_all_by_ordered_index(ConstTableView& ret, const DescriptorOrdering& ordering) const
+{
+    if (m_view || ordering.size() < 2 || ordering.get_type(0) != DescriptorType::Sort ||
+        ordering.get_type(1) != DescriptorType::Limit)
+        return false;
+    // The number of objects excluded by the limit is found by counting the
+    // query, so no other descriptor may change the number of results
+    for (size_t i = 2; i < ordering.size(); ++i) {
+        if (ordering.get_type(i) != DescriptorType::Include)
+            return false;
+    }
+
+    auto sort = static_cast<const SortDescriptor*>(ordering[0]);
+    auto& chain = sort->get_column_chain(0);
+    if (chain.size() != 1)
+        return false;
+    auto index = m_table->get_ordered_index(chain[0]);
+    if (!index)
+        return false;
+
+    // Visiting objects one by one is much slower than scanning a column, so
+    // give up if the walk gets longer than a fraction of the table
+    const size_t limit = static_cast<const LimitDescriptor*>(ordering[1])->get_limit();
+    const size_t index_size = index->size();
+    const size_t max_visits = index_size / 8;
+    if (limit == 0 || limit >= max_visits)
+        return false;
+
+    init();
+    const bool ascending = sort->is_ascending(0).value_or(true);
+    std::vector<ObjKey> keys;
+    Mixed last_value;
+    for (size_t visits = 0; visits < index_size; ++visits) {
+        if (visits == max_visits)
+            return false;
+        size_t ndx = ascending ? visits : index_size - 1 - visits;
+        Mixed value = index->get_value(ndx);
+        if (keys.size() >= limit && value.compare(last_value) != 0)
+            break;
+        ObjKey key = index->get_key(ndx);
+        if (!has_conditions() || eval_object(m_table->get_object(key))) {
+            keys.push_back(key);
+            last_value = value;
+        }
+    }
+
+    std::sort(keys.begin(), keys.end());
+    for (auto key : keys)
+        ret.m_key_values.add(key);
+    return true;
+}
+
 size_t Query::count(const DescriptorOrdering& descriptor)
 {
 #if REALM_METRICS
@@ -1574,136 +1869,6 @@ size_t Query::remove()
     return rows;
 }
 
-#if REALM_MULTITHREAD_QUERY
-TableView Query::find_all_multi(size_t start, size_t end)
-{
-    static_cast<void>(start);
-    static_cast<void>(end);
-
-    // Initialization
-    init();
-    ts.next_job = start;
-    ts.end_job = end;
-    ts.done_job = 0;
-    ts.count = 0;
-    ts.table = &table;
-    ts.node = first[0];
-
-    // Signal all threads to start
-    pthread_mutex_unlock(&ts.jobs_mutex);
-    pthread_cond_broadcast(&ts.jobs_cond);
-
-    // Wait until all threads have completed
-    pthread_mutex_lock(&ts.completed_mutex);
-    while (ts.done_job < ts.end_job)
-        pthread_cond_wait(&ts.completed_cond, &ts.completed_mutex);
-    pthread_mutex_lock(&ts.jobs_mutex);
-    pthread_mutex_unlock(&ts.completed_mutex);
-
-    TableView tv(*m_table);
-
-    // Sort search results because user expects ascending order
-    sort(ts.chunks.begin(), ts.chunks.end(), &Query::comp);
-    for (size_t i = 0; i < ts.chunks.size(); ++i) {
-        const size_t from = ts.chunks[i].m_root_node;
-        const size_t upto = (i == ts.chunks.size() - 1) ? size_t(-1) : ts.chunks[i + 1].m_root_node;
-        size_t first = ts.chunks[i].second;
-
-        while (first < ts.results.size() && ts.results[first] < upto && ts.results[first] >= from) {
-            tv.get_ref_column().add(ts.results[first]);
-            ++first;
-        }
-    }
-
-    return move(tv);
-}
-
-int Query::set_threads(unsigned int threadcount)
-{
-#if defined(_WIN32) || defined(__WIN32__) || defined(_WIN64)
-    pthread_win32_process_attach_np();
-#endif
-    pthread_mutex_init(&ts.result_mutex, nullptr);
-    pthread_cond_init(&ts.completed_cond, nullptr);
-    pthread_mutex_init(&ts.jobs_mutex, nullptr);
-    pthread_mutex_init(&ts.completed_mutex, nullptr);
-    pthread_cond_init(&ts.jobs_cond, nullptr);
-
-    pthread_mutex_lock(&ts.jobs_mutex);
-
-    for (size_t i = 0; i < m_threadcount; ++i)
-        pthread_detach(threads[i]);
-
-    for (size_t i = 0; i < threadcount; ++i) {
-        int r = pthread_create(&threads[i], nullptr, query_thread, (void*)&ts);
-        if (r != 0)
-            REALM_ASSERT(false); // todo
-    }
-    m_threadcount = threadcount;
-    return 0;
-}
-
-
-void* Query::query_thread(void* arg)
-{
-    static_cast<void>(arg);
-    thread_state* ts = static_cast<thread_state*>(arg);
-
-    std::vector<size_t> res;
-    std::vector<pair<size_t, size_t>> chunks;
-
-    for (;;) {
-        // Main waiting loop that waits for a query to start
-        pthread_mutex_lock(&ts->jobs_mutex);
-        while (ts->next_job == ts->end_job)
-            pthread_cond_wait(&ts->jobs_cond, &ts->jobs_mutex);
-        pthread_mutex_unlock(&ts->jobs_mutex);
-
-        for (;;) {
-            // Pick a job
-            pthread_mutex_lock(&ts->jobs_mutex);
-            if (ts->next_job == ts->end_job)
-                break;
-            const size_t chunk = min(ts->end_job - ts->next_job, thread_chunk_size);
-            const size_t mine = ts->next_job;
-            ts->next_job += chunk;
-            size_t r = mine - 1;
-            const size_t end = mine + chunk;
-
-            pthread_mutex_unlock(&ts->jobs_mutex);
-
-            // Execute job
-            for (;;) {
-                r = ts->node->find_first(r + 1, end);
-                if (r == end)
-                    break;
-                res.push_back(r);
-            }
-
-            // Append result in common queue shared by all threads.
-            pthread_mutex_lock(&ts->result_mutex);
-            ts->done_job += chunk;
-            if (res.size() > 0) {
-                ts->chunks.push_back(std::pair<size_t, size_t>(mine, ts->results.size()));
-                ts->count += res.size();
-                for (size_t i = 0; i < res.size(); i++) {
-                    ts->results.push_back(res[i]);
-                }
-                res.clear();
-            }
-            pthread_mutex_unlock(&ts->result_mutex);
-
-            // Signal main thread that we might have compleeted
-            pthread_mutex_lock(&ts->completed_mutex);
-            pthread_cond_signal(&ts->completed_cond);
-            pthread_mutex_unlock(&ts->completed_mutex);
-        }
-    }
-    return 0;
-}
-
-#endif // REALM_MULTITHREADQUERY
-
 std::string Query::validate()
 {
     if (!m_groups.size())
@@ -1747,6 +1912,21 @@ void Query::init() const
     }
 }
 
+std::vector<ColKey> Query::get_evaluation_order() const
+{
+    std::vector<ColKey> order;
+    if (!has_conditions())
+        return order;
+    init();
+    std::vector<ParentNode*> nodes = root_node()->m_children;
+    std::stable_sort(nodes.begin(), nodes.end(), [](const ParentNode* a, const ParentNode* b) {
+        return a->cost() < b->cost();
+    });
+    for (const ParentNode* node : nodes)
+        order.push_back(node->m_condition_column_key);
+    return order;
+}
+
 size_t Query::find_internal(size_t start, size_t end) const
 {
     if (end == size_t(-1))
@@ -26,14 +26,6 @@
 #include <string>
 #include <vector>
 
-#define REALM_MULTITHREAD_QUERY 0
-
-#if REALM_MULTITHREAD_QUERY
-// FIXME: Use our C++ thread abstraction API since it provides a much
-// higher level of encapsulation and safety.
-#include <pthread.h>
-#endif
-
 #include <realm/obj_list.hpp>
 #include <realm/table_ref.hpp>
 #include <realm/binary_data.hpp>
@@ -196,6 +188,11 @@ public:
     Query& contains(ColKey column_key, StringData value, bool case_sensitive = true);
     Query& like(ColKey column_key, StringData value, bool case_sensitive = true);
 
+    // Match strings containing all the words of `text`, in any order and case
+    // insensitively for ASCII letters. A word ending in '*' matches any word
+    // starting with it. A full-text index on the column is used if present.
+    Query& text(ColKey column_key, StringData text);
+
     // These are shortcuts for equal(StringData(c_str)) and
     // not_equal(StringData(c_str)), and are needed to avoid unwanted
     // implicit conversion of char* to bool.
@@ -264,12 +261,16 @@ public:
     // Deletion
     size_t remove();
 
-#if REALM_MULTITHREAD_QUERY
     // Multi-threading
-    TableView find_all_multi(size_t start = 0, size_t end = size_t(-1));
-    ConstTableView find_all_multi(size_t start = 0, size_t end = size_t(-1)) const;
-    int set_threads(unsigned int threadcount);
-#endif
+    // Evaluate find_all(), count() and the numeric aggregates on up to `threadcount` threads. This only takes
+    // effect for queries on frozen tables that are not restricted by a view; all other queries keep running on
+    // the calling thread. Sorts and distincts of 131072 or more objects found by the query are also done on up
+    // to `threadcount` threads, whether or not the table is frozen.
+    void set_threads(unsigned int threadcount);
+    unsigned int get_threads() const
+    {
+        return m_threadcount;
+    }
 
     ConstTableRef& get_table()
     {
@@ -292,6 +293,12 @@ public:
     std::string validate();
 
     std::string get_description() const;
+
+    /// The columns of the conditions of the query, in the order they are first
+    /// evaluated, which is cheapest first. The cost of a condition is
+    /// estimated from the column statistics where these are kept. Used to
+    /// diagnose and test the query planning.
+    std::vector<ColKey> get_evaluation_order() const;
     std::string get_description(util::serializer::SerialisationState& state) const;
 
     bool eval_object(const Obj& obj) const;
@@ -336,9 +343,15 @@ private:
                             ArrayPayload* source_column) const;
 
     void find_all(ConstTableView& tv, size_t start = 0, size_t end = size_t(-1), size_t limit = size_t(-1)) const;
+    bool find_all_by_ordered_index(ConstTableView& tv, const DescriptorOrdering& ordering) const;
     size_t do_count(size_t limit = size_t(-1)) const;
     void delete_nodes() noexcept;
 
+    bool use_parallel_execution() const;
+    std::vector<Query> make_workers() const;
+    template <class F>
+    void parallel_traverse_clusters(std::vector<Query>& workers, F func) const;
+
     bool has_conditions() const
     {
         return m_groups.size() > 0 && m_groups[0].m_root_node;
@@ -374,6 +387,8 @@ private:
     LnkSetPtr m_source_link_set;                   // link sets are owned by the query.
     ConstTableView* m_source_table_view = nullptr; // table views are not refcounted, and not owned by the query.
     std::unique_ptr<ConstTableView> m_owned_source_table_view; // <--- except when indicated here
+
+    unsigned int m_threadcount = 1;
 };
 
 // Implementation:
@@ -40,6 +40,9 @@ ParentNode::ParentNode(const ParentNode& from)
 
 size_t ParentNode::find_first(size_t start, size_t end)
 {
+    if (!cluster_may_match())
+        return not_found;
+
     size_t sz = m_children.size();
     size_t current_cond = 0;
     size_t nb_cond_to_test = sz;
@@ -376,6 +379,21 @@ bool StringNode<Equal>::do_consume_condition(ParentNode& node)
 
 size_t StringNode<Equal>::_find_first_local(size_t start, size_t end)
 {
+    if (m_leaf_ptr->is_enumerated()) {
+        if (m_needles.empty()) {
+            StringData value = m_value ? StringData(*m_value) : StringData();
+            update_enum_matches([&](StringData t) {
+                return t == value;
+            });
+        }
+        else {
+            update_enum_matches([&](StringData t) {
+                return m_needles.count(t) != 0;
+            });
+        }
+        return find_first_enum_match(start, end);
+    }
+
     if (m_needles.empty()) {
         return m_leaf_ptr->find_first(m_value, start, end);
     }
@@ -425,6 +443,13 @@ void StringNode<EqualIns>::_search_index_init()
 size_t StringNode<EqualIns>::_find_first_local(size_t start, size_t end)
 {
     EqualIns cond;
+    if (m_leaf_ptr->is_enumerated()) {
+        update_enum_matches([&](StringData t) {
+            return cond(StringData(m_value), m_ucase.c_str(), m_lcase.c_str(), t);
+        });
+        return find_first_enum_match(start, end);
+    }
+
     for (size_t s = start; s < end; ++s) {
         StringData t = get_string(s);
 
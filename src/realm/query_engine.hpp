@@ -101,6 +101,7 @@ AggregateState      State of the aggregate - contains a state variable that stor
 #include <realm/array_list.hpp>
 #include <realm/array_bool.hpp>
 #include <realm/array_backlink.hpp>
+#include <realm/column_statistics.hpp>
 #include <realm/column_type_traits.hpp>
 #include <realm/metrics/query_info.hpp>
 #include <realm/query_conditions.hpp>
@@ -112,6 +113,8 @@ AggregateState      State of the aggregate - contains a state variable that stor
 #include <realm/util/shared_ptr.hpp>
 #include <realm/util/string_buffer.hpp>
 #include <realm/utilities.hpp>
+#include <realm/index_fulltext.hpp>
+#include <realm/index_ordered.hpp>
 #include <realm/index_string.hpp>
 
 #include <map>
@@ -178,6 +181,36 @@ public:
 
     bool match(const Obj& obj);
 
+    // Estimate the match distance from the column statistics, if any are kept, so that
+    // Query::find_best_node() can pick a good node before any matches have been seen
+    template <class Condition>
+    void estimate_match_distance(Mixed value)
+    {
+        if (auto stats = m_table.unchecked_ptr()->get_column_statistics(m_condition_column_key)) {
+            double selectivity = stats->template estimate_selectivity<Condition>(value);
+            if (selectivity >= 0)
+                m_dD = 1.0 / std::max(selectivity, 1.0 / stats->get_row_count());
+        }
+    }
+
+    // Exclude the current cluster if the summary of the leaf shows that no entry in it can match
+    template <class Condition, class LeafType>
+    void exclude_cluster_if_no_match(const LeafType& leaf, Mixed value)
+    {
+        const LeafSummary* summary = m_table.unchecked_ptr()->get_leaf_summary(leaf);
+        m_cluster_excluded = summary && !summary->template may_match<Condition>(value);
+    }
+
+    // False if any of the conditions has excluded the current cluster
+    bool cluster_may_match() const
+    {
+        for (auto child : m_children) {
+            if (child->m_cluster_excluded)
+                return false;
+        }
+        return true;
+    }
+
     virtual void init(bool will_query_ranges)
     {
         m_dD = 100.0;
@@ -346,6 +379,9 @@ public:
     size_t m_probes = 0;
     size_t m_matches = 0;
 
+    // Set by cluster_changed() when the condition cannot match anything in the current cluster
+    bool m_cluster_excluded = false;
+
 protected:
     typedef bool (ParentNode::*Column_action_specialized)(QueryStateBase*, ArrayPayload*, size_t);
     Column_action_specialized m_column_action_specializer = nullptr;
@@ -439,6 +475,66 @@ protected:
     ArrayPayload* m_source_column = nullptr;
 };
 
+size_t do_search_index(ObjKey& last_start_key, size_t& result_get, std::vector<ObjKey>& results,
+                       const Cluster* cluster, size_t start, size_t end);
+
+/// The objects matching a condition, looked up in the ordered index of the
+/// condition column and ordered by key so that they can be visited cluster by
+/// cluster. The index is only used when the condition matches few enough
+/// objects that visiting them one by one beats scanning the column.
+class OrderedIndexMatches {
+public:
+    static constexpr double max_index_selectivity = 0.25;
+
+    template <class Condition>
+    bool init(const Table& table, ColKey col_key, Mixed value)
+    {
+        m_keys.clear();
+        m_result_get = 0;
+        m_last_start_key = ObjKey();
+        m_active = false;
+
+        auto index = table.get_ordered_index(col_key);
+        size_t begin, end;
+        if (!index || !index->template find_range<Condition>(value, begin, end))
+            return false;
+        if (end - begin > max_index_selectivity * index->size())
+            return false;
+        index->find_keys(begin, end, m_keys);
+        m_active = true;
+        return true;
+    }
+
+    bool is_active() const noexcept
+    {
+        return m_active;
+    }
+
+    size_t size() const noexcept
+    {
+        return m_keys.size();
+    }
+
+    size_t find_first(const Cluster* cluster, size_t start, size_t end)
+    {
+        return do_search_index(m_last_start_key, m_result_get, m_keys, cluster, start, end);
+    }
+
+    void aggregate(const Table& table, size_t limit, Evaluator evaluator) const
+    {
+        for (size_t t = 0; t < m_keys.size() && limit > 0; ++t) {
+            if (evaluator(table.get_object(m_keys[t])))
+                --limit;
+        }
+    }
+
+private:
+    std::vector<ObjKey> m_keys;
+    size_t m_result_get = 0;
+    ObjKey m_last_start_key;
+    bool m_active = false;
+};
+
 template <class LeafType>
 class IntegerNodeBase : public ColumnNodeBase {
     using ThisType = IntegerNodeBase<LeafType>;
@@ -644,6 +740,36 @@ public:
     {
     }
 
+    void init(bool will_query_ranges) override
+    {
+        BaseType::init(will_query_ranges);
+        if (m_index_matches.template init<TConditionFunction>(*this->m_table.unchecked_ptr(),
+                                                              this->m_condition_column_key,
+                                                              Mixed(this->m_value))) {
+            this->m_dT = 0;
+            this->m_dD = double(this->m_table->size()) / (m_index_matches.size() + 1);
+        }
+        else {
+            this->template estimate_match_distance<TConditionFunction>(Mixed(this->m_value));
+        }
+    }
+
+    bool has_search_index() const override
+    {
+        return m_index_matches.is_active();
+    }
+
+    void index_based_aggregate(size_t limit, Evaluator evaluator) override
+    {
+        m_index_matches.aggregate(*this->m_table.unchecked_ptr(), limit, evaluator);
+    }
+
+    void cluster_changed() override
+    {
+        BaseType::cluster_changed();
+        this->template exclude_cluster_if_no_match<TConditionFunction>(*this->m_leaf_ptr, Mixed(this->m_value));
+    }
+
     void aggregate_local_prepare(Action action, DataType col_id, bool is_nullable) override
     {
         this->m_fastmode_disabled = (col_id == type_Float || col_id == type_Double);
@@ -662,6 +788,8 @@ public:
 
     size_t find_first_local(size_t start, size_t end) override
     {
+        if (m_index_matches.is_active())
+            return m_index_matches.find_first(this->m_cluster, start, end);
         return this->m_leaf_ptr->template find_first<TConditionFunction>(this->m_value, start, end);
     }
 
@@ -680,6 +808,9 @@ public:
     {
         return std::unique_ptr<ParentNode>(new ThisType(*this));
     }
+
+private:
+    OrderedIndexMatches m_index_matches;
 };
 
 template <size_t linear_search_threshold, class LeafType, class NeedleContainer>
@@ -733,6 +864,16 @@ public:
             m_last_start_key = ObjKey();
             IntegerNodeBase<LeafType>::m_dT = 0;
         }
+        else if (m_needles.empty()) {
+            this->template estimate_match_distance<Equal>(Mixed(this->m_value));
+        }
+    }
+
+    void cluster_changed() override
+    {
+        BaseType::cluster_changed();
+        if (m_needles.empty() && !has_search_index())
+            this->template exclude_cluster_if_no_match<Equal>(*this->m_leaf_ptr, Mixed(this->m_value));
     }
 
     bool do_consume_condition(ParentNode& node) override
@@ -866,6 +1007,12 @@ public:
         m_dT = 1.0;
     }
 
+    void init(bool will_query_ranges) override
+    {
+        ParentNode::init(will_query_ranges);
+        estimate_match_distance<TConditionFunction>(null::is_null_float(m_value) ? Mixed() : Mixed(m_value));
+    }
+
     void cluster_changed() override
     {
         // Assigning nullptr will cause the Leaf destructor to be called. Must
@@ -1235,8 +1382,39 @@ class TimestampNode : public TimestampNodeBase {
 public:
     using TimestampNodeBase::TimestampNodeBase;
 
+    void init(bool will_query_ranges) override
+    {
+        TimestampNodeBase::init(will_query_ranges);
+        if (m_index_matches.init<TConditionFunction>(*m_table.unchecked_ptr(), m_condition_column_key,
+                                                     Mixed(m_value))) {
+            m_dT = 0;
+            m_dD = double(m_table->size()) / (m_index_matches.size() + 1);
+        }
+        else {
+            estimate_match_distance<TConditionFunction>(Mixed(m_value));
+        }
+    }
+
+    bool has_search_index() const override
+    {
+        return m_index_matches.is_active();
+    }
+
+    void index_based_aggregate(size_t limit, Evaluator evaluator) override
+    {
+        m_index_matches.aggregate(*m_table.unchecked_ptr(), limit, evaluator);
+    }
+
+    void cluster_changed() override
+    {
+        TimestampNodeBase::cluster_changed();
+        exclude_cluster_if_no_match<TConditionFunction>(*m_leaf_ptr, Mixed(m_value));
+    }
+
     size_t find_first_local(size_t start, size_t end) override
     {
+        if (m_index_matches.is_active())
+            return m_index_matches.find_first(m_cluster, start, end);
         return m_leaf_ptr->find_first<TConditionFunction>(m_value, start, end);
     }
 
@@ -1257,6 +1435,8 @@ protected:
         : TimestampNodeBase(from, tr)
     {
     }
+
+    OrderedIndexMatches m_index_matches;
 };
 
 class DecimalNodeBase : public ParentNode {
@@ -1310,8 +1490,30 @@ class DecimalNode : public DecimalNodeBase {
 public:
     using DecimalNodeBase::DecimalNodeBase;
 
+    void init(bool will_query_ranges) override
+    {
+        DecimalNodeBase::init(will_query_ranges);
+        if (m_index_matches.init<TConditionFunction>(*m_table.unchecked_ptr(), m_condition_column_key,
+                                                     Mixed(m_value))) {
+            m_dT = 0;
+            m_dD = double(m_table->size()) / (m_index_matches.size() + 1);
+        }
+    }
+
+    bool has_search_index() const override
+    {
+        return m_index_matches.is_active();
+    }
+
+    void index_based_aggregate(size_t limit, Evaluator evaluator) override
+    {
+        m_index_matches.aggregate(*m_table.unchecked_ptr(), limit, evaluator);
+    }
+
     size_t find_first_local(size_t start, size_t end) override
     {
+        if (m_index_matches.is_active())
+            return m_index_matches.find_first(m_cluster, start, end);
         TConditionFunction cond;
         bool value_is_null = m_value.is_null();
         for (size_t i = start; i < end; i++) {
@@ -1339,10 +1541,9 @@ protected:
         : DecimalNodeBase(from, tr)
     {
     }
-};
 
-size_t do_search_index(ObjKey& last_start_key, size_t& result_get, std::vector<ObjKey>& results,
-                       const Cluster* cluster, size_t start, size_t end);
+    OrderedIndexMatches m_index_matches;
+};
 
 template <class ObjectType, class ArrayType>
 class FixedBytesNodeBase : public ParentNode {
@@ -1669,6 +1870,8 @@ public:
         m_end_s = 0;
         m_leaf_start = 0;
         m_leaf_end = 0;
+        m_enum_matches.clear();
+        m_num_enum_matches = 0;
     }
 
     virtual void clear_leaf_state()
@@ -1709,10 +1912,50 @@ protected:
     size_t m_leaf_start = 0;
     size_t m_leaf_end = 0;
 
+    // For the leaves of an enumerated column, whether each of the unique
+    // values of the column matches the condition
+    std::vector<bool> m_enum_matches;
+    size_t m_num_enum_matches = 0;
+    size_t m_first_enum_match = 0;
+
     inline StringData get_string(size_t s)
     {
         return m_leaf_ptr->get(s);
     }
+
+    // The unique values of a column only change when values are added, so the
+    // matches stay valid as long as their number is unchanged.
+    template <class Predicate>
+    void update_enum_matches(Predicate&& predicate)
+    {
+        const ArrayString& values = m_leaf_ptr->get_enum_values();
+        size_t sz = values.size();
+        if (m_enum_matches.size() == sz)
+            return;
+        m_enum_matches.assign(sz, false);
+        m_num_enum_matches = 0;
+        for (size_t i = 0; i < sz; ++i) {
+            if (predicate(values.get(i))) {
+                m_enum_matches[i] = true;
+                if (m_num_enum_matches++ == 0)
+                    m_first_enum_match = i;
+            }
+        }
+    }
+
+    // Compares the indexes held by an enumerated leaf instead of the values
+    size_t find_first_enum_match(size_t start, size_t end) const
+    {
+        if (m_num_enum_matches == 0)
+            return not_found;
+        if (m_num_enum_matches == 1)
+            return m_leaf_ptr->find_first_enum_index(m_first_enum_match, start, end);
+        for (size_t s = start; s < end; ++s) {
+            if (m_enum_matches[m_leaf_ptr->get_enum_index(s)])
+                return s;
+        }
+        return not_found;
+    }
 };
 
 // Conditions for strings. Note that Equal is specialized later in this file!
@@ -1743,6 +1986,19 @@ public:
     {
         TConditionFunction cond;
 
+        if (m_leaf_ptr->is_enumerated()) {
+            update_enum_matches([&](StringData t) {
+                return cond(StringData(m_value), m_ucase.c_str(), m_lcase.c_str(), t);
+            });
+            return find_first_enum_match(start, end);
+        }
+
+        if constexpr (std::is_same_v<TConditionFunction, BeginsWith>) {
+            // The leaf compares many strings at a time
+            if (m_value)
+                return m_leaf_ptr->find_first_prefix(StringData(m_value), start, end);
+        }
+
         for (size_t s = start; s < end; ++s) {
             StringData t = get_string(s);
 
@@ -1809,6 +2065,13 @@ public:
     {
         Contains cond;
 
+        if (m_leaf_ptr->is_enumerated()) {
+            update_enum_matches([&](StringData t) {
+                return cond(StringData(m_value), m_charmap, t);
+            });
+            return find_first_enum_match(start, end);
+        }
+
         for (size_t s = start; s < end; ++s) {
             StringData t = get_string(s);
 
@@ -1886,6 +2149,13 @@ public:
     {
         ContainsIns cond;
 
+        if (m_leaf_ptr->is_enumerated()) {
+            update_enum_matches([&](StringData t) {
+                return !bool(m_value) || cond(StringData(m_value), m_ucase.c_str(), m_lcase.c_str(), m_charmap, t);
+            });
+            return find_first_enum_match(start, end);
+        }
+
         for (size_t s = start; s < end; ++s) {
             StringData t = get_string(s);
             // The current behaviour is to return all results when querying for a null string.
@@ -1990,6 +2260,20 @@ public:
         StringNodeBase::table_changed();
         m_has_search_index = m_table.unchecked_ptr()->has_search_index(m_condition_column_key) ||
                              m_table.unchecked_ptr()->get_primary_key_column() == m_condition_column_key;
+        if (m_has_search_index && !m_is_string_enum) {
+            // Collecting and visiting the keys of a very common value is slower than scanning the column
+            if (auto stats = m_table.unchecked_ptr()->get_column_statistics(m_condition_column_key)) {
+                StringData value = m_value ? StringData(*m_value) : StringData();
+                m_has_search_index = stats->estimate_selectivity<Equal>(value) < max_index_selectivity;
+            }
+        }
+    }
+
+    void init(bool will_query_ranges) override
+    {
+        StringNodeEqualBase::init(will_query_ranges);
+        if (!m_has_search_index && m_needles.empty())
+            estimate_match_distance<Equal>(m_value ? StringData(*m_value) : StringData());
     }
 
     void _search_index_init() override;
@@ -2038,6 +2322,9 @@ public:
     }
 
 private:
+    // Fraction of matching rows above which a scan is chosen over the search index
+    static constexpr double max_index_selectivity = 0.25;
+
     std::unique_ptr<IntegerColumn> m_index_matches;
 
     ObjKey get_key(size_t ndx) override
@@ -2130,6 +2417,92 @@ private:
     size_t _find_first_local(size_t start, size_t end) override;
 };
 
+// Condition matching the strings that contain all the words of a search text,
+// see FullTextIndex for how text is split into words. The full-text index of
+// the column is used if there is one, otherwise every string is tokenized.
+class TextNode : public StringNodeBase {
+public:
+    TextNode(StringData v, ColKey column)
+        : StringNodeBase(v, column)
+        , m_terms(FullTextIndex::parse_search(v))
+    {
+    }
+
+    void table_changed() override
+    {
+        StringNodeBase::table_changed();
+        m_has_fulltext_index = m_table.unchecked_ptr()->has_fulltext_index(m_condition_column_key);
+    }
+
+    void init(bool will_query_ranges) override
+    {
+        StringNodeBase::init(will_query_ranges);
+        clear_leaf_state();
+
+        m_index_matches.clear();
+        m_result_get = 0;
+        m_last_start_key = ObjKey();
+        if (m_has_fulltext_index) {
+            m_table->get_fulltext_index(m_condition_column_key)->find_all(m_terms, m_index_matches);
+            m_dT = 0;
+        }
+        else {
+            m_dT = 100.0;
+        }
+    }
+
+    bool has_search_index() const override
+    {
+        return m_has_fulltext_index;
+    }
+
+    void index_based_aggregate(size_t limit, Evaluator evaluator) override
+    {
+        for (size_t t = 0; t < m_index_matches.size() && limit > 0; ++t) {
+            auto obj = m_table->get_object(m_index_matches[t]);
+            if (evaluator(obj)) {
+                --limit;
+            }
+        }
+    }
+
+    size_t find_first_local(size_t start, size_t end) override
+    {
+        if (m_has_fulltext_index)
+            return do_search_index(m_last_start_key, m_result_get, m_index_matches, m_cluster, start, end);
+
+        for (size_t s = start; s < end; ++s) {
+            if (FullTextIndex::matches(get_string(s), m_terms))
+                return s;
+        }
+        return not_found;
+    }
+
+    virtual std::string describe_condition() const override
+    {
+        return "TEXT";
+    }
+
+    std::unique_ptr<ParentNode> clone() const override
+    {
+        return std::unique_ptr<ParentNode>(new TextNode(*this));
+    }
+
+    TextNode(const TextNode& from)
+        : StringNodeBase(from)
+        , m_terms(from.m_terms)
+        , m_has_fulltext_index(from.m_has_fulltext_index)
+    {
+    }
+
+private:
+    std::vector<FullTextIndex::Term> m_terms;
+    bool m_has_fulltext_index = false;
+    std::vector<ObjKey> m_index_matches;
+    size_t m_result_get = 0;
+    ObjKey m_last_start_key;
+};
+
 // OR node contains at least two node pointers: Two or more conditions to OR
 // together in m_conditions, and the next AND condition (if any) in m_child.
 //
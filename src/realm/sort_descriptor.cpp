@@ -18,12 +18,99 @@
 
 #include <realm/sort_descriptor.hpp>
 #include <realm/table.hpp>
+#include <realm/array_string.hpp>
 #include <realm/db.hpp>
+#include <realm/index_ordered.hpp>
+#include <realm/index_string.hpp>
 #include <realm/util/assert.hpp>
 #include <realm/list.hpp>
+#include <realm/unicode.hpp>
+
+#include <cmath>
+#include <exception>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 
 using namespace realm;
 
+namespace {
+
+// Inputs of at least this size are sorted on several threads, in runs of at
+// least parallel_sort_min_run entries
+constexpr size_t parallel_sort_min_size = 1 << 17;
+constexpr size_t parallel_sort_min_run = 1 << 15;
+
+// Run func(0) ... func(count - 1) on one thread each
+template <class F>
+void run_in_parallel(size_t count, F func)
+{
+    std::vector<std::exception_ptr> errors(count);
+    auto run = [&](size_t ndx) {
+        try {
+            func(ndx);
+        }
+        catch (...) {
+            errors[ndx] = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(count - 1);
+    for (size_t i = 1; i < count; ++i)
+        threads.emplace_back(run, i);
+    run(0);
+    for (auto& t : threads)
+        t.join();
+
+    for (auto& e : errors) {
+        if (e)
+            std::rethrow_exception(e);
+    }
+}
+
+// Sort with a merge sort whose runs are sorted, and then merged pairwise, on
+// up to predicate.get_threads() threads. The predicate must be a total order,
+// and safe to call from several threads, which holds for a Sorter once its
+// columns are cached. The result is then the same as that of std::sort.
+void sort_entries(BaseDescriptor::IndexPairs& v, const BaseDescriptor::Sorter& predicate)
+{
+    size_t sz = v.size();
+    size_t num_runs = 1;
+    // A string compare callback given by the user may not be safe to call
+    // from several threads
+    if (sz >= parallel_sort_min_size && string_compare_method != STRING_COMPARE_CALLBACK)
+        num_runs = std::min<size_t>(predicate.get_threads(), sz / parallel_sort_min_run);
+    if (num_runs < 2) {
+        std::sort(v.begin(), v.end(), std::ref(predicate));
+        return;
+    }
+
+    using Iterator = BaseDescriptor::IndexPairs::iterator;
+    std::vector<Iterator> bounds;
+    for (size_t i = 0; i <= num_runs; ++i)
+        bounds.push_back(v.begin() + sz * i / num_runs);
+
+    run_in_parallel(num_runs, [&](size_t i) {
+        std::sort(bounds[i], bounds[i + 1], std::ref(predicate));
+    });
+    while (bounds.size() > 2) {
+        size_t runs = bounds.size() - 1;
+        run_in_parallel(runs / 2, [&](size_t i) {
+            std::inplace_merge(bounds[2 * i], bounds[2 * i + 1], bounds[2 * i + 2], std::ref(predicate));
+        });
+        // Every other bound is gone, and an odd run out is kept as it is
+        std::vector<Iterator> merged;
+        for (size_t i = 0; i <= runs; i += 2)
+            merged.push_back(bounds[i]);
+        if (runs % 2)
+            merged.push_back(bounds[runs]);
+        bounds.swap(merged);
+    }
+}
+
+} // anonymous namespace
+
 LinkPathPart::LinkPathPart(ColKey col_key, ConstTableRef source)
     : column_key(col_key)
     , from(source->get_key())
@@ -206,7 +293,9 @@ BaseDescriptor::Sorter DistinctDescriptor::sorter(Table const& table, const Inde
 {
     REALM_ASSERT(!m_column_keys.empty());
     std::vector<bool> ascending(m_column_keys.size(), true);
-    return Sorter(m_column_keys, ascending, table, indexes);
+    Sorter sorter(m_column_keys, ascending, table, indexes);
+    sorter.use_enum_indexes();
+    return sorter;
 }
 
 void DistinctDescriptor::execute(IndexPairs& v, const Sorter& predicate, const BaseDescriptor* next) const
@@ -220,23 +309,58 @@ void DistinctDescriptor::execute(IndexPairs& v, const Sorter& predicate, const B
         v.erase(nulls, v.end());
     }
 
-    // Sort by the columns to distinct on
-    std::sort(v.begin(), v.end(), std::ref(predicate));
+    if (predicate.has_unique_values())
+        return;
 
-    // Move duplicates to the back - "not less than" is "equal" since they're sorted
-    auto duplicates = std::unique(v.begin(), v.end(), [&](const IP& a, const IP& b) {
-        return !predicate(a, b, false);
-    });
-    // Erase the duplicates
-    v.erase(duplicates, v.end());
-    bool will_be_sorted_next = next && next->get_type() == DescriptorType::Sort;
-    if (!will_be_sorted_next) {
-        // Restore the original order, this is either the original
-        // tableview order or the order of the previous sort
-        std::sort(v.begin(), v.end(), [](const IP& a, const IP& b) {
-            return a.index_in_view < b.index_in_view;
+    if (!predicate.can_hash()) {
+        // Sort by the columns to distinct on
+        sort_entries(v, predicate);
+
+        // Move duplicates to the back - "not less than" is "equal" since they're sorted
+        auto duplicates = std::unique(v.begin(), v.end(), [&](const IP& a, const IP& b) {
+            return !predicate(a, b, false);
         });
+        // Erase the duplicates
+        v.erase(duplicates, v.end());
+        bool will_be_sorted_next = next && next->get_type() == DescriptorType::Sort;
+        if (!will_be_sorted_next) {
+            // Restore the original order, this is either the original
+            // tableview order or the order of the previous sort
+            std::sort(v.begin(), v.end(), [](const IP& a, const IP& b) {
+                return a.index_in_view < b.index_in_view;
+            });
+        }
+        return;
+    }
+
+    // The entries are in order of index_in_view, so keeping the first entry
+    // of each set of equal ones keeps the one that the sort above would have
+    // kept, and the order is left as it is.
+    std::vector<size_t> hashes;
+    hashes.reserve(v.size());
+    for (auto& index : v)
+        hashes.push_back(predicate.hash(index));
+
+    // The set holds positions in v of the entries kept so far
+    auto hash = [&](size_t ndx) {
+        return hashes[ndx];
+    };
+    auto equal = [&](size_t a, size_t b) {
+        return predicate.is_equal(v[a], v[b]);
+    };
+    std::unordered_set<size_t, decltype(hash), decltype(equal)> kept_entries(v.size(), hash, equal);
+    size_t kept = 0;
+    for (size_t i = 0; i < v.size(); ++i) {
+        // Move the entry to the first free position, where it stays unless
+        // an equal entry has been kept already
+        if (i != kept) {
+            v[kept] = v[i];
+            hashes[kept] = hashes[i];
+        }
+        if (kept_entries.insert(kept).second)
+            ++kept;
     }
+    v.erase(v.begin() + kept, v.end());
 }
 
 void IncludeDescriptor::execute(IndexPairs&, const Sorter&, const BaseDescriptor*) const
@@ -252,7 +376,21 @@ BaseDescriptor::Sorter SortDescriptor::sorter(Table const& table, const IndexPai
 
 void SortDescriptor::execute(IndexPairs& v, const Sorter& predicate, const BaseDescriptor* next) const
 {
-    std::sort(v.begin(), v.end(), std::ref(predicate));
+    size_t limit = size_t(-1);
+    if (next && next->get_type() == DescriptorType::Limit)
+        limit = static_cast<const LimitDescriptor*>(next)->get_limit();
+
+    if (!predicate.sort_by_ordered_index(v, limit)) {
+        if (limit < v.size()) {
+            // Only the first entries survive the limit, so there is no need to
+            // order the rest. The predicate is a total order, so the result is
+            // the same as for a full sort.
+            std::partial_sort(v.begin(), v.begin() + limit, v.end(), std::ref(predicate));
+        }
+        else {
+            sort_entries(v, predicate);
+        }
+    }
 
     // not doing this on the last step is an optimisation
     if (next) {
@@ -290,8 +428,9 @@ void LimitDescriptor::execute(IndexPairs& v, const Sorter&, const BaseDescriptor
 bool BaseDescriptor::Sorter::operator()(IndexPair i, IndexPair j, bool total_ordering) const
 {
     // Sorting can be specified by multiple columns, so that if two entries in the first column are
-    // identical, then the rows are ordered according to the second column, and so forth. For the
-    // first column, all the payload of the View is cached in IndexPair::cached_value.
+    // identical, then the rows are ordered according to the second column, and so forth. The values
+    // of all columns are read up front by cache_columns(). For the first column they are kept in
+    // IndexPair::cached_value, for the others in SortColumn::cached_values.
     for (size_t t = 0; t < m_columns.size(); t++) {
         if (!m_columns[t].translated_keys.empty()) {
             bool null_i = m_columns[t].is_null[i.index_in_view];
@@ -312,17 +451,8 @@ bool BaseDescriptor::Sorter::operator()(IndexPair i, IndexPair j, bool total_ord
             c = i.cached_value.compare(j.cached_value);
         }
         else {
-            ObjKey key_i = i.key_for_object;
-            ObjKey key_j = j.key_for_object;
-
-            if (!m_columns[t].translated_keys.empty()) {
-                key_i = m_columns[t].translated_keys[i.index_in_view];
-                key_j = m_columns[t].translated_keys[j.index_in_view];
-            }
-            const Obj obj_i = m_columns[t].table->get_object(key_i);
-            const Obj obj_j = m_columns[t].table->get_object(key_j);
-
-            c = obj_i.cmp(obj_j, m_columns[t].col_key);
+            c = m_columns[t].compare(m_columns[t].cached_values[i.index_in_view],
+                                     m_columns[t].cached_values[j.index_in_view]);
         }
         // if c is negative i comes before j
         if (c) {
@@ -333,29 +463,222 @@ bool BaseDescriptor::Sorter::operator()(IndexPair i, IndexPair j, bool total_ord
     return total_ordering ? i.index_in_view < j.index_in_view : 0;
 }
 
-void BaseDescriptor::Sorter::cache_first_column(IndexPairs& v)
+bool BaseDescriptor::Sorter::sort_by_ordered_index(IndexPairs& v, size_t limit) const
 {
-    if (m_columns.empty())
+    if (m_columns.empty() || !m_columns[0].translated_keys.empty() || v.size() < 2)
+        return false;
+    const SortColumn& col = m_columns[0];
+    auto index = col.table->get_ordered_index(col.col_key);
+    if (!index)
+        return false;
+
+    // The walk visits objects outside the view too, until enough entries of
+    // the view have been found. Estimate its length assuming that the view is
+    // spread evenly over the index.
+    const size_t sz = v.size();
+    const size_t wanted = std::min(limit, sz);
+    double expected_walk = double(index->size()) * wanted / sz;
+    if (expected_walk > sz * std::log2(double(sz)))
+        return false;
+
+    std::unordered_map<int64_t, size_t> positions;
+    positions.reserve(sz);
+    for (size_t i = 0; i < sz; ++i) {
+        if (!positions.emplace(v[i].key_for_object.value, i).second)
+            return false; // The same object appears more than once
+    }
+
+    std::vector<IndexPair> sorted;
+    sorted.reserve(sz);
+    std::vector<bool> taken(sz);
+    // Entries with equal values in the first column are ordered by the
+    // remaining columns and the position in the view, as in a full sort.
+    auto add_group = [&](size_t begin, size_t end) {
+        size_t group_start = sorted.size();
+        for (size_t i = begin; i < end; ++i) {
+            auto it = positions.find(index->get_key(i).value);
+            if (it != positions.end()) {
+                sorted.push_back(v[it->second]);
+                taken[it->second] = true;
+            }
+        }
+        if (sorted.size() - group_start > 1)
+            std::sort(sorted.begin() + group_start, sorted.end(), std::ref(*this));
+    };
+
+    size_t index_size = index->size();
+    if (col.ascending) {
+        size_t begin = 0;
+        while (begin < index_size && sorted.size() < wanted) {
+            Mixed value = index->get_value(begin);
+            size_t end = begin + 1;
+            while (end < index_size && index->get_value(end).compare(value) == 0)
+                ++end;
+            add_group(begin, end);
+            begin = end;
+        }
+    }
+    else {
+        size_t end = index_size;
+        while (end > 0 && sorted.size() < wanted) {
+            Mixed value = index->get_value(end - 1);
+            size_t begin = end - 1;
+            while (begin > 0 && index->get_value(begin - 1).compare(value) == 0)
+                --begin;
+            add_group(begin, end);
+            end = begin;
+        }
+    }
+
+    // Whatever was not reached is beyond the limit and will be cut off
+    for (size_t i = 0; i < sz; ++i) {
+        if (!taken[i])
+            sorted.push_back(v[i]);
+    }
+    REALM_ASSERT(sorted.size() == sz);
+    v.std::vector<IndexPair>::swap(sorted);
+    return true;
+}
+
+int BaseDescriptor::Sorter::SortColumn::compare(const Mixed& a, const Mixed& b) const
+{
+    // Strings in secondary columns have always been ordered bytewise, as done
+    // by Obj::cmp(), while the first column uses the string compare method.
+    // Other values are ordered as in the first column. For floats and doubles
+    // that puts null before NaN before numbers, where Obj::cmp() found null
+    // and NaN equal to any value, which is not a strict weak ordering.
+    if (col_key.get_type() == col_type_String && !use_enum_index) {
+        StringData str_a = a.is_null() ? StringData() : a.get_string();
+        StringData str_b = b.is_null() ? StringData() : b.get_string();
+        return str_a < str_b ? -1 : (str_b < str_a ? 1 : 0);
+    }
+    return a.compare(b);
+}
+
+void BaseDescriptor::Sorter::use_enum_indexes()
+{
+    for (auto& col : m_columns) {
+        if (col.col_key.get_type() != col_type_String || !col.table->is_enumerated(col.col_key))
+            continue;
+        // Leaves of columns enumerated by older versions may hold the values
+        ArrayString leaf(col.table->get_alloc());
+        bool holds_values = col.table->traverse_clusters([&](const Cluster* cluster) {
+            cluster->init_leaf(col.col_key, &leaf);
+            return !leaf.is_enumerated();
+        });
+        col.use_enum_index = !holds_values;
+    }
+}
+
+void BaseDescriptor::Sorter::cache_columns(IndexPairs& v)
+{
+    if (m_columns.empty() || v.empty())
         return;
 
-    auto& col = m_columns[0];
-    ColKey ck = col.col_key;
-    for (size_t i = 0; i < v.size(); i++) {
-        IndexPair& index = v[i];
-        ObjKey key = index.key_for_object;
+    // Each object is looked up once, and the values of all the columns are
+    // read from it, so that comparisons only touch contiguous memory.
+    const Table* root_table = nullptr;
+    size_t cached_size = std::max_element(v.begin(), v.end())->index_in_view + 1;
+    for (size_t t = 0; t < m_columns.size(); ++t) {
+        auto& col = m_columns[t];
+        if (col.translated_keys.empty())
+            root_table = col.table;
+        if (t > 0)
+            col.cached_values.assign(cached_size, Mixed());
+    }
 
-        if (!col.translated_keys.empty()) {
-            if (col.is_null[i]) {
-                index.cached_value = Mixed();
-                continue;
+    for (auto& index : v) {
+        const Obj obj = root_table ? root_table->get_object(index.key_for_object) : Obj();
+        for (size_t t = 0; t < m_columns.size(); ++t) {
+            auto& col = m_columns[t];
+            auto get_value = [&](const Obj& o) {
+                // The leaf of an enumerated column holds the indexes
+                if (col.use_enum_index)
+                    return Mixed(o._get<int64_t>(col.col_key.get_index()));
+                return o.get_any(col.col_key);
+            };
+            Mixed value;
+            if (col.translated_keys.empty()) {
+                value = get_value(obj);
             }
-            else {
-                key = col.translated_keys[v[i].index_in_view];
+            else if (!col.is_null[index.index_in_view]) {
+                value = get_value(col.table->get_object(col.translated_keys[index.index_in_view]));
             }
+            if (t == 0)
+                index.cached_value = value;
+            else
+                col.cached_values[index.index_in_view] = value;
         }
+    }
+}
 
-        index.cached_value = col.table->get_object(key).get_any(ck);
+bool BaseDescriptor::Sorter::is_equal(IndexPair i, IndexPair j) const
+{
+    for (size_t t = 0; t < m_columns.size(); t++) {
+        auto& col = m_columns[t];
+        if (!col.translated_keys.empty()) {
+            bool null_i = col.is_null[i.index_in_view];
+            if (null_i != col.is_null[j.index_in_view])
+                return false;
+            if (null_i)
+                continue;
+        }
+        int c = (t == 0) ? i.cached_value.compare(j.cached_value)
+                         : col.compare(col.cached_values[i.index_in_view], col.cached_values[j.index_in_view]);
+        if (c)
+            return false;
     }
+    return true;
+}
+
+bool BaseDescriptor::Sorter::can_hash() const
+{
+    // Decimals that compare equal may differ in their representation, and
+    // Mixed values of different numeric types may compare equal.
+    return std::none_of(m_columns.begin(), m_columns.end(), [](auto&& col) {
+        auto type = col.col_key.get_type();
+        return type == col_type_Decimal || type == col_type_Mixed;
+    });
+}
+
+size_t BaseDescriptor::Sorter::hash(IndexPair i) const
+{
+    size_t h = 0;
+    for (size_t t = 0; t < m_columns.size(); t++) {
+        const Mixed& value = (t == 0) ? i.cached_value : m_columns[t].cached_values[i.index_in_view];
+        size_t value_hash = 0;
+        if (!value.is_null()) {
+            switch (value.get_type()) {
+                case type_Float:
+                    // 0 and -0 compare equal
+                    value_hash = value.get_float() == 0 ? 1 : value.hash();
+                    break;
+                case type_Double:
+                    value_hash = value.get_double() == 0 ? 1 : value.hash();
+                    break;
+                case type_Link:
+                    value_hash = std::hash<int64_t>()(value.get<ObjKey>().value);
+                    break;
+                default:
+                    value_hash = value.hash();
+                    break;
+            }
+        }
+        h ^= value_hash + 0x9e3779b9 + (h << 6) + (h >> 2);
+    }
+    return h;
+}
+
+bool BaseDescriptor::Sorter::has_unique_values() const
+{
+    if (!m_unique_objects || m_columns.size() != 1 || !m_columns[0].translated_keys.empty())
+        return false;
+    const SortColumn& col = m_columns[0];
+    if (col.table->get_primary_key_column() == col.col_key)
+        return true;
+    if (col.table->has_search_index(col.col_key))
+        return !col.table->get_search_index(col.col_key)->has_duplicate_values();
+    return false;
 }
 
 IncludeDescriptor::IncludeDescriptor(ConstTableRef table, const std::vector<std::vector<LinkPathPart>>& column_links)
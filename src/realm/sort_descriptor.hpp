@@ -92,7 +92,47 @@ public:
                 return col.is_null.empty() ? false : col.is_null[i.index_in_view];
             });
         }
-        void cache_first_column(IndexPairs& v);
+        /// For enumerated string columns, read the index of each value among
+        /// the unique values of the column instead of the value. The indexes
+        /// are equal exactly when the values are, but are not in the order of
+        /// the values, so this is only for distinct.
+        void use_enum_indexes();
+        /// Read the values of all sort columns for the entries in `v`. Must be
+        /// called before the predicate is used.
+        void cache_columns(IndexPairs& v);
+        /// True if `i` and `j` have equal values in all columns.
+        bool is_equal(IndexPair i, IndexPair j) const;
+        /// True if all columns are of a type for which hash() is consistent
+        /// with is_equal().
+        bool can_hash() const;
+        /// Hash of the values of all columns of `i`.
+        size_t hash(IndexPair i) const;
+        /// True if the entries are known to have distinct values without
+        /// comparing them, because they refer to distinct objects, and the only
+        /// column is the primary key or has a search index without duplicates.
+        bool has_unique_values() const;
+        /// Put the entries in order by walking the ordered index of the first
+        /// column, if it has one and that is expected to be cheaper than
+        /// sorting. Only the first `limit` entries are guaranteed to be in
+        /// order afterwards. Returns false if the entries were left untouched.
+        bool sort_by_ordered_index(IndexPairs& v, size_t limit) const;
+        /// Allow large inputs to be sorted on up to `threads` threads, see
+        /// Query::set_threads().
+        void set_threads(unsigned threads) noexcept
+        {
+            m_threads = threads;
+        }
+        unsigned get_threads() const noexcept
+        {
+            return m_threads;
+        }
+        /// Tell whether the entries refer to distinct objects, as those of a
+        /// view found by a query do. Views of a link list or of backlinks may
+        /// refer to an object more than once.
+        void set_unique_objects(bool unique) noexcept
+        {
+            m_unique_objects = unique;
+        }
 
     private:
         struct SortColumn {
@@ -102,14 +142,22 @@ public:
                 , ascending(a)
             {
             }
+            int compare(const Mixed& a, const Mixed& b) const;
+
             std::vector<bool> is_null;
             std::vector<ObjKey> translated_keys;
+            // Values of the column, by index in view. Not used for the first
+            // column, whose values are kept in the IndexPairs.
+            std::vector<Mixed> cached_values;
 
             const Table* table;
             ColKey col_key;
             bool ascending;
+            bool use_enum_index = false;
         };
         std::vector<SortColumn> m_columns;
+        unsigned m_threads = 1;
+        bool m_unique_objects = false;
         friend class ObjList;
     };
 
@@ -147,6 +195,16 @@ public:
     }
     void collect_dependencies(const Table* table, std::vector<TableKey>& table_keys) const override;
 
+    size_t get_column_count() const noexcept
+    {
+        return m_column_keys.size();
+    }
+    // The chain of columns leading to the ndx'th column
+    const std::vector<ColKey>& get_column_chain(size_t ndx) const
+    {
+        return m_column_keys[ndx];
+    }
+
 protected:
     std::vector<std::vector<ColKey>> m_column_keys;
 };
@@ -5888,6 +5888,10 @@ void ServerImpl::handle_allocation_metrics_wait()
     reporter.gauge("memory,subsystem=decrypted", double(decr_mem.memory_size));
     reporter.gauge("memory,subsystem=reclaimer_workload", double(decr_mem.reclaimer_workload));
     reporter.gauge("memory,subsystem=reclaimer_target", double(decr_mem.reclaimer_target));
+    reporter.gauge("memory,subsystem=decrypted_budget", double(decr_mem.memory_budget));
+    reporter.gauge("memory,subsystem=decrypted_hits", double(decr_mem.num_hits));
+    reporter.gauge("memory,subsystem=decrypted_misses", double(decr_mem.num_misses));
+    reporter.gauge("memory,subsystem=decrypted_evictions", double(decr_mem.num_evictions));
     reporter.gauge("memory,subsystem=core-slab", double(SlabAlloc::get_total_slab_size()));
     initiate_allocation_metrics_wait();
 }
@@ -809,7 +809,7 @@ int main(int argc, char* argv[])
     Group group{realm_path, encryption_key_3, open_mode};
     using gf = _impl::GroupFriend;
     int file_format_version = gf::get_file_format_version(group);
-    if (file_format_version != 20) {
+    if (file_format_version != 20 && file_format_version != 21) {
         std::cout << "ERROR: Unexpected file format version " << file_format_version << "\n";
         return EXIT_FAILURE;
     }
@@ -17,6 +17,7 @@
  **************************************************************************/
 
 #include <stdexcept>
+#include <unordered_set>
 
 #ifdef REALM_DEBUG
 #include <iostream>
@@ -29,6 +30,8 @@
 #include <realm/exceptions.hpp>
 #include <realm/table.hpp>
 #include <realm/alloc_slab.hpp>
+#include <realm/index_fulltext.hpp>
+#include <realm/index_ordered.hpp>
 #include <realm/index_string.hpp>
 #include <realm/db.hpp>
 #include <realm/replication.hpp>
@@ -40,6 +43,7 @@
 #include <realm/array_timestamp.hpp>
 #include <realm/array_decimal128.hpp>
 #include <realm/array_fixed_bytes.hpp>
+#include <realm/column_statistics.hpp>
 #include <realm/table_tpl.hpp>
 
 /// \page AccessorConsistencyLevels
@@ -501,6 +505,9 @@ void Table::remove_column(ColKey col_key)
 
     erase_root_column(col_key); // Throws
     m_has_any_embedded_objects.reset();
+
+    std::lock_guard<std::mutex> lock(m_statistics_mutex);
+    m_column_statistics.erase(col_key);
 }
 
 
@@ -718,6 +725,17 @@ void Table::erase_from_search_indexes(ObjKey key)
                 index->erase(key);
             }
         }
+        if (has_secondary_indexes()) {
+            const Obj obj = get_object(key);
+            for (auto col_key : m_leaf_ndx2colkey) {
+                if (!col_key)
+                    continue;
+                if (has_ordered_index(col_key))
+                    get_ordered_index(col_key)->erase(key, obj.get_any(col_key));
+                if (has_fulltext_index(col_key))
+                    get_fulltext_index(col_key)->erase(key, obj.get<StringData>(col_key));
+            }
+        }
     }
 }
 
@@ -803,6 +821,19 @@ void Table::update_indexes(ObjKey key, const FieldValues& values)
             }
         }
     }
+
+    if (has_secondary_indexes()) {
+        // The object has been created, so its initial values can be read back
+        const Obj obj = get_object(key);
+        for (auto col_key : m_leaf_ndx2colkey) {
+            if (!col_key)
+                continue;
+            if (has_ordered_index(col_key))
+                get_ordered_index(col_key)->insert(key, obj.get_any(col_key)); // Throws
+            if (has_fulltext_index(col_key))
+                get_fulltext_index(col_key)->insert(key, obj.get<StringData>(col_key)); // Throws
+        }
+    }
 }
 
 void Table::clear_indexes()
@@ -812,6 +843,14 @@ void Table::clear_indexes()
             index->clear();
         }
     }
+    for (auto col_key : m_leaf_ndx2colkey) {
+        if (!col_key)
+            continue;
+        if (has_ordered_index(col_key))
+            get_ordered_index(col_key)->clear();
+        if (has_fulltext_index(col_key))
+            get_fulltext_index(col_key)->clear();
+    }
 }
 
 void Table::add_search_index(ColKey col_key)
@@ -892,6 +931,104 @@ bool Table::is_enumerated(ColKey col_key) const noexcept
     return m_spec.is_string_enum_type(col_ndx);
 }
 
+void Table::compress_column(ColKey col_key)
+{
+    check_column(col_key);
+    ColumnType type = col_key.get_type();
+    if ((type != col_type_String && type != col_type_Binary) || col_key.is_collection())
+        throw LogicError(LogicError::illegal_type);
+
+    // Early-out if already compressed
+    if (is_compressed(col_key))
+        return;
+
+    auto spec_ndx = colkey2spec_ndx(col_key);
+    auto attr = m_spec.get_column_attr(spec_ndx);
+    attr.set(col_attr_Compressed);
+    m_spec.set_column_attr(spec_ndx, attr); // Throws
+
+    compress_leaves(col_key, false); // Throws
+}
+
+void Table::decompress_column(ColKey col_key)
+{
+    check_column(col_key);
+
+    // Early-out if not compressed
+    if (!is_compressed(col_key))
+        return;
+
+    auto spec_ndx = colkey2spec_ndx(col_key);
+    auto attr = m_spec.get_column_attr(spec_ndx);
+    attr.reset(col_attr_Compressed);
+    m_spec.set_column_attr(spec_ndx, attr); // Throws
+
+    auto decompress = [&](auto& leaf) {
+        m_clusters.update([&](Cluster* cluster) {
+            cluster->init_leaf(col_key, &leaf);
+            leaf.decompress(); // Throws
+        });
+    };
+    if (col_key.get_type() == col_type_String) {
+        ArrayString leaf(m_alloc);
+        decompress(leaf); // Throws
+    }
+    else {
+        ArrayBinary leaf(m_alloc);
+        decompress(leaf); // Throws
+    }
+}
+
+bool Table::is_compressed(ColKey col_key) const noexcept
+{
+    size_t col_ndx = colkey2spec_ndx(col_key);
+    return m_spec.get_column_attr(col_ndx).test(col_attr_Compressed);
+}
+
+// Compress the leaves of a compressed column. If `only_modified` is true,
+// only those modified in this transaction, as the others are already
+// compressed if that saves space.
+void Table::compress_leaves(ColKey col_key, bool only_modified)
+{
+    // Values read through Obj may be held in leaves that are about to be
+    // freed, and their refs reused for the leaves compressed here
+    m_compressed_leaves.clear();
+
+    auto compress = [&](auto& leaf) {
+        auto func = [&](Cluster* cluster) {
+            ref_type ref = cluster->get_as_ref(col_key.get_index().val + 1);
+            if (only_modified && m_alloc.is_read_only(ref))
+                return;
+            cluster->init_leaf(col_key, &leaf);
+            leaf.compress(); // Throws
+        };
+        if (only_modified) {
+            m_clusters.update_modified(func); // Throws
+        }
+        else {
+            m_clusters.update(func); // Throws
+        }
+    };
+    if (col_key.get_type() == col_type_String) {
+        ArrayString leaf(m_alloc);
+        compress(leaf); // Throws
+    }
+    else {
+        ArrayBinary leaf(m_alloc);
+        compress(leaf); // Throws
+    }
+}
+
+const ArrayCompressedBlobs& Table::get_compressed_leaf(ref_type ref) const
+{
+    auto& leaf = m_compressed_leaves[ref];
+    if (!leaf) {
+        leaf = std::make_unique<ArrayCompressedBlobs>(m_alloc); // Throws
+        leaf->init_from_ref(ref);
+    }
+    return *leaf;
+}
+
 size_t Table::get_num_unique_values(ColKey col_key) const
 {
     if (!is_enumerated(col_key))
@@ -906,6 +1043,70 @@ size_t Table::get_num_unique_values(ColKey col_key) const
 }
 
 
+namespace {
+
+// String columns of smaller tables are not enumerated automatically
+constexpr size_t enumeration_min_table_size = 1000;
+// A string column is enumerated automatically if it has no more than this
+// many unique values, and no more than one unique value per this many objects
+constexpr size_t enumeration_max_unique_values = 1000;
+constexpr size_t enumeration_min_objects_per_value = 8;
+
+} // anonymous namespace
+
+void Table::enumerate_low_cardinality_string_columns()
+{
+    // The columns are looked at again each time the table has doubled in
+    // size. The size is kept in the file, so that they are not looked at
+    // again by every transaction.
+    size_t sz = size();
+    size_t size_at_last_check = 0;
+    if (m_top.size() > top_position_for_enumeration_check)
+        size_at_last_check = size_t(m_top.get_as_ref_or_tagged(top_position_for_enumeration_check).get_as_int());
+    if (sz < enumeration_min_table_size || sz < 2 * size_at_last_check)
+        return;
+    while (m_top.size() <= top_position_for_enumeration_check)
+        m_top.add(0); // Throws
+    m_top.set(top_position_for_enumeration_check, RefOrTagged::make_tagged(sz)); // Throws
+
+    // The values of tombstones would not be enumerated along with the others
+    if (m_tombstones)
+        return;
+
+    size_t max_unique_values = std::min(enumeration_max_unique_values, sz / enumeration_min_objects_per_value);
+    for_each_public_column([&](ColKey col_key) {
+        if (col_key.get_type() != col_type_String || col_key.is_collection() || col_key == m_primary_key_col ||
+            is_enumerated(col_key) || is_compressed(col_key))
+            return false;
+        if (count_unique_strings(col_key, max_unique_values + 1) <= max_unique_values)
+            m_clusters.enumerate_string_column(col_key); // Throws
+        return false;
+    });
+}
+
+// Counts no further than to `limit`
+size_t Table::count_unique_strings(ColKey col_key, size_t limit) const
+{
+    std::unordered_set<std::string> values;
+    bool has_null = false;
+    ArrayString leaf(m_alloc);
+    m_clusters.traverse([&](const Cluster* cluster) {
+        cluster->init_leaf(col_key, &leaf);
+        size_t leaf_size = leaf.size();
+        for (size_t i = 0; i < leaf_size; i++) {
+            StringData value = leaf.get(i);
+            if (value.is_null())
+                has_null = true;
+            else
+                values.emplace(value.data(), value.size());
+            if (values.size() + size_t(has_null) >= limit)
+                return true; // Stop
+        }
+        return false; // Continue
+    });
+    return values.size() + size_t(has_null);
+}
+
 void Table::erase_root_column(ColKey col_key)
 {
     check_column(col_key);
@@ -984,6 +1185,8 @@ void Table::do_erase_root_column(ColKey col_key)
         delete m_index_accessors[col_ndx];
         m_index_accessors[col_ndx] = nullptr;
     }
+    destroy_secondary_index(top_position_for_ordered_indexes, col_key);
+    destroy_secondary_index(top_position_for_fulltext_indexes, col_key);
     m_opposite_table.set(col_ndx, TableKey().value);
     m_opposite_column.set(col_ndx, ColKey().value);
     m_index_accessors[col_ndx] = nullptr;
@@ -1102,6 +1305,145 @@ bool Table::has_search_index(ColKey col_key) const noexcept
     return m_index_accessors[col_key.get_index().val] != nullptr;
 }
 
+bool Table::has_secondary_indexes() const noexcept
+{
+    return (m_top.size() > top_position_for_ordered_indexes && m_top.get_as_ref(top_position_for_ordered_indexes)) ||
+           (m_top.size() > top_position_for_fulltext_indexes && m_top.get_as_ref(top_position_for_fulltext_indexes));
+}
+
+// Ordered and full-text indexes are stored in an array of refs with one
+// entry per column, found at `top_pos` in the table top
+bool Table::has_secondary_index(size_t top_pos, ColKey col_key) const noexcept
+{
+    if (m_top.size() <= top_pos)
+        return false;
+    ref_type refs_ref = m_top.get_as_ref(top_pos);
+    if (!refs_ref)
+        return false;
+    const char* header = m_alloc.translate(refs_ref);
+    size_t col_ndx = col_key.get_index().val;
+    return col_ndx < NodeHeader::get_size_from_header(header) && Array::get(header, col_ndx) != 0;
+}
+
+void Table::attach_secondary_index(size_t top_pos, ColKey col_key, ref_type ref)
+{
+    _impl::DeepArrayRefDestroyGuard dg(ref, m_alloc);
+    while (m_top.size() <= top_pos)
+        m_top.add(0); // Throws
+    Array refs(m_alloc);
+    refs.set_parent(&m_top, top_pos);
+    if (m_top.get_as_ref(top_pos)) {
+        refs.init_from_parent();
+    }
+    else {
+        refs.create(Array::type_HasRefs); // Throws
+        refs.update_parent();             // Throws
+    }
+    size_t col_ndx = col_key.get_index().val;
+    while (refs.size() <= col_ndx)
+        refs.add(0); // Throws
+
+    refs.set_as_ref(col_ndx, ref); // Throws
+    dg.release();
+
+    // Older versions ignore these slots of the table top, and would leave
+    // the index stale if they wrote to the file
+    if (Group* group = get_parent_group())
+        group->require_extended_file_format();
+}
+
+void Table::destroy_secondary_index(size_t top_pos, ColKey col_key)
+{
+    if (!has_secondary_index(top_pos, col_key))
+        return;
+    Array refs(m_alloc);
+    refs.set_parent(&m_top, top_pos);
+    refs.init_from_parent();
+    size_t col_ndx = col_key.get_index().val;
+    Array::destroy_deep(refs.get_as_ref(col_ndx), m_alloc);
+    refs.set(col_ndx, 0);
+}
+
+bool Table::has_ordered_index(ColKey col_key) const noexcept
+{
+    return has_secondary_index(top_position_for_ordered_indexes, col_key);
+}
+
+std::unique_ptr<OrderedIndex> Table::get_ordered_index(ColKey col_key) const
+{
+    report_invalid_key(col_key);
+    if (!has_ordered_index(col_key))
+        return nullptr;
+    // The accessor only changes the table top when the index is modified,
+    // which can only happen through a writable table.
+    return std::make_unique<OrderedIndex>(m_alloc, const_cast<Array*>(&m_top), top_position_for_ordered_indexes,
+                                          col_key.get_index().val);
+}
+
+void Table::add_ordered_index(ColKey col_key)
+{
+    check_column(col_key);
+
+    // Early-out if already indexed
+    if (has_ordered_index(col_key))
+        return;
+
+    if (!OrderedIndex::type_supported(col_key))
+        throw LogicError(LogicError::illegal_combination);
+
+    attach_secondary_index(top_position_for_ordered_indexes, col_key, OrderedIndex::create(m_alloc)); // Throws
+
+    auto index = get_ordered_index(col_key);
+    for (auto o : *this) {
+        index->insert(o.get_key(), o.get_any(col_key)); // Throws
+    }
+}
+
+void Table::remove_ordered_index(ColKey col_key)
+{
+    check_column(col_key);
+    destroy_secondary_index(top_position_for_ordered_indexes, col_key);
+}
+
+bool Table::has_fulltext_index(ColKey col_key) const noexcept
+{
+    return has_secondary_index(top_position_for_fulltext_indexes, col_key);
+}
+
+std::unique_ptr<FullTextIndex> Table::get_fulltext_index(ColKey col_key) const
+{
+    report_invalid_key(col_key);
+    if (!has_fulltext_index(col_key))
+        return nullptr;
+    return std::make_unique<FullTextIndex>(m_alloc, const_cast<Array*>(&m_top), top_position_for_fulltext_indexes,
+                                           col_key.get_index().val);
+}
+
+void Table::add_fulltext_index(ColKey col_key)
+{
+    check_column(col_key);
+
+    // Early-out if already indexed
+    if (has_fulltext_index(col_key))
+        return;
+
+    if (!FullTextIndex::type_supported(col_key))
+        throw LogicError(LogicError::illegal_combination);
+
+    attach_secondary_index(top_position_for_fulltext_indexes, col_key, FullTextIndex::create(m_alloc)); // Throws
+
+    auto index = get_fulltext_index(col_key);
+    for (auto o : *this) {
+        index->insert(o.get_key(), o.get<StringData>(col_key)); // Throws
+    }
+}
+
+void Table::remove_fulltext_index(ColKey col_key)
+{
+    check_column(col_key);
+    destroy_secondary_index(top_position_for_fulltext_indexes, col_key);
+}
+
 void Table::migrate_column_info()
 {
     bool changes = false;
@@ -1916,6 +2258,9 @@ ref_type Table::create_empty_table(Allocator& alloc, TableKey key)
     top.add(0); // pk col key
     top.add(0); // flags
     top.add(0); // tombstones
+    top.add(0); // ordered indexes
+    top.add(0); // full-text indexes
+    top.add(0); // enumeration check
 
     REALM_ASSERT(top.size() == top_array_size);
 
@@ -2354,6 +2699,36 @@ template ObjKey Table::find_first(ColKey col_key, UUID) const;
 template ObjKey Table::find_first(ColKey col_key, util::Optional<ObjectId>) const;
 template ObjKey Table::find_first(ColKey col_key, util::Optional<UUID>) const;
 
+std::shared_ptr<const ColumnStatistics> Table::get_column_statistics(ColKey col_key) const
+{
+    size_t row_count = size();
+    if (row_count < ColumnStatistics::min_table_size || !ColumnStatistics::is_supported(col_key))
+        return nullptr;
+
+    // Statistics of committed content are shared by the transactions of the
+    // DB and kept until a commit modifies the table
+    Group* group = get_parent_group();
+    ColumnStatisticsCache* shared = group ? group->get_column_statistics_cache() : nullptr;
+    if (shared && m_top.is_read_only()) {
+        return shared->get(m_key, col_key, m_top.get_ref(), m_in_file_version_at_transaction_boundary, [&] {
+            return std::make_shared<ColumnStatistics>(*this, col_key);
+        });
+    }
+
+    // Several threads may query the same frozen table
+    std::lock_guard<std::mutex> lock(m_statistics_mutex);
+    auto& stats = m_column_statistics[col_key];
+    if (!stats) {
+        stats = std::make_shared<ColumnStatistics>(*this, col_key);
+    }
+    else {
+        size_t drift = std::max(row_count, stats->get_row_count()) - std::min(row_count, stats->get_row_count());
+        if (drift > stats->get_row_count() / 8)
+            stats = std::make_shared<ColumnStatistics>(*this, col_key);
+    }
+    return stats;
+}
+
 ObjKey Table::find_first_int(ColKey col_key, int64_t value) const
 {
     if (is_nullable(col_key))
@@ -2704,6 +3079,12 @@ void Table::flush_for_commit()
 {
     if (m_top.is_attached() && m_top.size() >= top_position_for_version) {
         if (!m_top.is_read_only()) {
+            enumerate_low_cardinality_string_columns(); // Throws
+            for_each_public_column([&](ColKey col_key) {
+                if (is_compressed(col_key))
+                    compress_leaves(col_key, true); // Throws
+                return false;
+            });
             ++m_in_file_version_at_transaction_boundary;
             auto rot_version = RefOrTagged::make_tagged(m_in_file_version_at_transaction_boundary);
             m_top.set(top_position_for_version, rot_version);
@@ -3844,6 +4225,8 @@ ColKey Table::set_nullability(ColKey col_key, bool nullable, bool throw_on_null)
     check_column(col_key);
 
     bool si = has_search_index(col_key);
+    bool oi = has_ordered_index(col_key);
+    bool fi = has_fulltext_index(col_key);
     std::string column_name(get_column_name(col_key));
     auto type = col_key.get_type();
     auto attr = col_key.get_attrs();
@@ -3872,6 +4255,10 @@ ColKey Table::set_nullability(ColKey col_key, bool nullable, bool throw_on_null)
 
     if (si)
         add_search_index(new_col);
+    if (oi)
+        add_ordered_index(new_col);
+    if (fi)
+        add_fulltext_index(new_col);
 
     if (is_pk_col) {
         // If we go from non nullable to nullable, no values change,
@@ -30,7 +30,9 @@
 #include <realm/util/function_ref.hpp>
 #include <realm/util/thread.hpp>
 #include <realm/table_ref.hpp>
+#include <realm/column_statistics.hpp>
 #include <realm/spec.hpp>
+#include <realm/array_blobs_compressed.hpp>
 #include <realm/query.hpp>
 #include <realm/table_cluster_tree.hpp>
 #include <realm/keys.hpp>
@@ -50,6 +52,8 @@ class BacklinkCount;
 class BinaryColumy;
 class ConstTableView;
 class Group;
+class OrderedIndex;
+class FullTextIndex;
 class SortDescriptor;
 class StringIndex;
 class TableView;
@@ -183,10 +187,73 @@ public:
     void add_search_index(ColKey col_key);
     void remove_search_index(ColKey col_key);
 
+    /// Store the values of a string column as indexes into a list of its
+    /// unique values. This is done automatically on commit for the string
+    /// columns of larger tables that have few unique values.
     void enumerate_string_column(ColKey col_key);
     bool is_enumerated(ColKey col_key) const noexcept;
     bool contains_unique_values(ColKey col_key) const;
 
+    /// Store the leaves of a string or binary column compressed, when that
+    /// saves space. Leaves are compressed as they are committed, and
+    /// decompressed as a whole when they are read, which suits columns of
+    /// larger values that compress well, such as JSON documents. Values read
+    /// through `Obj` are kept decompressed until the transaction moves to
+    /// another version. decompress_column() stores all the values of the
+    /// column uncompressed again. Files with compressed columns cannot be
+    /// opened by versions of Realm that do not know the compressed format.
+    void compress_column(ColKey col_key);
+    void decompress_column(ColKey col_key);
+    bool is_compressed(ColKey col_key) const noexcept;
+
+    //@}
+
+    //@{
+
+    /// has_ordered_index() returns true if, and only if an ordered index has
+    /// been added to the specified column.
+    ///
+    /// add_ordered_index() adds an ordered index to the specified column. The
+    /// query engine uses it for range conditions (greater, less, between) and
+    /// sorting uses it to deliver the objects in order. It can be combined
+    /// with a search index on the same column. Only Int, Timestamp and
+    /// Decimal128 columns can have an ordered index. It has no effect if the
+    /// column already has one (idempotency).
+    ///
+    /// remove_ordered_index() removes the ordered index from the specified
+    /// column. It has no effect if the column has no ordered index.
+    ///
+    /// The ordered index is local to the file. Adding and removing it is not
+    /// replicated, so it must be added to each file that should have it. The
+    /// file is moved to file format 21 when an ordered index is first added,
+    /// see Group::get_file_format_version().
+
+    bool has_ordered_index(ColKey col_key) const noexcept;
+    void add_ordered_index(ColKey col_key);
+    void remove_ordered_index(ColKey col_key);
+
+    //@}
+
+    //@{
+
+    /// has_fulltext_index() returns true if, and only if a full-text index
+    /// has been added to the specified column.
+    ///
+    /// add_fulltext_index() adds a full-text index to the specified column.
+    /// The index maps every word of the column to the objects containing it,
+    /// and is used by Query::text(). Only String columns can have a full-text
+    /// index. It has no effect if the column already has one (idempotency).
+    ///
+    /// remove_fulltext_index() removes the full-text index from the specified
+    /// column. It has no effect if the column has no full-text index.
+    ///
+    /// Like the ordered index, the full-text index is local to the file and
+    /// adding it moves the file to file format 21.
+
+    bool has_fulltext_index(ColKey col_key) const noexcept;
+    void add_fulltext_index(ColKey col_key);
+    void remove_fulltext_index(ColKey col_key);
+
     //@}
 
     /// If the specified column is optimized to store only unique values, then
@@ -381,6 +448,27 @@ public:
             return nullptr;
         return m_index_accessors[col.get_index().val];
     }
+    // Will return an accessor for the ordered index. Will return nullptr if no index
+    std::unique_ptr<OrderedIndex> get_ordered_index(ColKey col) const;
+    // Will return an accessor for the full-text index. Will return nullptr if no index
+    std::unique_ptr<FullTextIndex> get_fulltext_index(ColKey col) const;
+    /// Get sampled statistics for the column, used by the query engine to
+    /// order conditions. Statistics of a table that is unchanged since the
+    /// last commit are shared by the transactions of the DB, see
+    /// ColumnStatisticsCache. Otherwise they are taken on first use and
+    /// retaken when the number of rows has drifted by more than an eighth.
+    /// Returns nullptr for small tables and for columns where no statistics
+    /// are kept.
+    std::shared_ptr<const ColumnStatistics> get_column_statistics(ColKey col_key) const;
+
+    /// Get the min/max summary of a column leaf of one of the clusters of this
+    /// table, or nullptr if it is not (yet) available. See LeafSummaryCache.
+    template <class LeafType>
+    const LeafSummary* get_leaf_summary(const LeafType& leaf) const
+    {
+        return m_leaf_summaries.get(leaf, get_content_version());
+    }
+
     template <class T>
     ObjKey find_first(ColKey col_key, T value) const;
 
@@ -635,6 +723,7 @@ private:
     void update_allocator_wrapper(bool writable)
     {
         m_alloc.update_from_underlying_allocator(writable);
+        m_compressed_leaves.clear();
     }
     Spec m_spec;                                    // 1st slot in m_top
     TableClusterTree m_clusters;                    // 3rd slot in m_top
@@ -644,6 +733,9 @@ private:
     Array m_opposite_table;                         // 7th slot in m_top
     Array m_opposite_column;                        // 8th slot in m_top
     std::vector<StringIndex*> m_index_accessors;
+    mutable std::mutex m_statistics_mutex;
+    mutable std::map<ColKey, std::shared_ptr<const ColumnStatistics>> m_column_statistics;
+    mutable LeafSummaryCache m_leaf_summaries;
     ColKey m_primary_key_col;
     Replication* const* m_repl;
     static Replication* g_dummy_replication;
@@ -658,6 +750,10 @@ private:
     void erase_from_search_indexes(ObjKey key);
     void update_indexes(ObjKey key, const FieldValues& values);
     void clear_indexes();
+    bool has_secondary_indexes() const noexcept;
+    bool has_secondary_index(size_t top_pos, ColKey col_key) const noexcept;
+    void attach_secondary_index(size_t top_pos, ColKey col_key, ref_type ref);
+    void destroy_secondary_index(size_t top_pos, ColKey col_key);
 
     // Migration support
     void migrate_column_info();
@@ -777,6 +873,10 @@ private:
     void refresh_index_accessors();
     void refresh_content_version();
     void flush_for_commit();
+    void enumerate_low_cardinality_string_columns();
+    size_t count_unique_strings(ColKey col_key, size_t limit) const;
+    void compress_leaves(ColKey col_key, bool only_modified);
+    const ArrayCompressedBlobs& get_compressed_leaf(ref_type ref) const;
 
     bool is_cross_table_link_target() const noexcept;
     template <Action action, typename T, typename R>
@@ -789,6 +889,9 @@ private:
     std::vector<size_t> m_leaf_ndx2spec_ndx;
     bool m_is_embedded = false;
     uint64_t m_in_file_version_at_transaction_boundary = 0;
+    // Leaves of compressed columns that values have been read from through
+    // Obj, which must stay valid as long as the version is being read
+    mutable std::map<ref_type, std::unique_ptr<ArrayCompressedBlobs>> m_compressed_leaves;
     LifeCycleCookie m_cookie;
 
     static constexpr int top_position_for_spec = 0;
@@ -806,7 +909,12 @@ private:
     static constexpr int top_position_for_flags = 12;
     // flags contents: bit 0 - is table embedded?
     static constexpr int top_position_for_tombstones = 13;
-    static constexpr int top_array_size = 14;
+    static constexpr int top_position_for_ordered_indexes = 14;
+    static constexpr int top_position_for_fulltext_indexes = 15;
+    // Number of objects when the string columns were last considered for
+    // enumeration
+    static constexpr int top_position_for_enumeration_check = 16;
+    static constexpr int top_array_size = 17;
 
     enum { s_collision_map_lo = 0, s_collision_map_hi = 1, s_collision_map_local_id = 2, s_collision_map_num_slots };
 
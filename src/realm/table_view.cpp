@@ -591,6 +591,7 @@ void ConstTableView::do_sync()
     // - Table::get_backlink_view()
     // Here we sync with the respective source.
     m_last_seen_versions.clear();
+    bool stopped_early = false;
 
     if (m_linklist_source) {
         m_key_values.clear();
@@ -631,10 +632,18 @@ void ConstTableView::do_sync()
 
         if (m_query.m_view)
             m_query.m_view->sync_if_needed();
-        m_query.find_all(*const_cast<ConstTableView*>(this), m_start, m_end, m_limit);
+        stopped_early = m_start == 0 && m_end == size_t(-1) && m_limit == size_t(-1) &&
+                        m_query.find_all_by_ordered_index(*this, m_descriptor_ordering);
+        if (!stopped_early)
+            m_query.find_all(*const_cast<ConstTableView*>(this), m_start, m_end, m_limit);
     }
 
     do_sort(m_descriptor_ordering);
+    if (stopped_early) {
+        // Only the objects that can pass the limit were found, so the ones
+        // excluded by it are counted
+        m_limit_count = m_query.count() - size();
+    }
 
     m_last_seen_versions = get_dependency_versions();
 }
@@ -671,9 +680,11 @@ void ConstTableView::do_sort(const DescriptorOrdering& ordering)
         BaseDescriptor::Sorter predicate = base_descr->sorter(*m_table, index_pairs);
 
         // Sorting can be specified by multiple columns, so that if two entries in the first column are
-        // identical, then the rows are ordered according to the second column, and so forth. For the
-        // first column, we cache all the payload of fields of the view in a std::vector<Mixed>
-        predicate.cache_first_column(index_pairs);
+        // identical, then the rows are ordered according to the second column, and so forth. The values
+        // of all these columns are read once up front, so that comparing rows does not look up objects.
+        predicate.cache_columns(index_pairs);
+        predicate.set_threads(m_query.get_threads());
+        predicate.set_unique_objects(!m_linklist_source && !m_linkset_source && !m_source_column_key);
 
         base_descr->execute(index_pairs, predicate, next);
     }
@@ -438,6 +438,16 @@ std::string case_map(StringData source, bool upper, IgnoreErrorsTag)
     return case_map(source, upper).value_or("");
 }
 
+std::string case_fold_ascii(StringData source)
+{
+    std::string result(source.data(), source.size());
+    for (char& c : result) {
+        if (c >= 'A' && c <= 'Z')
+            c = char(c + ('a' - 'A'));
+    }
+    return result;
+}
+
 // If needle == haystack, return true. NOTE: This function first
 // performs a case insensitive *byte* compare instead of one whole
 // UTF-8 character at a time. This is very fast, but not enough to
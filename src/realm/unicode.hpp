@@ -139,6 +139,11 @@ util::Optional<std::string> case_map(StringData source, bool upper);
 enum IgnoreErrorsTag { IgnoreErrors };
 std::string case_map(StringData source, bool upper, IgnoreErrorsTag);
 
+/// Lower case the ASCII letters of \a source and leave all other bytes
+/// untouched. Unlike case_map() the result is the same on all platforms, so
+/// it can be used for data that is stored in the file.
+std::string case_fold_ascii(StringData source);
+
 /// Assumes that the sizes of \a needle_upper and \a needle_lower are
 /// identical to the size of \a haystack. Returns false if the needle
 /// is different from the haystack.
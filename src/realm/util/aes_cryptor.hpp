@@ -35,6 +35,7 @@
 #else
 #include <openssl/sha.h>
 #include <openssl/evp.h>
+#include <openssl/rand.h>
 #endif
 
 namespace realm {
@@ -53,6 +54,17 @@ public:
     bool read(FileDesc fd, off_t pos, char* dst, size_t size);
     void write(FileDesc fd, off_t pos, const char* src, size_t size) noexcept;
 
+    // Blocks are either encrypted with AES-CBC and authenticated with a
+    // separate HMAC-SHA224, or encrypted and authenticated in one pass with
+    // AES-GCM. Both can be read, and blocks are written in the format of the
+    // first block of the file. AES-GCM is only available with OpenSSL.
+    bool uses_gcm(FileDesc fd) noexcept;
+
+    // Rewrite the blocks in [pos, pos + size) which are in the AES-CBC format
+    // with AES-GCM, and write all blocks with AES-GCM from now on. Returns
+    // false if AES-GCM is not available.
+    bool upgrade(FileDesc fd, off_t pos, size_t size);
+
 private:
     enum EncryptionMode {
 #if REALM_PLATFORM_APPLE
@@ -73,18 +85,33 @@ private:
 #elif defined(_WIN32)
     BCRYPT_KEY_HANDLE m_aes_key_handle;
 #else
-    uint8_t m_aesKey[32];
-    EVP_CIPHER_CTX* m_ctx;
+    EVP_CIPHER_CTX* m_encr;
+    EVP_CIPHER_CTX* m_decr;
+    EVP_CIPHER_CTX* m_gcm_encr;
+    EVP_CIPHER_CTX* m_gcm_decr;
 #endif
+    bool m_write_format_known = false;
+    bool m_write_gcm = false;
 
     uint8_t m_hmacKey[32];
+#if !REALM_PLATFORM_APPLE && !defined(_WIN32)
+    // Hash states after absorbing the inner and outer padded key, so that
+    // computing an hmac does not need to hash the key again for every block
+    SHA256_CTX m_hmac_inner;
+    SHA256_CTX m_hmac_outer;
+#endif
     std::vector<iv_table> m_iv_buffer;
     std::unique_ptr<char[]> m_rw_buffer;
     std::unique_ptr<char[]> m_dst_buffer;
+    std::unique_ptr<char[]> m_upgrade_buffer;
 
-    void calc_hmac(const void* src, size_t len, uint8_t* dst, const uint8_t* key) const;
+    void calc_hmac(const void* src, size_t len, uint8_t* dst) const;
     bool check_hmac(const void* data, size_t len, const uint8_t* hmac) const;
+    bool read_block(FileDesc fd, off_t pos, const char* src, size_t src_size, char* dst);
+    bool decrypt(off_t pos, const char* src, size_t src_size, const uint32_t& stored_iv, const uint8_t* hmac);
     void crypt(EncryptionMode mode, off_t pos, char* dst, const char* src, const char* stored_iv) noexcept;
+    void gcm_encrypt(off_t pos, char* dst, const char* src, uint32_t& stored_iv, uint8_t* hmac) noexcept;
+    bool gcm_decrypt(off_t pos, char* dst, const char* src, uint32_t stored_iv, const uint8_t* hmac) noexcept;
     iv_table& get_iv_table(FileDesc fd, off_t data_pos) noexcept;
     void handle_error();
 };
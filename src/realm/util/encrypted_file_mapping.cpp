@@ -51,6 +51,8 @@
 namespace realm {
 namespace util {
 
+DecryptedPageCounters decrypted_page_counters;
+
 SharedFileInfo::SharedFileInfo(const uint8_t* key, FileDesc file_descriptor)
     : fd(file_descriptor)
     , cryptor(key)
@@ -78,6 +80,15 @@ SharedFileInfo::SharedFileInfo(const uint8_t* key, FileDesc file_descriptor)
 // ciphertext. This ensures that if an error occurs between writing the IV and
 // the ciphertext, we can still determine that we should use the old IV, since
 // the ciphertext's hash will match the old ciphertext.
+//
+// Blocks written with AES-GCM store the authentication tag in place of the
+// hash, and need no separate hashing pass. Each write draws a random 96 bit
+// nonce, which is stored in the IV field and the rest of the hash field, so
+// the same key and nonce are never used twice however often a block at some
+// position is written, in this or in another file. The field ends with a
+// marker and the version of the format. The old and the new pair of each
+// block are checked in the format indicated by their own marker, so files may
+// mix both formats while being upgraded.
 
 struct iv_table {
     uint32_t iv1;
@@ -93,6 +104,29 @@ const size_t block_size = 4096;
 const size_t metadata_size = sizeof(iv_table);
 const size_t blocks_per_metadata_block = block_size / metadata_size;
 
+// AESCryptor::read() fetches the ciphertext of up to this many consecutive
+// blocks with a single read
+const size_t blocks_per_read = 16;
+
+const size_t gcm_iv_size = 12;
+const size_t gcm_tag_size = 16;
+// The part of the nonce which does not fit in the IV field follows the tag
+const size_t gcm_nonce_tail_size = gcm_iv_size - sizeof(uint32_t);
+const size_t gcm_marker_offset = gcm_tag_size + gcm_nonce_tail_size;
+const uint8_t gcm_marker[3] = {'G', 'C', 'M'};
+const uint8_t gcm_format_version = 2;
+static_assert(gcm_marker_offset + sizeof(gcm_marker) + 1 == sizeof(iv_table::hmac1), "");
+
+bool has_gcm_marker(const uint8_t* hmac) noexcept
+{
+    return memcmp(hmac + gcm_marker_offset, gcm_marker, sizeof(gcm_marker)) == 0;
+}
+
+bool is_gcm(const uint8_t* hmac) noexcept
+{
+    return has_gcm_marker(hmac) && hmac[gcm_marker_offset + sizeof(gcm_marker)] == gcm_format_version;
+}
+
 // map an offset in the data to the actual location in the file
 template <typename Int>
 Int real_offset(Int pos)
@@ -143,8 +177,9 @@ size_t check_read(FileDesc fd, off_t pos, void* dst, size_t len)
 } // anonymous namespace
 
 AESCryptor::AESCryptor(const uint8_t* key)
-    : m_rw_buffer(new char[block_size]),
-      m_dst_buffer(new char[block_size])
+    : m_rw_buffer(new char[blocks_per_read * block_size]),
+      m_dst_buffer(new char[block_size]),
+      m_upgrade_buffer(new char[block_size])
 {
 #if REALM_PLATFORM_APPLE
     // A random iv is passed to CCCryptorReset. This iv is *not used* by Realm; we set it manually prior to
@@ -168,14 +203,56 @@ AESCryptor::AESCryptor(const uint8_t* key)
     ret = BCryptGenerateSymmetricKey(hAesAlg, &m_aes_key_handle, nullptr, 0, (PBYTE)key, 32, 0);
     REALM_ASSERT_RELEASE_EX(ret == 0 && "BCryptGenerateSymmetricKey()", ret);
 #else
-    m_ctx = EVP_CIPHER_CTX_new();
+    // The key schedule is computed once here, and crypt() only sets the iv
+    m_encr = EVP_CIPHER_CTX_new();
+    m_decr = EVP_CIPHER_CTX_new();
 
-    if (!m_ctx)
+    if (!m_encr || !m_decr)
+        handle_error();
+    if (!EVP_CipherInit_ex(m_encr, EVP_aes_256_cbc(), NULL, key, NULL, mode_Encrypt))
+        handle_error();
+    if (!EVP_CipherInit_ex(m_decr, EVP_aes_256_cbc(), NULL, key, NULL, mode_Decrypt))
         handle_error();
 
-    memcpy(m_aesKey, key, 32);
+    // AES-GCM uses a key of its own, derived from the whole key, so that no
+    // key is used with two modes
+    uint8_t gcm_key[SHA256_DIGEST_LENGTH];
+    {
+        static const char label[] = "Realm AES-GCM page key";
+        SHA256_CTX ctx;
+        SHA256_Init(&ctx);
+        SHA256_Update(&ctx, label, sizeof(label) - 1);
+        SHA256_Update(&ctx, key, 64);
+        SHA256_Final(gcm_key, &ctx);
+    }
+    m_gcm_encr = EVP_CIPHER_CTX_new();
+    m_gcm_decr = EVP_CIPHER_CTX_new();
+    if (!m_gcm_encr || !m_gcm_decr)
+        handle_error();
+    if (!EVP_CipherInit_ex(m_gcm_encr, EVP_aes_256_gcm(), NULL, gcm_key, NULL, mode_Encrypt))
+        handle_error();
+    if (!EVP_CipherInit_ex(m_gcm_decr, EVP_aes_256_gcm(), NULL, gcm_key, NULL, mode_Decrypt))
+        handle_error();
+    memset(gcm_key, 0, sizeof(gcm_key));
 #endif
     memcpy(m_hmacKey, key + 32, 32);
+
+#if !REALM_PLATFORM_APPLE && !defined(_WIN32)
+    uint8_t ipad[64];
+    for (size_t i = 0; i < 32; ++i)
+        ipad[i] = m_hmacKey[i] ^ 0x36;
+    memset(ipad + 32, 0x36, 32);
+
+    uint8_t opad[64];
+    for (size_t i = 0; i < 32; ++i)
+        opad[i] = m_hmacKey[i] ^ 0x5C;
+    memset(opad + 32, 0x5C, 32);
+
+    SHA224_Init(&m_hmac_inner);
+    SHA256_Update(&m_hmac_inner, ipad, 64);
+    SHA224_Init(&m_hmac_outer);
+    SHA256_Update(&m_hmac_outer, opad, 64);
+#endif
 }
 
 AESCryptor::~AESCryptor() noexcept
@@ -185,8 +262,10 @@ AESCryptor::~AESCryptor() noexcept
     CCCryptorRelease(m_decr);
 #elif defined(_WIN32)
 #else
-    EVP_CIPHER_CTX_cleanup(m_ctx);
-    EVP_CIPHER_CTX_free(m_ctx);
+    EVP_CIPHER_CTX_free(m_encr);
+    EVP_CIPHER_CTX_free(m_decr);
+    EVP_CIPHER_CTX_free(m_gcm_encr);
+    EVP_CIPHER_CTX_free(m_gcm_decr);
 #endif
 }
 
@@ -228,7 +307,7 @@ iv_table& AESCryptor::get_iv_table(FileDesc fd, off_t data_pos) noexcept
 bool AESCryptor::check_hmac(const void* src, size_t len, const uint8_t* hmac) const
 {
     uint8_t buffer[224 / 8];
-    calc_hmac(src, len, buffer, m_hmacKey);
+    calc_hmac(src, len, buffer);
 
     // Constant-time memcmp to avoid timing attacks
     uint8_t result = 0;
@@ -241,83 +320,152 @@ bool AESCryptor::read(FileDesc fd, off_t pos, char* dst, size_t size)
 {
     REALM_ASSERT(size % block_size == 0);
     while (size > 0) {
-        ssize_t bytes_read = check_read(fd, real_offset(pos), m_rw_buffer.get(), block_size);
+        // Consecutive blocks are stored consecutively in the file up to the
+        // next metadata block, so fetch as many of them as possible at once
+        size_t index = size_t(pos) / block_size;
+        size_t num_blocks = std::min(size / block_size, blocks_per_read);
+        num_blocks = std::min(num_blocks, blocks_per_metadata_block - index % blocks_per_metadata_block);
+        size_t bytes_read = check_read(fd, real_offset(pos), m_rw_buffer.get(), num_blocks * block_size);
+
+        for (size_t i = 0; i < num_blocks; ++i) {
+            if (bytes_read <= i * block_size)
+                return false;
+            const char* src = m_rw_buffer.get() + i * block_size;
+            size_t src_size = std::min(bytes_read - i * block_size, block_size);
+            if (!read_block(fd, pos, src, src_size, dst))
+                return false;
 
-        if (bytes_read == 0)
-            return false;
+            pos += block_size;
+            dst += block_size;
+            size -= block_size;
+        }
+    }
+    return true;
+}
 
-        iv_table& iv = get_iv_table(fd, pos);
-        if (iv.iv1 == 0) {
-            // This block has never been written to, so we've just read pre-allocated
-            // space. No memset() since the code using this doesn't rely on
-            // pre-allocated space being zeroed.
+bool AESCryptor::read_block(FileDesc fd, off_t pos, const char* src, size_t src_size, char* dst)
+{
+    iv_table& iv = get_iv_table(fd, pos);
+    if (iv.iv1 == 0) {
+        // This block has never been written to, so we've just read pre-allocated
+        // space. No memset() since the code using this doesn't rely on
+        // pre-allocated space being zeroed.
+        return false;
+    }
+
+    if (!decrypt(pos, src, src_size, iv.iv1, iv.hmac1)) {
+        // Either the DB is corrupted or we were interrupted between writing the
+        // new IV and writing the data
+        if (iv.iv2 == 0) {
+            // Very first write was interrupted
             return false;
         }
 
-        if (!check_hmac(m_rw_buffer.get(), bytes_read, iv.hmac1)) {
-            // Either the DB is corrupted or we were interrupted between writing the
-            // new IV and writing the data
-            if (iv.iv2 == 0) {
-                // Very first write was interrupted
-                return false;
-            }
-
-            if (check_hmac(m_rw_buffer.get(), bytes_read, iv.hmac2)) {
-                // Un-bump the IV since the write with the bumped IV never actually
-                // happened
-                memcpy(&iv.iv1, &iv.iv2, 32);
-            }
-            else {
-                // If the file has been shrunk and then re-expanded, we may have
-                // old hmacs that don't go with this data. ftruncate() is
-                // required to fill any added space with zeroes, so assume that's
-                // what happened if the buffer is all zeroes
-                for (ssize_t i = 0; i < bytes_read; ++i) {
-                    if (m_rw_buffer[i] != 0)
-                        throw DecryptionFailed();
-                }
-                return false;
+        if (decrypt(pos, src, src_size, iv.iv2, iv.hmac2)) {
+            // Un-bump the IV since the write with the bumped IV never actually
+            // happened
+            memcpy(&iv.iv1, &iv.iv2, 32);
+        }
+        else {
+            // If the file has been shrunk and then re-expanded, we may have
+            // old hmacs that don't go with this data. ftruncate() is
+            // required to fill any added space with zeroes, so assume that's
+            // what happened if the buffer is all zeroes
+            for (size_t i = 0; i < src_size; ++i) {
+                if (src[i] != 0)
+                    throw DecryptionFailed();
             }
+            return false;
         }
+    }
 
-        // We may expect some adress ranges of the destination buffer of
-        // AESCryptor::read() to stay unmodified, i.e. being overwritten with
-        // the same bytes as already present, and may have read-access to these
-        // from other threads while decryption is taking place.
-        //
-        // However, some implementations of AES_cbc_encrypt(), in particular
-        // OpenSSL, will put garbled bytes as an intermediate step during the
-        // operation which will lead to incorrect data being read by other
-        // readers concurrently accessing that page. Incorrect data leads to
-        // crashes.
-        //
-        // We therefore decrypt to a temporary buffer first and then copy the
-        // completely decrypted data after.
-        crypt(mode_Decrypt, pos, m_dst_buffer.get(), m_rw_buffer.get(), reinterpret_cast<const char*>(&iv.iv1));
-        memcpy(dst, m_dst_buffer.get(), block_size);
+    // We may expect some adress ranges of the destination buffer of
+    // AESCryptor::read() to stay unmodified, i.e. being overwritten with
+    // the same bytes as already present, and may have read-access to these
+    // from other threads while decryption is taking place.
+    //
+    // However, some implementations of AES_cbc_encrypt(), in particular
+    // OpenSSL, will put garbled bytes as an intermediate step during the
+    // operation which will lead to incorrect data being read by other
+    // readers concurrently accessing that page. Incorrect data leads to
+    // crashes.
+    //
+    // We therefore decrypt to a temporary buffer first and then copy the
+    // completely decrypted data after.
+    memcpy(dst, m_dst_buffer.get(), block_size);
+    return true;
+}
 
-        pos += block_size;
-        dst += block_size;
-        size -= block_size;
+bool AESCryptor::decrypt(off_t pos, const char* src, size_t src_size, const uint32_t& stored_iv,
+                         const uint8_t* hmac)
+{
+    // On success, the plaintext is left in m_dst_buffer
+    if (is_gcm(hmac) && src_size == block_size && gcm_decrypt(pos, m_dst_buffer.get(), src, stored_iv, hmac))
+        return true;
+    // The hmac of an AES-CBC block may end like a marker by chance
+    if (!check_hmac(src, src_size, hmac)) {
+        // Written in a version of the AES-GCM format which we do not know
+        if (has_gcm_marker(hmac) && !is_gcm(hmac))
+            throw UnsupportedEncryptionFormat();
+        return false;
     }
+    crypt(mode_Decrypt, pos, m_dst_buffer.get(), src, reinterpret_cast<const char*>(&stored_iv));
     return true;
 }
 
+bool AESCryptor::uses_gcm(FileDesc fd) noexcept
+{
+    if (!m_write_format_known) {
+        iv_table& iv = get_iv_table(fd, 0);
+        m_write_gcm = iv.iv1 != 0 && is_gcm(iv.hmac1);
+        m_write_format_known = true;
+    }
+    return m_write_gcm;
+}
+
+bool AESCryptor::upgrade(FileDesc fd, off_t pos, size_t size)
+{
+    REALM_ASSERT(size % block_size == 0);
+#if REALM_PLATFORM_APPLE || defined(_WIN32)
+    static_cast<void>(fd);
+    static_cast<void>(pos);
+    return false;
+#else
+    m_write_gcm = true;
+    m_write_format_known = true;
+    for (; size > 0; pos += block_size, size -= block_size) {
+        iv_table& iv = get_iv_table(fd, pos);
+        if (iv.iv1 == 0 || is_gcm(iv.hmac1))
+            continue;
+        // Blocks which cannot be read hold no data
+        if (read(fd, pos, m_upgrade_buffer.get(), block_size))
+            write(fd, pos, m_upgrade_buffer.get(), block_size);
+    }
+    return true;
+#endif
+}
+
 void AESCryptor::write(FileDesc fd, off_t pos, const char* src, size_t size) noexcept
 {
     REALM_ASSERT(size % block_size == 0);
+    bool gcm = uses_gcm(fd);
     while (size > 0) {
         iv_table& iv = get_iv_table(fd, pos);
 
         memcpy(&iv.iv2, &iv.iv1, 32);
         do {
-            ++iv.iv1;
-            // 0 is reserved for never-been-used, so bump if we just wrapped around
-            if (iv.iv1 == 0)
+            if (gcm) {
+                // Draws a new nonce
+                gcm_encrypt(pos, m_rw_buffer.get(), src, iv.iv1, iv.hmac1);
+            }
+            else {
                 ++iv.iv1;
-
-            crypt(mode_Encrypt, pos, m_rw_buffer.get(), src, reinterpret_cast<const char*>(&iv.iv1));
-            calc_hmac(m_rw_buffer.get(), block_size, iv.hmac1, m_hmacKey);
+                // 0 is reserved for never-been-used, so bump if we just wrapped around
+                if (iv.iv1 == 0)
+                    ++iv.iv1;
+                crypt(mode_Encrypt, pos, m_rw_buffer.get(), src, reinterpret_cast<const char*>(&iv.iv1));
+                calc_hmac(m_rw_buffer.get(), block_size, iv.hmac1);
+            }
             // In the extremely unlikely case that both the old and new versions have
             // the same hash we won't know which IV to use, so bump the IV until
             // they're different.
@@ -367,28 +515,99 @@ void AESCryptor::crypt(EncryptionMode mode, off_t pos, char* dst, const char* sr
     }
 
 #else
-    if (!EVP_CipherInit_ex(m_ctx, EVP_aes_256_cbc(), NULL, m_aesKey, iv, mode))
+    EVP_CIPHER_CTX* ctx = mode == mode_Encrypt ? m_encr : m_decr;
+    // Keep the key schedule set up by the constructor and only reset the iv
+    if (!EVP_CipherInit_ex(ctx, NULL, NULL, NULL, iv, -1))
         handle_error();
 
     int len;
     // Use zero padding - we always write a whole page
-    EVP_CIPHER_CTX_set_padding(m_ctx, 0);
+    EVP_CIPHER_CTX_set_padding(ctx, 0);
 
-    if (!EVP_CipherUpdate(m_ctx, reinterpret_cast<uint8_t*>(dst), &len, reinterpret_cast<const uint8_t*>(src),
+    if (!EVP_CipherUpdate(ctx, reinterpret_cast<uint8_t*>(dst), &len, reinterpret_cast<const uint8_t*>(src),
                           block_size))
         handle_error();
 
     // Finalize the encryption. Should not output further data.
-    if (!EVP_CipherFinal_ex(m_ctx, reinterpret_cast<uint8_t*>(dst) + len, &len))
+    if (!EVP_CipherFinal_ex(ctx, reinterpret_cast<uint8_t*>(dst) + len, &len))
         handle_error();
 #endif
 }
 
-void AESCryptor::calc_hmac(const void* src, size_t len, uint8_t* dst, const uint8_t* key) const
+void AESCryptor::gcm_encrypt(off_t pos, char* dst, const char* src, uint32_t& stored_iv, uint8_t* hmac) noexcept
 {
-#if REALM_PLATFORM_APPLE
-    CCHmac(kCCHmacAlgSHA224, key, 32, src, len, dst);
+#if REALM_PLATFORM_APPLE || defined(_WIN32)
+    static_cast<void>(pos);
+    static_cast<void>(dst);
+    static_cast<void>(src);
+    static_cast<void>(stored_iv);
+    static_cast<void>(hmac);
+    REALM_UNREACHABLE();
+#else
+    uint8_t iv[gcm_iv_size];
+    do {
+        if (RAND_bytes(iv, gcm_iv_size) != 1)
+            handle_error();
+        memcpy(&stored_iv, iv, sizeof(stored_iv));
+        // 0 is reserved for never-been-used
+    } while (stored_iv == 0);
+    memcpy(hmac + gcm_tag_size, iv + sizeof(stored_iv), gcm_nonce_tail_size);
+
+    // The position is authenticated, so a block cannot be moved elsewhere
+    // along with its metadata
+    int len;
+    if (!EVP_CipherInit_ex(m_gcm_encr, NULL, NULL, NULL, iv, -1))
+        handle_error();
+    if (!EVP_CipherUpdate(m_gcm_encr, NULL, &len, reinterpret_cast<const uint8_t*>(&pos), sizeof(pos)))
+        handle_error();
+    if (!EVP_CipherUpdate(m_gcm_encr, reinterpret_cast<uint8_t*>(dst), &len,
+                          reinterpret_cast<const uint8_t*>(src), block_size))
+        handle_error();
+    if (!EVP_CipherFinal_ex(m_gcm_encr, reinterpret_cast<uint8_t*>(dst) + len, &len))
+        handle_error();
+    if (!EVP_CIPHER_CTX_ctrl(m_gcm_encr, EVP_CTRL_GCM_GET_TAG, gcm_tag_size, hmac))
+        handle_error();
+    memcpy(hmac + gcm_marker_offset, gcm_marker, sizeof(gcm_marker));
+    hmac[gcm_marker_offset + sizeof(gcm_marker)] = gcm_format_version;
+#endif
+}
+
+bool AESCryptor::gcm_decrypt(off_t pos, char* dst, const char* src, uint32_t stored_iv, const uint8_t* hmac) noexcept
+{
+#if REALM_PLATFORM_APPLE || defined(_WIN32)
+    // Written by a build using OpenSSL
+    static_cast<void>(pos);
+    static_cast<void>(dst);
+    static_cast<void>(src);
+    static_cast<void>(stored_iv);
+    static_cast<void>(hmac);
+    return false;
 #else
+    uint8_t iv[gcm_iv_size];
+    memcpy(iv, &stored_iv, sizeof(stored_iv));
+    memcpy(iv + sizeof(stored_iv), hmac + gcm_tag_size, gcm_nonce_tail_size);
+
+    int len;
+    if (!EVP_CipherInit_ex(m_gcm_decr, NULL, NULL, NULL, iv, -1))
+        handle_error();
+    if (!EVP_CipherUpdate(m_gcm_decr, NULL, &len, reinterpret_cast<const uint8_t*>(&pos), sizeof(pos)))
+        handle_error();
+    if (!EVP_CipherUpdate(m_gcm_decr, reinterpret_cast<uint8_t*>(dst), &len,
+                          reinterpret_cast<const uint8_t*>(src), block_size))
+        handle_error();
+    if (!EVP_CIPHER_CTX_ctrl(m_gcm_decr, EVP_CTRL_GCM_SET_TAG, gcm_tag_size, const_cast<uint8_t*>(hmac)))
+        handle_error();
+    // Fails if the tag does not match
+    return EVP_CipherFinal_ex(m_gcm_decr, reinterpret_cast<uint8_t*>(dst) + len, &len) > 0;
+#endif
+}
+
+void AESCryptor::calc_hmac(const void* src, size_t len, uint8_t* dst) const
+{
+#if REALM_PLATFORM_APPLE
+    CCHmac(kCCHmacAlgSHA224, m_hmacKey, 32, src, len, dst);
+#elif defined(_WIN32)
+    const uint8_t* key = m_hmacKey;
     uint8_t ipad[64];
     for (size_t i = 0; i < 32; ++i)
         ipad[i] = key[i] ^ 0x36;
@@ -400,7 +619,6 @@ void AESCryptor::calc_hmac(const void* src, size_t len, uint8_t* dst, const uint
     memset(opad + 32, 0x5C, 32);
 
     // Full hmac operation is sha224(opad + sha224(ipad + data))
-#ifdef _WIN32
     sha224_state s;
     sha_init(s);
     sha_process(s, ipad, 64);
@@ -412,19 +630,16 @@ void AESCryptor::calc_hmac(const void* src, size_t len, uint8_t* dst, const uint
     sha_process(s, dst, 28); // 28 == SHA224_DIGEST_LENGTH
     sha_done(s, dst);
 #else
-    SHA256_CTX ctx;
-    SHA224_Init(&ctx);
-    SHA256_Update(&ctx, ipad, 64);
+    // Full hmac operation is sha224(opad + sha224(ipad + data)), where the
+    // padded keys have already been hashed by the constructor
+    SHA256_CTX ctx = m_hmac_inner;
     SHA256_Update(&ctx, static_cast<const uint8_t*>(src), len);
     SHA256_Final(dst, &ctx);
 
-    SHA224_Init(&ctx);
-    SHA256_Update(&ctx, opad, 64);
+    ctx = m_hmac_outer;
     SHA256_Update(&ctx, dst, SHA224_DIGEST_LENGTH);
     SHA256_Final(dst, &ctx);
 #endif
-
-#endif
 }
 
 EncryptedFileMapping::EncryptedFileMapping(SharedFileInfo& file, size_t file_offset, void* addr, size_t size,
@@ -503,6 +718,7 @@ void EncryptedFileMapping::refresh_page(size_t local_page_ndx)
     REALM_ASSERT_EX(local_page_ndx < m_page_state.size(), local_page_ndx, m_page_state.size());
 
     char* addr = page_addr(local_page_ndx);
+    ++decrypted_page_counters.misses;
 
     if (!copy_up_to_date_page(local_page_ndx)) {
         size_t page_ndx_in_file = local_page_ndx + m_first_page;
@@ -513,6 +729,68 @@ void EncryptedFileMapping::refresh_page(size_t local_page_ndx)
         m_num_decrypted++;
     clear(m_page_state[local_page_ndx], PartiallyUpToDate);
     set(m_page_state[local_page_ndx], UpToDate);
+
+    if (local_page_ndx == m_next_sequential_page) {
+        size_t max_pages = std::max(max_read_ahead_size >> m_page_shift, size_t(1));
+        m_read_ahead = std::min(std::max(m_read_ahead * 2, size_t(1)), max_pages);
+    }
+    else {
+        m_read_ahead = 0;
+    }
+    m_next_sequential_page = local_page_ndx + 1;
+    if (m_read_ahead > 0)
+        read_ahead(local_page_ndx + 1);
+}
+
+void EncryptedFileMapping::read_ahead(size_t local_page_ndx) noexcept
+{
+    // Decrypt the next m_read_ahead pages which are not up to date. Pages
+    // which are (partially) up to date are skipped, since readers may be
+    // accessing them. The pages are not marked as touched, so the reclaimer
+    // releases them again if they turn out not to be needed.
+    size_t end = std::min(local_page_ndx + m_read_ahead, m_page_state.size());
+    size_t run_begin = local_page_ndx;
+
+    // Decrypt the pages in [run_begin, run_end) with a single read. Errors
+    // are left to be reported when a page is actually accessed.
+    auto decrypt_run = [&](size_t run_end) {
+        if (run_begin == run_end)
+            return true;
+        size_t page_ndx_in_file = run_begin + m_first_page;
+        bool success;
+        try {
+            success = m_file.cryptor.read(m_file.fd, off_t(page_ndx_in_file << m_page_shift),
+                                          page_addr(run_begin), (run_end - run_begin) << m_page_shift);
+        }
+        catch (const std::exception&) {
+            success = false;
+        }
+        if (!success) {
+            // Probably reached space which has not been written yet
+            m_read_ahead = 0;
+            return false;
+        }
+        for (size_t i = run_begin; i < run_end; ++i) {
+            set(m_page_state[i], UpToDate);
+            m_num_decrypted++;
+        }
+        return true;
+    };
+
+    for (size_t i = local_page_ndx; i < end; ++i) {
+        if (is_not(m_page_state[i], UpToDate | PartiallyUpToDate) && !copy_up_to_date_page(i))
+            continue; // extend the current run
+        if (!decrypt_run(i))
+            return;
+        if (is_not(m_page_state[i], UpToDate | PartiallyUpToDate)) {
+            // Copied from another mapping
+            set(m_page_state[i], UpToDate);
+            m_num_decrypted++;
+        }
+        run_begin = i + 1;
+    }
+    if (decrypt_run(end))
+        m_next_sequential_page = end;
 }
 
 void EncryptedFileMapping::write_page(size_t local_page_ndx) noexcept
@@ -654,6 +932,7 @@ void EncryptedFileMapping::reclaim_untouched(size_t& progress_index, size_t& wor
                 clear(m_page_state[page_ndx], UpToDate | PartiallyUpToDate);
                 reclaim_page(page_ndx);
                 m_num_decrypted--;
+                ++decrypted_page_counters.evictions;
                 done_some_work();
             }
             contiguous_scan = false;
@@ -799,6 +1078,8 @@ void EncryptedFileMapping::read_barrier(const void* addr, size_t size, Header_to
             set(ps, Touched);
         if (is_not(ps, UpToDate))
             refresh_page(first_accessed_local_page);
+        else
+            ++decrypted_page_counters.hits;
     }
 
     // force the page reclaimer to look into pages in this chunk:
@@ -830,6 +1111,8 @@ void EncryptedFileMapping::read_barrier(const void* addr, size_t size, Header_to
             set(ps, Touched);
         if (is_not(ps, UpToDate))
             refresh_page(idx);
+        else
+            ++decrypted_page_counters.hits;
     }
 }
 
@@ -849,6 +1132,8 @@ void EncryptedFileMapping::set(void* new_addr, size_t new_size, size_t new_file_
     size_t num_pages = new_size >> m_page_shift;
 
     m_num_decrypted = 0;
+    m_next_sequential_page = 0;
+    m_read_ahead = 0;
     m_page_state.clear();
     m_chunk_dont_scan.clear();
 
@@ -869,6 +1154,30 @@ File::SizeType data_size_to_encrypted_size(File::SizeType size) noexcept
     return real_offset((size + ps - 1) & ~(ps - 1));
 }
 
+bool upgrade_encryption(const std::string& path, const char* key)
+{
+    File file(path, File::mode_Update); // Throws
+    size_t size = size_t(encrypted_size_to_data_size(file.get_size())) & ~(block_size - 1);
+    if (size == 0)
+        return false;
+
+    AESCryptor cryptor(reinterpret_cast<const uint8_t*>(key));
+    cryptor.set_file_size(off_t(size));
+    FileDesc fd = file.get_descriptor();
+    if (cryptor.uses_gcm(fd))
+        return false;
+
+    // Later writes use the format of the first block, so it is upgraded last,
+    // once all other blocks have reached the disk. Should this be
+    // interrupted, the next attempt starts over.
+    if (!cryptor.upgrade(fd, off_t(block_size), size - block_size)) // Throws
+        return false;
+    file.sync();                        // Throws
+    cryptor.upgrade(fd, 0, block_size); // Throws
+    file.sync();                        // Throws
+    return true;
+}
+
 #else
 
 namespace realm {
@@ -884,6 +1193,11 @@ File::SizeType data_size_to_encrypted_size(File::SizeType size) noexcept
     return size;
 }
 
+bool upgrade_encryption(const std::string&, const char*)
+{
+    return false;
+}
+
 #endif // REALM_ENABLE_ENCRYPTION
 
 } // namespace util {
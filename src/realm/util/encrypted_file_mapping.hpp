@@ -35,6 +35,15 @@ namespace util {
 struct SharedFileInfo;
 class EncryptedFileMapping;
 
+// Counters for the decrypted pages of all encrypted files of the process.
+// Only accessed while holding mapping_mutex.
+struct DecryptedPageCounters {
+    uint64_t hits = 0;      // pages found up to date by a read barrier
+    uint64_t misses = 0;    // pages a read barrier had to decrypt (or copy from another mapping)
+    uint64_t evictions = 0; // pages released by the reclaimer
+};
+extern DecryptedPageCounters decrypted_page_counters;
+
 class EncryptedFileMapping {
 public:
     // Adds the newly-created object to file.mappings iff it's successfully constructed
@@ -95,6 +104,14 @@ private:
     size_t m_first_page;
     size_t m_num_decrypted; // 1 for every page decrypted
 
+    // Sequential access detection. When refresh_page() is asked for the page
+    // following the ones decrypted last, the pages after it are decrypted
+    // ahead of time as well, in bulk, doubling their number with every
+    // further sequential access up to max_read_ahead_size bytes.
+    size_t m_next_sequential_page = 0;
+    size_t m_read_ahead = 0; // in pages
+    static constexpr size_t max_read_ahead_size = 256 * 1024;
+
     enum PageState {
         Touched = 1,           // a ref->ptr translation has taken place
         UpToDate = 2,          // the page is fully up to date
@@ -135,6 +152,7 @@ private:
     void mark_outdated(size_t local_page_ndx) noexcept;
     bool copy_up_to_date_page(size_t local_page_ndx) noexcept;
     void refresh_page(size_t local_page_ndx);
+    void read_ahead(size_t local_page_ndx) noexcept;
     void write_page(size_t local_page_ndx) noexcept;
     void write_and_update_all(size_t local_page_ndx, size_t begin_offset, size_t end_offset) noexcept;
     void reclaim_page(size_t page_ndx);
@@ -170,8 +188,17 @@ namespace util {
 /// Thrown by EncryptedFileMapping if a file opened is non-empty and does not
 /// contain valid encrypted data
 struct DecryptionFailed : util::File::AccessError {
-    DecryptionFailed()
-        : util::File::AccessError("Decryption failed", std::string())
+    DecryptionFailed(const std::string& msg = "Decryption failed")
+        : util::File::AccessError(msg, std::string())
+    {
+    }
+};
+
+/// Thrown by EncryptedFileMapping if a block of a file opened is encrypted in
+/// a format written by a later version
+struct UnsupportedEncryptionFormat : DecryptionFailed {
+    UnsupportedEncryptionFormat()
+        : DecryptionFailed("Unsupported encryption format")
     {
     }
 };
@@ -703,6 +703,23 @@ void File::resize(SizeType size)
 }
 
 
+void File::prefetch(SizeType offset, size_t size) noexcept
+{
+    REALM_ASSERT_DEBUG(is_attached());
+#if defined(POSIX_FADV_WILLNEED)
+    ::posix_fadvise(m_fd, off_t(offset), off_t(size), POSIX_FADV_WILLNEED);
+#elif REALM_PLATFORM_APPLE
+    struct radvisory advice;
+    advice.ra_offset = off_t(offset);
+    advice.ra_count = int(std::min(size, size_t(std::numeric_limits<int>::max())));
+    ::fcntl(m_fd, F_RDADVISE, &advice);
+#else
+    static_cast<void>(offset);
+    static_cast<void>(size);
+#endif
+}
+
+
 void File::prealloc(size_t size)
 {
     REALM_ASSERT_RELEASE(is_attached());
@@ -1161,9 +1178,12 @@ void File::unlock() noexcept
 }
 
 
-void* File::map(AccessMode a, size_t size, int /*map_flags*/, size_t offset) const
+void* File::map(AccessMode a, size_t size, int map_flags, size_t offset) const
 {
-    return realm::util::mmap(m_fd, size, a, offset, m_encryption_key.get());
+    void* addr = realm::util::mmap(m_fd, size, a, offset, m_encryption_key.get());
+    if (!m_encryption_key)
+        advise_map(addr, size, map_flags);
+    return addr;
 }
 
 void* File::map_fixed(AccessMode a, void* address, size_t size, int /* map_flags */, size_t offset) const
@@ -1190,9 +1210,12 @@ void* File::map_reserve(AccessMode a, size_t size, size_t offset) const
 }
 
 #if REALM_ENABLE_ENCRYPTION
-void* File::map(AccessMode a, size_t size, EncryptedFileMapping*& mapping, int /*map_flags*/, size_t offset) const
+void* File::map(AccessMode a, size_t size, EncryptedFileMapping*& mapping, int map_flags, size_t offset) const
 {
-    return realm::util::mmap(m_fd, size, a, offset, m_encryption_key.get(), mapping);
+    void* addr = realm::util::mmap(m_fd, size, a, offset, m_encryption_key.get(), mapping);
+    if (!m_encryption_key)
+        advise_map(addr, size, map_flags);
+    return addr;
 }
 
 void* File::map_fixed(AccessMode a, void* address, size_t size, EncryptedFileMapping* mapping, int /* map_flags */,
@@ -1235,10 +1258,13 @@ void File::unmap(void* addr, size_t size) noexcept
 }
 
 
-void* File::remap(void* old_addr, size_t old_size, AccessMode a, size_t new_size, int /*map_flags*/,
+void* File::remap(void* old_addr, size_t old_size, AccessMode a, size_t new_size, int map_flags,
                   size_t file_offset) const
 {
-    return realm::util::mremap(m_fd, file_offset, old_addr, old_size, a, new_size, m_encryption_key.get());
+    void* addr = realm::util::mremap(m_fd, file_offset, old_addr, old_size, a, new_size, m_encryption_key.get());
+    if (!m_encryption_key)
+        advise_map(addr, new_size, map_flags);
+    return addr;
 }
 
 
@@ -1248,6 +1274,36 @@ void File::sync_map(FileDesc fd, void* addr, size_t size)
 }
 
 
+void File::advise_map(void* addr, size_t size, int map_flags) noexcept
+{
+#ifndef _WIN32
+    if (size == 0 || (map_flags & (map_Sequential | map_Random | map_WillNeed | map_HugePages)) == 0)
+        return;
+    // madvise() requires a page aligned address
+    size_t offset = reinterpret_cast<uintptr_t>(addr) & (page_size() - 1);
+    char* base = static_cast<char*>(addr) - offset;
+    size += offset;
+    // The advice is only a hint, so failures are ignored
+    if (map_flags & map_Sequential) {
+        ::madvise(base, size, MADV_SEQUENTIAL);
+    }
+    else if (map_flags & map_Random) {
+        ::madvise(base, size, MADV_RANDOM);
+    }
+#ifdef MADV_HUGEPAGE
+    if (map_flags & map_HugePages)
+        ::madvise(base, size, MADV_HUGEPAGE);
+#endif
+    if (map_flags & map_WillNeed)
+        ::madvise(base, size, MADV_WILLNEED);
+#else
+    static_cast<void>(addr);
+    static_cast<void>(size);
+    static_cast<void>(map_flags);
+#endif
+}
+
+
 bool File::exists(const std::string& path)
 {
 #ifdef _WIN32
@@ -287,6 +287,15 @@ public:
     /// \sa prealloc_if_supported()
     void prealloc(size_t new_size);
 
+    /// Ask the system to read the specified region of the file into
+    /// the page cache in the background, if supported. The region is
+    /// given in bytes of the underlying file, also when the file is
+    /// encrypted. Failures are ignored, as this is only a hint.
+    ///
+    /// Calling this function on an instance that is not attached to
+    /// an open file has undefined behavior.
+    void prefetch(SizeType offset, size_t size) noexcept;
+
     /// When supported by the system, allocate space on the target
     /// device for the specified region of the file. If the region
     /// extends beyond the current end of the file, the file size is
@@ -379,7 +388,20 @@ public:
         /// the default behavior. An explicit call to sync_map() will
         /// flush the buffers regardless of whether this flag is
         /// specified or not.
-        map_NoSync = 1
+        map_NoSync = 1,
+
+        /// The remaining flags are hints about how the mapping will be
+        /// accessed, given to the kernel with madvise() where
+        /// available. They are ignored for encrypted files.
+
+        /// Pages will be accessed in order, read ahead aggressively.
+        map_Sequential = 2,
+        /// Pages will be accessed in random order, do not read ahead.
+        map_Random = 4,
+        /// Start reading the whole mapping into the page cache.
+        map_WillNeed = 8,
+        /// Back the mapping with transparent huge pages if possible.
+        map_HugePages = 16
     };
 
     /// Map this file into memory. The file is mapped as shared
@@ -436,6 +458,12 @@ public:
     /// map().
     static void sync_map(FileDesc fd, void* addr, size_t size);
 
+    /// Give the hints among \a map_flags to the kernel for the specified
+    /// address range, which must be (a subset of) one that was previously
+    /// returned by map() for a file that is not encrypted. Hints that are not
+    /// supported by the system are ignored.
+    static void advise_map(void* addr, size_t size, int map_flags) noexcept;
+
     /// Check whether the specified file or directory exists. Note
     /// that a file or directory that resides in a directory that the
     /// calling process has no access to, will necessarily be reported
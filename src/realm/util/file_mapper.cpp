@@ -119,6 +119,7 @@ static unsigned int file_reclaim_index = 0;
 static std::atomic<size_t> num_decrypted_pages(0); // this is for statistical purposes
 static std::atomic<size_t> reclaimer_target(0);    // do.
 static std::atomic<size_t> reclaimer_workload(0);  // do.
+static std::atomic<size_t> memory_budget(0);       // in bytes, see set_decrypted_memory_budget()
 // helpers
 
 int64_t fetch_value_in_file(const std::string& fname, const char* scan_pattern)
@@ -216,7 +217,7 @@ private:
 static DefaultGovernor default_governor;
 static PageReclaimGovernor* governor = &default_governor;
 
-void reclaim_pages();
+bool reclaim_pages();
 
 #if !REALM_PLATFORM_APPLE
 static std::atomic<bool> reclaimer_shutdown(false);
@@ -227,8 +228,8 @@ static void ensure_reclaimer_thread_runs()
     if (reclaimer_thread == nullptr) {
         reclaimer_thread = std::make_unique<std::thread>([] {
             while (!reclaimer_shutdown) {
-                reclaim_pages();
-                millisleep(1000);
+                bool over_budget = reclaim_pages();
+                millisleep(over_budget ? 100 : 1000);
             }
         });
     }
@@ -286,6 +287,18 @@ void set_page_reclaim_governor(PageReclaimGovernor* new_governor)
     ensure_reclaimer_thread_runs();
 }
 
+void set_decrypted_memory_budget(size_t bytes)
+{
+    UniqueLock lock(mapping_mutex);
+    memory_budget = bytes;
+    ensure_reclaimer_thread_runs();
+}
+
+size_t get_decrypted_memory_budget()
+{
+    return memory_budget.load();
+}
+
 size_t get_num_decrypted_pages()
 {
     return num_decrypted_pages.load();
@@ -297,6 +310,11 @@ decrypted_memory_stats_t get_decrypted_memory_stats()
     retval.memory_size = num_decrypted_pages.load() * page_size();
     retval.reclaimer_target = reclaimer_target.load() * page_size();
     retval.reclaimer_workload = reclaimer_workload.load() * page_size();
+    retval.memory_budget = memory_budget.load();
+    UniqueLock lock(mapping_mutex);
+    retval.num_hits = decrypted_page_counters.hits;
+    retval.num_misses = decrypted_page_counters.misses;
+    retval.num_evictions = decrypted_page_counters.evictions;
     return retval;
 }
 
@@ -343,6 +361,18 @@ size_t collect_total_workload() // must be called under lock
     return total;
 }
 
+// Bound the work of a complete pass over all mappings, as accounted by
+// EncryptedFileMapping::reclaim_untouched() (a unit per 4K pages scanned)
+size_t collect_total_scan_work() // must be called under lock
+{
+    size_t total = 0;
+    for (auto i = mappings_by_file.begin(); i != mappings_by_file.end(); ++i) {
+        for (auto m : i->info->mappings)
+            total += (m->get_end_index() - m->get_start_index()) / 4096 + 1;
+    }
+    return total;
+}
+
 /* Compute the amount of work allowed in an attempt to reclaim pages.
  * please refer to EncryptedFileMapping::reclaim_untouched() for more details.
  *
@@ -415,8 +445,9 @@ void reclaim_pages_for_file(SharedFileInfo& info, size_t& work_limit)
 
 // Reclaim pages from all files, limited by a work limit that is derived
 // from a target for the amount of dirty (decrypted) pages. The target is
-// set by the governor function.
-void reclaim_pages()
+// set by the governor function, and capped by the memory budget. Returns
+// true if the decrypted pages exceeded the budget.
+bool reclaim_pages()
 {
     size_t load;
     std::function<int64_t()> runnable;
@@ -434,18 +465,27 @@ void reclaim_pages()
     {
         UniqueLock lock(mapping_mutex);
         reclaimer_workload = 0;
-        reclaimer_target = size_t(target / page_size());
         // Putting the target back into the govenor object will allow the govenor
         // to return a getter producing this value again next time it is called
         governor->report_target_result(target);
 
+        size_t budget_pages = memory_budget / page_size();
+        if (budget_pages > 0 && (target == PageReclaimGovernor::no_match || size_t(target) > memory_budget))
+            target = int64_t(budget_pages * page_size());
+        reclaimer_target = size_t(target / page_size());
+
         if (target == PageReclaimGovernor::no_match) // temporarily disabled by governor returning no_match
-            return;
+            return false;
 
+        bool over_budget = budget_pages > 0 && load > budget_pages;
         if (mappings_by_file.size() == 0)
-            return;
+            return over_budget;
 
         size_t work_limit = get_work_limit(load, reclaimer_target);
+        // Over budget, allow a complete pass over all pages, releasing each
+        // page not accessed since the previous one
+        if (over_budget)
+            work_limit = std::max(work_limit, load + collect_total_scan_work());
         reclaimer_workload = work_limit;
         if (file_reclaim_index >= mappings_by_file.size())
             file_reclaim_index = 0;
@@ -456,9 +496,10 @@ void reclaim_pages()
             if (work_limit > 0) { // consider next file:
                 ++file_reclaim_index;
                 if (file_reclaim_index >= mappings_by_file.size())
-                    return;
+                    return over_budget;
             }
         }
+        return over_budget;
     }
 }
 
@@ -677,6 +718,12 @@ void* mmap_fixed(FileDesc fd, void* address_request, size_t size, File::AccessMo
     }
 }
 
+#else
+
+decrypted_memory_stats_t get_decrypted_memory_stats()
+{
+    return decrypted_memory_stats_t{0, 0, 0, 0, 0, 0, 0};
+}
 
 #endif
 
@@ -73,6 +73,17 @@ inline void set_page_reclaim_governor_to_default()
     set_page_reclaim_governor(nullptr);
 }
 
+// Set a budget, in bytes, for the memory holding decrypted pages across all
+// open files, or remove it by passing zero. The target of the governor is
+// capped to the budget, and the budget is also enforced when the governor
+// returns no_match. While the decrypted pages exceed the budget, the page
+// reclaim daemon runs ten times per second, and releases every page which has
+// not been accessed since its previous pass, instead of a fraction of them.
+// Pages may still be accessed by live transactions, so the budget can be
+// exceeded until those end.
+void set_decrypted_memory_budget(size_t bytes);
+size_t get_decrypted_memory_budget();
+
 // Retrieves the number of in memory decrypted pages, across all open files.
 size_t get_num_decrypted_pages();
 
@@ -80,10 +91,18 @@ size_t get_num_decrypted_pages();
 // - amount of memory used for decrypted pages, across all open files.
 // - current target for the reclaimer (desired number of decrypted pages)
 // - current workload size for the reclaimer, across all open files.
+// - budget set by set_decrypted_memory_budget(), or zero.
+// - number of page accesses which found the page decrypted (hits) and which
+//   had to decrypt it (misses), and number of pages released by the reclaimer
+//   (evictions), since the process started.
 struct decrypted_memory_stats_t {
     size_t memory_size;
     size_t reclaimer_target;
     size_t reclaimer_workload;
+    size_t memory_budget;
+    uint64_t num_hits;
+    uint64_t num_misses;
+    uint64_t num_evictions;
 };
 
 decrypted_memory_stats_t get_decrypted_memory_stats();
@@ -145,6 +164,15 @@ void inline set_page_reclaim_governor(PageReclaimGovernor*)
 {
 }
 
+void inline set_decrypted_memory_budget(size_t)
+{
+}
+
+size_t inline get_decrypted_memory_budget()
+{
+    return 0;
+}
+
 size_t inline get_num_decrypted_pages()
 {
     return 0;
@@ -182,6 +210,13 @@ void encryption_write_barrier(const File::Map<T>& map, size_t index, size_t num_
 File::SizeType encrypted_size_to_data_size(File::SizeType size) noexcept;
 File::SizeType data_size_to_encrypted_size(File::SizeType size) noexcept;
 
+/// Re-encrypt the blocks of the encrypted file at \a path which are in the
+/// original AES-CBC and HMAC-SHA224 format with AES-GCM, which decrypts and
+/// authenticates a block in a single pass. The file must not be in use.
+/// Returns false if there was nothing to upgrade, or if AES-GCM is not
+/// available (it is only with OpenSSL).
+bool upgrade_encryption(const std::string& path, const char* key);
+
 size_t round_up_to_page_size(size_t size) noexcept;
 }
 }
@@ -38,30 +38,45 @@
 #ifdef REALM_COMPILER_SSE
 #ifdef _MSC_VER
 #include <intrin.h>
+#include <immintrin.h>
+#else
+#include <cpuid.h>
 #endif
 #endif
 
 namespace {
 
 #ifdef REALM_COMPILER_SSE
-#if !defined __clang__ && ((defined(_MSC_FULL_VER) && _MSC_FULL_VER >= 160040219) || defined __GNUC__)
-#if defined REALM_COMPILER_AVX && defined __GNUC__
-#define _XCR_XFEATURE_ENABLED_MASK 0
 
-inline unsigned long long _xgetbv(unsigned index)
+// Returns ebx, ecx of the given cpuid leaf (sub-leaf 0)
+void cpuid(unsigned leaf, unsigned& ebx, unsigned& ecx)
 {
-#if REALM_HAVE_AT_LEAST_GCC(4, 4)
-    unsigned int eax, edx;
-    __asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(index));
-    return (static_cast<unsigned long long>(edx) << 32) | eax;
+#ifdef _MSC_VER
+    int info[4];
+    __cpuidex(info, int(leaf), 0);
+    ebx = unsigned(info[1]);
+    ecx = unsigned(info[2]);
 #else
-    static_cast<void>(index);
-    return 0;
+    unsigned eax = 0, edx = 0;
+    ebx = ecx = 0;
+    if (leaf > __get_cpuid_max(0, nullptr))
+        return;
+    __cpuid_count(leaf, 0, eax, ebx, ecx, edx);
 #endif
 }
 
+// Returns the XCR0 register, which tells which register states the OS saves on context switches
+unsigned long long read_xcr0()
+{
+#ifdef _MSC_VER
+    return _xgetbv(0);
+#else
+    unsigned int eax, edx;
+    __asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (static_cast<unsigned long long>(edx) << 32) | eax;
 #endif
-#endif
+}
+
 #endif
 
 } // anonymous namespace
@@ -78,21 +93,8 @@ string_compare_method_t string_compare_method = STRING_COMPARE_CORE;
 void cpuid_init()
 {
 #ifdef REALM_COMPILER_SSE
-    int cret;
-#ifdef _MSC_VER
-    int CPUInfo[4];
-    __cpuid(CPUInfo, 1);
-    cret = CPUInfo[2];
-#else
-    int a = 1;
-    __asm("mov %1, %%eax; " // a into eax
-          "cpuid;"
-          "mov %%ecx, %0;"                 // ecx into b
-          : "=r"(cret)                     // output
-          : "r"(a)                         // input
-          : "%eax", "%ebx", "%ecx", "%edx" // clobbered register
-          );
-#endif
+    unsigned ebx, cret;
+    cpuid(1, ebx, cret);
 
     // Byte is atomic. Race can/will occur but that's fine
     if (cret & 0x100000) { // test for 4.2
@@ -105,29 +107,37 @@ void cpuid_init()
         sse_support = -2;
     }
 
-    bool avxSupported = false;
-
-// seems like in jenkins builds, __GNUC__ is defined for clang?! todo fixme
-#if !defined __clang__ && ((defined(_MSC_FULL_VER) && _MSC_FULL_VER >= 160040219) || defined __GNUC__)
-    bool osUsesXSAVE_XRSTORE = cret & (1 << 27) || false;
-    bool cpuAVXSuport = cret & (1 << 28) || false;
+    bool osUsesXSAVE_XRSTORE = cret & (1 << 27);
+    bool cpuAVXSuport = cret & (1 << 28);
+    unsigned long long xcrFeatureMask = 0;
 
     if (osUsesXSAVE_XRSTORE && cpuAVXSuport) {
         // Check if the OS will save the YMM registers
-        unsigned long long xcrFeatureMask = _xgetbv(_XCR_XFEATURE_ENABLED_MASK);
-        avxSupported = (xcrFeatureMask & 0x6) || false;
+        xcrFeatureMask = read_xcr0();
     }
-#endif
 
-    if (avxSupported) {
-        avx_support = 0; // AVX1 supported
+    if ((xcrFeatureMask & 0x6) == 0x6) {
+        unsigned ext_ebx, ext_ecx;
+        cpuid(7, ext_ebx, ext_ecx);
+        bool cpuAVX2Support = ext_ebx & (1 << 5);
+        // We need both AVX-512F and AVX-512BW, the latter for 8 and 16 bit elements
+        bool cpuAVX512Support = (ext_ebx & (1 << 16)) && (ext_ebx & (1 << 30));
+        // ... and the OS must also save the opmask and ZMM registers
+        bool osAVX512Support = (xcrFeatureMask & 0xe0) == 0xe0;
+
+        if (cpuAVX2Support && cpuAVX512Support && osAVX512Support) {
+            avx_support = 2; // AVX-512 supported
+        }
+        else if (cpuAVX2Support) {
+            avx_support = 1; // AVX2 supported
+        }
+        else {
+            avx_support = 0; // AVX1 supported
+        }
     }
     else {
         avx_support = -1; // No AVX supported
     }
-
-// 1 is reserved for AVX2
-
 #endif
 }
 
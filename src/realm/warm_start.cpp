@@ -0,0 +1,174 @@
+/*************************************************************************
+ *
+ * Copyright 2021 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <realm/warm_start.hpp>
+
+#include <realm/array.hpp>
+#include <realm/util/file.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <set>
+
+using namespace realm;
+using namespace realm::util;
+
+namespace {
+
+const uint32_t profile_magic = 0x4d524157; // "WARM" in ASCII
+
+// Prefetch this much at a time, so that a closing DB need not wait long
+const size_t prefetch_chunk_size = 1024 * 1024;
+
+struct ProfileHeader {
+    uint32_t magic;
+    uint32_t reserved;
+    uint64_t num_ranges;
+    // Of the ranges
+    uint64_t checksum;
+};
+
+uint64_t compute_checksum(const std::vector<WarmStart::Range>& ranges) noexcept
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    const char* data = reinterpret_cast<const char*>(ranges.data());
+    for (size_t i = 0; i < ranges.size() * sizeof(WarmStart::Range); ++i) {
+        hash ^= uint8_t(data[i]);
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+} // anonymous namespace
+
+std::vector<WarmStart::Range> WarmStart::collect(Allocator& alloc, ref_type top_ref, size_t file_size)
+{
+    const size_t page_size = util::page_size();
+    const size_t max_pages = max_size / page_size;
+    std::set<uint64_t> pages;
+    std::deque<ref_type> queue;
+    if (top_ref != 0 && top_ref < file_size)
+        queue.push_back(top_ref);
+    while (!queue.empty() && pages.size() < max_pages) {
+        ref_type ref = queue.front();
+        queue.pop_front();
+        char* header = alloc.translate(ref);
+        size_t byte_size = NodeHeader::get_byte_size_from_header(header);
+        size_t end = std::min(size_t(ref) + byte_size, file_size);
+        for (size_t page = ref / page_size; page * page_size < end && pages.size() < max_pages; ++page)
+            pages.insert(page);
+
+        Array node(alloc);
+        node.init_from_mem(MemRef(header, ref, alloc));
+        size_t size = node.size();
+        for (size_t i = 0; i < size; ++i) {
+            int_fast64_t value = node.get(i);
+            // Skip null refs and tagged integers
+            if (value == 0 || (value & 1) != 0)
+                continue;
+            ref_type child = to_ref(value);
+            if (child >= file_size)
+                continue;
+            // Arrays holding only values are not recorded
+            if (NodeHeader::get_hasrefs_from_header(alloc.translate(child)))
+                queue.push_back(child);
+        }
+    }
+
+    std::vector<Range> ranges;
+    for (uint64_t page : pages) {
+        uint64_t offset = page * page_size;
+        if (!ranges.empty() && ranges.back().offset + ranges.back().size == offset) {
+            ranges.back().size += page_size;
+        }
+        else {
+            ranges.push_back({offset, page_size});
+        }
+    }
+    return ranges;
+}
+
+void WarmStart::record(const std::string& realm_path, Allocator& alloc, ref_type top_ref, size_t file_size)
+{
+    std::vector<Range> ranges = collect(alloc, top_ref, file_size); // Throws
+    ProfileHeader header;
+    std::memset(&header, 0, sizeof header);
+    header.magic = profile_magic;
+    header.num_ranges = ranges.size();
+    header.checksum = compute_checksum(ranges);
+
+    // Replace the profile at once, so that a DB being opened never sees half
+    // of it
+    std::string path = get_path(realm_path);
+    std::string tmp_path = path + ".tmp";
+    {
+        File file(tmp_path, File::mode_Write);                                                   // Throws
+        file.write(reinterpret_cast<const char*>(&header), sizeof header);                       // Throws
+        file.write(reinterpret_cast<const char*>(ranges.data()), ranges.size() * sizeof(Range)); // Throws
+    }
+    File::move(tmp_path, path); // Throws
+}
+
+std::vector<WarmStart::Range> WarmStart::load(const std::string& realm_path)
+{
+    std::vector<Range> ranges;
+    try {
+        std::string path = get_path(realm_path);
+        if (!File::exists(path))
+            return ranges;
+        File file(path, File::mode_Read); // Throws
+        ProfileHeader header;
+        File::SizeType file_size = file.get_size();
+        if (file_size < File::SizeType(sizeof header))
+            return ranges;
+        file.read(reinterpret_cast<char*>(&header), sizeof header); // Throws
+        if (header.magic != profile_magic || header.num_ranges != uint64_t(file_size - sizeof header) / sizeof(Range))
+            return ranges;
+        ranges.resize(size_t(header.num_ranges));
+        file.read(reinterpret_cast<char*>(ranges.data()), ranges.size() * sizeof(Range)); // Throws
+        if (header.checksum != compute_checksum(ranges))
+            ranges.clear();
+    }
+    catch (const std::exception&) {
+        ranges.clear();
+    }
+    return ranges;
+}
+
+void WarmStart::prefetch(const std::string& realm_path, const std::vector<Range>& ranges,
+                         const std::atomic<bool>& stop) noexcept
+{
+    try {
+        File file(realm_path, File::mode_Read); // Throws
+        // The file may have been truncated since the profile was recorded
+        uint64_t file_size = uint64_t(file.get_size());
+        for (const Range& range : ranges) {
+            uint64_t end = std::min(range.offset + range.size, file_size);
+            for (uint64_t offset = range.offset; offset < end; offset += prefetch_chunk_size) {
+                if (stop.load(std::memory_order_relaxed))
+                    return;
+                size_t size = size_t(std::min(end - offset, uint64_t(prefetch_chunk_size)));
+                file.prefetch(File::SizeType(offset), size);
+            }
+        }
+    }
+    catch (const std::exception&) {
+        // Only a hint
+    }
+}
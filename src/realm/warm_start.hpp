@@ -0,0 +1,81 @@
+/*************************************************************************
+ *
+ * Copyright 2021 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_WARM_START_HPP
+#define REALM_WARM_START_HPP
+
+#include <realm/alloc.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace realm {
+
+/// The pages of a Realm file to read into the page cache when the file is
+/// opened. See DBOptions::warm_start.
+///
+/// A profile is recorded when a DB is closed. It holds the pages of the
+/// arrays that every query goes through before reaching the values it looks
+/// at: the group and table tops, the nodes of the cluster trees, the
+/// clusters themselves and the nodes of search indexes. These are the arrays
+/// holding refs, reached breadth first from the top ref, so the upper levels
+/// are recorded first. Arrays holding only values are not recorded.
+///
+/// The profile is kept next to the Realm file (<path>.warm). It only
+/// affects which pages are read early, so a profile that is stale or does
+/// not match the file is harmless.
+class WarmStart {
+public:
+    /// At most this many bytes of pages are recorded
+    static constexpr size_t max_size = 64 * 1024 * 1024;
+
+    struct Range {
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    static std::string get_path(const std::string& realm_path)
+    {
+        return realm_path + ".warm";
+    }
+
+    /// Collect the page aligned ranges of the file holding the arrays with
+    /// refs that are reachable from `top_ref`, in order of offset. The
+    /// version of `top_ref` must be kept alive, and `alloc` must map it.
+    static std::vector<Range> collect(Allocator& alloc, ref_type top_ref, size_t file_size);
+
+    /// Collect the profile of the version at `top_ref` and save it for the
+    /// Realm file at `realm_path`, replacing any previous one.
+    static void record(const std::string& realm_path, Allocator& alloc, ref_type top_ref, size_t file_size);
+
+    /// The profile saved for the Realm file at `realm_path`, or no ranges if
+    /// there is none or it is damaged.
+    static std::vector<Range> load(const std::string& realm_path);
+
+    /// Ask the system to read the ranges of the Realm file at `realm_path`
+    /// into the page cache. The ranges are clipped to the current size of
+    /// the file. Returns early once `stop` is set. Errors are ignored.
+    static void prefetch(const std::string& realm_path, const std::vector<Range>&,
+                         const std::atomic<bool>& stop) noexcept;
+};
+
+} // namespace realm
+
+#endif // REALM_WARM_START_HPP
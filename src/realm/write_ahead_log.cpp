@@ -0,0 +1,160 @@
+/*************************************************************************
+ *
+ * Copyright 2021 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <realm/write_ahead_log.hpp>
+
+#include <realm/disable_sync_to_disk.hpp>
+#include <realm/group_writer.hpp>
+
+#include <cstddef>
+#include <cstring>
+
+using namespace realm;
+using namespace realm::util;
+
+namespace {
+
+const uint32_t record_magic = 0x4c415752; // "RWAL" in ASCII
+
+uint64_t fnv1a(uint64_t hash, const char* data, size_t size) noexcept
+{
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= uint8_t(data[i]);
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+} // anonymous namespace
+
+struct WriteAheadLog::RecordHeader {
+    uint32_t magic;
+    uint32_t file_format_version;
+    uint64_t version;
+    uint64_t top_ref;
+    uint64_t file_size;
+    uint64_t payload_size;
+    // Of the fields above and the payload
+    uint64_t checksum;
+
+    uint64_t compute_checksum(const std::vector<char>& payload) const noexcept
+    {
+        uint64_t hash =
+            fnv1a(0xcbf29ce484222325ULL, reinterpret_cast<const char*>(this), offsetof(RecordHeader, checksum));
+        return fnv1a(hash, payload.data(), payload.size());
+    }
+};
+
+WriteAheadLog::WriteAheadLog(const std::string& realm_path)
+{
+    m_file.open(get_path(realm_path), File::access_ReadWrite, File::create_Auto, 0); // Throws
+}
+
+void WriteAheadLog::add_write(std::vector<char>& payload, ref_type ref, const char* data, size_t size)
+{
+    uint64_t entry[2] = {uint64_t(ref), uint64_t(size)};
+    payload.insert(payload.end(), reinterpret_cast<const char*>(entry), reinterpret_cast<const char*>(entry + 2));
+    payload.insert(payload.end(), data, data + size);
+}
+
+void WriteAheadLog::append(uint64_t version, ref_type top_ref, size_t file_size, int file_format_version,
+                           const std::vector<char>& payload)
+{
+    RecordHeader header;
+    std::memset(&header, 0, sizeof header);
+    header.magic = record_magic;
+    header.file_format_version = uint32_t(file_format_version);
+    header.version = version;
+    header.top_ref = uint64_t(top_ref);
+    header.file_size = uint64_t(file_size);
+    header.payload_size = payload.size();
+    header.checksum = header.compute_checksum(payload);
+
+    m_file.seek(m_file.get_size());                                       // Throws
+    m_file.write(reinterpret_cast<const char*>(&header), sizeof header); // Throws
+    m_file.write(payload.data(), payload.size());                         // Throws
+    if (!get_disable_sync_to_disk())
+        m_file.sync(); // Throws
+}
+
+size_t WriteAheadLog::size() const
+{
+    return size_t(m_file.get_size()); // Throws
+}
+
+void WriteAheadLog::clear()
+{
+    m_file.resize(0); // Throws
+    if (!get_disable_sync_to_disk())
+        m_file.sync(); // Throws
+}
+
+void WriteAheadLog::recover(const std::string& realm_path)
+{
+    std::string path = get_path(realm_path);
+    if (!File::exists(path) || !File::exists(realm_path))
+        return;
+
+    File log(path, File::mode_Update); // Throws
+    File::SizeType log_size = log.get_size();
+    if (log_size == 0)
+        return;
+
+    File file(realm_path, File::mode_Update); // Throws
+    bool recovered = false;
+    RecordHeader last;
+    std::vector<char> payload;
+    File::SizeType pos = 0;
+    while (log_size - pos >= File::SizeType(sizeof(RecordHeader))) {
+        RecordHeader header;
+        log.read(reinterpret_cast<char*>(&header), sizeof header); // Throws
+        pos += sizeof header;
+        if (header.magic != record_magic || header.payload_size > uint64_t(log_size - pos))
+            break;
+        payload.resize(size_t(header.payload_size));
+        log.read(payload.data(), payload.size()); // Throws
+        pos += payload.size();
+        if (header.checksum != header.compute_checksum(payload))
+            break;
+
+        if (file.get_size() < File::SizeType(header.file_size))
+            file.resize(File::SizeType(header.file_size)); // Throws
+        const char* p = payload.data();
+        const char* end = p + payload.size();
+        while (p != end) {
+            uint64_t entry[2];
+            std::memcpy(entry, p, sizeof entry);
+            p += sizeof entry;
+            REALM_ASSERT_RELEASE(entry[1] <= uint64_t(end - p));
+            file.seek(File::SizeType(entry[0])); // Throws
+            file.write(p, size_t(entry[1]));     // Throws
+            p += entry[1];
+        }
+        last = header;
+        recovered = true;
+    }
+
+    if (recovered) {
+        // The records left the arrays in place, so make the header refer to
+        // them the same way a group commit does
+        GroupWriter::commit_written(file, ref_type(last.top_ref), int(last.file_format_version)); // Throws
+    }
+    log.resize(0); // Throws
+    if (!get_disable_sync_to_disk())
+        log.sync(); // Throws
+}
@@ -0,0 +1,91 @@
+/*************************************************************************
+ *
+ * Copyright 2021 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_WRITE_AHEAD_LOG_HPP
+#define REALM_WRITE_AHEAD_LOG_HPP
+
+#include <realm/alloc.hpp>
+#include <realm/util/file.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace realm {
+
+/// A redo log of commits that have been written to the Realm file, but not
+/// yet flushed to it. See DBOptions::write_ahead_log.
+///
+/// Every commit appends one record holding the arrays written by
+/// GroupWriter::write_group() and the top ref they make up, and syncs the log.
+/// Writing to the log is sequential, whereas the arrays are scattered over the
+/// Realm file, which is only flushed once in a while (a checkpoint). The file
+/// header keeps referring to the version of the last checkpoint until then,
+/// and the space of that version must not be reused meanwhile, so the file is
+/// consistent whenever the log is lost.
+///
+/// After a crash, recover() writes the arrays of all complete records to the
+/// Realm file again, in order, and makes the file header refer to the top ref
+/// of the last one. A record that was not completely written belongs to a
+/// commit that never returned.
+///
+/// Not supported for encrypted files. All functions must be called while
+/// holding the write lock of the Realm file, or before any session has
+/// started, as appending and truncating must not overlap.
+class WriteAheadLog {
+public:
+    /// A checkpoint is due when the log has grown beyond this size
+    static constexpr size_t checkpoint_size = 4 * 1024 * 1024;
+
+    /// Open the log of the Realm file at `realm_path`, creating it if needed
+    explicit WriteAheadLog(const std::string& realm_path);
+
+    static std::string get_path(const std::string& realm_path)
+    {
+        return realm_path + ".wal";
+    }
+
+    /// Add the array of `size` bytes written at `ref` to the payload of a
+    /// record
+    static void add_write(std::vector<char>& payload, ref_type ref, const char* data, size_t size);
+
+    /// Append a record and sync the log. `payload` is built with add_write().
+    void append(uint64_t version, ref_type top_ref, size_t file_size, int file_format_version,
+                const std::vector<char>& payload);
+
+    /// Size of the log in bytes. Zero after a checkpoint.
+    size_t size() const;
+
+    /// Discard all records. Call after the Realm file has been flushed and
+    /// refers to the latest version.
+    void clear();
+
+    /// Apply the records left in the log of the Realm file at `realm_path`, if
+    /// any, to the file, then clear the log. Must be called before the file
+    /// is attached when a session starts.
+    static void recover(const std::string& realm_path);
+
+private:
+    struct RecordHeader;
+
+    util::File m_file;
+};
+
+} // namespace realm
+
+#endif // REALM_WRITE_AHEAD_LOG_HPP
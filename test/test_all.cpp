@@ -309,7 +309,8 @@ void display_build_config()
 
     const char* cpu_sse = realm::sseavx<42>() ? "4.2" : (realm::sseavx<30>() ? "3.0" : "None");
 
-    const char* cpu_avx = realm::sseavx<1>() ? "Yes" : "No";
+    const char* cpu_avx =
+        realm::sseavx<512>() ? "AVX-512" : (realm::sseavx<2>() ? "AVX2" : (realm::sseavx<1>() ? "AVX1" : "None"));
 
     std::cout << std::endl
               << "Realm version: " << Version::get_version() << " with Debug " << with_debug << "\n"
@@ -326,7 +327,7 @@ void display_build_config()
               << "Compiler supported SSE (auto detect):       " << compiler_sse << "\n"
               << "This CPU supports SSE (auto detect):        " << cpu_sse << "\n"
               << "Compiler supported AVX (auto detect):       " << compiler_avx << "\n"
-              << "This CPU supports AVX (AVX1) (auto detect): " << cpu_avx << "\n"
+              << "This CPU supports AVX (auto detect):        " << cpu_avx << "\n"
               << "\n"
               << "Unit test random seed:                      " << unit_test_random_seed << "\n"
               << std::endl;
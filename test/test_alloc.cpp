@@ -314,6 +314,115 @@ TEST(Alloc_Fuzzy)
     }
 }
 
+TEST(Alloc_SmallBlocks)
+{
+    SlabAlloc alloc;
+    alloc.attach_empty();
+    // Make room for all blocks in one slab, so that they are adjacent
+    MemRef big = alloc.alloc(2 * 1024 * 1024);
+    set_capacity(big.get_addr(), 2 * 1024 * 1024);
+    alloc.free_(big.get_ref(), big.get_addr());
+
+    std::vector<MemRef> refs;
+    for (size_t size = 8; size <= 4096; size += 8) {
+        MemRef r = alloc.alloc(size);
+        set_capacity(r.get_addr(), size);
+        refs.push_back(r);
+    }
+    // Free every other block, so that no freed blocks are merged
+    for (size_t i = 0; i < refs.size(); i += 2)
+        alloc.free_(refs[i].get_ref(), refs[i].get_addr());
+    // Blocks of the same size are reused, also when they are large
+    for (size_t i = 0; i < refs.size(); i += 2) {
+        size_t size = 8 * (i + 1);
+        MemRef r = alloc.alloc(size);
+        set_capacity(r.get_addr(), size);
+        // The smallest blocks are padded to fit a free block header
+        if (size > 24) {
+            CHECK_EQUAL(r.get_ref(), refs[i].get_ref());
+        }
+        refs[i] = r;
+    }
+    // A smaller block is carved out of a larger free one
+    alloc.free_(refs[100].get_ref(), refs[100].get_addr());
+    MemRef r = alloc.alloc(64);
+    set_capacity(r.get_addr(), 64);
+    CHECK_EQUAL(r.get_ref(), refs[100].get_ref());
+    refs[100] = r;
+
+    for (auto& ref : refs)
+        alloc.free_(ref.get_ref(), ref.get_addr());
+    CHECK(alloc.is_all_free());
+
+    // Mixed small and large blocks, checking that none overlap
+    refs.clear();
+    for (size_t iter = 0; iter < 10000; iter++) {
+        if (rand() % 100 > 45 || refs.empty()) {
+            size_t size = (rand() % 2 ? rand() % 300 + 1 : rand() % 2000 + 1) * 8;
+            MemRef r = alloc.alloc(size);
+            set_capacity(r.get_addr(), size);
+            memset(r.get_addr() + 3, static_cast<char>(r.get_ref() >> 3), size - 3);
+            refs.push_back(r);
+        }
+        else {
+            size_t entry = rand() % refs.size();
+            MemRef r = refs[entry];
+            size_t size = get_capacity(r.get_addr());
+            bool intact = true;
+            for (size_t c = 3; c < size; c++)
+                intact = intact && r.get_addr()[c] == static_cast<char>(r.get_ref() >> 3);
+            CHECK(intact);
+            alloc.free_(r.get_ref(), r.get_addr());
+            refs.erase(refs.begin() + entry);
+        }
+    }
+    for (auto& ref : refs)
+        alloc.free_(ref.get_ref(), ref.get_addr());
+    CHECK(alloc.is_all_free());
+}
+
+
+TEST(Alloc_SlabRetention)
+{
+    GROUP_TEST_PATH(path);
+    SlabAlloc alloc;
+    SlabAlloc::Config cfg;
+    cfg.slab_retention = 8 * 1024 * 1024;
+    alloc.attach_file(path, cfg);
+
+    auto write_transaction = [&] {
+        std::vector<MemRef> refs;
+        for (int i = 0; i < 6; ++i) {
+            MemRef r = alloc.alloc(512 * 1024);
+            set_capacity(r.get_addr(), 512 * 1024);
+            refs.push_back(r);
+        }
+        for (auto& ref : refs)
+            alloc.free_(ref.get_ref(), ref.get_addr());
+        alloc.reset_free_space_tracking();
+    };
+
+    write_transaction();
+    size_t retained = alloc.get_allocated_size();
+    CHECK_GREATER_EQUAL(retained, 3 * 1024 * 1024);
+    CHECK_LESS_EQUAL(retained, cfg.slab_retention);
+    // The retained slabs are enough for the next transaction
+    write_transaction();
+    CHECK_EQUAL(alloc.get_allocated_size(), retained);
+    alloc.detach();
+
+    // By default only the first minimal slab is kept
+    cfg = SlabAlloc::Config();
+    alloc.attach_file(path, cfg);
+    write_transaction();
+    CHECK_EQUAL(alloc.get_allocated_size(), 0);
+    MemRef r = alloc.alloc(64);
+    set_capacity(r.get_addr(), 64);
+    alloc.free_(r.get_ref(), r.get_addr());
+    alloc.reset_free_space_tracking();
+    CHECK_EQUAL(alloc.get_allocated_size(), 128 * 1024);
+}
+
 namespace {
 
 class TestSlabAlloc : public SlabAlloc
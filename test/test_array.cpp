@@ -1456,4 +1456,117 @@ TEST(Array_Large)
     c.destroy();
 }
 
+namespace {
+
+template <class Cond>
+void check_find_vectorized(TestContext& test_context, const Array& a, const std::vector<int64_t>& v, int64_t value,
+                           size_t start)
+{
+    Cond c;
+    size_t expected_count = 0;
+    int64_t expected_sum = 0;
+    size_t expected_first = not_found;
+    for (size_t i = start; i < v.size(); ++i) {
+        if (c(v[i], value)) {
+            if (expected_first == not_found)
+                expected_first = i;
+            ++expected_count;
+            expected_sum += v[i];
+        }
+    }
+
+    QueryState<int64_t> count_state(act_Count);
+    a.find<Cond>(act_Count, value, start, v.size(), 0, &count_state);
+    CHECK_EQUAL(size_t(count_state.m_state), expected_count);
+
+    QueryState<int64_t> sum_state(act_Sum);
+    a.find<Cond>(act_Sum, value, start, v.size(), 0, &sum_state);
+    CHECK_EQUAL(sum_state.m_state, expected_sum);
+
+    QueryState<int64_t> first_state(act_ReturnFirst);
+    a.find<Cond>(act_ReturnFirst, value, start, v.size(), 0, &first_state);
+    size_t first = first_state.m_match_count ? size_t(first_state.m_state) : not_found;
+    CHECK_EQUAL(first, expected_first);
+}
+
+} // anonymous namespace
+
+// Runs the searches on every element width through each of the AVX-512, AVX2 and SSE paths supported by the CPU
+TEST(Array_FindVectorized)
+{
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    const signed char detected_avx_support = avx_support;
+    const int64_t max_values[] = {1, 3, 15, 127, 32767, 2147483647, 9223372036854775807LL};
+
+    for (signed char level = detected_avx_support; level >= -1; --level) {
+        avx_support = level;
+        for (int64_t max_value : max_values) {
+            Array a(Allocator::get_default());
+            a.create(Array::type_Normal);
+            std::vector<int64_t> v;
+            // Make sure the array gets the full width of the range
+            a.add(max_value);
+            v.push_back(max_value);
+            a.add(max_value > 15 ? -max_value : 0);
+            v.push_back(max_value > 15 ? -max_value : 0);
+            for (size_t i = 0; i < 1000; ++i) {
+                // Few distinct values to make matches likely, with some runs without any match
+                int64_t val = (i / 100) % 3 == 0 ? 0 : random.draw_int<int64_t>(0, std::min<int64_t>(max_value, 7));
+                a.add(val);
+                v.push_back(val);
+            }
+
+            // Skip the extreme values to keep the sums from overflowing
+            for (size_t start : {size_t(2), size_t(5), size_t(79)}) {
+                for (int64_t value : {int64_t(0), int64_t(1), std::min<int64_t>(max_value, 5)}) {
+                    check_find_vectorized<Equal>(test_context, a, v, value, start);
+                    check_find_vectorized<NotEqual>(test_context, a, v, value, start);
+                    check_find_vectorized<Greater>(test_context, a, v, value, start);
+                    check_find_vectorized<Less>(test_context, a, v, value, start);
+                }
+            }
+            a.destroy();
+        }
+    }
+    avx_support = detected_avx_support;
+}
+
+TEST(Array_MinMaxVectorized)
+{
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    const signed char detected_avx_support = avx_support;
+    const int64_t max_values[] = {127, 32767, 2147483647, 9223372036854775807LL};
+
+    for (signed char level = detected_avx_support; level >= -1; --level) {
+        avx_support = level;
+        for (int64_t max_value : max_values) {
+            Array a(Allocator::get_default());
+            a.create(Array::type_Normal);
+            std::vector<int64_t> v;
+            for (size_t i = 0; i < 300; ++i) {
+                int64_t val = random.draw_int<int64_t>(-max_value, max_value);
+                a.add(val);
+                v.push_back(val);
+            }
+
+            for (size_t start : {size_t(0), size_t(3), size_t(41)}) {
+                for (size_t end : {size_t(60), size_t(77), size_t(300)}) {
+                    auto max_it = std::max_element(v.begin() + start, v.begin() + end);
+                    auto min_it = std::min_element(v.begin() + start, v.begin() + end);
+                    QueryState<int64_t> max_state(act_Max);
+                    a.find(cond_None, act_Max, 0, start, end, 0, &max_state);
+                    CHECK_EQUAL(*max_it, max_state.m_state);
+                    CHECK_EQUAL(max_it - v.begin(), max_state.m_minmax_index);
+                    QueryState<int64_t> min_state(act_Min);
+                    a.find(cond_None, act_Min, 0, start, end, 0, &min_state);
+                    CHECK_EQUAL(*min_it, min_state.m_state);
+                    CHECK_EQUAL(min_it - v.begin(), min_state.m_minmax_index);
+                }
+            }
+            a.destroy();
+        }
+    }
+    avx_support = detected_avx_support;
+}
+
 #endif // TEST_ARRAY
@@ -0,0 +1,207 @@
+/*************************************************************************
+ *
+ * Copyright 2021 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <realm/array_blobs_compressed.hpp>
+#include <realm/array_binary.hpp>
+#include <realm/array_string.hpp>
+
+#include "test.hpp"
+
+using namespace realm;
+
+
+// Test independence and thread-safety
+// -----------------------------------
+//
+// All tests must be thread safe and independent of each other. This
+// is required because it allows for both shuffling of the execution
+// order and for parallelized testing.
+//
+// In particular, avoid using std::rand() since it is not guaranteed
+// to be thread safe. Instead use the API offered in
+// `test/util/random.hpp`.
+//
+// All files created in tests must use the TEST_PATH macro (or one of
+// its friends) to obtain a suitable file system path. See
+// `test/util/test_path.hpp`.
+//
+//
+// Debugging and the ONLY() macro
+// ------------------------------
+//
+// A simple way of disabling all tests except one called `Foo`, is to
+// replace TEST(Foo) with ONLY(Foo) and then recompile and rerun the
+// test suite. Note that you can also use filtering by setting the
+// environment varible `UNITTEST_FILTER`. See `README.md` for more on
+// this.
+//
+// Another way to debug a particular test, is to copy that test into
+// `experiments/testcase.cpp` and then run `sh build.sh
+// check-testcase` (or one of its friends) from the command line.
+
+
+namespace {
+
+std::string make_document(size_t i)
+{
+    std::string doc = "{\"id\": " + util::to_string(i) + ", \"name\": \"user" + util::to_string(i % 17) +
+                      "\", \"tags\": [\"alpha\", \"beta\", \"gamma\"], \"active\": ";
+    doc += (i % 2 ? "true" : "false");
+    doc += ", \"address\": {\"street\": \"Main Street\", \"city\": \"Copenhagen\"}}";
+    return doc;
+}
+
+} // anonymous namespace
+
+TEST(ArrayCompressedBlobs_Basic)
+{
+    Allocator& alloc = Allocator::get_default();
+    std::vector<std::string> docs;
+    for (size_t i = 0; i < 100; ++i)
+        docs.push_back(make_document(i));
+    std::vector<BinaryData> values;
+    for (size_t i = 0; i < docs.size(); ++i)
+        values.emplace_back(docs[i].data(), docs[i].size());
+    values[3] = BinaryData();      // null
+    values[4] = BinaryData("", 0); // empty
+
+    MemRef mem = ArrayCompressedBlobs::create(values, alloc);
+    CHECK(mem.get_addr());
+    CHECK(ArrayCompressedBlobs::is_compressed(mem.get_addr()));
+    ArrayCompressedBlobs c(alloc);
+    c.init_from_mem(mem);
+    c.verify();
+
+    size_t raw_size = 0;
+    size_t max_size = 0;
+    for (auto& value : values) {
+        raw_size += value.size();
+        max_size = std::max(max_size, value.size());
+    }
+    CHECK_LESS(c.get_byte_size() * 4, raw_size);
+
+    CHECK_EQUAL(values.size(), c.size());
+    for (size_t i = 0; i < values.size(); ++i) {
+        CHECK_EQUAL(values[i], c.get(i));
+        CHECK_EQUAL(values[i].is_null(), c.is_null(i));
+    }
+    CHECK(c.get(3).is_null());
+    CHECK(c.get_string(3).is_null());
+    CHECK_NOT(c.get(4).is_null());
+    CHECK_EQUAL(0, c.get(4).size());
+    CHECK_EQUAL(StringData(docs[7]), c.get_string(7));
+    CHECK_EQUAL(0, c.get_string(7).data()[docs[7].size()]);
+
+    CHECK_EQUAL(7, c.find_first(values[7]));
+    CHECK_EQUAL(3, c.find_first(BinaryData()));
+    CHECK_EQUAL(4, c.find_first(BinaryData("", 0)));
+    CHECK_EQUAL(not_found, c.find_first(values[7], 8, 100));
+    CHECK_EQUAL(not_found, c.find_first(BinaryData("abc", 3)));
+    CHECK_EQUAL(max_size, c.max_value_size());
+
+    c.destroy();
+}
+
+TEST(ArrayCompressedBlobs_Incompressible)
+{
+    Allocator& alloc = Allocator::get_default();
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    std::string noise;
+    for (size_t i = 0; i < 4096; ++i) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        noise += char(state & 0xFF);
+    }
+    std::vector<BinaryData> values = {BinaryData(noise.data(), noise.size())};
+    CHECK_NOT(ArrayCompressedBlobs::create(values, alloc).get_addr());
+    CHECK_NOT(ArrayCompressedBlobs::create({}, alloc).get_addr());
+}
+
+TEST(ArrayCompressedBlobs_String)
+{
+    Allocator& alloc = Allocator::get_default();
+    ArrayString arr(alloc);
+    arr.create();
+    for (size_t i = 0; i < 200; ++i)
+        arr.add(make_document(i));
+    arr.set(10, StringData());
+    arr.set(11, "");
+
+    arr.compress();
+    CHECK(arr.is_compressed());
+    arr.verify();
+    CHECK_EQUAL(200, arr.size());
+    CHECK_EQUAL(make_document(5), arr.get(5));
+    CHECK(arr.is_null(10));
+    CHECK_NOT(arr.is_null(11));
+    CHECK_EQUAL(StringData(""), arr.get(11));
+    CHECK_EQUAL(42, arr.find_first(make_document(42), 0, 200));
+
+    // A modification decompresses the leaf
+    arr.set(0, arr.get(1));
+    CHECK_NOT(arr.is_compressed());
+    CHECK_EQUAL(make_document(1), arr.get(0));
+    CHECK_EQUAL(make_document(199), arr.get(199));
+    CHECK(arr.is_null(10));
+    CHECK_EQUAL(StringData(""), arr.get(11));
+
+    // Short values go back into a leaf of medium strings
+    ArrayString short_arr(alloc);
+    short_arr.create();
+    for (size_t i = 0; i < 200; ++i)
+        short_arr.add(std::string("medium string number ") + util::to_string(i % 10));
+    short_arr.compress();
+    CHECK(short_arr.is_compressed());
+    short_arr.erase(0);
+    CHECK_NOT(short_arr.is_compressed());
+    CHECK_EQUAL(199, short_arr.size());
+    CHECK_EQUAL("medium string number 1", short_arr.get(0));
+    CHECK_NOT(Array::get_context_flag_from_header(alloc.translate(short_arr.get_ref())));
+
+    arr.destroy();
+    short_arr.destroy();
+}
+
+TEST(ArrayCompressedBlobs_Binary)
+{
+    Allocator& alloc = Allocator::get_default();
+    ArrayBinary arr(alloc);
+    arr.create();
+    std::vector<std::string> docs;
+    for (size_t i = 0; i < 200; ++i)
+        docs.push_back(make_document(i));
+    for (auto& doc : docs)
+        arr.add(BinaryData(doc.data(), doc.size()));
+    arr.set(3, BinaryData());
+
+    arr.compress();
+    CHECK(arr.is_compressed());
+    arr.verify();
+    CHECK_EQUAL(BinaryData(docs[2].data(), docs[2].size()), arr.get(2));
+    CHECK(arr.is_null(3));
+    CHECK_EQUAL(2, arr.find_first(BinaryData(docs[2].data(), docs[2].size()), 0, 200));
+
+    arr.insert(0, BinaryData("x", 1));
+    CHECK_NOT(arr.is_compressed());
+    CHECK_EQUAL(201, arr.size());
+    CHECK_EQUAL(BinaryData(docs[2].data(), docs[2].size()), arr.get(3));
+    CHECK(arr.is_null(4));
+
+    Array::destroy_deep(arr.get_ref(), alloc);
+}
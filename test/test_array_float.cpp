@@ -555,4 +555,80 @@ TEST(ArrayDouble_Compare)
     BasicArray_Compare<ArrayDouble, double>(test_context);
 }
 
+
+template <typename T>
+void BasicArray_AggregateNotNull(TestContext& test_context)
+{
+    BasicArrayNull<T> f(Allocator::get_default());
+    f.create();
+
+    // Grow past several vector widths, with nulls, NaN and repeated extremes
+    for (size_t i = 0; i < 70; ++i) {
+        if (i % 7 == 3)
+            f.add(util::none);
+        else if (i == 40)
+            f.add(std::numeric_limits<T>::quiet_NaN());
+        else
+            f.add(T(int(i * 13 % 23) - 11) * T(0.25));
+
+        for (size_t begin = 0; begin < std::min(f.size(), size_t(9)); ++begin) {
+            size_t end = f.size();
+            double lanes[4] = {0, 0, 0, 0};
+            size_t expected_count = 0;
+            T expected_max = -std::numeric_limits<T>::infinity();
+            T expected_min = std::numeric_limits<T>::infinity();
+            size_t expected_max_ndx = npos;
+            size_t expected_min_ndx = npos;
+            for (size_t j = begin; j < end; ++j) {
+                if (f.is_null(j))
+                    continue;
+                T v = *f.get(j);
+                lanes[(j - begin) % 4] += v;
+                ++expected_count;
+                if (v > expected_max) {
+                    expected_max = v;
+                    expected_max_ndx = j;
+                }
+                if (v < expected_min) {
+                    expected_min = v;
+                    expected_min_ndx = j;
+                }
+            }
+            double expected_sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+
+            size_t count = 0;
+            double sum = f.sum_not_null(count, begin, end);
+            CHECK_EQUAL(expected_count, count);
+            if (i < 40 || begin > 40)
+                CHECK_EQUAL(expected_sum, sum);
+            else
+                CHECK(std::isnan(sum));
+
+            T max = -std::numeric_limits<T>::infinity();
+            CHECK_EQUAL(expected_max_ndx, f.maximum_not_null(max, count, begin, end));
+            CHECK_EQUAL(expected_count, count);
+            CHECK_EQUAL(expected_max, max);
+
+            T min = std::numeric_limits<T>::infinity();
+            CHECK_EQUAL(expected_min_ndx, f.minimum_not_null(min, count, begin, end));
+            CHECK_EQUAL(expected_min, min);
+
+            // Nothing beats the starting value
+            min = T(-100);
+            CHECK_EQUAL(npos, f.minimum_not_null(min, count, begin, end));
+            CHECK_EQUAL(T(-100), min);
+        }
+    }
+
+    f.destroy(); // cleanup
+}
+TEST(ArrayFloat_AggregateNotNull)
+{
+    BasicArray_AggregateNotNull<float>(test_context);
+}
+TEST(ArrayDouble_AggregateNotNull)
+{
+    BasicArray_AggregateNotNull<double>(test_context);
+}
+
 #endif // TEST_ARRAY_FLOAT
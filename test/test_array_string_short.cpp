@@ -23,6 +23,7 @@
 #include <realm/column_integer.hpp>
 
 #include "test.hpp"
+#include "util/random.hpp"
 
 using namespace realm;
 using namespace realm::test_util;
@@ -755,4 +756,69 @@ TEST(ArrayString_Null2)
 }
 
 
+// The slots of each width are compared by a different kernel
+TEST(ArrayString_FindFirstWidths)
+{
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    for (size_t max_size : {1, 3, 7, 15, 31, 63}) {
+        for (bool nullable : {false, true}) {
+            ArrayStringShort a(Allocator::get_default(), nullable);
+            a.create();
+
+            // Values that are prefixes of each other, and ones that only
+            // differ in their size or in the last byte
+            std::vector<std::string> values;
+            std::string value;
+            for (size_t i = 0; i < max_size; ++i) {
+                value += char('a' + i % 3);
+                values.push_back(value);
+                values.push_back(value.substr(0, i) + "x");
+            }
+            values.push_back("");
+            values.push_back(std::string(max_size, 'a'));
+
+            for (size_t i = 0; i < 150; ++i) {
+                if (random.draw_int_mod(10) == 0) {
+                    if (nullable)
+                        a.add(realm::null());
+                    else
+                        a.add("");
+                }
+                else {
+                    a.add(values[random.draw_int_mod(values.size())]);
+                }
+            }
+
+            auto check = [&](StringData needle, size_t begin, size_t end) {
+                size_t expected = not_found;
+                size_t expected_prefix = not_found;
+                for (size_t i = begin; i < end; ++i) {
+                    StringData v = a.get(i);
+                    if (expected == not_found && v == needle)
+                        expected = i;
+                    if (expected_prefix == not_found && v.begins_with(needle))
+                        expected_prefix = i;
+                }
+                CHECK_EQUAL(a.find_first(needle, begin, end), expected);
+                if (!needle.is_null())
+                    CHECK_EQUAL(a.find_first_prefix(needle, begin, end), expected_prefix);
+            };
+            values.push_back(std::string(max_size + 1, 'a'));
+            values.push_back("z");
+            for (const std::string& v : values) {
+                check(v, 0, a.size());
+                check(v, 17, 101);
+                check(v, 33, 34);
+            }
+            // A leaf that is not nullable finds empty strings for null
+            if (nullable) {
+                check(realm::null(), 0, a.size());
+                check(realm::null(), 5, 60);
+            }
+
+            a.destroy();
+        }
+    }
+}
+
 #endif // TEST_ARRAY_STRING
@@ -184,5 +184,203 @@ TEST(EncryptedFile_LargePages)
     close(fd);
 }
 
+TEST(EncryptedFile_CryptorManyBlocks)
+{
+    TEST_PATH(path);
+
+    // Spans several metadata blocks, and more blocks than are read at once
+    const size_t num_blocks = 150;
+    std::unique_ptr<char[]> data(new char[4096 * num_blocks]);
+    for (size_t i = 0; i < 4096 * num_blocks; ++i)
+        data[i] = static_cast<char>(i % 251);
+
+    AESCryptor cryptor(test_key);
+    cryptor.set_file_size(4096 * num_blocks);
+    std::unique_ptr<char[]> buffer(new char[4096 * num_blocks]);
+
+    int fd = open(path.c_str(), O_CREAT | O_RDWR, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    cryptor.write(fd, 0, data.get(), 4096 * num_blocks);
+    CHECK(cryptor.read(fd, 0, buffer.get(), 4096 * num_blocks));
+    CHECK(memcmp(buffer.get(), data.get(), 4096 * num_blocks) == 0);
+
+    // Unaligned with respect to both metadata blocks and batched reads
+    memset(buffer.get(), 0, 4096 * num_blocks);
+    CHECK(cryptor.read(fd, 4096 * 61, buffer.get(), 4096 * 70));
+    CHECK(memcmp(buffer.get(), data.get() + 4096 * 61, 4096 * 70) == 0);
+
+    // Reading beyond the blocks written stops there
+    CHECK_NOT(cryptor.read(fd, 4096 * (num_blocks - 2), buffer.get(), 4096 * 4));
+    CHECK(memcmp(buffer.get(), data.get() + 4096 * (num_blocks - 2), 4096 * 2) == 0);
+    close(fd);
+
+    // A separate cryptor can read it too
+    fd = open(path.c_str(), O_RDWR);
+    AESCryptor cryptor2(test_key);
+    cryptor2.set_file_size(4096 * num_blocks);
+    memset(buffer.get(), 0, 4096 * num_blocks);
+    CHECK(cryptor2.read(fd, 0, buffer.get(), 4096 * num_blocks));
+    CHECK(memcmp(buffer.get(), data.get(), 4096 * num_blocks) == 0);
+    close(fd);
+}
+
+#if !REALM_PLATFORM_APPLE
+TEST(EncryptedFile_CryptorUpgrade)
+{
+    TEST_PATH(path);
+
+    const size_t num_blocks = 100;
+    std::unique_ptr<char[]> data(new char[4096 * num_blocks]);
+    for (size_t i = 0; i < 4096 * num_blocks; ++i)
+        data[i] = static_cast<char>(i % 253);
+    std::unique_ptr<char[]> buffer(new char[4096 * num_blocks]);
+    char raw_buffer[4096];
+
+    int fd = open(path.c_str(), O_CREAT | O_RDWR, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    {
+        AESCryptor cryptor(test_key);
+        cryptor.set_file_size(4096 * num_blocks);
+        cryptor.write(fd, 0, data.get(), 4096 * num_blocks);
+        CHECK_NOT(cryptor.uses_gcm(fd));
+    }
+    {
+        // Upgrade all but the first block, so the file mixes both formats
+        AESCryptor cryptor(test_key);
+        cryptor.set_file_size(4096 * num_blocks);
+        CHECK(cryptor.upgrade(fd, 4096, 4096 * (num_blocks - 1)));
+    }
+    {
+        AESCryptor cryptor(test_key);
+        cryptor.set_file_size(4096 * num_blocks);
+        CHECK_NOT(cryptor.uses_gcm(fd));
+        CHECK(cryptor.read(fd, 0, buffer.get(), 4096 * num_blocks));
+        CHECK(memcmp(buffer.get(), data.get(), 4096 * num_blocks) == 0);
+        CHECK(cryptor.upgrade(fd, 0, 4096));
+    }
+    {
+        AESCryptor cryptor(test_key);
+        cryptor.set_file_size(4096 * num_blocks);
+        CHECK(cryptor.uses_gcm(fd));
+        memset(buffer.get(), 0, 4096 * num_blocks);
+        CHECK(cryptor.read(fd, 0, buffer.get(), 4096 * num_blocks));
+        CHECK(memcmp(buffer.get(), data.get(), 4096 * num_blocks) == 0);
+        cryptor.write(fd, 4096 * 3, data.get(), 4096);
+    }
+
+    // A changed byte of the ciphertext of the fifth block (which follows the
+    // first metadata block) fails authentication
+    ssize_t actual_pread = pread(fd, raw_buffer, 4096, 4096 * 5);
+    CHECK_EQUAL(actual_pread, 4096);
+    raw_buffer[100]++;
+    ssize_t actual_pwrite = pwrite(fd, raw_buffer, 4096, 4096 * 5);
+    CHECK_EQUAL(actual_pwrite, 4096);
+    {
+        AESCryptor cryptor(test_key);
+        cryptor.set_file_size(4096 * num_blocks);
+        CHECK(cryptor.read(fd, 4096 * 3, buffer.get(), 4096));
+        CHECK(memcmp(buffer.get(), data.get(), 4096) == 0);
+        CHECK_THROW(cryptor.read(fd, 4096 * 3, buffer.get(), 4096 * 2), DecryptionFailed);
+    }
+    close(fd);
+}
+
+TEST(EncryptedFile_CryptorUpgradeInterruptedWrite)
+{
+    TEST_PATH(path);
+
+    const char data[4096] = "test data";
+    const char data2[4096] = "more test data";
+    char buffer[4096];
+
+    int fd = open(path.c_str(), O_CREAT | O_RDWR, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    {
+        AESCryptor cryptor(test_key);
+        cryptor.set_file_size(16);
+        cryptor.write(fd, 0, data, sizeof(data));
+        CHECK(cryptor.upgrade(fd, 0, 4096));
+    }
+
+    // Fake an interrupted write which updates the IV table but not the data,
+    // by restoring the ciphertext written by the upgrade
+    {
+        AESCryptor cryptor(test_key);
+        cryptor.set_file_size(16);
+        char ciphertext[4096];
+        ssize_t actual_pread = pread(fd, ciphertext, 4096, 4096);
+        CHECK_EQUAL(actual_pread, 4096);
+        cryptor.write(fd, 0, data2, sizeof(data2));
+        ssize_t actual_pwrite = pwrite(fd, ciphertext, 4096, 4096);
+        CHECK_EQUAL(actual_pwrite, 4096);
+    }
+    {
+        AESCryptor cryptor(test_key);
+        cryptor.set_file_size(16);
+        CHECK(cryptor.uses_gcm(fd));
+        CHECK(cryptor.read(fd, 0, buffer, sizeof(buffer)));
+        CHECK(memcmp(buffer, data, strlen(data)) == 0);
+    }
+
+    close(fd);
+}
+
+TEST(EncryptedFile_CryptorUpgradeNonce)
+{
+    TEST_PATH(path_1);
+    TEST_PATH(path_2);
+
+    const char data[4096 * 2] = "test data";
+    char buffer[4096 * 2];
+    char ciphertext_1[4096];
+    char ciphertext_2[4096];
+
+    int fd_1 = open(path_1.c_str(), O_CREAT | O_RDWR, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    int fd_2 = open(path_2.c_str(), O_CREAT | O_RDWR, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    for (int fd : {fd_1, fd_2}) {
+        AESCryptor cryptor(test_key);
+        cryptor.set_file_size(sizeof(data));
+        cryptor.write(fd, 0, data, sizeof(data));
+        CHECK(cryptor.upgrade(fd, 0, sizeof(data)));
+    }
+
+    // The same data written at the same position with the same key is
+    // encrypted differently, in another file as well as in the same one
+    CHECK_EQUAL(pread(fd_1, ciphertext_1, 4096, 4096), 4096);
+    CHECK_EQUAL(pread(fd_2, ciphertext_2, 4096, 4096), 4096);
+    CHECK(memcmp(ciphertext_1, ciphertext_2, 4096) != 0);
+    {
+        AESCryptor cryptor(test_key);
+        cryptor.set_file_size(sizeof(data));
+        cryptor.write(fd_1, 0, data, 4096);
+    }
+    CHECK_EQUAL(pread(fd_1, ciphertext_2, 4096, 4096), 4096);
+    CHECK(memcmp(ciphertext_1, ciphertext_2, 4096) != 0);
+
+    // A block moved to another position along with its metadata fails
+    // authentication
+    char metadata[64];
+    CHECK_EQUAL(pread(fd_2, metadata, 64, 0), 64);
+    CHECK_EQUAL(pread(fd_2, ciphertext_2, 4096, 4096), 4096);
+    CHECK_EQUAL(pwrite(fd_2, metadata, 64, 64), 64);
+    CHECK_EQUAL(pwrite(fd_2, ciphertext_2, 4096, 4096 * 2), 4096);
+    {
+        AESCryptor cryptor(test_key);
+        cryptor.set_file_size(sizeof(data));
+        CHECK(cryptor.read(fd_2, 0, buffer, 4096));
+        CHECK_THROW(cryptor.read(fd_2, 4096, buffer, 4096), DecryptionFailed);
+    }
+
+    // A block written in a later version of the format is reported as such.
+    // The version follows the marker at the end of the hmac.
+    metadata[4 + 27] = 3;
+    CHECK_EQUAL(pwrite(fd_2, metadata, 64, 0), 64);
+    {
+        AESCryptor cryptor(test_key);
+        cryptor.set_file_size(sizeof(data));
+        CHECK_THROW(cryptor.read(fd_2, 0, buffer, 4096), UnsupportedEncryptionFormat);
+    }
+    close(fd_1);
+    close(fd_2);
+}
+#endif // !REALM_PLATFORM_APPLE
+
 #endif // REALM_ENABLE_ENCRYPTION
 #endif // TEST_ENCRYPTED_FILE_MAPPING
@@ -19,6 +19,7 @@
 #include "testsettings.hpp"
 #ifdef TEST_FILE
 
+#include <fstream>
 #include <ostream>
 #include <sstream>
 
@@ -178,6 +179,60 @@ TEST(File_MapMultiplePages)
     }
 }
 
+#ifdef __linux__
+namespace {
+
+// The VmFlags line of /proc/self/smaps for the mapping containing addr
+std::string get_vm_flags(const void* addr)
+{
+    std::ifstream smaps("/proc/self/smaps");
+    auto target = reinterpret_cast<uintptr_t>(addr);
+    bool found = false;
+    std::string line;
+    while (std::getline(smaps, line)) {
+        unsigned long long begin, end;
+        char dash;
+        std::istringstream range(line);
+        if (line.find(':') > line.find(' ') && range >> std::hex >> begin >> dash >> end && dash == '-') {
+            found = begin <= target && target < end;
+        }
+        else if (found && line.compare(0, 8, "VmFlags:") == 0) {
+            return line + " ";
+        }
+    }
+    return {};
+}
+
+} // unnamed namespace
+#endif
+
+TEST(File_MapAdvice)
+{
+    TEST_PATH(path);
+    const size_t size = 16 * page_size();
+    File f(path, File::mode_Write);
+    f.resize(size);
+    {
+        File::Map<char> map(f, File::access_ReadOnly, size, File::map_Sequential | File::map_WillNeed);
+        CHECK_EQUAL(map.get_addr()[size - 1], 0);
+#ifdef __linux__
+        std::string flags = get_vm_flags(map.get_addr());
+        CHECK_NOT_EQUAL(flags.find(" sr "), std::string::npos);
+        CHECK_EQUAL(flags.find(" rr "), std::string::npos);
+#endif
+    }
+    {
+        File::Map<char> map(f, File::access_ReadOnly, size, File::map_Random);
+        CHECK_EQUAL(map.get_addr()[0], 0);
+#ifdef __linux__
+        std::string flags = get_vm_flags(map.get_addr());
+        CHECK_NOT_EQUAL(flags.find(" rr "), std::string::npos);
+        CHECK_EQUAL(flags.find(" sr "), std::string::npos);
+#endif
+        File::advise_map(map.get_addr() + page_size(), page_size(), File::map_HugePages);
+    }
+}
+
 TEST(File_ReaderAndWriter)
 {
     const size_t count = 4096 / sizeof(size_t) * 256 * 2;
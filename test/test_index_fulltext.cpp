@@ -0,0 +1,257 @@
+/*************************************************************************
+ *
+ * Copyright 2021 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include "testsettings.hpp"
+#ifdef TEST_INDEX_FULLTEXT
+
+#include <realm.hpp>
+#include <realm/index_fulltext.hpp>
+#include <realm/history.hpp>
+#include "test.hpp"
+#include "util/random.hpp"
+
+using namespace realm;
+using namespace realm::util;
+using namespace realm::test_util;
+using unit_test::TestContext;
+
+// Test independence and thread-safety
+// -----------------------------------
+//
+// All tests must be thread safe and independent of each other. This
+// is required because it allows for both shuffling of the execution
+// order and for parallelized testing.
+//
+// In particular, avoid using std::rand() since it is not guaranteed
+// to be thread safe. Instead use the API offered in
+// `test/util/random.hpp`.
+//
+// All files created in tests must use the TEST_PATH macro (or one of
+// its friends) to obtain a suitable file system path. See
+// `test/util/test_path.hpp`.
+
+namespace {
+
+std::vector<ObjKey> keys_of(const TableView& tv)
+{
+    std::vector<ObjKey> keys;
+    for (size_t i = 0; i < tv.size(); ++i)
+        keys.push_back(tv.get_key(i));
+    return keys;
+}
+
+// Check that the index holds exactly the words of the column
+void check_index(TestContext& test_context, const Table& table, ColKey col)
+{
+    auto index = table.get_fulltext_index(col);
+    CHECK(index);
+    if (!index)
+        return;
+    size_t words = 0;
+    for (auto o : table) {
+        auto tokens = FullTextIndex::tokenize(o.get<StringData>(col));
+        words += tokens.size();
+        for (auto& token : tokens) {
+            std::vector<ObjKey> found;
+            index->find_all({{token, false}}, found);
+            CHECK(std::binary_search(found.begin(), found.end(), o.get_key()));
+        }
+    }
+    CHECK_EQUAL(index->size(), words);
+}
+
+} // unnamed namespace
+
+TEST(FullTextIndex_Tokenize)
+{
+    using Words = std::vector<std::string>;
+    CHECK(FullTextIndex::tokenize(StringData()) == Words{});
+    CHECK(FullTextIndex::tokenize("") == Words{});
+    CHECK(FullTextIndex::tokenize(" ,.-! ") == Words{});
+    CHECK(FullTextIndex::tokenize("The quick, brown FOX jumps over the lazy dog.") ==
+          (Words{"brown", "dog", "fox", "jumps", "lazy", "over", "quick", "the"}));
+    CHECK(FullTextIndex::tokenize("route66 isn't") == (Words{"isn", "route66", "t"}));
+    // Non-ASCII characters are part of words and kept as they are
+    CHECK(FullTextIndex::tokenize("Grüße aus Köln") == (Words{"aus", "grüße", "köln"}));
+
+    auto terms = FullTextIndex::parse_search("Quick bro* -dog");
+    CHECK_EQUAL(terms.size(), 3);
+    CHECK_EQUAL(terms[0].word, "quick");
+    CHECK_NOT(terms[0].prefix);
+    CHECK_EQUAL(terms[1].word, "bro");
+    CHECK(terms[1].prefix);
+    CHECK_EQUAL(terms[2].word, "dog");
+
+    CHECK(FullTextIndex::matches("The quick brown fox", FullTextIndex::parse_search("FOX qui*")));
+    CHECK_NOT(FullTextIndex::matches("The quick brown fox", FullTextIndex::parse_search("fox qui")));
+    CHECK_NOT(FullTextIndex::matches("The quick brown fox", FullTextIndex::parse_search("")));
+    CHECK_NOT(FullTextIndex::matches(StringData(), FullTextIndex::parse_search("fox")));
+}
+
+TEST(FullTextIndex_Maintenance)
+{
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    const char* words[] = {"alpha", "beta", "gamma", "delta", "Alphabet", "BETAMAX", "gam", "x"};
+    auto random_text = [&] {
+        std::string text;
+        size_t n = random.draw_int_mod(6);
+        for (size_t i = 0; i < n; ++i) {
+            text += words[random.draw_int_mod(8)];
+            text += random.draw_bool() ? " " : ", ";
+        }
+        return text;
+    };
+
+    Group g;
+    auto table = g.add_table("table");
+    auto col = table->add_column(type_String, "text", true);
+    auto col_int = table->add_column(type_Int, "int");
+    auto col_list = table->add_column_list(type_String, "list");
+
+    std::vector<ObjKey> keys;
+    for (size_t i = 0; i < 300; ++i)
+        keys.push_back(table->create_object().set(col, random_text()).get_key());
+
+    CHECK_THROW(table->add_fulltext_index(col_int), LogicError);
+    CHECK_THROW(table->add_fulltext_index(col_list), LogicError);
+    CHECK_NOT(table->has_fulltext_index(col));
+    table->add_fulltext_index(col);
+    table->add_fulltext_index(col); // Idempotent
+    CHECK(table->has_fulltext_index(col));
+    check_index(test_context, *table, col);
+
+    for (size_t i = 0; i < 1000; ++i) {
+        auto obj = table->get_object(keys[random.draw_int_mod(keys.size())]);
+        switch (random.draw_int_mod(4)) {
+            case 0:
+                obj.set(col, random_text());
+                break;
+            case 1:
+                obj.set_null(col);
+                break;
+            case 2:
+                keys.push_back(table->create_object(ObjKey{}, {{col, random_text()}}).get_key());
+                break;
+            case 3: {
+                auto it = std::find(keys.begin(), keys.end(), obj.get_key());
+                keys.erase(it);
+                obj.remove();
+                break;
+            }
+        }
+    }
+    check_index(test_context, *table, col);
+
+    // Changing nullability rebuilds the column and keeps the index
+    col = table->set_nullability(col, false, false);
+    CHECK(table->has_fulltext_index(col));
+    check_index(test_context, *table, col);
+
+    table->clear();
+    check_index(test_context, *table, col);
+
+    table->remove_fulltext_index(col);
+    CHECK_NOT(table->has_fulltext_index(col));
+    CHECK_NOT(table->get_fulltext_index(col));
+}
+
+TEST(FullTextIndex_Query)
+{
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    const char* words[] = {"red", "green", "blue", "Yellow", "redwood", "greenhouse", "blueberry", "café"};
+    Table table;
+    auto col = table.add_column(type_String, "text", true);
+    auto col_int = table.add_column(type_Int, "int");
+
+    for (size_t i = 0; i < 2000; ++i) {
+        auto obj = table.create_object();
+        std::string text;
+        size_t n = random.draw_int_mod(5);
+        for (size_t j = 0; j < n; ++j)
+            text += std::string(words[random.draw_int_mod(8)]) + " ";
+        if (random.draw_int_mod(50) != 0)
+            obj.set(col, text);
+        obj.set(col_int, random.draw_int<int64_t>(0, 9));
+    }
+
+    CHECK_THROW(table.where().text(col_int, "red"), LogicError);
+
+    auto run_queries = [&] {
+        std::vector<std::vector<ObjKey>> results;
+        std::vector<size_t> counts;
+        for (const char* search : {"red", "RED blue", "yellow", "green*", "blue* red", "café", "purple", "",
+                                   "redwood greenhouse blueberry yellow"}) {
+            Query q = table.where().text(col, search);
+            results.push_back(keys_of(q.find_all()));
+            counts.push_back(q.count());
+            results.push_back(keys_of(table.where().equal(col_int, 3).text(col, search).find_all()));
+            results.push_back(keys_of(table.where().text(col, search).Or().equal(col_int, 7).find_all()));
+        }
+        return std::make_pair(results, counts);
+    };
+
+    auto expected = run_queries();
+    table.add_fulltext_index(col);
+    auto actual = run_queries();
+    CHECK(expected.first == actual.first);
+    CHECK(expected.second == actual.second);
+
+    // Spot check the semantics against the column values
+    auto tv = table.where().text(col, "Gree*").find_all();
+    CHECK_GREATER(tv.size(), 0);
+    for (size_t i = 0; i < tv.size(); ++i) {
+        std::string value = table.get_object(tv.get_key(i)).get<StringData>(col);
+        CHECK(value.find("green") != std::string::npos);
+    }
+    size_t with_red = 0;
+    for (auto o : table) {
+        auto tokens = FullTextIndex::tokenize(o.get<StringData>(col));
+        if (std::binary_search(tokens.begin(), tokens.end(), "red"))
+            ++with_red;
+    }
+    CHECK_EQUAL(table.where().text(col, "red").count(), with_red);
+}
+
+TEST(FullTextIndex_FileFormat)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    auto file_format_version = [&] {
+        Group group(path, crypt_key());
+        return _impl::GroupFriend::get_file_format_version(group);
+    };
+
+    auto hist = make_in_realm_history(path);
+    DBRef db = DB::create(*hist, DBOptions(crypt_key()));
+    ColKey col;
+    {
+        WriteTransaction wt(db);
+        col = wt.add_table("table")->add_column(type_String, "text");
+        wt.get_table("table")->create_object().set(col, "a few words");
+        wt.commit();
+    }
+    CHECK_EQUAL(file_format_version(), 20);
+    {
+        WriteTransaction wt(db);
+        wt.get_table("table")->add_fulltext_index(col);
+        wt.commit();
+    }
+    CHECK_EQUAL(file_format_version(), 21);
+    CHECK_EQUAL(db->start_read()->get_table("table")->where().text(col, "few").count(), 1);
+}
+
+#endif // TEST_INDEX_FULLTEXT
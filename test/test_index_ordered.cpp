@@ -0,0 +1,413 @@
+/*************************************************************************
+ *
+ * Copyright 2021 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include "testsettings.hpp"
+#ifdef TEST_INDEX_ORDERED
+
+#include <realm.hpp>
+#include <realm/index_ordered.hpp>
+#include <realm/history.hpp>
+#include "test.hpp"
+#include "util/random.hpp"
+
+using namespace realm;
+using namespace realm::util;
+using namespace realm::test_util;
+using unit_test::TestContext;
+
+// Test independence and thread-safety
+// -----------------------------------
+//
+// All tests must be thread safe and independent of each other. This
+// is required because it allows for both shuffling of the execution
+// order and for parallelized testing.
+//
+// In particular, avoid using std::rand() since it is not guaranteed
+// to be thread safe. Instead use the API offered in
+// `test/util/random.hpp`.
+//
+// All files created in tests must use the TEST_PATH macro (or one of
+// its friends) to obtain a suitable file system path. See
+// `test/util/test_path.hpp`.
+
+namespace {
+
+// Check that the index holds exactly the values of the column, in order
+void check_index(TestContext& test_context, const Table& table, ColKey col)
+{
+    auto index = table.get_ordered_index(col);
+    CHECK(index);
+    if (!index)
+        return;
+    CHECK_EQUAL(index->size(), table.size());
+    for (size_t i = 0; i < index->size(); ++i) {
+        ObjKey key = index->get_key(i);
+        CHECK(table.is_valid(key));
+        if (!table.is_valid(key))
+            continue;
+        CHECK_EQUAL(index->get_value(i), table.get_object(key).get_any(col));
+        if (i > 0) {
+            int c = index->get_value(i - 1).compare(index->get_value(i));
+            CHECK(c < 0 || (c == 0 && index->get_key(i - 1) < key));
+        }
+    }
+}
+
+std::vector<ObjKey> keys_of(const TableView& tv)
+{
+    std::vector<ObjKey> keys;
+    for (size_t i = 0; i < tv.size(); ++i)
+        keys.push_back(tv.get_key(i));
+    return keys;
+}
+
+} // unnamed namespace
+
+TEST(OrderedIndex_Types)
+{
+    Table table;
+    auto col_int = table.add_column(type_Int, "int", true);
+    auto col_date = table.add_column(type_Timestamp, "date");
+    auto col_dec = table.add_column(type_Decimal, "decimal");
+    auto col_str = table.add_column(type_String, "string");
+    auto col_list = table.add_column_list(type_Int, "list");
+
+    CHECK_NOT(table.has_ordered_index(col_int));
+    table.add_ordered_index(col_int);
+    table.add_ordered_index(col_date);
+    table.add_ordered_index(col_dec);
+    table.add_ordered_index(col_int); // Idempotent
+    CHECK(table.has_ordered_index(col_int));
+    CHECK(table.has_ordered_index(col_date));
+    CHECK(table.has_ordered_index(col_dec));
+    CHECK_THROW(table.add_ordered_index(col_str), LogicError);
+    CHECK_THROW(table.add_ordered_index(col_list), LogicError);
+    CHECK_NOT(table.get_ordered_index(col_str));
+
+    table.remove_ordered_index(col_date);
+    CHECK_NOT(table.has_ordered_index(col_date));
+    CHECK(table.has_ordered_index(col_int));
+    table.remove_ordered_index(col_date); // Idempotent
+
+    // Removing a column drops its index, and a new column reusing the
+    // slot does not inherit it
+    table.remove_column(col_int);
+    auto col_int2 = table.add_column(type_Int, "int2");
+    CHECK_NOT(table.has_ordered_index(col_int2));
+    CHECK(table.has_ordered_index(col_dec));
+}
+
+TEST(OrderedIndex_Maintenance)
+{
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    Group g;
+    auto table = g.add_table("table");
+    auto col_int = table->add_column(type_Int, "int", true);
+    auto col_date = table->add_column(type_Timestamp, "date", true);
+    auto col_dec = table->add_column(type_Decimal, "decimal");
+
+    std::vector<ObjKey> keys;
+    table->create_objects(500, keys);
+    for (auto key : keys) {
+        auto obj = table->get_object(key);
+        obj.set(col_int, random.draw_int<int64_t>(-50, 50));
+        obj.set(col_date, Timestamp(random.draw_int<int64_t>(0, 100), 0));
+    }
+
+    // Populated from the existing objects
+    table->add_ordered_index(col_int);
+    table->add_ordered_index(col_date);
+    table->add_ordered_index(col_dec);
+    check_index(test_context, *table, col_int);
+    check_index(test_context, *table, col_date);
+    check_index(test_context, *table, col_dec);
+
+    for (size_t i = 0; i < 2000; ++i) {
+        auto obj = table->get_object(keys[random.draw_int_mod(keys.size())]);
+        switch (random.draw_int_mod(8)) {
+            case 0:
+                obj.set(col_int, random.draw_int<int64_t>(-50, 50));
+                break;
+            case 1:
+                obj.set_null(col_int);
+                break;
+            case 2:
+                if (!obj.is_null(col_int))
+                    obj.add_int(col_int, random.draw_int<int64_t>(-5, 5));
+                break;
+            case 3:
+                obj.set(col_date, Timestamp(random.draw_int<int64_t>(0, 100), 0));
+                break;
+            case 4:
+                obj.set_null(col_date);
+                break;
+            case 5:
+                obj.set(col_dec, Decimal128(random.draw_int<int64_t>(-10, 10)));
+                break;
+            case 6: {
+                // New objects get their initial values indexed
+                auto new_obj = table->create_object(ObjKey{}, {{col_int, random.draw_int<int64_t>(-50, 50)}});
+                keys.push_back(new_obj.get_key());
+                break;
+            }
+            case 7: {
+                auto it = std::find(keys.begin(), keys.end(), obj.get_key());
+                keys.erase(it);
+                obj.remove();
+                break;
+            }
+        }
+    }
+    check_index(test_context, *table, col_int);
+    check_index(test_context, *table, col_date);
+    check_index(test_context, *table, col_dec);
+
+    // Changing nullability rebuilds the column and keeps the index
+    col_dec = table->set_nullability(col_dec, true, false);
+    CHECK(table->has_ordered_index(col_dec));
+    check_index(test_context, *table, col_dec);
+
+    table->clear();
+    check_index(test_context, *table, col_int);
+    table->create_object().set(col_int, 7);
+    check_index(test_context, *table, col_int);
+}
+
+TEST(OrderedIndex_RangeQuery)
+{
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    Table table;
+    auto col_int = table.add_column(type_Int, "int", true);
+    auto col_date = table.add_column(type_Timestamp, "date");
+    auto col_dec = table.add_column(type_Decimal, "decimal", true);
+    auto col_other = table.add_column(type_Int, "other");
+
+    for (size_t i = 0; i < 5000; ++i) {
+        auto obj = table.create_object();
+        if (random.draw_int_mod(10) == 0)
+            obj.set_null(col_int);
+        else
+            obj.set(col_int, random.draw_int<int64_t>(0, 999));
+        obj.set(col_date, Timestamp(random.draw_int<int64_t>(0, 999), 0));
+        if (random.draw_int_mod(10) != 0)
+            obj.set(col_dec, Decimal128(random.draw_int<int64_t>(0, 999)));
+        obj.set(col_other, random.draw_int<int64_t>(0, 9));
+    }
+    // Remove some objects so that keys have gaps
+    for (size_t i = 0; i < 500; ++i)
+        table.remove_object(table.get_object(random.draw_int_mod(table.size())).get_key());
+
+    auto run_queries = [&] {
+        std::vector<std::vector<ObjKey>> results;
+        std::vector<size_t> counts;
+        auto add = [&](Query q) {
+            results.push_back(keys_of(q.find_all()));
+            counts.push_back(q.count());
+            results.push_back(keys_of(q.find_all(0, size_t(-1), 10)));
+            ObjKey first = q.find();
+            results.push_back(first ? std::vector<ObjKey>{first} : std::vector<ObjKey>{});
+        };
+        add(table.where().greater(col_int, 990));
+        add(table.where().greater_equal(col_int, 980).less(col_int, 990));
+        add(table.where().between(col_int, 100, 120).equal(col_other, 3));
+        add(table.where().less_equal(col_int, 5));
+        add(table.where().less(col_int, 500));
+        add(table.where().greater(col_int, 10).Or().less(col_int, 3));
+        add(table.where().Not().greater(col_int, 5));
+        add(table.where().less(col_date, Timestamp(10, 0)));
+        add(table.where().greater_equal(col_date, Timestamp(995, 0)));
+        add(table.where().greater(col_dec, Decimal128(989)));
+        add(table.where().less_equal(col_dec, Decimal128(3)));
+        return std::make_pair(results, counts);
+    };
+
+    auto expected = run_queries();
+    table.add_ordered_index(col_int);
+    table.add_ordered_index(col_date);
+    table.add_ordered_index(col_dec);
+    auto actual = run_queries();
+    CHECK(expected.first == actual.first);
+    CHECK(expected.second == actual.second);
+
+    // Aggregates driven by the index
+    CHECK_EQUAL(table.where().greater(col_int, 990).sum_int(col_other),
+                table.where().greater(col_int, 990).find_all().sum_int(col_other));
+}
+
+TEST(OrderedIndex_Sort)
+{
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    Table table;
+    auto col_int = table.add_column(type_Int, "int", true);
+    auto col_other = table.add_column(type_Int, "other");
+
+    for (size_t i = 0; i < 2000; ++i) {
+        auto obj = table.create_object();
+        if (random.draw_int_mod(20) == 0)
+            obj.set_null(col_int);
+        else
+            obj.set(col_int, random.draw_int<int64_t>(0, 99));
+        obj.set(col_other, random.draw_int<int64_t>(0, 9));
+    }
+
+    auto run_sorts = [&] {
+        std::vector<std::vector<ObjKey>> results;
+        for (bool ascending : {true, false}) {
+            for (size_t limit : {size_t(1), size_t(25), size_t(-1)}) {
+                DescriptorOrdering ordering;
+                ordering.append_sort(SortDescriptor({{col_int}}, {ascending}));
+                ordering.append_limit(LimitDescriptor(limit));
+                results.push_back(keys_of(table.where().find_all(ordering)));
+                results.push_back(keys_of(table.where().equal(col_other, 4).find_all(ordering)));
+
+                // Ties are broken by the second column
+                DescriptorOrdering ordering2;
+                ordering2.append_sort(SortDescriptor({{col_int}, {col_other}}, {ascending, !ascending}));
+                ordering2.append_limit(LimitDescriptor(limit));
+                results.push_back(keys_of(table.where().find_all(ordering2)));
+            }
+        }
+        return results;
+    };
+
+    auto expected = run_sorts();
+    table.add_ordered_index(col_int);
+    auto actual = run_sorts();
+    CHECK(expected == actual);
+}
+
+TEST(OrderedIndex_SortLimit)
+{
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    Table table;
+    auto col_int = table.add_column(type_Int, "int", true);
+    auto col_other = table.add_column(type_Int, "other");
+
+    for (size_t i = 0; i < 5000; ++i) {
+        auto obj = table.create_object();
+        if (random.draw_int_mod(20) != 0)
+            obj.set(col_int, random.draw_int<int64_t>(0, 999));
+        obj.set(col_other, random.draw_int<int64_t>(0, 9));
+    }
+
+    // A sort followed by a limit must give the first entries of the full sort
+    auto check_limits = [&](Query q) {
+        for (bool ascending : {true, false}) {
+            SortDescriptor sort({{col_int}, {col_other}}, {ascending, true});
+            DescriptorOrdering full;
+            full.append_sort(sort);
+            auto all = keys_of(q.find_all(full));
+            for (size_t limit : {size_t(0), size_t(1), size_t(10), size_t(300), size_t(4000)}) {
+                DescriptorOrdering ordering;
+                ordering.append_sort(sort);
+                ordering.append_limit(LimitDescriptor(limit));
+                auto tv = q.find_all(ordering);
+                size_t expected_size = std::min(limit, all.size());
+                CHECK(keys_of(tv) == std::vector<ObjKey>(all.begin(), all.begin() + expected_size));
+                CHECK_EQUAL(tv.get_num_results_excluded_by_limit(), all.size() - expected_size);
+            }
+        }
+    };
+
+    check_limits(table.where());
+    check_limits(table.where().equal(col_other, 5));
+    check_limits(table.where().greater(col_other, 7));
+    table.add_ordered_index(col_int);
+    check_limits(table.where());
+    check_limits(table.where().equal(col_other, 5));
+    check_limits(table.where().greater(col_other, 7));
+
+    // The view is kept up to date after changes
+    DescriptorOrdering ordering;
+    ordering.append_sort(SortDescriptor({{col_int}}, {false}));
+    ordering.append_limit(LimitDescriptor(3));
+    auto tv = table.where().find_all(ordering);
+    auto top = table.create_object().set(col_int, 5000);
+    tv.sync_if_needed();
+    CHECK_EQUAL(tv.size(), 3);
+    CHECK_EQUAL(tv.get_key(0), top.get_key());
+    CHECK_EQUAL(tv.get_num_results_excluded_by_limit(), table.size() - 3);
+}
+
+TEST(OrderedIndex_FileFormat)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    using gf = _impl::GroupFriend;
+    auto file_format_version = [&] {
+        Group group(path, crypt_key());
+        return gf::get_file_format_version(group);
+    };
+
+    ColKey col;
+    {
+        auto hist = make_in_realm_history(path);
+        DBRef db = DB::create(*hist, DBOptions(crypt_key()));
+        WriteTransaction wt(db);
+        col = wt.add_table("table")->add_column(type_Int, "int");
+        wt.get_table("table")->create_object().set(col, 7);
+        wt.commit();
+    }
+    CHECK_EQUAL(file_format_version(), 20);
+
+    {
+        auto hist = make_in_realm_history(path);
+        DBRef db = DB::create(*hist, DBOptions(crypt_key()));
+        auto tr = db->start_write();
+        tr->get_table("table")->add_ordered_index(col);
+        tr->rollback_and_continue_as_read();
+        tr->promote_to_write();
+        tr->get_table("table")->create_object().set(col, 8);
+        tr->commit();
+    }
+    // Rolling back forgets the index
+    CHECK_EQUAL(file_format_version(), 20);
+
+    {
+        auto hist = make_in_realm_history(path);
+        auto other_hist = make_in_realm_history(path);
+        DBRef db = DB::create(*hist, DBOptions(crypt_key()));
+        DBRef other = DB::create(*other_hist, DBOptions(crypt_key()));
+        {
+            WriteTransaction wt(db);
+            wt.get_table("table")->add_ordered_index(col);
+            wt.commit();
+        }
+        // Commits of other participants of the session keep the format
+        WriteTransaction wt(other);
+        wt.get_table("table")->create_object().set(col, 9);
+        wt.commit();
+    }
+    CHECK_EQUAL(file_format_version(), 21);
+
+    // The file stays in the extended format when the index is removed
+    {
+        auto hist = make_in_realm_history(path);
+        DBRef db = DB::create(*hist, DBOptions(crypt_key()));
+        {
+            WriteTransaction wt(db);
+            CHECK(wt.get_table("table")->has_ordered_index(col));
+            wt.get_table("table")->remove_ordered_index(col);
+            wt.commit();
+        }
+        CHECK(db->compact());
+        CHECK_EQUAL(db->start_read()->get_table("table")->size(), 3);
+    }
+    CHECK_EQUAL(file_format_version(), 21);
+}
+
+#endif // TEST_INDEX_ORDERED
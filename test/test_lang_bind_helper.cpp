@@ -930,14 +930,15 @@ TEST(LangBindHelper_AdvanceReadTransact_EnumeratedStrings)
     CHECK_EQUAL(0, rt->size());
 
     // Create 3 string columns, one primed for conversion to "unique string
-    // enumeration" representation
+    // enumeration" representation. The table is too small for the column to
+    // be enumerated on commit.
     {
         WriteTransaction wt(sg);
         TableRef table_w = wt.add_table("t");
         c0 = table_w->add_column(type_String, "a");
         c1 = table_w->add_column(type_String, "b");
         c2 = table_w->add_column(type_String, "c");
-        for (int i = 0; i < 1000; ++i) {
+        for (int i = 0; i < 500; ++i) {
             std::ostringstream out;
             out << i;
             std::string str = out.str();
@@ -1093,6 +1093,75 @@ NONCONCURRENT_TEST_IF(Metrics_NumDecryptedPagesWithEncryption, REALM_ENABLE_ENCR
     CHECK_EQUAL(transactions->at(1).get_num_decrypted_pages(), 1);
 }
 
+// this test relies on the global state of the decrypted pages and therefore must be run in isolation
+NONCONCURRENT_TEST_IF(Metrics_DecryptedMemoryBudget, REALM_ENABLE_ENCRYPTION)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    std::unique_ptr<Replication> hist(make_in_realm_history(path));
+    DBOptions options(crypt_key(true));
+    options.enable_metrics = true;
+    options.metrics_buffer_size = 10;
+    auto sg = DB::create(*hist, options);
+    const size_t num_objects = 2000;
+    std::string str(1000, 'a');
+    {
+        auto tr = sg->start_write();
+        auto table = tr->add_table("table");
+        auto col = table->add_column(type_String, "str");
+        // Distinct values, so that the column is not enumerated
+        for (size_t i = 0; i < num_objects; ++i) {
+            std::string value = util::to_string(i);
+            value.resize(str.size(), 'a');
+            table->create_object().set(col, value);
+        }
+        tr->commit();
+    }
+
+    const size_t budget = 64 * 1024;
+    realm::util::set_decrypted_memory_budget(budget);
+    auto on_exit = make_scope_exit([]() noexcept { realm::util::set_decrypted_memory_budget(0); });
+    CHECK_EQUAL(realm::util::get_decrypted_memory_budget(), budget);
+    auto before = realm::util::get_decrypted_memory_stats();
+    CHECK_EQUAL(before.memory_budget, budget);
+
+    {
+        auto rt = sg->start_read();
+        auto table = rt->get_table("table");
+        auto col = table->get_column_key("str");
+        size_t total_size = 0;
+        for (auto& obj : *table)
+            total_size += obj.get<String>(col).size();
+        CHECK_EQUAL(total_size, num_objects * str.size());
+    }
+
+    // Once no transaction uses the pages, the reclaimer gets below the budget.
+    // The memory size is the one seen by the latest pass of the reclaimer.
+    auto stats = realm::util::get_decrypted_memory_stats();
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    while ((stats.num_evictions == before.num_evictions || stats.memory_size > budget) &&
+           std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        stats = realm::util::get_decrypted_memory_stats();
+    }
+    CHECK_LESS_EQUAL(stats.memory_size, budget);
+    CHECK_GREATER(stats.num_hits, before.num_hits);
+    CHECK_GREATER(stats.num_misses, before.num_misses);
+    CHECK_GREATER(stats.num_evictions, before.num_evictions);
+
+    {
+        auto rt = sg->start_read();
+    }
+    std::shared_ptr<Metrics> metrics = sg->get_metrics();
+    CHECK(metrics);
+    std::unique_ptr<Metrics::TransactionInfoList> transactions = metrics->take_transactions();
+    CHECK(transactions);
+    CHECK_EQUAL(transactions->size(), 3);
+    const auto& exported = transactions->at(2).get_decrypted_memory_stats();
+    CHECK_EQUAL(exported.memory_budget, budget);
+    CHECK_GREATER_EQUAL(exported.num_evictions, stats.num_evictions);
+    CHECK_EQUAL(transactions->at(2).get_num_decrypted_pages(), exported.memory_size / realm::util::page_size());
+}
+
 TEST(Metrics_MemoryChecks)
 {
     SHARED_GROUP_TEST_PATH(path);
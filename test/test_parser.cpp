@@ -790,6 +790,35 @@ TEST(Parser_StringOperations)
 }
 
 
+TEST(Parser_Text)
+{
+    Group g;
+    TableRef t = g.add_table("book");
+    ColKey title_col = t->add_column(type_String, "title", true);
+    t->add_column(*t, "sequel");
+    std::vector<std::string> titles = {"The Old Man and the Sea", "The Sea-Wolf", "Treasure Island",
+                                       "The Man in the High Castle"};
+    for (auto& title : titles)
+        t->create_object().set(title_col, StringData(title));
+    t->create_object(); // null
+
+    for (bool with_index : {false, true}) {
+        if (with_index)
+            t->add_fulltext_index(title_col);
+        verify_query(test_context, t, "title TEXT 'sea'", 2);
+        verify_query(test_context, t, "title text 'SEA the'", 2);
+        verify_query(test_context, t, "title TEXT 'man sea'", 1);
+        verify_query(test_context, t, "title TEXT 'tre*'", 1);
+        verify_query(test_context, t, "title TEXT 'whale'", 0);
+        verify_query(test_context, t, "!(title TEXT 'man')", 3);
+    }
+
+    // Only a string property of the queried object can be searched
+    CHECK_THROW_ANY(verify_query(test_context, t, "sequel.title TEXT 'sea'", 0));
+    CHECK_THROW_ANY(verify_query(test_context, t, "'sea' TEXT title", 0));
+}
+
+
 TEST(Parser_Timestamps)
 {
     Group g;
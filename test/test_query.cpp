@@ -32,6 +32,7 @@ using namespace std::chrono;
 #include <realm/history.hpp>
 #include <realm/query_expression.hpp>
 #include <realm/index_string.hpp>
+#include <realm/column_statistics.hpp>
 #include <realm/query_expression.hpp>
 #include "test.hpp"
 #include "test_table_helper.hpp"
@@ -5877,4 +5878,177 @@ TEST(Query_OptimalNode)
     // std::cout << "cnt: " << cnt << " dur3: " << dur3 << " us" << std::endl;
 }
 
+TEST(Query_ColumnStatistics)
+{
+    Group g;
+    TableRef table = g.add_table("table");
+    auto col_age = table->add_column(type_Int, "age");
+    auto col_kind = table->add_column(type_String, "kind");
+    auto col_score = table->add_column(type_Double, "score", true);
+    table->add_search_index(col_kind);
+
+    for (int i = 0; i < 100; i++) {
+        table->create_object().set(col_age, i);
+    }
+    // Too small to be worth sampling
+    CHECK_NOT(table->get_column_statistics(col_age));
+
+    table->clear();
+    for (int i = 0; i < 10000; i++) {
+        auto obj = table->create_object();
+        obj.set(col_age, i % 100);
+        obj.set(col_kind, i % 10 ? std::string("common") : "rare" + util::to_string(i));
+        if (i % 4)
+            obj.set(col_score, double(i));
+    }
+
+    auto stats = table->get_column_statistics(col_age);
+    CHECK(stats);
+    CHECK_EQUAL(stats->get_row_count(), 10000);
+    CHECK_EQUAL(stats->get_min(), Mixed(0));
+    CHECK_EQUAL(stats->get_max(), Mixed(99));
+    CHECK_EQUAL(stats->get_distinct_count(), 100);
+    CHECK_EQUAL(stats->get_null_count(), 0);
+    CHECK_APPROXIMATELY_EQUAL(stats->estimate_selectivity<Equal>(5), 0.01, 0.25);
+    CHECK_APPROXIMATELY_EQUAL(stats->estimate_selectivity<NotEqual>(5), 0.99, 0.01);
+    CHECK_APPROXIMATELY_EQUAL(stats->estimate_selectivity<Less>(50), 0.5, 0.05);
+    CHECK_APPROXIMATELY_EQUAL(stats->estimate_selectivity<GreaterEqual>(50), 0.5, 0.05);
+    CHECK_LESS(stats->estimate_selectivity<Greater>(1000), 0.001);
+    CHECK_LESS(stats->estimate_selectivity<BeginsWith>(5), 0);
+
+    // Cached until the table size drifts
+    CHECK_EQUAL(table->get_column_statistics(col_age), stats);
+    auto score_stats = table->get_column_statistics(col_score);
+    CHECK_APPROXIMATELY_EQUAL(double(score_stats->get_null_count()), 2500, 0.05);
+    CHECK_APPROXIMATELY_EQUAL(score_stats->estimate_selectivity<Equal>(Mixed()), 0.25, 0.05);
+
+    auto kind_stats = table->get_column_statistics(col_kind);
+    CHECK_APPROXIMATELY_EQUAL(kind_stats->estimate_selectivity<Equal>("common"), 0.9, 0.03);
+    CHECK_LESS(kind_stats->estimate_selectivity<Equal>("rare10"), 0.01);
+
+    // Results do not depend on the node order or on whether the index is used
+    CHECK_EQUAL(table->where().equal(col_kind, "common").count(), 9000);
+    CHECK_EQUAL(table->where().equal(col_kind, "rare20").count(), 1);
+    CHECK_EQUAL(table->where().equal(col_kind, "common").equal(col_age, 5).count(), 100);
+    CHECK_EQUAL(table->where().equal(col_age, 10).equal(col_kind, "rare10").count(), 1);
+    CHECK_EQUAL(table->where().greater(col_score, 9000.0).less(col_age, 3).count(), 20);
+
+    // The most selective condition is evaluated first, whatever the order of
+    // the conditions in the query
+    using Order = std::vector<ColKey>;
+    CHECK(table->where().equal(col_kind, "common").equal(col_age, 5).get_evaluation_order() ==
+          Order({col_age, col_kind}));
+    CHECK(table->where().greater(col_score, 9000.0).less(col_age, 3).get_evaluation_order() ==
+          Order({col_age, col_score}));
+    CHECK(table->where().less(col_age, 95).greater(col_score, 9000.0).get_evaluation_order() ==
+          Order({col_score, col_age}));
+
+    for (int i = 0; i < 2000; i++) {
+        table->create_object().set(col_age, 100);
+    }
+    auto new_stats = table->get_column_statistics(col_age);
+    CHECK_NOT_EQUAL(new_stats, stats);
+    CHECK_EQUAL(new_stats->get_max(), Mixed(100));
+}
+
+TEST(Query_ColumnStatisticsShared)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    DBRef db = DB::create(path);
+    ColKey col_age;
+    {
+        WriteTransaction wt(db);
+        auto table = wt.add_table("table");
+        wt.add_table("other")->add_column(type_Int, "int");
+        col_age = table->add_column(type_Int, "age");
+        for (int i = 0; i < 5000; i++)
+            table->create_object().set(col_age, i % 100);
+        // Not shared while the table is modified in the transaction
+        auto stats = table->get_column_statistics(col_age);
+        CHECK(stats);
+        wt.commit();
+        CHECK_NOT_EQUAL(stats, db->start_read()->get_table("table")->get_column_statistics(col_age));
+    }
+
+    // Transactions share the statistics of the same content
+    auto rt_1 = db->start_read();
+    auto stats = rt_1->get_table("table")->get_column_statistics(col_age);
+    CHECK(stats);
+    CHECK_EQUAL(db->start_read()->get_table("table")->get_column_statistics(col_age), stats);
+    CHECK_EQUAL(db->start_frozen()->get_table("table")->get_column_statistics(col_age), stats);
+
+    // and of later versions, until the table is modified
+    {
+        WriteTransaction wt(db);
+        wt.get_table("other")->create_object();
+        wt.commit();
+    }
+    CHECK_EQUAL(db->start_read()->get_table("table")->get_column_statistics(col_age), stats);
+    {
+        WriteTransaction wt(db);
+        auto table = wt.get_table("table");
+        CHECK_EQUAL(table->get_column_statistics(col_age), stats);
+        table->add_column(type_String, "name");
+        wt.commit();
+    }
+    auto new_stats = db->start_read()->get_table("table")->get_column_statistics(col_age);
+    CHECK(new_stats);
+    CHECK_NOT_EQUAL(new_stats, stats);
+    CHECK_EQUAL(new_stats->get_row_count(), 5000);
+}
+
+TEST(Query_ClusterSkipping)
+{
+    Group g;
+    TableRef table = g.add_table("table");
+    auto col_seq = table->add_column(type_Int, "seq");
+    auto col_opt = table->add_column(type_Int, "opt", true);
+    auto col_created = table->add_column(type_Timestamp, "created");
+
+    // Append-only time series, so each cluster covers a narrow range
+    const int n = 20000;
+    for (int i = 0; i < n; i++) {
+        auto obj = table->create_object();
+        obj.set(col_seq, i);
+        if (i < n / 2)
+            obj.set(col_opt, i / 1000);
+        obj.set(col_created, Timestamp(1600000000 + i, 0));
+    }
+
+    auto check = [&] {
+        // Run every query twice, as summaries are only computed on the second visit of a leaf
+        for (int run = 0; run < 2; run++) {
+            CHECK_EQUAL(table->where().greater(col_seq, n - 100).count(), 99);
+            CHECK_EQUAL(table->where().less_equal(col_seq, 10).count(), 11);
+            CHECK_EQUAL(table->where().equal(col_seq, 12345).count(), 1);
+            CHECK_EQUAL(table->where().not_equal(col_seq, 12345).count(), n - 1);
+            CHECK_EQUAL(table->where().between(col_seq, 5000, 5999).count(), 1000);
+            CHECK_EQUAL(table->where().equal(col_opt, null()).count(), n / 2);
+            CHECK_EQUAL(table->where().not_equal(col_opt, 3).count(), n - 1000);
+            CHECK_EQUAL(table->where().greater(col_opt, 8).count(), 1000);
+            CHECK_EQUAL(table->where().greater(col_created, Timestamp(1600000000 + n - 50, 0)).count(), 49);
+            CHECK_EQUAL(table->where().less(col_created, Timestamp(1600000000 + 20, 0)).count(), 20);
+            CHECK_EQUAL(table->where().greater_equal(col_created, Timestamp(1600000000 + 100, 0))
+                            .less(col_seq, 200)
+                            .count(),
+                        100);
+            CHECK_EQUAL(table->where().greater(col_seq, n - 10).find(), table->get_object(n - 9).get_key());
+            CHECK_EQUAL(table->where().Not().greater(col_seq, 9).count(), 10);
+            CHECK_EQUAL(table->where().greater(col_seq, n).count(), 0);
+        }
+    };
+    check();
+
+    // Changing the table invalidates the summaries
+    table->get_object(0).set(col_seq, n + 1);
+    table->get_object(1).set(col_seq, -1);
+    CHECK_EQUAL(table->where().greater(col_seq, n).count(), 1);
+    CHECK_EQUAL(table->where().greater(col_seq, n).count(), 1);
+    CHECK_EQUAL(table->where().less(col_seq, 0).count(), 1);
+    CHECK_EQUAL(table->where().less(col_seq, 0).count(), 1);
+    table->get_object(0).set(col_seq, 0);
+    table->get_object(1).set(col_seq, 1);
+    check();
+}
+
 #endif // TEST_QUERY
@@ -621,4 +621,62 @@ TEST(Query_TableInitialization)
     });
 }
 
+TEST(Query_Parallel)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    std::unique_ptr<Replication> hist(make_in_realm_history(path));
+    DBRef db = DB::create(*hist);
+    ColKey col_int;
+    ColKey col_double;
+    {
+        auto wt = db->start_write();
+        auto table = wt->add_table("table");
+        col_int = table->add_column(type_Int, "int");
+        col_double = table->add_column(type_Double, "double");
+        for (int i = 0; i < 100000; ++i) {
+            table->create_object().set(col_int, (i * 7919) % 1000).set(col_double, double(i % 37));
+        }
+        wt->commit();
+    }
+
+    auto frozen = db->start_frozen();
+    auto table = frozen->get_table("table");
+
+    Query serial = table->where().greater(col_int, 100).less(col_double, 30.0);
+    Query parallel = serial;
+    parallel.set_threads(4);
+    CHECK_EQUAL(parallel.get_threads(), 4);
+
+    CHECK_EQUAL(parallel.count(), serial.count());
+
+    TableView tv_serial = serial.find_all();
+    TableView tv_parallel = parallel.find_all();
+    CHECK_EQUAL(tv_parallel.size(), tv_serial.size());
+    bool same_order = true;
+    for (size_t i = 0; i < tv_serial.size(); ++i) {
+        if (tv_serial.get_key(i) != tv_parallel.get_key(i))
+            same_order = false;
+    }
+    CHECK(same_order);
+
+    CHECK_EQUAL(parallel.sum_int(col_int), serial.sum_int(col_int));
+    ObjKey serial_key;
+    ObjKey parallel_key;
+    CHECK_EQUAL(parallel.maximum_int(col_int, &parallel_key), serial.maximum_int(col_int, &serial_key));
+    CHECK_EQUAL(parallel_key, serial_key);
+    CHECK_EQUAL(parallel.minimum_double(col_double, &parallel_key), serial.minimum_double(col_double, &serial_key));
+    CHECK_EQUAL(parallel_key, serial_key);
+    size_t serial_count = 0;
+    size_t parallel_count = 0;
+    CHECK_APPROXIMATELY_EQUAL(parallel.average_double(col_double, &parallel_count),
+                              serial.average_double(col_double, &serial_count), 1e-9);
+    CHECK_EQUAL(parallel_count, serial_count);
+
+    // Queries on a live transaction fall back to running on the calling thread
+    auto rt = db->start_read();
+    Query live = rt->get_table("table")->where().greater(col_int, 100).less(col_double, 30.0);
+    live.set_threads(4);
+    CHECK_EQUAL(live.count(), serial.count());
+}
+
 #endif
@@ -22,6 +22,7 @@
 #include <condition_variable>
 #include <streambuf>
 #include <fstream>
+#include <set>
 #include <tuple>
 #include <iostream>
 #include <fstream>
@@ -50,6 +51,7 @@
 #include <realm/util/thread.hpp>
 #include <realm/util/to_string.hpp>
 #include <realm/impl/simulated_failure.hpp>
+#include <realm/warm_start.hpp>
 
 #include "fuzz_group.hpp"
 
@@ -643,6 +645,160 @@ TEST(Shared_EncryptedRemap)
 }
 
 
+#if REALM_ENABLE_ENCRYPTION && !defined(_WIN32) && !REALM_PLATFORM_APPLE
+TEST(Shared_EncryptionUpgrade)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    const char* key = crypt_key(true);
+    std::string str(10000, 'a');
+    {
+        DBRef sg = DB::create(path, false, DBOptions(key));
+        WriteTransaction wt(sg);
+        auto t = wt.add_table("test");
+        auto col = t->add_column(type_String, "str");
+        for (int i = 0; i < 100; ++i)
+            t->create_object().set(col, str);
+        wt.commit();
+    }
+
+    DBOptions options(key);
+    options.upgrade_encryption = true;
+    {
+        // Upgraded when the session starts
+        DBRef sg = DB::create(path, true, options);
+        {
+            ReadTransaction rt(sg);
+            auto t = rt.get_table("test");
+            CHECK_EQUAL(t->size(), 100);
+            CHECK_EQUAL(t->get_object(99).get<String>("str"), str);
+            rt.get_group().verify();
+        }
+        WriteTransaction wt(sg);
+        auto t = wt.get_table("test");
+        auto col = t->get_column_key("str");
+        for (int i = 0; i < 100; ++i)
+            t->create_object().set(col, "b");
+        wt.commit();
+        CHECK(sg->compact());
+    }
+    // Nothing left to upgrade, even after writing and compacting
+    CHECK_NOT(util::upgrade_encryption(path, key));
+
+    {
+        // The new format is used without the option too
+        DBRef sg = DB::create(path, true, DBOptions(key));
+        {
+            WriteTransaction wt(sg);
+            wt.get_table("test")->clear();
+            wt.commit();
+        }
+        ReadTransaction rt(sg);
+        CHECK_EQUAL(rt.get_table("test")->size(), 0);
+        rt.get_group().verify();
+    }
+    CHECK_NOT(util::upgrade_encryption(path, key));
+}
+#endif
+
+
+TEST(Shared_MappingHints)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    std::string str(10000, 'a');
+    DBOptions options(crypt_key());
+    options.access_pattern = DBOptions::AccessPattern::Sequential;
+    options.prefetch_on_open = true;
+    options.huge_pages = true;
+    {
+        DBRef sg = DB::create(path, false, options);
+        // Grow the file over several commits, so mappings are extended
+        for (int i = 0; i < 10; ++i) {
+            WriteTransaction wt(sg);
+            auto t = i == 0 ? wt.add_table("test") : wt.get_table("test");
+            auto col = i == 0 ? t->add_column(type_String, "str") : t->get_column_key("str");
+            for (int j = 0; j < 100; ++j)
+                t->create_object().set(col, str);
+            wt.commit();
+        }
+    }
+
+    options.access_pattern = DBOptions::AccessPattern::Random;
+    DBRef sg = DB::create(path, true, options);
+    ReadTransaction rt(sg);
+    auto t = rt.get_table("test");
+    CHECK_EQUAL(t->size(), 1000);
+    CHECK_EQUAL(t->get_object(999).get<String>("str"), str);
+    rt.get_group().verify();
+}
+
+
+TEST(Shared_WarmStart)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    std::string warm_start_path = WarmStart::get_path(path);
+    DBOptions options;
+    options.warm_start = true;
+    {
+        DBRef sg = DB::create(path, false, options);
+        WriteTransaction wt(sg);
+        auto t = wt.add_table("test");
+        auto col_int = t->add_column(type_Int, "int");
+        auto col_str = t->add_column(type_String, "str");
+        t->add_search_index(col_str);
+        for (int i = 0; i < 10000; ++i)
+            t->create_object().set(col_int, i).set(col_str, std::string(i % 100, 'a'));
+        wt.commit();
+    }
+    // Recorded on close
+    CHECK(File::exists(warm_start_path));
+    auto core_files = DB::get_core_files(path);
+    CHECK(std::find(core_files.begin(), core_files.end(), std::make_pair(warm_start_path, false)) !=
+          core_files.end());
+
+    std::vector<WarmStart::Range> ranges = WarmStart::load(path);
+    CHECK(!ranges.empty());
+    size_t file_size = size_t(File(path).get_size());
+    size_t recorded = 0;
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        CHECK_EQUAL(ranges[i].offset % page_size(), 0);
+        CHECK_EQUAL(ranges[i].size % page_size(), 0);
+        CHECK_LESS_EQUAL(ranges[i].offset + ranges[i].size, round_up(file_size, page_size()));
+        if (i > 0)
+            CHECK_GREATER(ranges[i].offset, ranges[i - 1].offset + ranges[i - 1].size);
+        recorded += size_t(ranges[i].size);
+    }
+    // Leaves holding only values are left out
+    CHECK_LESS(recorded, file_size);
+    {
+        // Read ahead by the next session
+        DBRef sg = DB::create(path, true, options);
+        ReadTransaction rt(sg);
+        auto t = rt.get_table("test");
+        CHECK_EQUAL(t->size(), 10000);
+        CHECK_EQUAL(t->find_first_string(t->get_column_key("str"), std::string(42, 'a')), t->get_object(42).get_key());
+        rt.get_group().verify();
+    }
+
+    // A damaged profile is ignored
+    {
+        File file(warm_start_path, File::mode_Update);
+        file.seek(sizeof(uint64_t));
+        file.write("x", 1);
+    }
+    CHECK(WarmStart::load(path).empty());
+    {
+        DBRef sg = DB::create(path, true, options);
+        ReadTransaction rt(sg);
+        CHECK_EQUAL(rt.get_table("test")->size(), 10000);
+    }
+    CHECK_NOT(WarmStart::load(path).empty());
+
+    // Not used without the option
+    File::remove(warm_start_path);
+    DB::create(path, true)->close();
+    CHECK_NOT(File::exists(warm_start_path));
+}
+
 TEST(Shared_Initial)
 {
     SHARED_GROUP_TEST_PATH(path);
@@ -1557,6 +1713,219 @@ TEST(Shared_WriterThreads)
 }
 
 
+TEST(Shared_GroupCommit)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    const int thread_count = 10;
+    {
+        DBOptions options;
+        options.group_commit_window = std::chrono::milliseconds(1);
+        DBRef sg = DB::create(path, false, options);
+
+        {
+            WriteTransaction wt(sg);
+            auto t1 = wt.add_table("test");
+            test_table_add_columns(t1);
+            for (int i = 0; i < thread_count; ++i)
+                t1->create_object(ObjKey(i)).set_all(0, 2, false, "test");
+            wt.commit();
+        }
+
+        Thread threads[thread_count];
+        for (int i = 0; i < thread_count; ++i)
+            threads[i].start([this, &sg, i] { writer_threads_thread(test_context, sg, ObjKey(i)); });
+        for (int i = 0; i < thread_count; ++i)
+            threads[i].join();
+
+        auto tr = sg->start_write();
+        auto t = tr->get_table("test");
+        t->get_object(ObjKey(0)).add_int(t->get_column_keys()[0], 1);
+        tr->commit_and_continue_as_read();
+        CHECK_EQUAL(t->get_object(ObjKey(0)).get<Int>(t->get_column_keys()[0]), 101);
+    }
+
+    // All commits were made durable, so a new session sees them
+    {
+        DBRef sg = DB::create(path);
+        ReadTransaction rt(sg);
+        rt.get_group().verify();
+        auto t = rt.get_table("test");
+        auto col = t->get_column_keys()[0];
+        for (int i = 0; i < thread_count; ++i) {
+            int64_t v = t->get_object(ObjKey(i)).get<Int>(col);
+            CHECK_EQUAL(i == 0 ? 101 : 100, v);
+        }
+    }
+
+    // The file on disk trails the committed version while a commit waits
+    // for the window to pass, and a commit made within the window is made
+    // durable by the same flush
+    auto durable_value = [&](ObjKey key) {
+        Group g(path);
+        auto t = g.get_table("test");
+        return t->get_object(key).get<Int>(t->get_column_keys()[0]);
+    };
+    DBOptions options;
+    options.group_commit_window = std::chrono::milliseconds(500);
+    DBRef sg = DB::create(path, false, options);
+    auto increment = [&](ObjKey key) {
+        WriteTransaction wt(sg);
+        auto t = wt.get_table("test");
+        t->get_object(key).add_int(t->get_column_keys()[0], 1);
+        wt.commit();
+    };
+    auto version = sg->get_version_of_latest_snapshot();
+    int64_t value_seen_by_first = 0;
+    Thread first;
+    first.start([&] {
+        increment(ObjKey(1));
+        value_seen_by_first = durable_value(ObjKey(2));
+    });
+    while (sg->get_version_of_latest_snapshot() == version)
+        millisleep(1);
+    CHECK_EQUAL(durable_value(ObjKey(1)), 100);
+    increment(ObjKey(2));
+    first.join();
+    CHECK_EQUAL(value_seen_by_first, 101);
+    CHECK_EQUAL(durable_value(ObjKey(1)), 101);
+}
+
+TEST(Shared_AsyncInProcess)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    {
+        DBOptions options(DBOptions::Durability::Async);
+        options.group_commit_window = std::chrono::milliseconds(1);
+        DBRef sg = DB::create(path, false, options);
+
+        DB::version_type version = 0;
+        for (int i = 0; i < 20; ++i) {
+            WriteTransaction wt(sg);
+            auto t1 = wt.get_or_add_table("test");
+            if (t1->is_empty())
+                test_table_add_columns(t1);
+            t1->create_object().set_all(1, i, false, "test");
+            version = wt.commit();
+        }
+        sg->wait_for_durable(version);
+        CHECK_THROW(sg->wait_for_durable(version + 1), LogicError);
+
+        // Commits that have not been flushed yet are flushed on close
+        WriteTransaction wt(sg);
+        wt.get_table("test")->create_object().set_all(1, 20, false, "test");
+        wt.commit();
+    }
+
+    DBRef sg = DB::create(path);
+    ReadTransaction rt(sg);
+    rt.get_group().verify();
+    CHECK_EQUAL(21, rt.get_table("test")->size());
+}
+
+TEST(Shared_WriteAheadLog)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    SHARED_GROUP_TEST_PATH(path_2);
+    std::string wal_path = WriteAheadLog::get_path(path);
+    {
+        DBOptions options;
+        options.write_ahead_log = true;
+        DBRef sg = DB::create(path, false, options);
+        for (int i = 0; i < 20; ++i) {
+            WriteTransaction wt(sg);
+            auto t1 = wt.get_or_add_table("test");
+            if (t1->is_empty())
+                test_table_add_columns(t1);
+            t1->create_object().set_all(1, i, false, "test");
+            wt.commit();
+        }
+        CHECK_GREATER(File(wal_path).get_size(), 0);
+
+        // All participants must agree on using the log
+        CHECK_THROW(DB::create(path), LogicError);
+
+        // A copy of the file made now still has the header of the last
+        // checkpoint, so the commits must be recovered from the log
+        File::copy(path, path_2);
+        File::copy(wal_path, WriteAheadLog::get_path(path_2));
+        {
+            DBRef sg_2 = DB::create(path_2);
+            ReadTransaction rt(sg_2);
+            rt.get_group().verify();
+            CHECK_EQUAL(20, rt.get_table("test")->size());
+        }
+        CHECK_EQUAL(File(WriteAheadLog::get_path(path_2)).get_size(), 0);
+
+        // A large commit is flushed to the file instead
+        {
+            WriteTransaction wt(sg);
+            auto t1 = wt.get_table("test");
+            std::string big(WriteAheadLog::checkpoint_size, 'x');
+            t1->create_object().set_all(1, 20, false, StringData(big));
+            wt.commit();
+        }
+        CHECK_EQUAL(File(wal_path).get_size(), 0);
+
+        WriteTransaction wt(sg);
+        wt.get_table("test")->create_object().set_all(1, 21, false, "test");
+        wt.commit();
+    }
+    // The log is checkpointed on close
+    CHECK_EQUAL(File(wal_path).get_size(), 0);
+
+    DBRef sg = DB::create(path);
+    ReadTransaction rt(sg);
+    rt.get_group().verify();
+    CHECK_EQUAL(22, rt.get_table("test")->size());
+}
+
+TEST(Shared_CompactWithWriteAheadLog)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    std::string wal_path = WriteAheadLog::get_path(path);
+    for (bool group_commit : {false, true}) {
+        DBOptions options;
+        options.write_ahead_log = true;
+        if (group_commit)
+            options.group_commit_window = std::chrono::milliseconds(1);
+        DBRef sg = DB::create(path, false, options);
+        for (int i = 0; i < 10; ++i) {
+            WriteTransaction wt(sg);
+            auto t1 = wt.get_or_add_table("test");
+            if (t1->is_empty())
+                test_table_add_columns(t1);
+            t1->create_object().set_all(1, i, false, "test");
+            wt.commit();
+        }
+        CHECK_GREATER(File(wal_path).get_size(), 0);
+
+        // The commits in the log are checkpointed before the file is replaced
+        CHECK(sg->compact());
+        CHECK_EQUAL(File(wal_path).get_size(), 0);
+        {
+            ReadTransaction rt(sg);
+            rt.get_group().verify();
+            CHECK_EQUAL(group_commit ? 21 : 10, rt.get_table("test")->size());
+        }
+
+        // Commits after the compaction go to the log again
+        WriteTransaction wt(sg);
+        wt.get_table("test")->create_object().set_all(1, 10, false, "test");
+        wt.commit();
+        CHECK_GREATER(File(wal_path).get_size(), 0);
+
+        // A transaction other than the ones waiting to be made durable
+        // still prevents compaction
+        ReadTransaction rt(sg);
+        CHECK_NOT(sg->compact());
+    }
+
+    DBRef sg = DB::create(path);
+    ReadTransaction rt(sg);
+    rt.get_group().verify();
+    CHECK_EQUAL(22, rt.get_table("test")->size());
+}
+
 #if !REALM_ENABLE_ENCRYPTION && defined(ENABLE_ROBUST_AGAINST_DEATH_DURING_WRITE)
 // this unittest has issues that has not been fully understood, but could be
 // related to interaction between posix robust mutexes and the fork() system call.
@@ -1692,6 +2061,608 @@ TEST(Shared_SpaceOveruse)
 }
 
 
+TEST(Shared_FragmentedFreeSpaceReuse)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    DBRef sg = DB::create(path, false, DBOptions(crypt_key()));
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    const int num_objects = 2000;
+    ColKey col;
+    {
+        WriteTransaction wt(sg);
+        auto table = wt.add_table("table");
+        col = table->add_column(type_String, "text");
+        for (int i = 0; i < num_objects; ++i)
+            table->create_object(ObjKey(i)).set(col, std::string(8 + i % 300, 'a'));
+        wt.commit();
+    }
+
+    // Strings of many different lengths leave free chunks of many sizes, and
+    // a reader held over some of the commits keeps some of them locked
+    auto update = [&](int rounds) {
+        for (int i = 0; i < rounds; ++i) {
+            TransactionRef reader = (i % 4 == 0) ? sg->start_read() : TransactionRef();
+            WriteTransaction wt(sg);
+            auto table = wt.get_table("table");
+            for (int j = 0; j < 50; ++j) {
+                auto obj = table->get_object(ObjKey(random.draw_int_mod(num_objects)));
+                obj.set(col, std::string(1 + random.draw_int_mod(1000), 'b'));
+            }
+            wt.commit();
+        }
+    };
+    update(100);
+    size_t size_after_warmup = size_t(File(path).get_size());
+    update(100);
+    size_t size_after_more = size_t(File(path).get_size());
+    // The file grows while the data does, but not because space is lost
+    CHECK_LESS_EQUAL(size_after_more, size_after_warmup * 2);
+
+    ReadTransaction rt(sg);
+    rt.get_group().verify();
+    CHECK_EQUAL(num_objects, rt.get_table("table")->size());
+}
+
+
+TEST(Shared_IncrementalCompaction)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    DBOptions options;
+    options.incremental_compaction = true;
+    std::unique_ptr<Replication> hist(make_in_realm_history(path));
+    DBRef sg = DB::create(*hist, options);
+    ColKey col_bulk, col_kept, col_counter;
+    auto kept_value = [](int i) {
+        return std::string(1000, char('a' + i % 26));
+    };
+    {
+        WriteTransaction wt(sg);
+        auto bulk = wt.add_table("bulk");
+        col_bulk = bulk->add_column(type_String, "text");
+        // Distinct values, so that the column is not enumerated
+        for (int i = 0; i < 2000; ++i)
+            bulk->create_object(ObjKey(i)).set(col_bulk, std::string(4000, 'x') + util::to_string(i));
+        wt.commit();
+    }
+    {
+        // Lands beyond the bulk data at the end of the file, in more arrays
+        // than are searched by one commit
+        WriteTransaction wt(sg);
+        auto kept = wt.add_table("kept");
+        col_kept = kept->add_column(type_String, "text");
+        for (int i = 0; i < 3000; ++i)
+            kept->create_object(ObjKey(i)).set(col_kept, kept_value(i));
+        auto counter = wt.add_table("counter");
+        col_counter = counter->add_column(type_Int, "value");
+        counter->create_object(ObjKey(0));
+        wt.commit();
+    }
+    {
+        WriteTransaction wt(sg);
+        wt.get_table("bulk")->clear();
+        wt.commit();
+    }
+    size_t size_before = size_t(File(path).get_size());
+
+    // Commits that do not touch the kept data move it, and accessors see it
+    // wherever it is
+    TransactionRef reader = sg->start_read();
+    Obj obj = reader->get_table("kept")->get_object(ObjKey(123));
+    for (int i = 0; i < 100; ++i) {
+        WriteTransaction wt(sg);
+        wt.get_table("counter")->get_object(ObjKey(0)).add_int(col_counter, 1);
+        wt.commit();
+        reader->advance_read();
+        CHECK_EQUAL(obj.get<String>(col_kept), kept_value(123));
+    }
+    size_t size_after = size_t(File(path).get_size());
+    CHECK_LESS(size_after, size_before / 2);
+
+    reader->verify();
+    auto kept = reader->get_table("kept");
+    for (int i = 0; i < 3000; ++i)
+        CHECK_EQUAL(kept->get_object(ObjKey(i)).get<String>(col_kept), kept_value(i));
+    reader.reset();
+    sg.reset();
+
+    // The truncated file opens as usual
+    sg = DB::create(*hist, options);
+    ReadTransaction rt(sg);
+    rt.get_group().verify();
+    CHECK_EQUAL(rt.get_table("counter")->get_object(ObjKey(0)).get<Int>(col_counter), 100);
+    CHECK_EQUAL(rt.get_table("kept")->get_object(ObjKey(2999)).get<String>(col_kept), kept_value(2999));
+}
+
+
+TEST(Shared_PackIntegers)
+{
+    SHARED_GROUP_TEST_PATH(path_1);
+    SHARED_GROUP_TEST_PATH(path_2);
+    DBOptions options;
+    DBRef plain = DB::create(path_1, false, options);
+    options.pack_integers = true;
+    DBRef packed = DB::create(path_2, false, options);
+
+    const int64_t base = 1'600'000'000;
+    ColKey col_int, col_null, col_date, col_link;
+    for (DBRef db : {plain, packed}) {
+        WriteTransaction wt(db);
+        auto t = wt.add_table("table");
+        col_int = t->add_column(type_Int, "int");
+        col_null = t->add_column(type_Int, "null", true);
+        col_date = t->add_column(type_Timestamp, "date");
+        col_link = t->add_column_link(type_Link, "link", *t);
+        for (int64_t i = 0; i < 3000; ++i) {
+            Obj obj = t->create_object(ObjKey(i));
+            obj.set(col_int, base + i * 7);
+            if (i % 5 != 0)
+                obj.set(col_null, -base + i % 100);
+            obj.set(col_date, Timestamp(base + i, 0));
+            obj.set(col_link, ObjKey((i * 11) % (i + 1)));
+        }
+        wt.commit();
+    }
+    // Older versions refuse to open a file with packed leaves
+    CHECK_EQUAL(_impl::GroupFriend::get_file_format_version(*plain->start_read()), 20);
+    CHECK_EQUAL(_impl::GroupFriend::get_file_format_version(*packed->start_read()), 21);
+    {
+        Group group(path_2);
+        CHECK_EQUAL(_impl::GroupFriend::get_file_format_version(group), 21);
+    }
+
+    auto compare = [&] {
+        ReadTransaction rt_1(plain);
+        ReadTransaction rt_2(packed);
+        rt_2.get_group().verify();
+        auto t_1 = rt_1.get_table("table");
+        auto t_2 = rt_2.get_table("table");
+        CHECK_EQUAL(t_1->size(), t_2->size());
+        for (Obj obj_1 : *t_1) {
+            Obj obj_2 = t_2->get_object(obj_1.get_key());
+            CHECK_EQUAL(obj_1.get<Int>(col_int), obj_2.get<Int>(col_int));
+            CHECK_EQUAL(obj_1.get<util::Optional<Int>>(col_null), obj_2.get<util::Optional<Int>>(col_null));
+            CHECK_EQUAL(obj_1.get<Timestamp>(col_date), obj_2.get<Timestamp>(col_date));
+            CHECK_EQUAL(obj_1.get<ObjKey>(col_link), obj_2.get<ObjKey>(col_link));
+        }
+        for (int64_t v : {base - 1, base, base + 700, base + 701, base + 20993, base + 30000}) {
+            CHECK_EQUAL(t_1->where().equal(col_int, v).count(), t_2->where().equal(col_int, v).count());
+            CHECK_EQUAL(t_1->where().not_equal(col_int, v).count(), t_2->where().not_equal(col_int, v).count());
+            CHECK_EQUAL(t_1->where().greater(col_int, v).count(), t_2->where().greater(col_int, v).count());
+            CHECK_EQUAL(t_1->where().less(col_int, v).count(), t_2->where().less(col_int, v).count());
+            CHECK_EQUAL(t_1->where().less(col_int, v).sum_int(col_int), t_2->where().less(col_int, v).sum_int(col_int));
+            Timestamp ts(v, 0);
+            CHECK_EQUAL(t_1->where().greater(col_date, ts).count(), t_2->where().greater(col_date, ts).count());
+        }
+        for (int64_t v : {-base, -base + 50, -base + 99}) {
+            CHECK_EQUAL(t_1->where().equal(col_null, v).count(), t_2->where().equal(col_null, v).count());
+            CHECK_EQUAL(t_1->where().greater(col_null, v).count(), t_2->where().greater(col_null, v).count());
+        }
+        CHECK_EQUAL(t_1->where().equal(col_null, null()).count(), t_2->where().equal(col_null, null()).count());
+        CHECK_EQUAL(t_1->sum_int(col_int), t_2->sum_int(col_int));
+        CHECK_EQUAL(t_1->minimum_int(col_int), t_2->minimum_int(col_int));
+        CHECK_EQUAL(t_1->maximum_int(col_int), t_2->maximum_int(col_int));
+        CHECK_EQUAL(t_1->sum_int(col_null), t_2->sum_int(col_null));
+        CHECK_EQUAL(t_1->maximum_int(col_null), t_2->maximum_int(col_null));
+        CHECK_EQUAL(t_1->where().links_to(col_link, ObjKey(33)).count(),
+                    t_2->where().links_to(col_link, ObjKey(33)).count());
+        CHECK_EQUAL(t_1->find_first_int(col_int, base + 1400), t_2->find_first_int(col_int, base + 1400));
+    };
+    compare();
+    {
+        ReadTransaction rt_1(plain);
+        ReadTransaction rt_2(packed);
+        CHECK_LESS(rt_2.get_table("table")->compute_aggregated_byte_size(),
+                   rt_1.get_table("table")->compute_aggregated_byte_size());
+    }
+
+    // Packed leaves are unpacked when modified, also by values beyond the
+    // ones they hold
+    for (DBRef db : {plain, packed}) {
+        WriteTransaction wt(db);
+        auto t = wt.get_table("table");
+        t->get_object(ObjKey(10)).set(col_int, base + 15);
+        t->get_object(ObjKey(1500)).set(col_int, -1);
+        t->get_object(ObjKey(2000)).set(col_null, util::Optional<int64_t>(-base + 1000));
+        t->get_object(ObjKey(2001)).set_null(col_null);
+        t->get_object(ObjKey(2500)).set(col_date, Timestamp(base * 2, 5));
+        t->get_object(ObjKey(2999)).set(col_link, ObjKey(33));
+        t->remove_object(ObjKey(700));
+        t->create_object(ObjKey(5000)).set(col_int, base * 3);
+        wt.commit();
+    }
+    compare();
+}
+
+TEST(Shared_EnumerateStringColumns)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    DBRef db = DB::create(path);
+    const char* statuses[] = {"open", "closed", "pending"};
+    ColKey col_status, col_country, col_name;
+    {
+        WriteTransaction wt(db);
+        auto t = wt.add_table("table");
+        col_status = t->add_column(type_String, "status", true);
+        col_country = t->add_column(type_String, "country");
+        col_name = t->add_column(type_String, "name");
+        auto small = wt.add_table("small");
+        auto col_small = small->add_column(type_String, "status");
+        for (int i = 0; i < 3000; ++i) {
+            Obj obj = t->create_object();
+            if (i % 7 != 0)
+                obj.set(col_status, statuses[i % 3]);
+            obj.set(col_country, std::string("country ") + util::to_string(i % 40));
+            obj.set(col_name, std::string("name ") + util::to_string(i));
+        }
+        // Too small to be enumerated
+        for (int i = 0; i < 500; ++i)
+            small->create_object().set(col_small, statuses[i % 3]);
+        wt.commit();
+    }
+
+    auto check_queries = [&](ConstTableRef t) {
+        auto count_matching = [&](ColKey col, auto pred) {
+            size_t n = 0;
+            for (auto obj : *t)
+                n += pred(obj.get<String>(col));
+            return n;
+        };
+        for (StringData value : {StringData("open"), StringData("archived"), StringData("none"), StringData()}) {
+            CHECK_EQUAL(t->where().equal(col_status, value).count(), count_matching(col_status, [&](StringData v) {
+                return v == value;
+            }));
+            CHECK_EQUAL(t->where().not_equal(col_status, value).count(),
+                        count_matching(col_status, [&](StringData v) {
+                            return v != value;
+                        }));
+        }
+        CHECK_EQUAL(t->where().equal(col_status, "OPEN", false).count(), count_matching(col_status, [](StringData v) {
+            return v == "open";
+        }));
+        CHECK_EQUAL(t->where().begins_with(col_country, "country 1").count(),
+                    count_matching(col_country, [](StringData v) {
+                        return v.begins_with("country 1");
+                    }));
+        CHECK_EQUAL(t->where().contains(col_country, "y 3").count(), count_matching(col_country, [](StringData v) {
+            return v.contains("y 3");
+        }));
+        CHECK_EQUAL(t->where().contains(col_status, "EN", false).count(),
+                    count_matching(col_status, [](StringData v) {
+                        return v == "open" || v == "pending";
+                    }));
+        // In
+        Query q = t->where()
+                      .equal(col_status, "closed")
+                      .Or()
+                      .equal(col_status, "archived")
+                      .Or()
+                      .equal(col_status, StringData());
+        CHECK_EQUAL(q.count(), count_matching(col_status, [](StringData v) {
+            return v == "closed" || v == "archived" || v.is_null();
+        }));
+        Query q2 = t->where().equal(col_country, "country 3").equal(col_status, "pending");
+        size_t expected = 0;
+        for (auto obj : *t)
+            expected += obj.get<String>(col_country) == "country 3" && obj.get<String>(col_status) == "pending";
+        CHECK_EQUAL(q2.count(), expected);
+
+        // Distinct keeps the first object with each value
+        auto tv = t->where().find_all();
+        tv.distinct(DistinctDescriptor({{col_country}, {col_status}}));
+        std::set<std::tuple<std::string, bool, std::string>> seen;
+        std::vector<ObjKey> expected_keys;
+        for (auto obj : *t) {
+            StringData status = obj.get<String>(col_status);
+            std::string country(obj.get<String>(col_country));
+            if (seen.emplace(country, status.is_null(), status.is_null() ? "" : std::string(status)).second)
+                expected_keys.push_back(obj.get_key());
+        }
+        CHECK_EQUAL(tv.size(), expected_keys.size());
+        for (size_t i = 0; i < tv.size() && i < expected_keys.size(); ++i)
+            CHECK_EQUAL(tv.get_key(i), expected_keys[i]);
+    };
+
+    {
+        ReadTransaction rt(db);
+        rt.get_group().verify();
+        auto t = rt.get_table("table");
+        CHECK(t->is_enumerated(col_status));
+        CHECK(t->is_enumerated(col_country));
+        CHECK(!t->is_enumerated(col_name));
+        CHECK_EQUAL(t->get_num_unique_values(col_status), 4);
+        CHECK_EQUAL(t->get_object(1).get<String>(col_status), "closed");
+        CHECK(t->get_object(0).is_null(col_status));
+        auto small = rt.get_table("small");
+        CHECK(!small->is_enumerated(small->get_column_key("status")));
+        check_queries(t);
+    }
+
+    // Values not seen before are added to the unique values
+    {
+        WriteTransaction wt(db);
+        auto t = wt.get_table("table");
+        for (auto obj : *t) {
+            if (obj.get_key().value % 10 == 3)
+                obj.set(col_status, "archived");
+        }
+        t->create_object().set(col_country, "country 100");
+        wt.commit();
+    }
+    {
+        ReadTransaction rt(db);
+        rt.get_group().verify();
+        auto t = rt.get_table("table");
+        CHECK_EQUAL(t->get_num_unique_values(col_status), 5);
+        CHECK_EQUAL(t->get_object(3).get<String>(col_status), "archived");
+        check_queries(t);
+    }
+
+    // The size of the table when the columns were looked at is kept in the
+    // file, so they are not looked at again before the table has doubled in
+    // size, also not by another session
+    db->close();
+    db = DB::create(path);
+    ColKey col_kind;
+    {
+        WriteTransaction wt(db);
+        auto t = wt.get_table("table");
+        col_kind = t->add_column(type_String, "kind");
+        for (auto obj : *t)
+            obj.set(col_kind, "a");
+        wt.commit();
+    }
+    CHECK_NOT(db->start_read()->get_table("table")->is_enumerated(col_kind));
+    {
+        WriteTransaction wt(db);
+        auto t = wt.get_table("table");
+        for (int i = 0; i < 3000; ++i)
+            t->create_object().set(col_kind, "b");
+        wt.commit();
+    }
+    CHECK(db->start_read()->get_table("table")->is_enumerated(col_kind));
+}
+
+TEST(Shared_CompressColumns)
+{
+    SHARED_GROUP_TEST_PATH(path_1);
+    SHARED_GROUP_TEST_PATH(path_2);
+    DBRef plain = DB::create(path_1);
+    DBRef compressed = DB::create(path_2);
+
+    auto make_document = [](int64_t i) {
+        return "{\"id\": " + util::to_string(i) + ", \"name\": \"user " + util::to_string(i % 50) +
+               "\", \"roles\": [\"reader\", \"writer\"], \"address\": {\"city\": \"Copenhagen\", "
+               "\"zip\": \"" +
+               util::to_string(1000 + i % 30) + "\"}}";
+    };
+    ColKey col_doc, col_bin, col_int;
+    for (DBRef db : {plain, compressed}) {
+        WriteTransaction wt(db);
+        auto t = wt.add_table("table");
+        col_doc = t->add_column(type_String, "doc", true);
+        col_bin = t->add_column(type_Binary, "bin", true);
+        col_int = t->add_column(type_Int, "int");
+        for (int64_t i = 0; i < 3000; ++i) {
+            Obj obj = t->create_object(ObjKey(i));
+            std::string doc = make_document(i);
+            if (i % 11 != 0)
+                obj.set(col_doc, doc);
+            obj.set(col_bin, BinaryData(doc.data(), doc.size()));
+            obj.set(col_int, i);
+        }
+        if (db == compressed) {
+            CHECK_THROW(t->compress_column(col_int), LogicError);
+            t->compress_column(col_doc);
+            t->compress_column(col_bin);
+            CHECK(t->is_compressed(col_doc));
+            CHECK_NOT(t->is_compressed(col_int));
+        }
+        wt.commit();
+    }
+
+    auto compare = [&] {
+        ReadTransaction rt_1(plain);
+        ReadTransaction rt_2(compressed);
+        rt_2.get_group().verify();
+        auto t_1 = rt_1.get_table("table");
+        auto t_2 = rt_2.get_table("table");
+        CHECK_EQUAL(t_1->size(), t_2->size());
+        // Values read through Obj stay valid while others are read
+        std::vector<StringData> docs;
+        for (Obj obj_1 : *t_1) {
+            Obj obj_2 = t_2->get_object(obj_1.get_key());
+            docs.push_back(obj_2.get<String>(col_doc));
+            CHECK_EQUAL(obj_1.get<Binary>(col_bin), obj_2.get<Binary>(col_bin));
+        }
+        size_t ndx = 0;
+        for (Obj obj_1 : *t_1)
+            CHECK_EQUAL(obj_1.get<String>(col_doc), docs[ndx++]);
+
+        for (StringData value : {StringData(make_document(22)), StringData(make_document(23)), StringData()}) {
+            CHECK_EQUAL(t_1->where().equal(col_doc, value).count(), t_2->where().equal(col_doc, value).count());
+            CHECK_EQUAL(t_1->where().not_equal(col_doc, value).count(),
+                        t_2->where().not_equal(col_doc, value).count());
+        }
+        CHECK_EQUAL(t_1->where().contains(col_doc, "user 7\"").count(),
+                    t_2->where().contains(col_doc, "user 7\"").count());
+        CHECK_EQUAL(t_1->where().begins_with(col_doc, "{\"id\": 12").count(),
+                    t_2->where().begins_with(col_doc, "{\"id\": 12").count());
+        BinaryData bin("\"zip\": \"1017\"", 13);
+        CHECK_EQUAL(t_1->where().contains(col_bin, bin).count(), t_2->where().contains(col_bin, bin).count());
+        CHECK_EQUAL(t_1->where().equal(col_doc, "{\"ID", false).count(),
+                    t_2->where().equal(col_doc, "{\"ID", false).count());
+        CHECK_EQUAL(t_1->get_sorted_view(col_doc).get_object(100).get_key(),
+                    t_2->get_sorted_view(col_doc).get_object(100).get_key());
+        CHECK_EQUAL(t_1->find_first_string(col_doc, make_document(1234)),
+                    t_2->find_first_string(col_doc, make_document(1234)));
+    };
+    compare();
+    {
+        ReadTransaction rt_1(plain);
+        ReadTransaction rt_2(compressed);
+        CHECK_LESS(rt_2.get_table("table")->compute_aggregated_byte_size() * 2,
+                   rt_1.get_table("table")->compute_aggregated_byte_size());
+    }
+
+    // Compressed leaves are decompressed when modified, and compressed again
+    // on commit
+    for (DBRef db : {plain, compressed}) {
+        WriteTransaction wt(db);
+        auto t = wt.get_table("table");
+        StringData doc_20 = t->get_object(ObjKey(20)).get<String>(col_doc);
+        t->get_object(ObjKey(10)).set(col_doc, doc_20);
+        t->get_object(ObjKey(11)).set(col_doc, "short");
+        t->get_object(ObjKey(1500)).set_null(col_doc);
+        t->get_object(ObjKey(2000)).set(col_bin, BinaryData("abc", 3));
+        t->remove_object(ObjKey(700));
+        for (int64_t i = 5000; i < 5300; ++i)
+            t->create_object(ObjKey(i)).set(col_doc, make_document(i));
+        CHECK_EQUAL(t->get_object(ObjKey(10)).get<String>(col_doc), make_document(20));
+        wt.commit();
+    }
+    compare();
+
+    {
+        WriteTransaction wt(compressed);
+        auto t = wt.get_table("table");
+        t->decompress_column(col_doc);
+        CHECK_NOT(t->is_compressed(col_doc));
+        CHECK(t->is_compressed(col_bin));
+        wt.commit();
+    }
+    compare();
+    {
+        WriteTransaction wt(compressed);
+        wt.get_table("table")->decompress_column(col_bin);
+        wt.commit();
+    }
+    compare();
+    {
+        ReadTransaction rt(compressed);
+        CHECK_NOT(rt.get_table("table")->is_compressed(col_bin));
+    }
+}
+
+
+TEST(Shared_CompactStrings)
+{
+    SHARED_GROUP_TEST_PATH(path_1);
+    SHARED_GROUP_TEST_PATH(path_2);
+    DBOptions options;
+    DBRef plain = DB::create(path_1, false, options);
+    options.compact_strings = true;
+    DBRef compact = DB::create(path_2, false, options);
+
+    const char* cities[] = {"Copenhagen", "Aarhus", "Odense", "Aalborg", "Esbjerg", "Randers", "Kolding"};
+    auto make_city = [&](int64_t i) -> std::string {
+        // Too many unique values for the column to be enumerated
+        if (i % 5 == 0)
+            return "unique " + util::to_string(i);
+        return cities[i % 7];
+    };
+    ColKey col_city, col_code, col_list;
+    for (DBRef db : {plain, compact}) {
+        WriteTransaction wt(db);
+        auto t = wt.add_table("table");
+        col_city = t->add_column(type_String, "city", true);
+        col_code = t->add_column(type_String, "code");
+        col_list = t->add_column_list(type_String, "list");
+        for (int64_t i = 0; i < 3000; ++i) {
+            Obj obj = t->create_object(ObjKey(i));
+            if (i % 13 != 0)
+                obj.set(col_city, make_city(i));
+            if (i % 3 != 0)
+                obj.set(col_code, "Postal code " + util::to_string(i % 2 ? i % 1000 : 7));
+            auto list = obj.get_list<String>(col_list);
+            for (int64_t j = 0; j < i % 4; ++j)
+                list.add(cities[(i + j) % 7]);
+        }
+        wt.commit();
+    }
+
+    auto compare = [&] {
+        ReadTransaction rt_1(plain);
+        ReadTransaction rt_2(compact);
+        rt_2.get_group().verify();
+        auto t_1 = rt_1.get_table("table");
+        auto t_2 = rt_2.get_table("table");
+        CHECK_NOT(t_2->is_enumerated(col_city));
+        CHECK_EQUAL(t_1->size(), t_2->size());
+        for (Obj obj_1 : *t_1) {
+            Obj obj_2 = t_2->get_object(obj_1.get_key());
+            CHECK_EQUAL(obj_1.get<String>(col_city), obj_2.get<String>(col_city));
+            CHECK_EQUAL(obj_1.get<String>(col_code), obj_2.get<String>(col_code));
+            auto list_1 = obj_1.get_list<String>(col_list);
+            auto list_2 = obj_2.get_list<String>(col_list);
+            CHECK_EQUAL(list_1.size(), list_2.size());
+            for (size_t j = 0; j < list_1.size(); ++j)
+                CHECK_EQUAL(list_1.get(j), list_2.get(j));
+        }
+
+        for (StringData value : {StringData("Aarhus"), StringData("unique 1235"), StringData("Odens"), StringData(),
+                                 StringData("")}) {
+            CHECK_EQUAL(t_1->where().equal(col_city, value).count(), t_2->where().equal(col_city, value).count());
+            CHECK_EQUAL(t_1->where().not_equal(col_city, value).count(),
+                        t_2->where().not_equal(col_city, value).count());
+            CHECK_EQUAL(t_1->where().equal(col_code, value).count(), t_2->where().equal(col_code, value).count());
+            if (!value.is_null()) {
+                CHECK_EQUAL(t_1->where().begins_with(col_city, value).count(),
+                            t_2->where().begins_with(col_city, value).count());
+                CHECK_EQUAL(t_1->where().begins_with(col_code, value).count(),
+                            t_2->where().begins_with(col_code, value).count());
+            }
+        }
+        for (StringData prefix : {"Aa", "unique 12", "Postal code 7", "Postal code 59"}) {
+            CHECK_EQUAL(t_1->where().begins_with(col_city, prefix).count(),
+                        t_2->where().begins_with(col_city, prefix).count());
+            CHECK_EQUAL(t_1->where().begins_with(col_code, prefix).count(),
+                        t_2->where().begins_with(col_code, prefix).count());
+        }
+        CHECK_EQUAL(t_1->where().contains(col_city, "en").count(), t_2->where().contains(col_city, "en").count());
+        CHECK_EQUAL(t_1->where().equal(col_city, "aarhus", false).count(),
+                    t_2->where().equal(col_city, "aarhus", false).count());
+        CHECK_EQUAL(t_1->get_sorted_view(col_city).get_object(1000).get_key(),
+                    t_2->get_sorted_view(col_city).get_object(1000).get_key());
+        CHECK_EQUAL(t_1->find_first_string(col_code, "Postal code 599"),
+                    t_2->find_first_string(col_code, "Postal code 599"));
+        CHECK_EQUAL((t_1->column<Lst<String>>(col_list) == "Odense").count(),
+                    (t_2->column<Lst<String>>(col_list) == "Odense").count());
+    };
+    compare();
+    {
+        ReadTransaction rt_1(plain);
+        ReadTransaction rt_2(compact);
+        CHECK_LESS(rt_2.get_table("table")->compute_aggregated_byte_size(),
+                   rt_1.get_table("table")->compute_aggregated_byte_size());
+    }
+
+    // Compact leaves are expanded when modified, and made compact again on
+    // commit
+    for (DBRef db : {plain, compact}) {
+        WriteTransaction wt(db);
+        auto t = wt.get_table("table");
+        t->get_object(ObjKey(10)).set(col_city, "A much longer name of a city");
+        t->get_object(ObjKey(11)).set_null(col_city);
+        t->get_object(ObjKey(12)).set(col_code, "");
+        t->remove_object(ObjKey(700));
+        t->get_object(ObjKey(1002)).get_list<String>(col_list).insert(0, "Vejle");
+        t->get_object(ObjKey(1003)).get_list<String>(col_list).remove(1);
+        for (int64_t i = 5000; i < 5300; ++i)
+            t->create_object(ObjKey(i)).set(col_city, make_city(i));
+        CHECK_EQUAL(t->get_object(ObjKey(10)).get<String>(col_city), "A much longer name of a city");
+        wt.commit();
+    }
+    compare();
+    {
+        // A transaction that only reads does not write the leaves again
+        WriteTransaction wt(compact);
+        auto t = wt.get_table("table");
+        CHECK_EQUAL(t->where().begins_with(col_city, "A much").find(), ObjKey(10));
+        wt.commit();
+    }
+    compare();
+}
+
 TEST(Shared_Notifications)
 {
     // Create a new shared db
@@ -1046,6 +1046,93 @@ TEST(TableView_MultiColSort)
     CHECK_EQUAL(tv[2].get<float>(col_float), 1.f);
 }
 
+TEST(TableView_MultiColSortLarge)
+{
+    // Large enough to be sorted on several threads, with many ties in the
+    // first column so that the other columns decide the order
+    Table table;
+    auto col_int = table.add_column(type_Int, "int");
+    auto col_str = table.add_column(type_String, "str", true);
+    auto col_double = table.add_column(type_Double, "double");
+
+    std::vector<std::tuple<int64_t, std::string, bool, double, ObjKey>> rows;
+    for (int64_t i = 0; i < 150000; ++i) {
+        int64_t v = (i * 7919) % 100;
+        bool str_null = (i % 13 == 0);
+        std::string str = str_null ? "" : std::to_string((i * 104729) % 50);
+        double d = double((i * 31) % 17);
+        auto obj = table.create_object().set(col_int, v).set(col_double, d);
+        if (!str_null)
+            obj.set(col_str, str);
+        rows.emplace_back(v, str, str_null, d, obj.get_key());
+    }
+
+    // Ascending int, descending string (bytewise, null first), ascending
+    // double, then table order
+    std::stable_sort(rows.begin(), rows.end(), [](auto& a, auto& b) {
+        if (std::get<0>(a) != std::get<0>(b))
+            return std::get<0>(a) < std::get<0>(b);
+        StringData str_a = std::get<2>(a) ? StringData() : StringData(std::get<1>(a));
+        StringData str_b = std::get<2>(b) ? StringData() : StringData(std::get<1>(b));
+        if (str_a != str_b)
+            return str_b < str_a;
+        return std::get<3>(a) < std::get<3>(b);
+    });
+
+    for (unsigned threads : {1, 4}) {
+        Query q = table.where();
+        q.set_threads(threads);
+        TableView tv = q.find_all();
+        tv.sort(SortDescriptor({{col_int}, {col_str}, {col_double}}, {true, false, true}));
+        CHECK_EQUAL(tv.size(), rows.size());
+        bool same = true;
+        for (size_t i = 0; i < rows.size() && same; ++i)
+            same = tv.get_key(i) == std::get<4>(rows[i]);
+        CHECK(same);
+
+        // Distinct keeps the first object of every combination, in table order
+        tv = q.find_all();
+        tv.distinct(DistinctDescriptor({{col_int}, {col_double}}));
+        CHECK_EQUAL(tv.size(), 100 * 17);
+        for (size_t i = 1; i < tv.size(); ++i)
+            CHECK_LESS(tv.get_key(i - 1), tv.get_key(i));
+    }
+}
+
+TEST(TableView_MultiColSortNullAndNaN)
+{
+    // Null and NaN are ordered the same way in every sort column
+    Table table;
+    auto col_int = table.add_column(type_Int, "int");
+    auto col_float = table.add_column(type_Float, "float", true);
+    auto col_double = table.add_column(type_Double, "double", true);
+    float nan_f = std::numeric_limits<float>::quiet_NaN();
+    double nan_d = std::numeric_limits<double>::quiet_NaN();
+
+    auto k0 = table.create_object().set(col_float, 2.f).set(col_double, 2.).get_key();
+    auto k1 = table.create_object().get_key();
+    auto k2 = table.create_object().set(col_float, nan_f).set(col_double, nan_d).get_key();
+    auto k3 = table.create_object().set(col_float, -1.f).set(col_double, -1.).get_key();
+    std::vector<ObjKey> ascending = {k1, k2, k3, k0};
+    std::vector<ObjKey> descending = {k0, k3, k2, k1};
+
+    for (auto col : {col_float, col_double}) {
+        for (bool first : {true, false}) {
+            auto columns = first ? std::vector<std::vector<ColKey>>{{col}}
+                                 : std::vector<std::vector<ColKey>>{{col_int}, {col}};
+            TableView tv = table.where().find_all();
+            tv.sort(SortDescriptor(columns, std::vector<bool>(columns.size(), true)));
+            CHECK_EQUAL(tv.size(), 4);
+            for (size_t i = 0; i < tv.size(); ++i)
+                CHECK_EQUAL(tv.get_key(i), ascending[i]);
+            tv = table.where().find_all();
+            tv.sort(SortDescriptor(columns, std::vector<bool>(columns.size(), false)));
+            for (size_t i = 0; i < tv.size(); ++i)
+                CHECK_EQUAL(tv.get_key(i), descending[i]);
+        }
+    }
+}
+
 TEST(TableView_QueryCopy)
 {
     Table table;
@@ -1581,6 +1668,102 @@ TEST(TableView_DistinctOverNullLink)
     CHECK_EQUAL(tv.get(1).get_linked_object(col_link).get<Int>(col_int), 1);
 }
 
+TEST(TableView_DistinctKeepsOrder)
+{
+    Table table;
+    auto col_int = table.add_column(type_Int, "int");
+    auto col_double = table.add_column(type_Double, "double");
+    auto col_str = table.add_column(type_String, "str", true);
+    auto col_decimal = table.add_column(type_Decimal, "decimal");
+    table.add_search_index(col_str);
+
+    std::vector<ObjKey> keys;
+    keys.push_back(table.create_object().set_all(3, 0.0, "a", Decimal128("1.0")).get_key());
+    keys.push_back(table.create_object().set_all(1, -0.0, "b", Decimal128("1.00")).get_key());
+    keys.push_back(table.create_object().set_all(3, 2.5, "c", Decimal128("2")).get_key());
+    keys.push_back(table.create_object().set_all(2, 2.5, "d", Decimal128("1")).get_key());
+    keys.push_back(table.create_object().set_all(1, 0.0, "e", Decimal128("2")).get_key());
+
+    // The first object of each value is kept, in view order
+    TableView tv = table.where().find_all();
+    tv.distinct(DistinctDescriptor({{col_int}}));
+    CHECK_EQUAL(tv.size(), 3);
+    CHECK_EQUAL(tv.get_key(0), keys[0]);
+    CHECK_EQUAL(tv.get_key(1), keys[1]);
+    CHECK_EQUAL(tv.get_key(2), keys[3]);
+
+    // 0 and -0 are the same value
+    tv = table.where().find_all();
+    tv.distinct(DistinctDescriptor({{col_double}}));
+    CHECK_EQUAL(tv.size(), 2);
+    CHECK_EQUAL(tv.get_key(0), keys[0]);
+    CHECK_EQUAL(tv.get_key(1), keys[2]);
+
+    // Decimals are compared by value
+    tv = table.where().find_all();
+    tv.distinct(DistinctDescriptor({{col_decimal}}));
+    CHECK_EQUAL(tv.size(), 2);
+    CHECK_EQUAL(tv.get_key(0), keys[0]);
+    CHECK_EQUAL(tv.get_key(1), keys[2]);
+
+    // After a sort, the first object in sorted order is kept
+    tv = table.where().find_all();
+    tv.sort(col_str, false);
+    tv.distinct(DistinctDescriptor({{col_int}, {col_double}}));
+    CHECK_EQUAL(tv.size(), 4);
+    CHECK_EQUAL(tv.get_key(0), keys[4]);
+    CHECK_EQUAL(tv.get_key(1), keys[3]);
+    CHECK_EQUAL(tv.get_key(2), keys[2]);
+    CHECK_EQUAL(tv.get_key(3), keys[0]);
+
+    // The search index shows that there are no duplicates, until there are
+    tv = table.where().find_all();
+    tv.distinct(DistinctDescriptor({{col_str}}));
+    CHECK_EQUAL(tv.size(), 5);
+    table.get_object(keys[3]).set(col_str, "a");
+    tv = table.where().find_all();
+    tv.distinct(DistinctDescriptor({{col_str}}));
+    CHECK_EQUAL(tv.size(), 4);
+    CHECK_EQUAL(tv.get_key(3), keys[4]);
+}
+
+TEST(TableView_DistinctOnLinkList)
+{
+    // A view of a link list or of backlinks can hold an object more than once
+    Group g;
+    auto target = g.add_table_with_primary_key("target", type_Int, "id");
+    auto origin = g.add_table("origin");
+    auto col_id = target->get_primary_key_column();
+    auto col_name = target->add_column(type_String, "name");
+    target->add_search_index(col_name);
+    auto col_links = origin->add_column_list(*target, "links");
+
+    auto a = target->create_object_with_primary_key(1).set(col_name, "a");
+    auto b = target->create_object_with_primary_key(2).set(col_name, "b");
+    auto list = origin->create_object().get_linklist_ptr(col_links);
+    list->add(a.get_key());
+    list->add(b.get_key());
+    list->add(a.get_key());
+
+    for (auto col : {col_id, col_name}) {
+        TableView tv = list->get_sorted_view(col);
+        CHECK_EQUAL(tv.size(), 3);
+        tv.distinct(DistinctDescriptor({{col}}));
+        CHECK_EQUAL(tv.size(), 2);
+        CHECK_EQUAL(tv.get_key(0), a.get_key());
+        CHECK_EQUAL(tv.get_key(1), b.get_key());
+    }
+
+    auto origin_obj = origin->begin()->get_key();
+    auto col_origin_name = origin->add_column(type_String, "name");
+    origin->add_search_index(col_origin_name);
+    TableView tv = a.get_backlink_view(origin, col_links);
+    CHECK_EQUAL(tv.size(), 2);
+    tv.distinct(DistinctDescriptor({{col_origin_name}}));
+    CHECK_EQUAL(tv.size(), 1);
+    CHECK_EQUAL(tv.get_key(0), origin_obj);
+}
+
 TEST(TableView_IsRowAttachedAfterClear)
 {
     Table t;
@@ -56,6 +56,8 @@
 #define TEST_FILE_LOCKS
 #define TEST_GROUP
 #define TEST_UPGRADE
+#define TEST_INDEX_FULLTEXT
+#define TEST_INDEX_ORDERED
 #define TEST_INDEX_STRING
 #define TEST_LANG_BIND_HELPER
 #define TEST_METRICS
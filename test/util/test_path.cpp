@@ -202,6 +202,8 @@ void DBTestPathGuard::cleanup() const noexcept
         if (File::is_dir(m_path + ".management"))
             remove_dir(m_path + ".management");
         File::try_remove(get_lock_path());
+        File::try_remove(m_path + ".wal");
+        File::try_remove(m_path + ".warm");
     }
     catch (...) {
         // Exception deliberately ignored